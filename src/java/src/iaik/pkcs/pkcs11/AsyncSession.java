@@ -0,0 +1,556 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.objects.Key;
+import iaik.pkcs.pkcs11.objects.Object;
+
+import java.util.Vector;
+
+/**
+ * Runs operations of a token in the background, so that the threads of the application never wait
+ * for the module; e.g. the event loop threads of a network server. Each operation returns an
+ * OperationFuture at once. A fixed number of worker threads runs the operations in the order of
+ * submission; each worker uses a session of its own, which it opens at startup and uses for all
+ * its operations. The queue of waiting operations is bounded; if it is full, the operation fails
+ * at once instead of blocking. Example:
+ * <code>
+ *   AsyncSession asyncSession = token.createAsyncSession(4, 1000,
+ *       Token.SessionReadWriteBehavior.RO_SESSION);
+ *   OperationFuture future = asyncSession.sign(Mechanism.SHA256_RSA_PKCS, key, data, 100);
+ *   future.addCallback(new OperationFuture.Callback() {
+ *     public void done(OperationFuture future) {
+ *       ...
+ *     }
+ *   });
+ * </code> All sessions of an application share the login state; so if the key is private, the
+ * application must log in with any session, before the operations can use the key. Each operation
+ * takes the mechanism and key with it and runs in a single call to the native part, so operations
+ * of different submitters cannot interfere.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (token_ <> null) and (queue_ <> null) and (workers_ <> null)
+ */
+public class AsyncSession {
+
+  /**
+   * An operation that a worker runs with its session.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   */
+  public interface Operation {
+
+    /**
+     * Run the operation.
+     * 
+     * @param session
+     *          The session of the worker.
+     * @return The result of the operation, or null.
+     * @exception TokenException
+     *              If the operation fails.
+     */
+    public java.lang.Object execute(Session session) throws TokenException;
+
+  }
+
+  /**
+   * An operation waiting in the queue and its future.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (operation_ <> null) and (future_ <> null)
+   */
+  protected static class Task {
+
+    /**
+     * The operation to run.
+     */
+    protected Operation operation_;
+
+    /**
+     * The future of the operation.
+     */
+    protected OperationFuture future_;
+
+    /**
+     * Constructor taking the operation and its future.
+     * 
+     * @param operation
+     *          The operation to run.
+     * @param future
+     *          The future of the operation.
+     */
+    protected Task(Operation operation, OperationFuture future) {
+      operation_ = operation;
+      future_ = future;
+    }
+
+  }
+
+  /**
+   * A worker thread and its session.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (session_ <> null)
+   */
+  protected class Worker implements Runnable {
+
+    /**
+     * The session of this worker.
+     */
+    protected Session session_;
+
+    /**
+     * Constructor taking the session of the worker.
+     * 
+     * @param session
+     *          The session of this worker.
+     */
+    protected Worker(Session session) {
+      session_ = session;
+    }
+
+    /**
+     * Run operations from the queue until the async session is closed, then close the session.
+     */
+    public void run() {
+      Task task;
+      while ((task = takeTask()) != null) {
+        if (!task.future_.start()) {
+          continue;
+        }
+        try {
+          task.future_.complete(task.operation_.execute(session_));
+        } catch (TokenException ex) {
+          task.future_.fail(ex);
+        } catch (Throwable ex) {
+          // also errors, e.g. an OutOfMemoryError; the future must not stay pending, and the
+          // worker must go on and close its session in the end
+          task.future_.fail(new TokenException((ex instanceof Exception) ? (Exception) ex
+              : new RuntimeException(ex)));
+        }
+      }
+      try {
+        session_.closeSession();
+      } catch (TokenException ex) {
+        // nobody is left to report this to
+      }
+    }
+
+  }
+
+  /**
+   * The token of the sessions.
+   */
+  protected Token token_;
+
+  /**
+   * The waiting tasks. Guarded by the monitor of this object.
+   */
+  protected Vector queue_ = new Vector();
+
+  /**
+   * The maximum number of waiting tasks.
+   */
+  protected int queueCapacity_;
+
+  /**
+   * The workers.
+   */
+  protected Worker[] workers_;
+
+  /**
+   * True, if this object has been closed. Guarded by the monitor of this object.
+   */
+  protected boolean closed_;
+
+  /**
+   * Constructor taking the token and the number of workers. It opens a session for each worker and
+   * starts the worker threads, which are daemon threads.
+   * 
+   * @param token
+   *          The token of the sessions.
+   * @param threadCount
+   *          The number of worker threads and sessions.
+   * @param queueCapacity
+   *          The maximum number of operations waiting to be run.
+   * @param rwSession
+   *          Token.SessionReadWriteBehavior.RW_SESSION for read-write sessions, or
+   *          Token.SessionReadWriteBehavior.RO_SESSION for read-only sessions.
+   * @exception TokenException
+   *              If opening a session fails.
+   * @preconditions (token <> null) and (threadCount > 0) and (queueCapacity > 0)
+   */
+  protected AsyncSession(Token token, int threadCount, int queueCapacity, boolean rwSession)
+      throws TokenException {
+    if (token == null) {
+      throw new NullPointerException("Argument \"token\" must not be null.");
+    }
+    if ((threadCount <= 0) || (queueCapacity <= 0)) {
+      throw new IllegalArgumentException("The thread count and queue capacity must be positive.");
+    }
+    token_ = token;
+    queueCapacity_ = queueCapacity;
+
+    workers_ = new Worker[threadCount];
+    try {
+      for (int i = 0; i < threadCount; i++) {
+        workers_[i] = new Worker(token.openSession(Token.SessionType.SERIAL_SESSION, rwSession,
+            null, null));
+      }
+    } catch (TokenException ex) {
+      for (int i = 0; i < threadCount; i++) {
+        if (workers_[i] != null) {
+          workers_[i].session_.closeSession();
+        }
+      }
+      throw ex;
+    }
+    for (int i = 0; i < threadCount; i++) {
+      Thread thread = new Thread(workers_[i], "PKCS#11 async worker " + i);
+      thread.setDaemon(true);
+      thread.start();
+    }
+  }
+
+  /**
+   * Submit an operation. This never blocks. If the queue is full or this object is closed, the
+   * returned future has failed already.
+   * 
+   * @param operation
+   *          The operation to run.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the operation.
+   * @preconditions (operation <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture submit(Operation operation, long timeout) {
+    if (operation == null) {
+      throw new NullPointerException("Argument \"operation\" must not be null.");
+    }
+    OperationFuture future = new OperationFuture((timeout > 0) ? System.currentTimeMillis()
+        + timeout : 0L);
+
+    String failure = null;
+    synchronized (this) {
+      if (closed_) {
+        failure = "The async session is closed.";
+      } else if (queue_.size() >= queueCapacity_) {
+        failure = "The queue of the async session is full.";
+      } else {
+        queue_.addElement(new Task(operation, future));
+        notify();
+      }
+    }
+    if (failure != null) {
+      future.fail(new TokenException(failure));
+    }
+
+    return future;
+  }
+
+  /**
+   * Sign the given data; see Session.sign(Mechanism, Key, byte[]). The result is the signature.
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param key
+   *          The signing key.
+   * @param data
+   *          The data to sign.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the signature.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture sign(final Mechanism mechanism, final Key key, final byte[] data,
+      long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        return session.sign(mechanism, key, data);
+      }
+    }, timeout);
+  }
+
+  /**
+   * Verify the given signature; see Session.verify(Mechanism, Key, byte[], byte[]). The result is
+   * null; an invalid signature fails the operation.
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param key
+   *          The verification key.
+   * @param data
+   *          The signed data.
+   * @param signature
+   *          The signature.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the verification.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   *                and (signature <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture verify(final Mechanism mechanism, final Key key, final byte[] data,
+      final byte[] signature, long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        session.verify(mechanism, key, data, signature);
+        return null;
+      }
+    }, timeout);
+  }
+
+  /**
+   * Encrypt the given data; see Session.encrypt(Mechanism, Key, byte[]). The result is the
+   * encrypted data.
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param key
+   *          The encryption key.
+   * @param data
+   *          The data to encrypt.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the encrypted data.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture encrypt(final Mechanism mechanism, final Key key, final byte[] data,
+      long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        return session.encrypt(mechanism, key, data);
+      }
+    }, timeout);
+  }
+
+  /**
+   * Decrypt the given data; see Session.decrypt(Mechanism, Key, byte[]). The result is the
+   * decrypted data.
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param key
+   *          The decryption key.
+   * @param data
+   *          The data to decrypt.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the decrypted data.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture decrypt(final Mechanism mechanism, final Key key, final byte[] data,
+      long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        return session.decrypt(mechanism, key, data);
+      }
+    }, timeout);
+  }
+
+  /**
+   * Digest the given data; see Session.digest(Mechanism, byte[]). The result is the digest.
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param data
+   *          The data to digest.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the digest.
+   * @preconditions (mechanism <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture digest(final Mechanism mechanism, final byte[] data, long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        return session.digest(mechanism, data);
+      }
+    }, timeout);
+  }
+
+  /**
+   * Wrap the given key; see Session.wrapKey. The result is the wrapped key as byte[].
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param wrappingKey
+   *          The key to wrap with.
+   * @param key
+   *          The key to wrap.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the wrapped key.
+   * @preconditions (mechanism <> null) and (wrappingKey <> null) and (key <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture wrapKey(final Mechanism mechanism, final Key wrappingKey,
+      final Key key, long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        return session.wrapKey(mechanism, wrappingKey, key);
+      }
+    }, timeout);
+  }
+
+  /**
+   * Unwrap the given key; see Session.unwrapKey. The result is the new Key.
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param unwrappingKey
+   *          The key to unwrap with.
+   * @param wrappedKey
+   *          The wrapped key.
+   * @param keyTemplate
+   *          The template for the new key.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the unwrapped key.
+   * @preconditions (mechanism <> null) and (unwrappingKey <> null) and (wrappedKey <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture unwrapKey(final Mechanism mechanism, final Key unwrappingKey,
+      final byte[] wrappedKey, final Object keyTemplate, long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        return session.unwrapKey(mechanism, unwrappingKey, wrappedKey, keyTemplate);
+      }
+    }, timeout);
+  }
+
+  /**
+   * Derive a key; see Session.deriveKey. The result is the derived Key, or null for mechanisms
+   * which return the keys in their parameters.
+   * 
+   * @param mechanism
+   *          The mechanism to use.
+   * @param baseKey
+   *          The key to derive from.
+   * @param template
+   *          The template for the new key.
+   * @param timeout
+   *          The time in milliseconds within which the operation must start, or 0 for no limit.
+   * @return The future of the derived key.
+   * @preconditions (mechanism <> null) and (baseKey <> null)
+   * @postconditions (result <> null)
+   */
+  public OperationFuture deriveKey(final Mechanism mechanism, final Key baseKey,
+      final Key template, long timeout) {
+    return submit(new Operation() {
+      public java.lang.Object execute(Session session) throws TokenException {
+        return session.deriveKey(mechanism, baseKey, template);
+      }
+    }, timeout);
+  }
+
+  /**
+   * Get the number of operations waiting to be run.
+   * 
+   * @return The number of waiting operations.
+   * @postconditions (result >= 0)
+   */
+  public synchronized int getQueueSize() {
+    return queue_.size();
+  }
+
+  /**
+   * Get the token of the sessions.
+   * 
+   * @return The token.
+   * @postconditions (result <> null)
+   */
+  public Token getToken() {
+    return token_;
+  }
+
+  /**
+   * Close this object. Waiting operations fail, running operations finish. The workers close their
+   * sessions and end.
+   */
+  public void close() {
+    Task[] tasks;
+    synchronized (this) {
+      closed_ = true;
+      tasks = new Task[queue_.size()];
+      queue_.copyInto(tasks);
+      queue_.removeAllElements();
+      notifyAll();
+    }
+    for (int i = 0; i < tasks.length; i++) {
+      tasks[i].future_.fail(new TokenException("The async session is closed."));
+    }
+  }
+
+  /**
+   * Take the next task from the queue, waiting for one if the queue is empty.
+   * 
+   * @return The next task, or null if this object has been closed.
+   */
+  protected synchronized Task takeTask() {
+    while (queue_.isEmpty() && !closed_) {
+      try {
+        wait();
+      } catch (InterruptedException ex) {
+        // the workers end only when this object is closed
+      }
+    }
+    if (closed_) {
+      return null;
+    }
+    Task task = (Task) queue_.elementAt(0);
+    queue_.removeElementAt(0);
+
+    return task;
+  }
+
+}
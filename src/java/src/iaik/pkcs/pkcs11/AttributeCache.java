@@ -0,0 +1,381 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.wrapper.CK_ATTRIBUTE;
+import iaik.pkcs.pkcs11.wrapper.Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
+
+import java.util.Hashtable;
+import java.util.Iterator;
+import java.util.LinkedHashMap;
+
+/**
+ * Objects of this class cache attribute values of token objects by object handle, to save calls
+ * to the module for attributes that are read again and again; e.g. CKA_KEY_TYPE or CKA_MODULUS of
+ * a key in use. An application can set a cache for a token, which all its sessions share, or for a
+ * single session; see Token.setAttributeCache and Session.setAttributeCache.
+ * <p>
+ * The cache is bounded by the number of objects and by the estimated number of bytes of the
+ * values. If a bound is exceeded, the objects used least recently are removed. The Session class
+ * keeps the cache up to date for all changes it makes: setting attributes or destroying an object
+ * removes the object from the cache, logging out removes all objects that are not known to be
+ * public and closing a session removes all objects that are not known to be token objects. Changes
+ * made by other applications are not visible to the cache; so applications should only cache
+ * objects that do not change, like keys and certificates on a token.
+ * <p>
+ * Attributes which hold secret key material, like CKA_VALUE or CKA_PRIVATE_EXPONENT, are never
+ * cached, even if the module returns their values. Sensitive attributes have no value that could
+ * be cached at all.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (objects_ <> null) and (maxObjects_ >= 0) and (maxBytes_ >= 0)
+ */
+public class AttributeCache {
+
+  /**
+   * The cached attributes of one object.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (attributes_ <> null) and (bytes_ >= 0)
+   */
+  protected static class Entry {
+
+    /**
+     * The cached attributes. The key is the attribute type as Long, the value the CK_ATTRIBUTE.
+     */
+    protected Hashtable attributes_ = new Hashtable(8);
+
+    /**
+     * The estimated number of bytes of the cached attributes.
+     */
+    protected long bytes_;
+
+  }
+
+  /**
+   * The estimated number of bytes that a cached attribute takes in addition to its value.
+   */
+  protected static final long ATTRIBUTE_OVERHEAD = 32L;
+
+  /**
+   * The maximum number of objects in this cache.
+   */
+  protected int maxObjects_;
+
+  /**
+   * The maximum estimated number of bytes of all cached values.
+   */
+  protected long maxBytes_;
+
+  /**
+   * The cached objects in the order of their last use. The key is the object handle as Long, the
+   * value the Entry.
+   */
+  protected LinkedHashMap objects_;
+
+  /**
+   * The estimated number of bytes of all cached values.
+   */
+  protected long bytes_;
+
+  /**
+   * The number of attributes that have been found in this cache.
+   */
+  protected long hits_;
+
+  /**
+   * The number of attributes that have been looked up but not found in this cache.
+   */
+  protected long misses_;
+
+  /**
+   * Constructor taking the bounds of the cache.
+   * 
+   * @param maxObjects
+   *          The maximum number of objects to cache the attributes of.
+   * @param maxBytes
+   *          The maximum estimated number of bytes of all cached values.
+   * @preconditions (maxObjects >= 0) and (maxBytes >= 0)
+   */
+  public AttributeCache(int maxObjects, long maxBytes) {
+    if (maxObjects < 0) {
+      throw new IllegalArgumentException("Argument \"maxObjects\" must not be negative.");
+    }
+    if (maxBytes < 0) {
+      throw new IllegalArgumentException("Argument \"maxBytes\" must not be negative.");
+    }
+    maxObjects_ = maxObjects;
+    maxBytes_ = maxBytes;
+    objects_ = new LinkedHashMap(16, 0.75f, true);
+  }
+
+  /**
+   * Check, if attributes of the given type may be cached at all. Attributes holding secret key
+   * material may not.
+   * 
+   * @param type
+   *          The attribute type; e.g. PKCS11Constants.CKA_LABEL.
+   * @return True, if the attribute may be cached. False, otherwise.
+   */
+  public static boolean isCacheable(long type) {
+    return (type != PKCS11Constants.CKA_VALUE) && (type != PKCS11Constants.CKA_PRIVATE_EXPONENT)
+        && (type != PKCS11Constants.CKA_PRIME_1) && (type != PKCS11Constants.CKA_PRIME_2)
+        && (type != PKCS11Constants.CKA_EXPONENT_1) && (type != PKCS11Constants.CKA_EXPONENT_2)
+        && (type != PKCS11Constants.CKA_COEFFICIENT);
+  }
+
+  /**
+   * Get the cached attribute of the given type of the given object.
+   * 
+   * @param objectHandle
+   *          The handle of the object.
+   * @param type
+   *          The attribute type.
+   * @return A copy of the cached attribute or null, if it is not cached.
+   */
+  public synchronized CK_ATTRIBUTE get(long objectHandle, long type) {
+    Entry entry = (Entry) objects_.get(new Long(objectHandle));
+    CK_ATTRIBUTE attribute = (entry != null) ? (CK_ATTRIBUTE) entry.attributes_.get(new Long(
+        type)) : null;
+    if (attribute == null) {
+      misses_++;
+      return null;
+    }
+    hits_++;
+
+    return (CK_ATTRIBUTE) attribute.clone();
+  }
+
+  /**
+   * Check, if the attribute of the given type of the given object is cached. This counts as use of
+   * the object, but neither as hit nor as miss.
+   * 
+   * @param objectHandle
+   *          The handle of the object.
+   * @param type
+   *          The attribute type.
+   * @return True, if the attribute is cached. False, otherwise.
+   */
+  public synchronized boolean contains(long objectHandle, long type) {
+    Entry entry = (Entry) objects_.get(new Long(objectHandle));
+
+    return (entry != null) && entry.attributes_.containsKey(new Long(type));
+  }
+
+  /**
+   * Put a copy of the given attribute of the given object into this cache. Attributes that may not
+   * be cached are ignored. If a bound is exceeded afterwards, the objects used least recently are
+   * removed.
+   * 
+   * @param objectHandle
+   *          The handle of the object.
+   * @param attribute
+   *          The attribute as read from the token.
+   * @preconditions (attribute <> null)
+   */
+  public synchronized void put(long objectHandle, CK_ATTRIBUTE attribute) {
+    if (attribute == null) {
+      throw new NullPointerException("Argument \"attribute\" must not be null.");
+    }
+    if (!isCacheable(attribute.type) || (maxObjects_ == 0)) {
+      return;
+    }
+
+    Long handle = new Long(objectHandle);
+    Entry entry = (Entry) objects_.get(handle);
+    if (entry == null) {
+      entry = new Entry();
+      objects_.put(handle, entry);
+    }
+    CK_ATTRIBUTE previous = (CK_ATTRIBUTE) entry.attributes_.put(new Long(attribute.type),
+        attribute.clone());
+    long bytes = getSize(attribute) - ((previous != null) ? getSize(previous) : 0L);
+    entry.bytes_ += bytes;
+    bytes_ += bytes;
+
+    Iterator iterator = objects_.values().iterator();
+    while (((objects_.size() > maxObjects_) || (bytes_ > maxBytes_)) && iterator.hasNext()) {
+      bytes_ -= ((Entry) iterator.next()).bytes_;
+      iterator.remove();
+    }
+  }
+
+  /**
+   * Remove all cached attributes of the given object; e.g. because the object has been changed or
+   * destroyed.
+   * 
+   * @param objectHandle
+   *          The handle of the object.
+   */
+  public synchronized void invalidate(long objectHandle) {
+    Entry entry = (Entry) objects_.remove(new Long(objectHandle));
+    if (entry != null) {
+      bytes_ -= entry.bytes_;
+    }
+  }
+
+  /**
+   * Remove all cached objects except those, for which the given boolean attribute is cached with
+   * the given value. For instance, after a logout only the objects with CKA_PRIVATE cached as false
+   * are still valid.
+   * 
+   * @param type
+   *          The type of a boolean attribute; e.g. PKCS11Constants.CKA_TOKEN.
+   * @param value
+   *          The value of the attribute of the objects to keep.
+   */
+  public synchronized void retainObjects(long type, boolean value) {
+    Iterator iterator = objects_.values().iterator();
+    while (iterator.hasNext()) {
+      Entry entry = (Entry) iterator.next();
+      CK_ATTRIBUTE attribute = (CK_ATTRIBUTE) entry.attributes_.get(new Long(type));
+      if ((attribute == null) || !(attribute.pValue instanceof Boolean)
+          || (((Boolean) attribute.pValue).booleanValue() != value)) {
+        bytes_ -= entry.bytes_;
+        iterator.remove();
+      }
+    }
+  }
+
+  /**
+   * Remove all cached objects.
+   */
+  public synchronized void invalidateAll() {
+    objects_.clear();
+    bytes_ = 0L;
+  }
+
+  /**
+   * Get the number of objects in this cache.
+   * 
+   * @return The number of objects.
+   * @postconditions (result >= 0)
+   */
+  public synchronized int getObjectCount() {
+    return objects_.size();
+  }
+
+  /**
+   * Get the estimated number of bytes of all cached values.
+   * 
+   * @return The estimated number of bytes.
+   * @postconditions (result >= 0)
+   */
+  public synchronized long getByteCount() {
+    return bytes_;
+  }
+
+  /**
+   * Get the number of attributes that have been found in this cache.
+   * 
+   * @return The number of hits.
+   * @postconditions (result >= 0)
+   */
+  public synchronized long getHitCount() {
+    return hits_;
+  }
+
+  /**
+   * Get the number of attributes that have been looked up but not found in this cache.
+   * 
+   * @return The number of misses.
+   * @postconditions (result >= 0)
+   */
+  public synchronized long getMissCount() {
+    return misses_;
+  }
+
+  /**
+   * Estimate the number of bytes that the given attribute takes in this cache.
+   * 
+   * @param attribute
+   *          The attribute.
+   * @return The estimated number of bytes.
+   * @preconditions (attribute <> null)
+   * @postconditions (result >= 0)
+   */
+  protected static long getSize(CK_ATTRIBUTE attribute) {
+    java.lang.Object value = attribute.pValue;
+    long size;
+
+    if (value instanceof byte[]) {
+      size = ((byte[]) value).length;
+    } else if (value instanceof char[]) {
+      size = 2L * ((char[]) value).length;
+    } else if (value instanceof long[]) {
+      size = 8L * ((long[]) value).length;
+    } else {
+      size = 8L;
+    }
+
+    return ATTRIBUTE_OVERHEAD + size;
+  }
+
+  /**
+   * Returns the string representation of this object.
+   * 
+   * @return the string representation of this object
+   */
+  public String toString() {
+    StringBuffer buffer = new StringBuffer();
+
+    buffer.append("Objects: ");
+    buffer.append(getObjectCount());
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Bytes: ");
+    buffer.append(getByteCount());
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Hits: ");
+    buffer.append(getHitCount());
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Misses: ");
+    buffer.append(getMissCount());
+
+    return buffer.toString();
+  }
+
+}
@@ -0,0 +1,421 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.wrapper.Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Exception;
+
+/**
+ * Objects of this class hold the values of the same attributes of many objects, as read by
+ * Session.getAttributeValues(long[], long[]) in a single call. The values are kept as they come
+ * from the native part: packed into one array with a table that holds the offset, the length and
+ * the PKCS#11 error code of each value. A cell is addressed by the index of the object and the
+ * index of the attribute type in the arrays given to the read.
+ * <p>
+ * A value that could not be read, e.g. because it is sensitive (CKR_ATTRIBUTE_SENSITIVE) or the
+ * object does not have this attribute (CKR_ATTRIBUTE_TYPE_INVALID), has an error code other than
+ * CKR_OK and its value is null. Values of type CK_ULONG, like CKA_CLASS or CKA_KEY_TYPE, are
+ * stored as 8 byte big-endian numbers; see getLongValue. The same holds for each element of
+ * CKA_ALLOWED_MECHANISMS. All other values are the raw bytes from the module.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (objectHandles_ <> null) and (attributeTypes_ <> null) and (packedValues_ <> null)
+ *             and (cells_ <> null)
+ */
+public class AttributeValueTable {
+
+  /**
+   * The handles of the objects that have been read.
+   */
+  protected long[] objectHandles_;
+
+  /**
+   * The types of the attributes that have been read of each object.
+   */
+  protected long[] attributeTypes_;
+
+  /**
+   * The values of all cells packed into one array.
+   */
+  protected byte[] packedValues_;
+
+  /**
+   * The offset in packedValues_, the length and the error code of each cell; three entries per
+   * cell, object by object.
+   */
+  protected long[] cells_;
+
+  /**
+   * Constructor taking the handles and types that have been read and the result of the read.
+   * 
+   * @param objectHandles
+   *          The handles of the objects.
+   * @param attributeTypes
+   *          The types of the attributes.
+   * @param packedValues
+   *          The values of all cells packed into one array.
+   * @param cells
+   *          The offset, the length and the error code of each cell.
+   * @preconditions (objectHandles <> null) and (attributeTypes <> null) and (packedValues <> null)
+   *                and (cells <> null)
+   *                and (cells.length >= 3 * objectHandles.length * attributeTypes.length)
+   */
+  protected AttributeValueTable(long[] objectHandles, long[] attributeTypes,
+      byte[] packedValues, long[] cells) {
+    if (objectHandles == null) {
+      throw new NullPointerException("Argument \"objectHandles\" must not be null.");
+    }
+    if (attributeTypes == null) {
+      throw new NullPointerException("Argument \"attributeTypes\" must not be null.");
+    }
+    if (packedValues == null) {
+      throw new NullPointerException("Argument \"packedValues\" must not be null.");
+    }
+    if (cells == null) {
+      throw new NullPointerException("Argument \"cells\" must not be null.");
+    }
+    if (cells.length < 3 * objectHandles.length * attributeTypes.length) {
+      throw new IllegalArgumentException(
+          "Argument \"cells\" must hold three entries for each attribute of each object.");
+    }
+    objectHandles_ = objectHandles;
+    attributeTypes_ = attributeTypes;
+    packedValues_ = packedValues;
+    cells_ = cells;
+  }
+
+  /**
+   * Get the number of objects that have been read.
+   * 
+   * @return The number of objects.
+   * @postconditions (result >= 0)
+   */
+  public int getObjectCount() {
+    return objectHandles_.length;
+  }
+
+  /**
+   * Get the number of attributes that have been read of each object.
+   * 
+   * @return The number of attributes.
+   * @postconditions (result >= 0)
+   */
+  public int getAttributeCount() {
+    return attributeTypes_.length;
+  }
+
+  /**
+   * Get the handle of the object with the given index.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @return The handle of the object.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   */
+  public long getObjectHandle(int objectIndex) {
+    return objectHandles_[objectIndex];
+  }
+
+  /**
+   * Get the type of the attribute with the given index; e.g. PKCS11Constants.CKA_LABEL.
+   * 
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The type of the attribute.
+   * @preconditions (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   */
+  public long getAttributeType(int attributeIndex) {
+    return attributeTypes_[attributeIndex];
+  }
+
+  /**
+   * Get the PKCS#11 error code of a cell. This is CKR_OK, if the value has been read.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The error code of the cell.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   */
+  public long getErrorCode(int objectIndex, int attributeIndex) {
+    return cells_[getCellIndex(objectIndex, attributeIndex) + 2];
+  }
+
+  /**
+   * Check, if the value of a cell has been read.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return True, if the value is available. False, otherwise.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   */
+  public boolean isAvailable(int objectIndex, int attributeIndex) {
+    return getErrorCode(objectIndex, attributeIndex) == PKCS11Constants.CKR_OK;
+  }
+
+  /**
+   * Get the offset of the value of a cell in the packed values.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The offset of the value.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   * @postconditions (result >= 0)
+   */
+  public int getOffset(int objectIndex, int attributeIndex) {
+    return (int) cells_[getCellIndex(objectIndex, attributeIndex)];
+  }
+
+  /**
+   * Get the length of the value of a cell in the packed values. This is 0 for a value that is not
+   * available.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The length of the value.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   * @postconditions (result >= 0)
+   */
+  public int getLength(int objectIndex, int attributeIndex) {
+    return (int) cells_[getCellIndex(objectIndex, attributeIndex) + 1];
+  }
+
+  /**
+   * Get the values of all cells packed into one array. Use getOffset and getLength to find the
+   * value of a cell.
+   * 
+   * @return The packed values.
+   * @postconditions (result <> null)
+   */
+  public byte[] getPackedValues() {
+    return packedValues_;
+  }
+
+  /**
+   * Get the value of a cell as a new array.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The value or null, if the value is not available.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   */
+  public byte[] getValue(int objectIndex, int attributeIndex) {
+    if (!isAvailable(objectIndex, attributeIndex)) {
+      return null;
+    }
+    int length = getLength(objectIndex, attributeIndex);
+    byte[] value = new byte[length];
+    System.arraycopy(packedValues_, getOffset(objectIndex, attributeIndex), value, 0, length);
+
+    return value;
+  }
+
+  /**
+   * Get the value of a cell of type CK_ULONG; e.g. of CKA_CLASS or CKA_KEY_TYPE.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The value or null, if the value is not available or not a single number.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   */
+  public Long getLongValue(int objectIndex, int attributeIndex) {
+    if (!isAvailable(objectIndex, attributeIndex)
+        || (getLength(objectIndex, attributeIndex) != 8)) {
+      return null;
+    }
+    int offset = getOffset(objectIndex, attributeIndex);
+    long value = 0;
+    for (int i = 0; i < 8; i++) {
+      value = (value << 8) | (packedValues_[offset + i] & 0xFF);
+    }
+
+    return new Long(value);
+  }
+
+  /**
+   * Get the value of a cell of type CK_BBOOL; e.g. of CKA_TOKEN or CKA_SENSITIVE.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The value or null, if the value is not available or not a single byte.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   */
+  public Boolean getBooleanValue(int objectIndex, int attributeIndex) {
+    if (!isAvailable(objectIndex, attributeIndex)
+        || (getLength(objectIndex, attributeIndex) != 1)) {
+      return null;
+    }
+
+    return (packedValues_[getOffset(objectIndex, attributeIndex)] != 0) ? Boolean.TRUE
+        : Boolean.FALSE;
+  }
+
+  /**
+   * Get an exception for a cell, if its value is not available. The exception is only created on
+   * demand.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The exception for the error code of the cell or null, if the value is available.
+   * @preconditions (objectIndex >= 0) and (objectIndex < getObjectCount())
+   *                and (attributeIndex >= 0) and (attributeIndex < getAttributeCount())
+   */
+  public PKCS11Exception getException(int objectIndex, int attributeIndex) {
+    return isAvailable(objectIndex, attributeIndex) ? null : new PKCS11Exception(getErrorCode(
+        objectIndex, attributeIndex));
+  }
+
+  /**
+   * Get the index of the first entry of a cell in cells_.
+   * 
+   * @param objectIndex
+   *          The index of the object.
+   * @param attributeIndex
+   *          The index of the attribute.
+   * @return The index of the offset of the cell.
+   */
+  protected int getCellIndex(int objectIndex, int attributeIndex) {
+    if ((attributeIndex < 0) || (attributeIndex >= attributeTypes_.length)) {
+      throw new IndexOutOfBoundsException("Attribute index " + attributeIndex + " out of range.");
+    }
+
+    return 3 * (objectIndex * attributeTypes_.length + attributeIndex);
+  }
+
+  /**
+   * Join the tables of consecutive parts of a read into one table; e.g. of the batches of a
+   * parallel scan.
+   * 
+   * @param objectHandles
+   *          The handles of the objects of all parts, in the order of the parts.
+   * @param attributeTypes
+   *          The types of the attributes, which must be the same for all parts.
+   * @param parts
+   *          The tables of the parts.
+   * @return The table holding the cells of all parts.
+   * @preconditions (objectHandles <> null) and (attributeTypes <> null) and (parts <> null)
+   * @postconditions (result <> null)
+   */
+  protected static AttributeValueTable concatenate(long[] objectHandles, long[] attributeTypes,
+      AttributeValueTable[] parts) {
+    if (parts == null) {
+      throw new NullPointerException("Argument \"parts\" must not be null.");
+    }
+    int packedLength = 0;
+    for (int i = 0; i < parts.length; i++) {
+      packedLength += parts[i].packedValues_.length;
+    }
+
+    byte[] packedValues = new byte[packedLength];
+    long[] cells = new long[3 * objectHandles.length * attributeTypes.length];
+    int packedOffset = 0;
+    int cellOffset = 0;
+    for (int i = 0; i < parts.length; i++) {
+      AttributeValueTable part = parts[i];
+      System.arraycopy(part.packedValues_, 0, packedValues, packedOffset,
+          part.packedValues_.length);
+      int partCells = 3 * part.objectHandles_.length * part.attributeTypes_.length;
+      for (int j = 0; j < partCells; j += 3) {
+        cells[cellOffset + j] = part.cells_[j] + packedOffset;
+        cells[cellOffset + j + 1] = part.cells_[j + 1];
+        cells[cellOffset + j + 2] = part.cells_[j + 2];
+      }
+      packedOffset += part.packedValues_.length;
+      cellOffset += partCells;
+    }
+
+    return new AttributeValueTable(objectHandles, attributeTypes, packedValues, cells);
+  }
+
+  /**
+   * Returns the string representation of this object.
+   * 
+   * @return the string representation of this object
+   */
+  public String toString() {
+    StringBuffer buffer = new StringBuffer();
+    int unavailable = 0;
+
+    for (int i = 2; i < 3 * objectHandles_.length * attributeTypes_.length; i += 3) {
+      if (cells_[i] != PKCS11Constants.CKR_OK) {
+        unavailable++;
+      }
+    }
+    buffer.append("Objects: ");
+    buffer.append(objectHandles_.length);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Attributes: ");
+    buffer.append(attributeTypes_.length);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Unavailable Values: ");
+    buffer.append(unavailable);
+
+    return buffer.toString();
+  }
+
+}
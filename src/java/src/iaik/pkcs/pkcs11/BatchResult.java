@@ -0,0 +1,297 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.wrapper.Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Exception;
+
+/**
+ * Objects of this class hold the outcome of a batch operation of a session; e.g. of
+ * Session.signBatch. For each item of the batch, there is a result and the PKCS#11 error code of
+ * the operation. If an item failed, its result is null and its error code tells why. A failed item
+ * does not throw an exception; call getException to get one.
+ * <p>
+ * If all results have the same length, like digests or MACs, the results may be packed into a
+ * single array with a slot of the same size for each item; see getPackedResults. The slot of a
+ * failed item is zeroed.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (errorCodes_ <> null) and ((results_ <> null) or (packedResults_ <> null))
+ */
+public class BatchResult {
+
+  /**
+   * The results of the items in the order of the batch.
+   */
+  protected byte[][] results_;
+
+  /**
+   * The results of the items packed into slots of slotLength_ bytes, or null, if the results are
+   * not packed.
+   */
+  protected byte[] packedResults_;
+
+  /**
+   * The length of a slot in packedResults_.
+   */
+  protected int slotLength_;
+
+  /**
+   * The error codes of the items in the order of the batch.
+   */
+  protected long[] errorCodes_;
+
+  /**
+   * Constructor taking the results and the error codes of the items.
+   * 
+   * @param results
+   *          The results of the items, null for the failed items.
+   * @param errorCodes
+   *          The error codes of the items.
+   * @preconditions (results <> null) and (errorCodes <> null)
+   *                and (results.length == errorCodes.length)
+   */
+  protected BatchResult(byte[][] results, long[] errorCodes) {
+    if (results == null) {
+      throw new NullPointerException("Argument \"results\" must not be null.");
+    }
+    if (errorCodes == null) {
+      throw new NullPointerException("Argument \"errorCodes\" must not be null.");
+    }
+    if (results.length != errorCodes.length) {
+      throw new IllegalArgumentException(
+          "Argument \"results\" must have the same length as \"errorCodes\".");
+    }
+    results_ = results;
+    errorCodes_ = errorCodes;
+  }
+
+  /**
+   * Constructor taking the packed results and the error codes of the items. The packed array holds
+   * a slot of the same size for each item.
+   * 
+   * @param packedResults
+   *          The results of the items packed into slots of the same size.
+   * @param errorCodes
+   *          The error codes of the items.
+   * @preconditions (packedResults <> null) and (errorCodes <> null)
+   *                and ((errorCodes.length == 0)
+   *                or (packedResults.length % errorCodes.length == 0))
+   */
+  protected BatchResult(byte[] packedResults, long[] errorCodes) {
+    if (packedResults == null) {
+      throw new NullPointerException("Argument \"packedResults\" must not be null.");
+    }
+    if (errorCodes == null) {
+      throw new NullPointerException("Argument \"errorCodes\" must not be null.");
+    }
+    if ((errorCodes.length == 0) ? (packedResults.length != 0)
+        : (packedResults.length % errorCodes.length != 0)) {
+      throw new IllegalArgumentException(
+          "Argument \"packedResults\" must hold a slot of the same size for each error code.");
+    }
+    packedResults_ = packedResults;
+    slotLength_ = (errorCodes.length == 0) ? 0 : packedResults.length / errorCodes.length;
+    errorCodes_ = errorCodes;
+  }
+
+  /**
+   * Get the number of items of the batch.
+   * 
+   * @return The number of items.
+   * @postconditions (result >= 0)
+   */
+  public int size() {
+    return errorCodes_.length;
+  }
+
+  /**
+   * Get the result of the item with the given index.
+   * 
+   * @param index
+   *          The index of the item in the batch.
+   * @return The result of the item or null, if the item failed.
+   * @preconditions (index >= 0) and (index < size())
+   */
+  public byte[] getResult(int index) {
+    if (results_ != null) {
+      return results_[index];
+    }
+    if (!isSuccessful(index)) {
+      return null;
+    }
+    byte[] result = new byte[slotLength_];
+    System.arraycopy(packedResults_, index * slotLength_, result, 0, slotLength_);
+
+    return result;
+  }
+
+  /**
+   * Get the results of all items in the order of the batch. The failed items are null. If the
+   * results are packed, this unpacks them once.
+   * 
+   * @return The results of all items.
+   * @postconditions (result <> null)
+   */
+  public byte[][] getResults() {
+    if (results_ == null) {
+      byte[][] results = new byte[errorCodes_.length][];
+      for (int i = 0; i < results.length; i++) {
+        results[i] = getResult(i);
+      }
+      results_ = results;
+    }
+
+    return results_;
+  }
+
+  /**
+   * Get the results of all items packed into one array. The result of the item with index i starts
+   * at i * getSlotLength(). The slots of failed items are zeroed.
+   * 
+   * @return The packed results or null, if the results are not packed.
+   */
+  public byte[] getPackedResults() {
+    return packedResults_;
+  }
+
+  /**
+   * Get the length of a slot in the packed results.
+   * 
+   * @return The length of a slot or 0, if the results are not packed or no item succeeded.
+   * @postconditions (result >= 0)
+   */
+  public int getSlotLength() {
+    return slotLength_;
+  }
+
+  /**
+   * Get the PKCS#11 error code of the item with the given index. This is CKR_OK, if the item
+   * succeeded.
+   * 
+   * @param index
+   *          The index of the item in the batch.
+   * @return The error code of the item.
+   * @preconditions (index >= 0) and (index < size())
+   */
+  public long getErrorCode(int index) {
+    return errorCodes_[index];
+  }
+
+  /**
+   * Get the PKCS#11 error codes of all items in the order of the batch.
+   * 
+   * @return The error codes of all items.
+   * @postconditions (result <> null)
+   */
+  public long[] getErrorCodes() {
+    return errorCodes_;
+  }
+
+  /**
+   * Check, if the item with the given index succeeded.
+   * 
+   * @param index
+   *          The index of the item in the batch.
+   * @return True, if the item succeeded. False, otherwise.
+   * @preconditions (index >= 0) and (index < size())
+   */
+  public boolean isSuccessful(int index) {
+    return errorCodes_[index] == PKCS11Constants.CKR_OK;
+  }
+
+  /**
+   * Check, if all items of the batch succeeded.
+   * 
+   * @return True, if all items succeeded. False, otherwise.
+   */
+  public boolean isAllSuccessful() {
+    for (int i = 0; i < errorCodes_.length; i++) {
+      if (errorCodes_[i] != PKCS11Constants.CKR_OK) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Get an exception for the item with the given index, if the item failed. The exception is only
+   * created on demand.
+   * 
+   * @param index
+   *          The index of the item in the batch.
+   * @return The exception for the error code of the item or null, if the item succeeded.
+   * @preconditions (index >= 0) and (index < size())
+   */
+  public PKCS11Exception getException(int index) {
+    return isSuccessful(index) ? null : new PKCS11Exception(errorCodes_[index]);
+  }
+
+  /**
+   * Returns the string representation of this object.
+   * 
+   * @return the string representation of this object
+   */
+  public String toString() {
+    StringBuffer buffer = new StringBuffer();
+    int failed = 0;
+
+    for (int i = 0; i < errorCodes_.length; i++) {
+      if (errorCodes_[i] != PKCS11Constants.CKR_OK) {
+        failed++;
+      }
+    }
+    buffer.append("Items: ");
+    buffer.append(errorCodes_.length);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Failed Items: ");
+    buffer.append(failed);
+
+    return buffer.toString();
+  }
+
+}
@@ -0,0 +1,610 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.wrapper.Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11;
+
+import java.lang.reflect.InvocationHandler;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.lang.reflect.Proxy;
+import java.util.Vector;
+import java.util.concurrent.locks.LockSupport;
+
+/**
+ * Runs the calls to a PKCS#11 module on a dedicated pool of platform threads instead of the
+ * calling threads. A thread in a native method stays bound to its carrier thread for the whole
+ * round trip to the module; for virtual threads of a server, this takes the carriers away from
+ * all other virtual threads, while the module works. With this pool, the calling thread only
+ * parks until its call is done, which releases the carrier of a virtual thread meanwhile. The
+ * pool is selected for a whole module with
+ * Module.setBlockingCallPool or for a single session with Session.setBlockingCallPool; all calls
+ * to the module of the wrapper, which the module or session makes afterwards, run on the pool.
+ * Example:
+ * <code>
+ *   BlockingCallPool pool = new BlockingCallPool(16);
+ *   module.setBlockingCallPool(pool);
+ *   ...
+ *   System.out.println(pool);
+ * </code> The pool counts the calls and measures how long they wait for a thread and how long
+ * they run, in nanoseconds, and how many threads are busy. If the peak number of active
+ * threads reaches the thread count and calls wait for a thread, the pool is too small. Use
+ * resetStatistics to measure a period of its own.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (queue_ <> null) and (threads_ <> null)
+ */
+public class BlockingCallPool {
+
+  /**
+   * A call to a module waiting in the queue or running, and its result.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (method_ <> null) and (target_ <> null)
+   */
+  protected static class Call {
+
+    /**
+     * The method to call.
+     */
+    protected Method method_;
+
+    /**
+     * The module to call the method on.
+     */
+    protected java.lang.Object target_;
+
+    /**
+     * The arguments of the call, or null if it has none.
+     */
+    protected java.lang.Object[] arguments_;
+
+    /**
+     * The time of the submission, as returned by System.nanoTime.
+     */
+    protected long submitTime_;
+
+    /**
+     * The thread that waits for the call.
+     */
+    protected Thread caller_;
+
+    /**
+     * The result of the method. Published by done_.
+     */
+    protected java.lang.Object result_;
+
+    /**
+     * The exception the method threw, or null. Published by done_.
+     */
+    protected Throwable exception_;
+
+    /**
+     * True, if the method has returned.
+     */
+    protected volatile boolean done_;
+
+    /**
+     * Constructor taking the method and its arguments.
+     * 
+     * @param method
+     *          The method to call.
+     * @param target
+     *          The module to call the method on.
+     * @param arguments
+     *          The arguments of the call, or null if it has none.
+     */
+    protected Call(Method method, java.lang.Object target, java.lang.Object[] arguments) {
+      method_ = method;
+      target_ = target;
+      arguments_ = arguments;
+      caller_ = Thread.currentThread();
+    }
+
+  }
+
+  /**
+   * Hands the calls of a module proxy to the pool.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (pkcs11Module_ <> null)
+   */
+  protected class Handler implements InvocationHandler {
+
+    /**
+     * The module that runs the calls.
+     */
+    protected PKCS11 pkcs11Module_;
+
+    /**
+     * Constructor taking the module that runs the calls.
+     * 
+     * @param pkcs11Module
+     *          The module that runs the calls.
+     */
+    protected Handler(PKCS11 pkcs11Module) {
+      pkcs11Module_ = pkcs11Module;
+    }
+
+    /**
+     * Run a call to the proxy on the pool. The methods of java.lang.Object run directly. Finalize
+     * does nothing, because the garbage collector calls it for the proxy, while the module stays in
+     * use; the owner of the module finalizes the module itself.
+     * 
+     * @param proxy
+     *          The proxy.
+     * @param method
+     *          The called method.
+     * @param arguments
+     *          The arguments of the call, or null if it has none.
+     * @return The result of the method.
+     * @exception Throwable
+     *              The exception the method threw.
+     */
+    public java.lang.Object invoke(java.lang.Object proxy, Method method,
+        java.lang.Object[] arguments) throws Throwable {
+      if (method.getName().equals("finalize")) {
+        return null;
+      }
+      if (method.getDeclaringClass() == java.lang.Object.class) {
+        try {
+          return method.invoke(pkcs11Module_, arguments);
+        } catch (InvocationTargetException ex) {
+          throw ex.getTargetException();
+        }
+      }
+
+      return execute(new Call(method, pkcs11Module_, arguments));
+    }
+
+  }
+
+  /**
+   * A thread of the pool.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   */
+  protected class Worker implements Runnable {
+
+    /**
+     * Run calls from the queue until the pool is closed and the queue is empty.
+     */
+    public void run() {
+      Call call;
+      while ((call = takeCall()) != null) {
+        long startTime = System.nanoTime();
+        java.lang.Object result = null;
+        Throwable exception = null;
+        try {
+          result = call.method_.invoke(call.target_, call.arguments_);
+        } catch (InvocationTargetException ex) {
+          exception = ex.getTargetException();
+        } catch (Throwable ex) {
+          exception = ex;
+        }
+        callFinished(System.nanoTime() - startTime);
+        call.result_ = result;
+        call.exception_ = exception;
+        call.done_ = true;
+        LockSupport.unpark(call.caller_);
+      }
+    }
+
+  }
+
+  /**
+   * The waiting calls. Guarded by the monitor of this object.
+   */
+  protected Vector queue_ = new Vector();
+
+  /**
+   * The threads of the pool.
+   */
+  protected Thread[] threads_;
+
+  /**
+   * True, if this pool has been closed. Guarded by the monitor of this object.
+   */
+  protected boolean closed_;
+
+  /**
+   * The number of finished calls. Guarded by the monitor of this object, like all statistics.
+   */
+  protected long callCount_;
+
+  /**
+   * The sum of the running times of the finished calls, in nanoseconds.
+   */
+  protected long totalCallTime_;
+
+  /**
+   * The longest running time of a call, in nanoseconds.
+   */
+  protected long maxCallTime_;
+
+  /**
+   * The sum of the times the started calls waited for a thread, in nanoseconds.
+   */
+  protected long totalWaitTime_;
+
+  /**
+   * The longest time a call waited for a thread, in nanoseconds.
+   */
+  protected long maxWaitTime_;
+
+  /**
+   * The number of threads running a call.
+   */
+  protected int activeCount_;
+
+  /**
+   * The largest number of threads running a call at the same time.
+   */
+  protected int peakActiveCount_;
+
+  /**
+   * The largest number of calls waiting for a thread at the same time.
+   */
+  protected int peakQueueLength_;
+
+  /**
+   * Constructor taking the number of threads. It starts the threads, which are daemon threads.
+   * 
+   * @param threadCount
+   *          The number of threads; this is the maximum number of calls to the module at the same
+   *          time.
+   * @preconditions (threadCount > 0)
+   */
+  public BlockingCallPool(int threadCount) {
+    if (threadCount <= 0) {
+      throw new IllegalArgumentException("The thread count must be positive.");
+    }
+    threads_ = new Thread[threadCount];
+    for (int i = 0; i < threadCount; i++) {
+      threads_[i] = new Thread(new Worker(), "PKCS#11 blocking call " + i);
+      threads_[i].setDaemon(true);
+      threads_[i].start();
+    }
+  }
+
+  /**
+   * Get the direct module behind a module returned by offload. Other modules are returned as they
+   * are.
+   * 
+   * @param pkcs11Module
+   *          The module, maybe one returned by offload.
+   * @return The module, which runs the calls in the calling thread.
+   * @preconditions (pkcs11Module <> null)
+   * @postconditions (result <> null)
+   */
+  public static PKCS11 getDirectModule(PKCS11 pkcs11Module) {
+    if (pkcs11Module == null) {
+      throw new NullPointerException("Argument \"pkcs11Module\" must not be null.");
+    }
+    if (Proxy.isProxyClass(pkcs11Module.getClass())) {
+      InvocationHandler handler = Proxy.getInvocationHandler(pkcs11Module);
+      if (handler instanceof Handler) {
+        return ((Handler) handler).pkcs11Module_;
+      }
+    }
+
+    return pkcs11Module;
+  }
+
+  /**
+   * Get a module that runs all calls to the given module on this pool. The calls behave the same
+   * as those to the given module, including the exceptions they throw. If the given module runs
+   * its calls on a pool already, the new one calls its direct module.
+   * 
+   * @param pkcs11Module
+   *          The module to run the calls of.
+   * @return The module running the calls on this pool.
+   * @preconditions (pkcs11Module <> null)
+   * @postconditions (result <> null)
+   */
+  public PKCS11 offload(PKCS11 pkcs11Module) {
+    PKCS11 directModule = getDirectModule(pkcs11Module);
+
+    return (PKCS11) Proxy.newProxyInstance(PKCS11.class.getClassLoader(),
+        new Class[] { PKCS11.class }, new Handler(directModule));
+  }
+
+  /**
+   * Run a call on a thread of the pool and wait until it returns. If the pool is closed, the call
+   * runs in the calling thread. The call cannot be abandoned, because the module may still use
+   * its arguments; thus, an interrupt does not end the wait, but is kept for the caller.
+   * 
+   * @param call
+   *          The call to run.
+   * @return The result of the method.
+   * @exception Throwable
+   *              The exception the method threw.
+   * @preconditions (call <> null)
+   */
+  protected java.lang.Object execute(Call call) throws Throwable {
+    boolean direct;
+    synchronized (this) {
+      direct = closed_;
+      if (!direct) {
+        call.submitTime_ = System.nanoTime();
+        queue_.addElement(call);
+        if (queue_.size() > peakQueueLength_) {
+          peakQueueLength_ = queue_.size();
+        }
+        notify();
+      }
+    }
+    if (direct) {
+      try {
+        return call.method_.invoke(call.target_, call.arguments_);
+      } catch (InvocationTargetException ex) {
+        throw ex.getTargetException();
+      }
+    }
+
+    boolean interrupted = false;
+    while (!call.done_) {
+      LockSupport.park(call);
+      // park returns at once while the thread is interrupted; clear and restore it afterwards
+      if (Thread.interrupted()) {
+        interrupted = true;
+      }
+    }
+    if (interrupted) {
+      Thread.currentThread().interrupt();
+    }
+    if (call.exception_ != null) {
+      throw call.exception_;
+    }
+
+    return call.result_;
+  }
+
+  /**
+   * Take the next call from the queue, waiting for one if the queue is empty.
+   * 
+   * @return The next call, or null if this pool has been closed and the queue is empty.
+   */
+  protected synchronized Call takeCall() {
+    while (queue_.isEmpty() && !closed_) {
+      try {
+        wait();
+      } catch (InterruptedException ex) {
+        // the threads end only when this pool is closed
+      }
+    }
+    if (queue_.isEmpty()) {
+      return null;
+    }
+    Call call = (Call) queue_.elementAt(0);
+    queue_.removeElementAt(0);
+
+    long waitTime = System.nanoTime() - call.submitTime_;
+    totalWaitTime_ += waitTime;
+    if (waitTime > maxWaitTime_) {
+      maxWaitTime_ = waitTime;
+    }
+    activeCount_++;
+    if (activeCount_ > peakActiveCount_) {
+      peakActiveCount_ = activeCount_;
+    }
+
+    return call;
+  }
+
+  /**
+   * Count a finished call.
+   * 
+   * @param callTime
+   *          The running time of the call, in nanoseconds.
+   */
+  protected synchronized void callFinished(long callTime) {
+    activeCount_--;
+    callCount_++;
+    totalCallTime_ += callTime;
+    if (callTime > maxCallTime_) {
+      maxCallTime_ = callTime;
+    }
+  }
+
+  /**
+   * Get the number of threads of this pool.
+   * 
+   * @return The number of threads.
+   * @postconditions (result > 0)
+   */
+  public int getThreadCount() {
+    return threads_.length;
+  }
+
+  /**
+   * Get the number of finished calls.
+   * 
+   * @return The number of finished calls.
+   */
+  public synchronized long getCallCount() {
+    return callCount_;
+  }
+
+  /**
+   * Get the sum of the running times of the finished calls.
+   * 
+   * @return The sum of the running times in nanoseconds.
+   */
+  public synchronized long getTotalCallTime() {
+    return totalCallTime_;
+  }
+
+  /**
+   * Get the longest running time of a call.
+   * 
+   * @return The longest running time in nanoseconds.
+   */
+  public synchronized long getMaxCallTime() {
+    return maxCallTime_;
+  }
+
+  /**
+   * Get the sum of the times the calls waited for a thread.
+   * 
+   * @return The sum of the waiting times in nanoseconds.
+   */
+  public synchronized long getTotalWaitTime() {
+    return totalWaitTime_;
+  }
+
+  /**
+   * Get the longest time a call waited for a thread.
+   * 
+   * @return The longest waiting time in nanoseconds.
+   */
+  public synchronized long getMaxWaitTime() {
+    return maxWaitTime_;
+  }
+
+  /**
+   * Get the number of threads running a call now.
+   * 
+   * @return The number of active threads.
+   */
+  public synchronized int getActiveCount() {
+    return activeCount_;
+  }
+
+  /**
+   * Get the largest number of threads that ran a call at the same time.
+   * 
+   * @return The peak number of active threads.
+   */
+  public synchronized int getPeakActiveCount() {
+    return peakActiveCount_;
+  }
+
+  /**
+   * Get the number of calls waiting for a thread now.
+   * 
+   * @return The number of waiting calls.
+   */
+  public synchronized int getQueueLength() {
+    return queue_.size();
+  }
+
+  /**
+   * Get the largest number of calls that waited for a thread at the same time.
+   * 
+   * @return The peak number of waiting calls.
+   */
+  public synchronized int getPeakQueueLength() {
+    return peakQueueLength_;
+  }
+
+  /**
+   * Reset the statistics; the peaks start at the current values.
+   */
+  public synchronized void resetStatistics() {
+    callCount_ = 0;
+    totalCallTime_ = 0;
+    maxCallTime_ = 0;
+    totalWaitTime_ = 0;
+    maxWaitTime_ = 0;
+    peakActiveCount_ = activeCount_;
+    peakQueueLength_ = queue_.size();
+  }
+
+  /**
+   * Stop the threads, after they have run the waiting calls. Calls after this run in the calling
+   * threads. Calling this again has no effect.
+   */
+  public synchronized void close() {
+    closed_ = true;
+    notifyAll();
+  }
+
+  /**
+   * Returns the string representation of this object.
+   * 
+   * @return The string representation of object
+   */
+  public synchronized String toString() {
+    StringBuffer buffer = new StringBuffer();
+
+    buffer.append("Threads: ");
+    buffer.append(threads_.length);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Calls: ");
+    buffer.append(callCount_);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Total Call Time (ns): ");
+    buffer.append(totalCallTime_);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Max Call Time (ns): ");
+    buffer.append(maxCallTime_);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Total Wait Time (ns): ");
+    buffer.append(totalWaitTime_);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Max Wait Time (ns): ");
+    buffer.append(maxWaitTime_);
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Active Threads: ");
+    buffer.append(activeCount_);
+    buffer.append(" (peak ");
+    buffer.append(peakActiveCount_);
+    buffer.append(")");
+    buffer.append(Constants.NEWLINE);
+    buffer.append("Waiting Calls: ");
+    buffer.append(queue_.size());
+    buffer.append(" (peak ");
+    buffer.append(peakQueueLength_);
+    buffer.append(")");
+
+    return buffer.toString();
+  }
+
+}
@@ -172,6 +172,39 @@ public class DefaultInitializeArgs implements InitializeArgs {
     mutexHandler_ = mutexHandler;
   }
 
+  /**
+   * Check, if the wrapper uses the mutexes of the operating system in its native part; i.e. if the
+   * mutex-handler is a NativeMutexHandler.
+   * 
+   * @return True, if the mutex-handler is a NativeMutexHandler. False, otherwise.
+   * 
+   * @postconditions (result == (mutexHandler_ instanceof NativeMutexHandler))
+   */
+  public boolean isUseNativeMutexes() {
+    return mutexHandler_ instanceof NativeMutexHandler;
+  }
+
+  /**
+   * Set, if the wrapper shall use the mutexes of the operating system in its native part. This
+   * avoids calling back to Java each time the module locks or unlocks a mutex. If set to true, the
+   * mutex-handler is set to a new NativeMutexHandler. If set to false while native mutexes are in
+   * use, the mutex-handler is set to null.
+   * 
+   * @param useNativeMutexes
+   *          True, to use the native mutexes of the wrapper. False, otherwise.
+   * 
+   * @postconditions (isUseNativeMutexes() == useNativeMutexes)
+   */
+  public void setUseNativeMutexes(boolean useNativeMutexes) {
+    if (useNativeMutexes) {
+      if (!(mutexHandler_ instanceof NativeMutexHandler)) {
+        mutexHandler_ = new NativeMutexHandler();
+      }
+    } else if (mutexHandler_ instanceof NativeMutexHandler) {
+      mutexHandler_ = null;
+    }
+  }
+
   /**
    * Set, if application threads which are executing calls to the library may not use native
    * operating system calls to spawn new threads.
@@ -218,7 +251,8 @@ public class DefaultInitializeArgs implements InitializeArgs {
     StringBuffer buffer = new StringBuffer();
 
     buffer.append("Mutex Handler: ");
-    buffer.append((mutexHandler_ != null) ? "present" : "not present");
+    buffer.append((mutexHandler_ instanceof NativeMutexHandler) ? "native"
+        : ((mutexHandler_ != null) ? "present" : "not present"));
     buffer.append(Constants.NEWLINE);
 
     buffer.append("Library can't create OS-Threads: ");
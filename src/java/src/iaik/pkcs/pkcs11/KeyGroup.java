@@ -0,0 +1,512 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.objects.Key;
+import iaik.pkcs.pkcs11.wrapper.Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Exception;
+
+import java.util.Vector;
+
+/**
+ * A logical key that exists on several tokens; e.g. a signing key replicated to the partitions of
+ * several HSMs with the same CKA_ID or CKA_LABEL. Each member of the group is a session pool of one
+ * token together with the handle of the key on this token. Each operation goes to the member which
+ * is expected to finish it first; this is the member with the lowest product of its average
+ * latency and the number of operations it is running, the new one included. The average latency is
+ * an exponentially weighted moving average of the latencies of the successful operations of the
+ * member, measured from the time the operation got its session. So the throughput grows with the
+ * number of members, and slow members get less work. Example:
+ * <code>
+ *   RSAPrivateKey keyTemplate = new RSAPrivateKey();
+ *   keyTemplate.getId().setByteArrayValue(keyId);
+ *   KeyGroup keyGroup = new KeyGroup();
+ *   keyGroup.addMember(pool1, keyTemplate);
+ *   keyGroup.addMember(pool2, keyTemplate);
+ *   ...
+ *   byte[] signature = keyGroup.sign(Mechanism.SHA256_RSA_PKCS, data);
+ * </code>
+ * <p>
+ * If an operation fails with an error of the device or the token, like CKR_DEVICE_ERROR or
+ * CKR_TOKEN_NOT_PRESENT, the member is ejected for the ejection time and the operation is retried
+ * with another member. Ejected members get operations only, if all members are ejected. Other
+ * errors, like CKR_DATA_LEN_RANGE, are thrown to the application.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (members_ <> null)
+ */
+public class KeyGroup {
+
+  /**
+   * An operation with the key of a member, which the group runs on the member of its choice.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   */
+  public interface Operation {
+
+    /**
+     * Run the operation.
+     * 
+     * @param session
+     *          A session of the token of the member, borrowed from its pool.
+     * @param key
+     *          The key on this token.
+     * @return The result of the operation, or null.
+     * @exception TokenException
+     *              If the operation fails.
+     */
+    public java.lang.Object execute(Session session, Key key) throws TokenException;
+
+  }
+
+  /**
+   * A token holding the key and its statistics.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (pool_ <> null) and (key_ <> null)
+   */
+  protected static class Member {
+
+    /**
+     * The pool of sessions of the token.
+     */
+    protected SessionPool pool_;
+
+    /**
+     * The key on the token. Only its handle is set.
+     */
+    protected Key key_;
+
+    /**
+     * The average latency of the operations in milliseconds. Guarded by the monitor of the group.
+     */
+    protected double averageLatency_;
+
+    /**
+     * True, if averageLatency_ holds at least one measured latency. Guarded by the monitor of the
+     * group.
+     */
+    protected boolean sampled_;
+
+    /**
+     * The number of running operations. Guarded by the monitor of the group.
+     */
+    protected int running_;
+
+    /**
+     * The time in milliseconds until which the member is ejected. Guarded by the monitor of the
+     * group.
+     */
+    protected long ejectedUntil_;
+
+    /**
+     * Constructor taking the pool and the key.
+     * 
+     * @param pool
+     *          The pool of sessions of the token.
+     * @param key
+     *          The key on the token.
+     */
+    protected Member(SessionPool pool, Key key) {
+      pool_ = pool;
+      key_ = key;
+    }
+
+  }
+
+  /**
+   * The default time in milliseconds that a member is ejected after a device error.
+   */
+  public static final long DEFAULT_EJECTION_TIME = 30000L;
+
+  /**
+   * The default weight of the latency of a new operation in the average latency.
+   */
+  public static final double DEFAULT_LATENCY_WEIGHT = 0.2;
+
+  /**
+   * The latency in milliseconds that is added to the average latency of each member when
+   * selecting one. Without it, a member with an average latency of 0, e.g. of a very fast or a not
+   * yet measured token, would get all operations, regardless of how many are running on it.
+   */
+  protected static final double LATENCY_FLOOR = 0.01;
+
+  /**
+   * The members of the group. Guarded by the monitor of the group.
+   */
+  protected Vector members_ = new Vector();
+
+  /**
+   * The time in milliseconds that a member is ejected after a device error.
+   */
+  protected long ejectionTime_ = DEFAULT_EJECTION_TIME;
+
+  /**
+   * The weight of the latency of a new operation in the average latency.
+   */
+  protected double latencyWeight_ = DEFAULT_LATENCY_WEIGHT;
+
+  /**
+   * Add a token to this group. This finds the key matching the template on the token.
+   * 
+   * @param pool
+   *          The pool of sessions of the token.
+   * @param keyTemplate
+   *          The template that identifies the key; e.g. a key with the CKA_ID or CKA_LABEL set.
+   * @exception TokenException
+   *              If finding the key fails, or if the token has no such key.
+   * @preconditions (pool <> null) and (keyTemplate <> null)
+   */
+  public void addMember(SessionPool pool, Key keyTemplate) throws TokenException {
+    if (pool == null) {
+      throw new NullPointerException("Argument \"pool\" must not be null.");
+    }
+    if (keyTemplate == null) {
+      throw new NullPointerException("Argument \"keyTemplate\" must not be null.");
+    }
+
+    long keyHandle;
+    Session session = pool.borrowSession();
+    try {
+      ObjectIterator iterator = session.iterateObjectHandles(keyTemplate);
+      try {
+        if (!iterator.hasNext()) {
+          throw new TokenException("The token has no key matching the template.");
+        }
+        keyHandle = iterator.nextHandle();
+      } catch (TokenRuntimeException ex) {
+        throw new TokenException(ex);
+      } finally {
+        iterator.close();
+      }
+    } finally {
+      pool.returnSession(session);
+    }
+    Key key = (Key) keyTemplate.clone();
+    key.setObjectHandle(keyHandle);
+
+    synchronized (this) {
+      members_.addElement(new Member(pool, key));
+    }
+  }
+
+  /**
+   * Run the given operation on the member that is expected to finish it first. If it fails with a
+   * device error, the member is ejected and the operation is run on the next member; each member
+   * is tried at most once.
+   * 
+   * @param operation
+   *          The operation to run.
+   * @return The result of the operation.
+   * @exception TokenException
+   *              If the group has no members, or the operation failed on all members tried.
+   * @preconditions (operation <> null)
+   */
+  public java.lang.Object execute(Operation operation) throws TokenException {
+    if (operation == null) {
+      throw new NullPointerException("Argument \"operation\" must not be null.");
+    }
+
+    Vector tried = new Vector();
+    TokenException lastException = null;
+    while (true) {
+      Member member = selectMember(tried);
+      if (member == null) {
+        if (lastException != null) {
+          throw lastException;
+        }
+        throw new TokenException("The key group has no members.");
+      }
+      tried.addElement(member);
+
+      Session session = null;
+      TokenException exception = null;
+      double latency = -1.0;
+      try {
+        session = member.pool_.borrowSession();
+        // waiting for a session is not the latency of the token; only successful operations are
+        // sampled, a failing one, e.g. with CKR_DATA_LEN_RANGE, may return early
+        long start = System.nanoTime();
+        java.lang.Object result = operation.execute(session, member.key_);
+        latency = (System.nanoTime() - start) / 1000000.0;
+        return result;
+      } catch (TokenException ex) {
+        exception = ex;
+        if (!isDeviceError(ex)) {
+          throw ex;
+        }
+        lastException = ex;
+      } finally {
+        if (session != null) {
+          member.pool_.returnSession(session, exception);
+        }
+        finished(member, latency, isDeviceError(exception));
+      }
+    }
+  }
+
+  /**
+   * Sign the given data with the key of the group.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA256_RSA_PKCS.
+   * @param data
+   *          The data to sign.
+   * @return The signature.
+   * @exception TokenException
+   *              If signing fails.
+   * @preconditions (mechanism <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] sign(final Mechanism mechanism, final byte[] data) throws TokenException {
+    return (byte[]) execute(new Operation() {
+      public java.lang.Object execute(Session session, Key key) throws TokenException {
+        return session.sign(mechanism, key, data);
+      }
+    });
+  }
+
+  /**
+   * Encrypt the given data with the key of the group.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.RSA_PKCS.
+   * @param data
+   *          The data to encrypt.
+   * @return The encrypted data.
+   * @exception TokenException
+   *              If encrypting fails.
+   * @preconditions (mechanism <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] encrypt(final Mechanism mechanism, final byte[] data) throws TokenException {
+    return (byte[]) execute(new Operation() {
+      public java.lang.Object execute(Session session, Key key) throws TokenException {
+        return session.encrypt(mechanism, key, data);
+      }
+    });
+  }
+
+  /**
+   * Decrypt the given data with the key of the group.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.RSA_PKCS.
+   * @param data
+   *          The data to decrypt.
+   * @return The decrypted data.
+   * @exception TokenException
+   *              If decrypting fails.
+   * @preconditions (mechanism <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] decrypt(final Mechanism mechanism, final byte[] data) throws TokenException {
+    return (byte[]) execute(new Operation() {
+      public java.lang.Object execute(Session session, Key key) throws TokenException {
+        return session.decrypt(mechanism, key, data);
+      }
+    });
+  }
+
+  /**
+   * Set the time that a member is ejected after a device error. The default is
+   * DEFAULT_EJECTION_TIME.
+   * 
+   * @param ejectionTime
+   *          The time in milliseconds.
+   */
+  public void setEjectionTime(long ejectionTime) {
+    ejectionTime_ = ejectionTime;
+  }
+
+  /**
+   * Set the weight of the latency of a new operation in the average latency of a member. A higher
+   * weight makes the group react faster to changes of the latency. The default is
+   * DEFAULT_LATENCY_WEIGHT.
+   * 
+   * @param latencyWeight
+   *          The weight, greater than 0 and at most 1.
+   * @preconditions (0 < latencyWeight <= 1)
+   */
+  public synchronized void setLatencyWeight(double latencyWeight) {
+    if ((latencyWeight <= 0) || (latencyWeight > 1)) {
+      throw new IllegalArgumentException("Argument \"latencyWeight\" must be in (0, 1].");
+    }
+    latencyWeight_ = latencyWeight;
+  }
+
+  /**
+   * Get the number of members of this group.
+   * 
+   * @return The number of members.
+   * @postconditions (result >= 0)
+   */
+  public synchronized int getMemberCount() {
+    return members_.size();
+  }
+
+  /**
+   * Check, if the given exception is an error of the device or the token, after which the member
+   * should not get operations for a while.
+   * 
+   * @param exception
+   *          The exception to check. May be null.
+   * @return True, if it is a device error. False, otherwise.
+   */
+  public static boolean isDeviceError(TokenException exception) {
+    if (!(exception instanceof PKCS11Exception)) {
+      return false;
+    }
+    long errorCode = ((PKCS11Exception) exception).getErrorCode();
+
+    return (errorCode == PKCS11Constants.CKR_GENERAL_ERROR)
+        || (errorCode == PKCS11Constants.CKR_DEVICE_ERROR)
+        || (errorCode == PKCS11Constants.CKR_DEVICE_MEMORY)
+        || (errorCode == PKCS11Constants.CKR_DEVICE_REMOVED)
+        || (errorCode == PKCS11Constants.CKR_TOKEN_NOT_PRESENT)
+        || (errorCode == PKCS11Constants.CKR_TOKEN_NOT_RECOGNIZED);
+  }
+
+  /**
+   * Select the member that is expected to finish a new operation first among the members not
+   * tried yet, and count the operation as running on it. Ejected members are only selected, if
+   * all members not tried yet are ejected; then the one ejected first is selected.
+   * 
+   * @param tried
+   *          The members that have been tried for this operation.
+   * @return The selected member, or null if all members have been tried.
+   */
+  protected synchronized Member selectMember(Vector tried) {
+    long now = System.currentTimeMillis();
+    Member best = null;
+    double bestCost = 0.0;
+    Member bestEjected = null;
+    for (int i = 0; i < members_.size(); i++) {
+      Member member = (Member) members_.elementAt(i);
+      if (tried.contains(member)) {
+        continue;
+      }
+      if (member.ejectedUntil_ > now) {
+        if ((bestEjected == null) || (member.ejectedUntil_ < bestEjected.ejectedUntil_)) {
+          bestEjected = member;
+        }
+        continue;
+      }
+      double cost = (member.averageLatency_ + LATENCY_FLOOR) * (member.running_ + 1);
+      if ((best == null) || (cost < bestCost)) {
+        best = member;
+        bestCost = cost;
+      }
+    }
+    if (best == null) {
+      best = bestEjected;
+    }
+    if (best != null) {
+      best.running_++;
+    }
+
+    return best;
+  }
+
+  /**
+   * Update the statistics of the given member after an operation.
+   * 
+   * @param member
+   *          The member that ran the operation.
+   * @param latency
+   *          The time the operation took in milliseconds, or a negative value, if the operation
+   *          failed and gives no sample.
+   * @param deviceError
+   *          True, if the operation failed with a device error.
+   */
+  protected synchronized void finished(Member member, double latency, boolean deviceError) {
+    member.running_--;
+    if (deviceError) {
+      member.ejectedUntil_ = System.currentTimeMillis() + ejectionTime_;
+    } else if (latency < 0.0) {
+      return;
+    } else if (!member.sampled_) {
+      // the first latency is the best estimate we have; do not average it with 0
+      member.averageLatency_ = latency;
+      member.sampled_ = true;
+    } else {
+      member.averageLatency_ += latencyWeight_ * (latency - member.averageLatency_);
+    }
+  }
+
+  /**
+   * Returns the string representation of this object.
+   * 
+   * @return the string representation of this object
+   */
+  public synchronized String toString() {
+    StringBuffer buffer = new StringBuffer();
+
+    long now = System.currentTimeMillis();
+    for (int i = 0; i < members_.size(); i++) {
+      Member member = (Member) members_.elementAt(i);
+      if (i > 0) {
+        buffer.append(Constants.NEWLINE);
+      }
+      buffer.append("Member ");
+      buffer.append(i);
+      buffer.append(": ");
+      buffer.append(member.pool_.getToken().getSlot().getSlotID());
+      buffer.append(", average latency: ");
+      buffer.append(member.averageLatency_);
+      buffer.append(" ms, running: ");
+      buffer.append(member.running_);
+      if (member.ejectedUntil_ > now) {
+        buffer.append(", ejected");
+      }
+    }
+
+    return buffer.toString();
+  }
+
+}
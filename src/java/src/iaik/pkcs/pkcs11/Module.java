@@ -48,6 +48,7 @@ import iaik.pkcs.pkcs11.wrapper.CK_DESTROYMUTEX;
 import iaik.pkcs.pkcs11.wrapper.CK_INFO;
 import iaik.pkcs.pkcs11.wrapper.CK_LOCKMUTEX;
 import iaik.pkcs.pkcs11.wrapper.CK_UNLOCKMUTEX;
+import iaik.pkcs.pkcs11.wrapper.NativeMutexes;
 import iaik.pkcs.pkcs11.wrapper.PKCS11;
 import iaik.pkcs.pkcs11.wrapper.PKCS11Connector;
 import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
@@ -171,6 +172,16 @@ public class Module {
    */
   protected PKCS11 pkcs11Module_;
 
+  /**
+   * The pool that runs the calls to the PKCS#11 module, or null to call it directly.
+   */
+  protected BlockingCallPool blockingCallPool_;
+
+  /**
+   * The PKCS#11 module running its calls on the blocking call pool, or null to call it directly.
+   */
+  protected PKCS11 offloadedPKCS11Module_;
+
   /**
    * Create a new module that uses the given PKCS11 interface to interact with the token.
    * 
@@ -262,14 +273,16 @@ public class Module {
    * @postconditions (result <> null)
    */
   public Info getInfo() throws TokenException {
-    CK_INFO ckInfo = pkcs11Module_.C_GetInfo();
+    CK_INFO ckInfo = getPKCS11Module().C_GetInfo();
 
     return new Info(ckInfo);
   }
 
   /**
    * Initializes the module. The application must call this method before calling any other method
-   * of the module.
+   * of the module. If the mutex-handler of the initArgs is a NativeMutexHandler, the module gets
+   * mutex functions that use the mutexes of the operating system directly in the native part of
+   * the wrapper.
    * 
    * @param initArgs
    *          The initialization arguments for the module as defined in PKCS#11. May be null.
@@ -282,7 +295,14 @@ public class Module {
       InitializeArgs castedInitArgs = initArgs;
       final MutexHandler mutexHandler = castedInitArgs.getMutexHandler();
       wrapperInitArgs = new CK_C_INITIALIZE_ARGS();
-      if (mutexHandler != null) {
+      if (mutexHandler instanceof NativeMutexHandler) {
+        // the native part of the wrapper uses the mutexes of the operating system
+        NativeMutexes nativeMutexes = new NativeMutexes();
+        wrapperInitArgs.CreateMutex = nativeMutexes;
+        wrapperInitArgs.DestroyMutex = nativeMutexes;
+        wrapperInitArgs.LockMutex = nativeMutexes;
+        wrapperInitArgs.UnlockMutex = nativeMutexes;
+      } else if (mutexHandler != null) {
         wrapperInitArgs.CreateMutex = new CK_CREATEMUTEX() {
           public Object CK_CREATEMUTEX() throws PKCS11Exception {
             return mutexHandler.createMutex();
@@ -353,7 +373,7 @@ public class Module {
    * @postconditions (result <> null)
    */
   public Slot[] getSlotList(boolean tokenPresent) throws TokenException {
-    long[] slotIDs = pkcs11Module_.C_GetSlotList(tokenPresent);
+    long[] slotIDs = getPKCS11Module().C_GetSlotList(tokenPresent);
     Slot[] slots = new Slot[slotIDs.length];
     for (int i = 0; i < slots.length; i++) {
       slots[i] = new Slot(this, slotIDs[i]);
@@ -382,20 +402,51 @@ public class Module {
    */
   public Slot waitForSlotEvent(boolean dontBlock, Object reserved) throws TokenException {
     long flags = (dontBlock) ? PKCS11Constants.CKF_DONT_BLOCK : 0L;
-    long slotID = pkcs11Module_.C_WaitForSlotEvent(flags, reserved);
+    long slotID = getPKCS11Module().C_WaitForSlotEvent(flags, reserved);
 
     return new Slot(this, slotID);
   }
 
   /**
-   * Gets the PKCS#11 module of the wrapper package behind this object.
+   * Gets the PKCS#11 module of the wrapper package behind this object. If a blocking call pool is
+   * set, the returned module runs its calls on the pool.
    * 
    * @return The PKCS#11 module behind this object.
    * 
    * @postconditions (result <> null)
    */
   public PKCS11 getPKCS11Module() {
-    return pkcs11Module_;
+    PKCS11 offloadedPKCS11Module = offloadedPKCS11Module_;
+
+    return (offloadedPKCS11Module != null) ? offloadedPKCS11Module : pkcs11Module_;
+  }
+
+  /**
+   * Set the pool that runs the calls to the PKCS#11 module in platform threads; see
+   * BlockingCallPool. Virtual threads use this to avoid binding their carrier threads for the
+   * whole round trip to the module. This applies to the calls of this object and of the slots and
+   * tokens, and to the sessions opened afterwards; an open session keeps its mode, which
+   * Session.setBlockingCallPool changes.
+   * 
+   * @param blockingCallPool
+   *          The pool to run the calls on, or null to call the module directly.
+   */
+  public synchronized void setBlockingCallPool(BlockingCallPool blockingCallPool) {
+    blockingCallPool_ = blockingCallPool;
+    if (blockingCallPool != null) {
+      offloadedPKCS11Module_ = blockingCallPool.offload(pkcs11Module_);
+    } else {
+      offloadedPKCS11Module_ = null;
+    }
+  }
+
+  /**
+   * Get the pool that runs the calls to the PKCS#11 module.
+   * 
+   * @return The pool, or null if the module is called directly.
+   */
+  public synchronized BlockingCallPool getBlockingCallPool() {
+    return blockingCallPool_;
   }
 
   /**
@@ -0,0 +1,365 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.objects.Key;
+import iaik.pkcs.pkcs11.parameters.Parameters;
+import iaik.pkcs.pkcs11.wrapper.CK_MECHANISM;
+import iaik.pkcs.pkcs11.wrapper.PKCS11;
+
+/**
+ * Runs many small operations of a token on native threads inside the wrapper library instead of
+ * Java threads. Each native thread owns a session of its own and runs the requests in whole
+ * operations, like Session.sign(Mechanism, Key, byte[]). Java submits batches of requests, each
+ * with an id of the caller, and polls the results in batches; so a few Java threads can keep many
+ * sessions busy with a single call to the native part per batch. Submitting never blocks; the
+ * pool accepts as many requests as its capacity allows, which limits the requests whose results
+ * were not polled yet. Example:
+ * <code>
+ *   NativeWorkerPool pool = token.createNativeWorkerPool(8, 4096,
+ *       Token.SessionReadWriteBehavior.RO_SESSION);
+ *   int accepted = pool.submit(NativeWorkerPool.SIGN, Mechanism.SHA256_RSA_PKCS, key, ids,
+ *       data);
+ *   ...
+ *   int count = pool.poll(resultIds, errorCodes, signatures, 100);
+ * </code> All sessions of an application share the login state; so if the key is private, the
+ * application must log in with any session, before the requests can use the key. The results
+ * arrive in the order the requests finish, not in the order of submission. Submitting, polling
+ * and closing may run in different threads at the same time; close makes waiting polls return and
+ * frees the native pool only after all running calls have left it.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (token_ <> null) and (sessions_ <> null)
+ */
+public class NativeWorkerPool {
+
+  /**
+   * Sign the data with the key.
+   */
+  public static final int SIGN = 0;
+
+  /**
+   * Encrypt the data with the key.
+   */
+  public static final int ENCRYPT = 1;
+
+  /**
+   * Decrypt the data with the key.
+   */
+  public static final int DECRYPT = 2;
+
+  /**
+   * Digest the data; no key is needed.
+   */
+  public static final int DIGEST = 3;
+
+  /**
+   * The token of the sessions.
+   */
+  protected Token token_;
+
+  /**
+   * The module, which runs the pool.
+   */
+  protected PKCS11 pkcs11Module_;
+
+  /**
+   * The sessions of the native threads.
+   */
+  protected Session[] sessions_;
+
+  /**
+   * The native handle of the pool.
+   */
+  protected long poolHandle_;
+
+  /**
+   * True, if this object has been closed. Guarded by the monitor of this object.
+   */
+  protected boolean closed_;
+
+  /**
+   * The number of calls of submit and poll, which are using the native pool. Guarded by the
+   * monitor of this object.
+   */
+  protected int activeCalls_;
+
+  /**
+   * Constructor taking the token and the number of threads. It opens a session for each thread and
+   * starts the native threads.
+   * 
+   * @param token
+   *          The token of the sessions.
+   * @param threadCount
+   *          The number of native threads and sessions.
+   * @param capacity
+   *          The maximum number of requests submitted, whose results were not polled yet.
+   * @param rwSession
+   *          Token.SessionReadWriteBehavior.RW_SESSION for read-write sessions, or
+   *          Token.SessionReadWriteBehavior.RO_SESSION for read-only sessions.
+   * @exception TokenException
+   *              If opening a session or starting the threads fails.
+   * @preconditions (token <> null) and (threadCount > 0) and (capacity > 0)
+   */
+  protected NativeWorkerPool(Token token, int threadCount, int capacity, boolean rwSession)
+      throws TokenException {
+    if (token == null) {
+      throw new NullPointerException("Argument \"token\" must not be null.");
+    }
+    if ((threadCount <= 0) || (capacity <= 0)) {
+      throw new IllegalArgumentException("The thread count and capacity must be positive.");
+    }
+    token_ = token;
+    pkcs11Module_ = token.getSlot().getModule().getPKCS11Module();
+
+    sessions_ = new Session[threadCount];
+    long[] sessionHandles = new long[threadCount];
+    try {
+      for (int i = 0; i < threadCount; i++) {
+        sessions_[i] = token.openSession(Token.SessionType.SERIAL_SESSION, rwSession, null, null);
+        sessionHandles[i] = sessions_[i].getSessionHandle();
+      }
+      poolHandle_ = pkcs11Module_.C_WorkerPoolCreate(sessionHandles, capacity);
+    } catch (TokenException ex) {
+      closeSessions();
+      throw ex;
+    } catch (RuntimeException ex) {
+      closeSessions();
+      throw ex;
+    }
+  }
+
+  /**
+   * Submit requests to run the same operation with the same mechanism and key for many pieces of
+   * data. This never blocks. It accepts as many requests as the capacity allows, from the first on;
+   * the caller must submit the others later again.
+   * 
+   * @param operation
+   *          The operation; SIGN, ENCRYPT, DECRYPT or DIGEST.
+   * @param mechanism
+   *          The mechanism to use.
+   * @param key
+   *          The key to use, null for DIGEST.
+   * @param ids
+   *          The ids of the requests, which poll returns with their results; must be at least as
+   *          long as data.
+   * @param data
+   *          The input of each request.
+   * @return The number of accepted requests; 0, if the pool is full.
+   * @exception TokenException
+   *              If this object is closed or the requests could not be submitted at all.
+   * @preconditions (mechanism <> null) and (ids <> null) and (data <> null)
+   *                and (ids.length >= data.length)
+   * @postconditions (0 <= result <= data.length)
+   */
+  public int submit(int operation, Mechanism mechanism, Key key, long[] ids, byte[][] data)
+      throws TokenException {
+    if (mechanism == null) {
+      throw new NullPointerException("Argument \"mechanism\" must not be null.");
+    }
+    if (ids == null) {
+      throw new NullPointerException("Argument \"ids\" must not be null.");
+    }
+    if (data == null) {
+      throw new NullPointerException("Argument \"data\" must not be null.");
+    }
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+
+    long poolHandle = enterCall();
+    try {
+      return pkcs11Module_.C_WorkerPoolSubmit(poolHandle, operation, ckMechanism,
+          (key != null) ? key.getObjectHandle() : 0L, ids, data, token_.useUtf8Encoding_);
+    } finally {
+      exitCall();
+    }
+  }
+
+  /**
+   * Take the results of finished requests, as many as ids can hold. If there is none, wait for
+   * the first one up to the given timeout. The wait ends early with no result, if no request is
+   * in flight, or if the pool is closed meanwhile.
+   * 
+   * @param ids
+   *          Receives the id of each result.
+   * @param errorCodes
+   *          Receives the error code of each result, 0 for success; must be at least as long as
+   *          ids.
+   * @param outputs
+   *          Receives the output of each result, null for a failed request; must be at least as
+   *          long as ids.
+   * @param timeout
+   *          The time in milliseconds to wait for the first result; 0 not to wait, a negative value
+   *          to wait as long as it takes.
+   * @return The number of results stored in the arrays, from index 0 on.
+   * @exception TokenException
+   *              If this object is closed.
+   * @preconditions (ids <> null) and (errorCodes <> null) and (outputs <> null)
+   * @postconditions (0 <= result <= ids.length)
+   */
+  public int poll(long[] ids, long[] errorCodes, byte[][] outputs, long timeout)
+      throws TokenException {
+    if (ids == null) {
+      throw new NullPointerException("Argument \"ids\" must not be null.");
+    }
+    if (errorCodes == null) {
+      throw new NullPointerException("Argument \"errorCodes\" must not be null.");
+    }
+    if (outputs == null) {
+      throw new NullPointerException("Argument \"outputs\" must not be null.");
+    }
+
+    long poolHandle = enterCall();
+    try {
+      return pkcs11Module_.C_WorkerPoolPoll(poolHandle, ids, errorCodes, outputs, timeout);
+    } finally {
+      exitCall();
+    }
+  }
+
+  /**
+   * Get the token of the sessions.
+   * 
+   * @return The token.
+   * @postconditions (result <> null)
+   */
+  public Token getToken() {
+    return token_;
+  }
+
+  /**
+   * Get the number of native threads.
+   * 
+   * @return The number of threads.
+   * @postconditions (result > 0)
+   */
+  public int getThreadCount() {
+    return sessions_.length;
+  }
+
+  /**
+   * Stop the native threads, drop all requests and results, which were not polled yet, and close
+   * the sessions. Polls waiting for a result return at once; the native pool is freed, when all
+   * running calls of submit and poll have returned. Calling this again has no effect.
+   * 
+   * @exception TokenException
+   *              If stopping or destroying the native pool fails.
+   */
+  public void close() throws TokenException {
+    synchronized (this) {
+      if (closed_) {
+        return;
+      }
+      closed_ = true;
+    }
+    pkcs11Module_.C_WorkerPoolStop(poolHandle_);
+
+    boolean interrupted = false;
+    synchronized (this) {
+      // the native pool must not be freed while a call still uses it
+      while (activeCalls_ > 0) {
+        try {
+          wait();
+        } catch (InterruptedException ex) {
+          interrupted = true;
+        }
+      }
+    }
+    if (interrupted) {
+      Thread.currentThread().interrupt();
+    }
+    pkcs11Module_.C_WorkerPoolDestroy(poolHandle_);
+    poolHandle_ = 0L;
+    closeSessions();
+  }
+
+  /**
+   * Register a call that uses the native pool, unless this object is closed. Each successful call
+   * must be followed by a call of exitCall.
+   * 
+   * @return The native handle of the pool.
+   * @exception TokenException
+   *              If this object is closed.
+   */
+  protected synchronized long enterCall() throws TokenException {
+    if (closed_) {
+      throw new TokenException("The native worker pool is closed.");
+    }
+    activeCalls_++;
+
+    return poolHandle_;
+  }
+
+  /**
+   * Unregister a call that has used the native pool, and wake up close, if it waits for the last
+   * one.
+   */
+  protected synchronized void exitCall() {
+    activeCalls_--;
+    if (closed_ && (activeCalls_ == 0)) {
+      notifyAll();
+    }
+  }
+
+  /**
+   * Close the sessions opened so far.
+   */
+  protected void closeSessions() {
+    for (int i = 0; i < sessions_.length; i++) {
+      if (sessions_[i] != null) {
+        try {
+          sessions_[i].closeSession();
+        } catch (TokenException ex) {
+          // the pool is gone anyway
+        }
+        sessions_[i] = null;
+      }
+    }
+  }
+
+}
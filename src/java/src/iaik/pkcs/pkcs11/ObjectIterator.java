@@ -0,0 +1,292 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.objects.Object;
+import iaik.pkcs.pkcs11.wrapper.PKCS11;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Exception;
+
+import java.util.Iterator;
+import java.util.NoSuchElementException;
+
+/**
+ * An iterator over the objects found by a find operation. It gets the object handles from the
+ * module in batches, starting with a small batch and doubling the batch size up to a maximum with
+ * each call. This way, a search for a few objects needs only a small batch, while a scan over
+ * thousands of objects needs few calls. The handles of all batches go to the same array, so the
+ * memory needed does not grow with the number of objects found.
+ * <p>
+ * In the default mode, next returns the found objects as created by Object.getInstance. In the
+ * handles-only mode, next returns the handles as Long objects without creating any objects; use
+ * nextHandle to avoid even these. The find operation is finalized as soon as the module has no
+ * more objects to return, or when the application calls close. An application that stops
+ * iterating early must call close before starting another operation in the session. Example:
+ * <code>
+ *   ObjectIterator iterator = session.iterateObjects(keyTemplate);
+ *   try {
+ *     while (iterator.hasNext()) {
+ *       Key key = (Key) iterator.next();
+ *       ...
+ *     }
+ *   } finally {
+ *     iterator.close();
+ *   }
+ * </code> Errors of the module during hasNext or next are thrown as TokenRuntimeException, because
+ * the Iterator interface does not allow checked exceptions.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (session_ <> null) and (handles_ <> null) and (0 < batchSize_ <= handles_.length)
+ */
+public class ObjectIterator implements Iterator {
+
+  /**
+   * The number of handles to get with the first call to the module, if the application does not
+   * specify it.
+   */
+  public static final int DEFAULT_INITIAL_BATCH_SIZE = 16;
+
+  /**
+   * The maximum number of handles to get with a single call to the module, if the application does
+   * not specify it.
+   */
+  public static final int DEFAULT_MAX_BATCH_SIZE = 1024;
+
+  /**
+   * The session running the find operation.
+   */
+  protected Session session_;
+
+  /**
+   * True, if next returns the handles only.
+   */
+  protected boolean handlesOnly_;
+
+  /**
+   * The array receiving the handles of each batch. Its length is the maximum batch size.
+   */
+  protected long[] handles_;
+
+  /**
+   * The number of valid handles of the current batch in handles_.
+   */
+  protected int count_;
+
+  /**
+   * The index of the next handle to return in handles_.
+   */
+  protected int position_;
+
+  /**
+   * The number of handles to get with the next call to the module.
+   */
+  protected int batchSize_;
+
+  /**
+   * The number of calls to the module to get handles so far.
+   */
+  protected int callCount_;
+
+  /**
+   * True, if the find operation has been finalized.
+   */
+  protected boolean closed_;
+
+  /**
+   * Constructor for a find operation that the session has already initialized.
+   * 
+   * @param session
+   *          The session running the find operation.
+   * @param handlesOnly
+   *          True, if next shall return the handles only. False, if it shall return objects.
+   * @param initialBatchSize
+   *          The number of handles to get with the first call to the module.
+   * @param maxBatchSize
+   *          The maximum number of handles to get with a single call to the module.
+   * @preconditions (session <> null) and (0 < initialBatchSize <= maxBatchSize)
+   */
+  protected ObjectIterator(Session session, boolean handlesOnly, int initialBatchSize,
+      int maxBatchSize) {
+    if (session == null) {
+      throw new NullPointerException("Argument \"session\" must not be null.");
+    }
+    if ((initialBatchSize <= 0) || (initialBatchSize > maxBatchSize)) {
+      throw new IllegalArgumentException(
+          "The batch sizes must be positive and the initial one must not exceed the maximum.");
+    }
+    session_ = session;
+    handlesOnly_ = handlesOnly;
+    handles_ = new long[maxBatchSize];
+    batchSize_ = initialBatchSize;
+  }
+
+  /**
+   * Check, if there are more objects. This gets the next batch of handles from the module, if the
+   * current one is used up.
+   * 
+   * @return True, if there are more objects. False, otherwise.
+   * @exception TokenRuntimeException
+   *              If getting the handles from the module fails.
+   */
+  public boolean hasNext() {
+    if ((position_ >= count_) && !closed_) {
+      fetchBatch();
+    }
+
+    return position_ < count_;
+  }
+
+  /**
+   * Get the next object, or the next handle as Long in the handles-only mode.
+   * 
+   * @return The next object or handle.
+   * @exception NoSuchElementException
+   *              If there are no more objects.
+   * @exception TokenRuntimeException
+   *              If getting the handles or creating the object fails.
+   * @postconditions (result <> null)
+   */
+  public java.lang.Object next() {
+    if (handlesOnly_) {
+      return new Long(nextHandle());
+    }
+    long objectHandle = nextHandle();
+    try {
+      return Object.getInstance(session_, objectHandle);
+    } catch (TokenException ex) {
+      throw new TokenRuntimeException("Creating a found object failed.", ex);
+    }
+  }
+
+  /**
+   * Get the handle of the next object. This works in both modes.
+   * 
+   * @return The handle of the next object.
+   * @exception NoSuchElementException
+   *              If there are no more objects.
+   * @exception TokenRuntimeException
+   *              If getting the handles from the module fails.
+   */
+  public long nextHandle() {
+    if (!hasNext()) {
+      throw new NoSuchElementException("The find operation has no more objects.");
+    }
+
+    return handles_[position_++];
+  }
+
+  /**
+   * Not supported; use Session.destroyObject to remove an object from the token.
+   * 
+   * @exception UnsupportedOperationException
+   *              Always.
+   */
+  public void remove() {
+    throw new UnsupportedOperationException("Objects cannot be removed through a find operation.");
+  }
+
+  /**
+   * Finalize the find operation, if it is still running. Afterwards, hasNext returns false.
+   * Calling this method more than once has no effect.
+   * 
+   * @exception TokenException
+   *              If finalizing the find operation fails.
+   */
+  public void close() throws TokenException {
+    if (!closed_) {
+      closed_ = true;
+      count_ = 0;
+      position_ = 0;
+      session_.findObjectsFinal();
+    }
+  }
+
+  /**
+   * Check, if the find operation has been finalized.
+   * 
+   * @return True, if the find operation has been finalized. False, otherwise.
+   */
+  public boolean isClosed() {
+    return closed_;
+  }
+
+  /**
+   * Get the number of calls to the module to get handles so far, the final empty one included.
+   * 
+   * @return The number of calls.
+   * @postconditions (result >= 0)
+   */
+  public int getCallCount() {
+    return callCount_;
+  }
+
+  /**
+   * Get the next batch of handles from the module and double the batch size for the call after.
+   * If the module returns no handles, the find operation is finalized.
+   * 
+   * @exception TokenRuntimeException
+   *              If getting the handles from the module or finalizing the find operation fails.
+   */
+  protected void fetchBatch() {
+    PKCS11 pkcs11Module = session_.getPKCS11Module();
+    try {
+      count_ = pkcs11Module.C_FindObjectsInto(session_.getSessionHandle(), handles_, batchSize_);
+    } catch (PKCS11Exception ex) {
+      throw new TokenRuntimeException("Getting the found object handles failed.", ex);
+    }
+    position_ = 0;
+    callCount_++;
+
+    if (count_ == 0) {
+      try {
+        close();
+      } catch (TokenException ex) {
+        throw new TokenRuntimeException("Finalizing the find operation failed.", ex);
+      }
+    } else if (batchSize_ < handles_.length) {
+      batchSize_ = (batchSize_ > handles_.length / 2) ? handles_.length : 2 * batchSize_;
+    }
+  }
+
+}
@@ -0,0 +1,449 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import java.util.Vector;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+
+/**
+ * The pending result of an operation that an AsyncSession runs in the background. The application
+ * can wait for the result with get, or register a callback, which the thread finishing the
+ * operation calls; the latter never blocks the thread of the application. An operation can be
+ * cancelled as long as it has not started; a running operation always finishes, because a call to
+ * the module cannot be interrupted. An operation with a deadline fails, if it has not started
+ * before the deadline. For code that works with java.util.concurrent, asFuture returns a view of
+ * this object as Future.
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (callbacks_ <> null)
+ */
+public class OperationFuture {
+
+  /**
+   * The interface for callbacks, which are called when an operation is finished, failed or
+   * cancelled.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   */
+  public interface Callback {
+
+    /**
+     * Called once when the operation is done. Implementations should return quickly, because they
+     * run on the worker thread of the operation.
+     * 
+     * @param future
+     *          The future of the operation, which is done.
+     */
+    public void done(OperationFuture future);
+
+  }
+
+  /**
+   * A view of an OperationFuture as java.util.concurrent.Future.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   */
+  protected class FutureView implements Future {
+
+    /**
+     * Cancel the operation, if it has not started yet. A running operation cannot be interrupted.
+     * 
+     * @param mayInterruptIfRunning
+     *          Has no effect.
+     * @return True, if the operation has been cancelled. False, if it has already started.
+     */
+    public boolean cancel(boolean mayInterruptIfRunning) {
+      return OperationFuture.this.cancel();
+    }
+
+    /**
+     * Check, if the operation has been cancelled.
+     * 
+     * @return True, if the operation has been cancelled. False, otherwise.
+     */
+    public boolean isCancelled() {
+      return OperationFuture.this.isCancelled();
+    }
+
+    /**
+     * Check, if the operation is done; i.e. finished, failed or cancelled.
+     * 
+     * @return True, if the operation is done. False, otherwise.
+     */
+    public boolean isDone() {
+      return OperationFuture.this.isDone();
+    }
+
+    /**
+     * Wait until the operation is done and get its result.
+     * 
+     * @return The result of the operation.
+     * @exception InterruptedException
+     *              If the waiting thread has been interrupted.
+     * @exception ExecutionException
+     *              If the operation failed. Its cause is the TokenException of the operation.
+     */
+    public java.lang.Object get() throws InterruptedException, ExecutionException {
+      await(0L);
+
+      return report();
+    }
+
+    /**
+     * Wait until the operation is done or the timeout expires, and get its result.
+     * 
+     * @param timeout
+     *          The maximum time to wait.
+     * @param unit
+     *          The unit of the timeout.
+     * @return The result of the operation.
+     * @exception InterruptedException
+     *              If the waiting thread has been interrupted.
+     * @exception ExecutionException
+     *              If the operation failed. Its cause is the TokenException of the operation.
+     * @exception TimeoutException
+     *              If the operation is not done after the timeout.
+     * @preconditions (unit <> null)
+     */
+    public java.lang.Object get(long timeout, TimeUnit unit) throws InterruptedException,
+        ExecutionException, TimeoutException {
+      long timeoutMillis = unit.toMillis(timeout);
+      if ((timeoutMillis <= 0) ? !OperationFuture.this.isDone() : !await(timeoutMillis)) {
+        throw new TimeoutException("The operation is not done within the timeout.");
+      }
+
+      return report();
+    }
+
+    /**
+     * Get the result of the done operation.
+     * 
+     * @return The result of the operation.
+     * @exception ExecutionException
+     *              If the operation failed.
+     */
+    protected java.lang.Object report() throws ExecutionException {
+      synchronized (OperationFuture.this) {
+        if (state_ == CANCELLED) {
+          throw new CancellationException("The operation has been cancelled.");
+        }
+        if (exception_ != null) {
+          throw new ExecutionException(exception_);
+        }
+
+        return result_;
+      }
+    }
+
+  }
+
+  /**
+   * The state of an operation that waits in the queue.
+   */
+  protected static final int PENDING = 0;
+
+  /**
+   * The state of an operation that runs.
+   */
+  protected static final int RUNNING = 1;
+
+  /**
+   * The state of an operation that is finished or failed.
+   */
+  protected static final int DONE = 2;
+
+  /**
+   * The state of an operation that has been cancelled before it started.
+   */
+  protected static final int CANCELLED = 3;
+
+  /**
+   * The state of the operation. Guarded by the monitor of this future.
+   */
+  protected int state_ = PENDING;
+
+  /**
+   * The time in milliseconds until which the operation must start, or 0 for no deadline.
+   */
+  protected long deadline_;
+
+  /**
+   * The result of the operation, if it is finished.
+   */
+  protected java.lang.Object result_;
+
+  /**
+   * The exception of the operation, if it failed or has been cancelled.
+   */
+  protected TokenException exception_;
+
+  /**
+   * The callbacks to call when the operation is done. Guarded by the monitor of this future.
+   */
+  protected Vector callbacks_ = new Vector(2);
+
+  /**
+   * Constructor taking the deadline.
+   * 
+   * @param deadline
+   *          The time in milliseconds until which the operation must start, or 0 for no deadline.
+   */
+  protected OperationFuture(long deadline) {
+    deadline_ = deadline;
+  }
+
+  /**
+   * Wait until the operation is done and get its result.
+   * 
+   * @return The result of the operation; e.g. a byte[] for a signature or a Key for an unwrapped
+   *         key. Null for operations without result, like verify.
+   * @exception TokenException
+   *              If the operation failed, has been cancelled or the waiting thread has been
+   *              interrupted.
+   */
+  public java.lang.Object get() throws TokenException {
+    return get(0L);
+  }
+
+  /**
+   * Wait until the operation is done or the timeout expires, and get its result.
+   * 
+   * @param timeout
+   *          The maximum time to wait in milliseconds, or 0 to wait as long as it takes.
+   * @return The result of the operation.
+   * @exception TokenException
+   *              If the operation failed, has been cancelled, is not done after the timeout, or the
+   *              waiting thread has been interrupted.
+   */
+  public synchronized java.lang.Object get(long timeout) throws TokenException {
+    try {
+      if (!await(timeout)) {
+        throw new TokenException("The operation is not done within the timeout.");
+      }
+    } catch (InterruptedException ex) {
+      Thread.currentThread().interrupt();
+      throw new TokenException("Interrupted while waiting for the operation.", ex);
+    }
+    if (exception_ != null) {
+      throw exception_;
+    }
+
+    return result_;
+  }
+
+  /**
+   * Get a view of this object as java.util.concurrent.Future; e.g. to wait for it together with
+   * the futures of an ExecutorService. Its get methods throw an ExecutionException with the
+   * TokenException of a failed operation as cause, and a CancellationException for a cancelled
+   * one. Cancelling the view cancels the operation, if it has not started yet.
+   * 
+   * @return The view of this object.
+   * @postconditions (result <> null)
+   */
+  public Future asFuture() {
+    return new FutureView();
+  }
+
+  /**
+   * Wait until the operation is done or the timeout expires.
+   * 
+   * @param timeout
+   *          The maximum time to wait in milliseconds, or 0 to wait as long as it takes.
+   * @return True, if the operation is done. False, if the timeout expired.
+   * @exception InterruptedException
+   *              If the waiting thread has been interrupted.
+   */
+  protected synchronized boolean await(long timeout) throws InterruptedException {
+    long end = (timeout > 0) ? System.currentTimeMillis() + timeout : Long.MAX_VALUE;
+    while (!isDone()) {
+      long remaining = end - System.currentTimeMillis();
+      if (remaining <= 0) {
+        return false;
+      }
+      wait(remaining);
+    }
+
+    return true;
+  }
+
+  /**
+   * Cancel the operation, if it has not started yet.
+   * 
+   * @return True, if the operation has been cancelled. False, if it has already started.
+   */
+  public boolean cancel() {
+    return finish(PENDING, CANCELLED, null, new TokenException(
+        "The operation has been cancelled."));
+  }
+
+  /**
+   * Check, if the operation is done; i.e. finished, failed or cancelled.
+   * 
+   * @return True, if the operation is done. False, otherwise.
+   */
+  public synchronized boolean isDone() {
+    return (state_ == DONE) || (state_ == CANCELLED);
+  }
+
+  /**
+   * Check, if the operation has been cancelled.
+   * 
+   * @return True, if the operation has been cancelled. False, otherwise.
+   */
+  public synchronized boolean isCancelled() {
+    return state_ == CANCELLED;
+  }
+
+  /**
+   * Register a callback to be called when the operation is done. If it is done already, the
+   * callback is called immediately in the current thread.
+   * 
+   * @param callback
+   *          The callback.
+   * @preconditions (callback <> null)
+   */
+  public void addCallback(Callback callback) {
+    if (callback == null) {
+      throw new NullPointerException("Argument \"callback\" must not be null.");
+    }
+    synchronized (this) {
+      if (!isDone()) {
+        callbacks_.addElement(callback);
+        return;
+      }
+    }
+    callback.done(this);
+  }
+
+  /**
+   * Mark the operation as running. This fails the operation, if its deadline has passed.
+   * 
+   * @return True, if the operation may run. False, if it has been cancelled or its deadline has
+   *         passed.
+   */
+  protected boolean start() {
+    if ((deadline_ != 0) && (System.currentTimeMillis() > deadline_)) {
+      finish(PENDING, DONE, null, new TokenException(
+          "The deadline of the operation passed before it started."));
+      return false;
+    }
+    synchronized (this) {
+      if (state_ != PENDING) {
+        return false;
+      }
+      state_ = RUNNING;
+      return true;
+    }
+  }
+
+  /**
+   * Finish the running operation with the given result.
+   * 
+   * @param result
+   *          The result of the operation.
+   */
+  protected void complete(java.lang.Object result) {
+    finish(RUNNING, DONE, result, null);
+  }
+
+  /**
+   * Finish the operation with the given exception, if it is pending or running.
+   * 
+   * @param exception
+   *          The exception of the operation.
+   * @preconditions (exception <> null)
+   */
+  protected void fail(TokenException exception) {
+    if (!finish(PENDING, DONE, null, exception)) {
+      finish(RUNNING, DONE, null, exception);
+    }
+  }
+
+  /**
+   * Change the state of the operation, if it is in the expected state, and call the callbacks.
+   * 
+   * @param expectedState
+   *          The state that the operation must be in.
+   * @param newState
+   *          The new state, DONE or CANCELLED.
+   * @param result
+   *          The result of the operation.
+   * @param exception
+   *          The exception of the operation, or null.
+   * @return True, if the state has been changed. False, otherwise.
+   */
+  protected boolean finish(int expectedState, int newState, java.lang.Object result,
+      TokenException exception) {
+    Callback[] callbacks;
+    synchronized (this) {
+      if (state_ != expectedState) {
+        return false;
+      }
+      state_ = newState;
+      result_ = result;
+      exception_ = exception;
+      notifyAll();
+      callbacks = new Callback[callbacks_.size()];
+      callbacks_.copyInto(callbacks);
+      callbacks_.removeAllElements();
+    }
+    for (int i = 0; i < callbacks.length; i++) {
+      try {
+        callbacks[i].done(this);
+      } catch (RuntimeException ex) {
+        // a failing callback must not keep the others from being called
+      }
+    }
+
+    return true;
+  }
+
+}
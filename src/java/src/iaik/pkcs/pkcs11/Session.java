@@ -60,7 +60,9 @@ import iaik.pkcs.pkcs11.wrapper.Constants;
 import iaik.pkcs.pkcs11.wrapper.Functions;
 import iaik.pkcs.pkcs11.wrapper.PKCS11;
 import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Exception;
 
+import java.nio.ByteBuffer;
 import java.util.Vector;
 
 /**
@@ -194,6 +196,22 @@ public class Session {
    */
   private boolean useUtf8Encoding_;
 
+  /**
+   * True, if objects created by this session read their attributes on first use.
+   */
+  protected boolean lazyAttributeLoading_;
+
+  /**
+   * The cache for attribute values of this session, or null to use the cache of the token.
+   */
+  protected AttributeCache attributeCache_;
+
+  /**
+   * The pool that runs the calls of this session to the PKCS#11 module, or null to call it
+   * directly.
+   */
+  protected BlockingCallPool blockingCallPool_;
+
   /**
    * Constructor taking the token and the session handle.
    * 
@@ -211,6 +229,7 @@ public class Session {
     token_ = token;
     module_ = token_.getSlot().getModule();
     pkcs11Module_ = module_.getPKCS11Module();
+    blockingCallPool_ = module_.getBlockingCallPool();
     sessionHandle_ = sessionHandle;
     useUtf8Encoding_ = token.useUtf8Encoding_;
   }
@@ -252,6 +271,15 @@ public class Session {
    */
   public void closeSession() throws TokenException {
     pkcs11Module_.C_CloseSession(sessionHandle_);
+    // the session objects are gone; of a shared cache keep only objects known to be token objects
+    AttributeCache attributeCache = getAttributeCache();
+    if (attributeCache == attributeCache_) {
+      if (attributeCache != null) {
+        attributeCache.invalidateAll();
+      }
+    } else {
+      attributeCache.retainObjects(PKCS11Constants.CKA_TOKEN, true);
+    }
   }
 
   /**
@@ -374,6 +402,101 @@ public class Session {
     return useUtf8Encoding_;
   }
 
+  /**
+   * Set, if the objects that this session creates from the token, e.g. by findObjects, read their
+   * attributes when they are first used instead of reading all of them at once. This saves calls
+   * and memory, if the application only needs a few attributes of many objects; e.g. the ID of all
+   * keys. The objects behave the same in both modes, but in lazy mode an attribute that cannot be
+   * read later, e.g. because this session has been closed, causes a TokenRuntimeException when it
+   * is used. Call readAttributes on an object to read all its attributes at once. The default is
+   * false.
+   * 
+   * @param lazyAttributeLoading
+   *          True, to read attributes on first use. False, to read all attributes at once.
+   */
+  public void setLazyAttributeLoading(boolean lazyAttributeLoading) {
+    lazyAttributeLoading_ = lazyAttributeLoading;
+  }
+
+  /**
+   * Check, if the objects that this session creates from the token read their attributes on first
+   * use.
+   * 
+   * @return True, if attributes are read on first use. False, if all are read at once.
+   */
+  public boolean isLazyAttributeLoading() {
+    return lazyAttributeLoading_;
+  }
+
+  /**
+   * Set a cache for attribute values for this session only. If no cache is set, the session uses
+   * the cache of its token, if any; see Token.setAttributeCache.
+   * 
+   * @param attributeCache
+   *          The cache to use, or null to use the cache of the token.
+   */
+  public void setAttributeCache(AttributeCache attributeCache) {
+    attributeCache_ = attributeCache;
+  }
+
+  /**
+   * Get the cache for attribute values that this session uses. This is the cache of this session,
+   * if set, or the cache of the token otherwise.
+   * 
+   * @return The cache, or null if there is none.
+   */
+  public AttributeCache getAttributeCache() {
+    return (attributeCache_ != null) ? attributeCache_ : token_.getAttributeCache();
+  }
+
+  /**
+   * Set the pool that runs the calls of this session to the PKCS#11 module in platform threads;
+   * see BlockingCallPool. A new session takes the pool of its module.
+   * 
+   * @param blockingCallPool
+   *          The pool to run the calls on, or null to call the module directly.
+   */
+  public void setBlockingCallPool(BlockingCallPool blockingCallPool) {
+    PKCS11 directModule = BlockingCallPool.getDirectModule(module_.getPKCS11Module());
+    pkcs11Module_ = (blockingCallPool != null) ? blockingCallPool.offload(directModule)
+        : directModule;
+    blockingCallPool_ = blockingCallPool;
+  }
+
+  /**
+   * Get the pool that runs the calls of this session to the PKCS#11 module.
+   * 
+   * @return The pool, or null if the module is called directly.
+   */
+  public BlockingCallPool getBlockingCallPool() {
+    return blockingCallPool_;
+  }
+
+  /**
+   * Get the PKCS#11 module, which this session calls; it runs its calls on the blocking call pool
+   * of this session, if there is one.
+   * 
+   * @return The PKCS#11 module of this session.
+   * @postconditions (result <> null)
+   */
+  public PKCS11 getPKCS11Module() {
+    return pkcs11Module_;
+  }
+
+  /**
+   * Remove the given object from the attribute cache, if there is one. The module may reuse the
+   * handles of destroyed objects, so this is also done for the handles of new objects.
+   * 
+   * @param objectHandle
+   *          The handle of the object.
+   */
+  protected void invalidateCachedAttributes(long objectHandle) {
+    AttributeCache attributeCache = getAttributeCache();
+    if (attributeCache != null) {
+      attributeCache.invalidate(objectHandle);
+    }
+  }
+
   /**
    * Logs in the user or the security officer to the session. Notice that all sessions of a token
    * have the same login state; i.e. if you login the user to one session all other open sessions of
@@ -400,6 +523,10 @@ public class Session {
    */
   public void logout() throws TokenException {
     pkcs11Module_.C_Logout(sessionHandle_);
+    AttributeCache attributeCache = getAttributeCache();
+    if (attributeCache != null) {
+      attributeCache.retainObjects(PKCS11Constants.CKA_PRIVATE, false);
+    }
   }
 
   /**
@@ -437,6 +564,7 @@ public class Session {
     CK_ATTRIBUTE[] ckAttributes = Object.getSetAttributes(templateObject);
     long objectHandle = pkcs11Module_.C_CreateObject(sessionHandle_, ckAttributes,
         useUtf8Encoding_);
+    invalidateCachedAttributes(objectHandle);
 
     return Object.getInstance(this, objectHandle);
   }
@@ -465,6 +593,7 @@ public class Session {
     CK_ATTRIBUTE[] ckAttributes = Object.getSetAttributes(templateObject);
     long newObjectHandle = pkcs11Module_.C_CopyObject(sessionHandle_, sourceObjectHandle,
         ckAttributes, useUtf8Encoding_);
+    invalidateCachedAttributes(newObjectHandle);
 
     return Object.getInstance(this, newObjectHandle);
   }
@@ -492,8 +621,11 @@ public class Session {
       throws TokenException {
     long objectToUpdateHandle = objectToUpdate.getObjectHandle();
     CK_ATTRIBUTE[] ckAttributesTemplates = Object.getSetAttributes(templateObject);
+    invalidateCachedAttributes(objectToUpdateHandle);
     pkcs11Module_.C_SetAttributeValue(sessionHandle_, objectToUpdateHandle,
         ckAttributesTemplates, useUtf8Encoding_);
+    // also after the call, in case another thread read the old values in the meantime
+    invalidateCachedAttributes(objectToUpdateHandle);
   }
 
   /**
@@ -512,10 +644,44 @@ public class Session {
    */
   public Object getAttributeValues(Object objectToRead) throws TokenException {
     long objectHandle = objectToRead.getObjectHandle();
+    invalidateCachedAttributes(objectHandle);
 
     return Object.getInstance(this, objectHandle);
   }
 
+  /**
+   * Reads the same attributes of many objects in a single call to the native part. This is much
+   * cheaper than reading the objects one by one, e.g. for listing all keys and certificates of a
+   * token. A value that cannot be read, e.g. because it is sensitive, does not stop the read; check
+   * the error codes of the returned table.
+   * 
+   * @param objectHandles
+   *          The handles of the objects to read; e.g. of the objects found by findObjects.
+   * @param attributeTypes
+   *          The types of the attributes to read of each object; e.g. PKCS11Constants.CKA_CLASS and
+   *          PKCS11Constants.CKA_LABEL. Array attributes like CKA_WRAP_TEMPLATE are not supported.
+   * @return The values of the attributes of all objects.
+   * @exception TokenException
+   *              If the attributes could not be read at all.
+   * @preconditions (objectHandles <> null) and (attributeTypes <> null)
+   * @postconditions (result <> null)
+   */
+  public AttributeValueTable getAttributeValues(long[] objectHandles, long[] attributeTypes)
+      throws TokenException {
+    if (objectHandles == null) {
+      throw new NullPointerException("Argument \"objectHandles\" must not be null.");
+    }
+    if (attributeTypes == null) {
+      throw new NullPointerException("Argument \"attributeTypes\" must not be null.");
+    }
+    long[] cells = new long[3 * objectHandles.length * attributeTypes.length];
+
+    byte[] packedValues = pkcs11Module_.C_GetAttributeValueBulk(sessionHandle_, objectHandles,
+        attributeTypes, cells);
+
+    return new AttributeValueTable(objectHandles, attributeTypes, packedValues, cells);
+  }
+
   /**
    * Destroy a certain object on the token (or in the session). Give the object that you want to
    * destroy. This method uses only the internal object handle of the given object to identify the
@@ -531,6 +697,7 @@ public class Session {
   public void destroyObject(Object object) throws TokenException {
     long objectHandle = object.getObjectHandle();
     pkcs11Module_.C_DestroyObject(sessionHandle_, objectHandle);
+    invalidateCachedAttributes(objectHandle);
   }
 
   /**
@@ -615,6 +782,73 @@ public class Session {
     pkcs11Module_.C_FindObjectsFinal(sessionHandle_);
   }
 
+  /**
+   * Starts a find operation and returns an iterator over the found objects. The iterator gets the
+   * handles in batches of growing size and creates each object only when the application asks for
+   * it; so scanning all objects of a large token needs little memory and few calls to the module.
+   * The find operation is finalized when the iterator has returned all objects or when the
+   * application closes the iterator; see ObjectIterator.
+   * 
+   * @param templateObject
+   *          The object that serves as a template for searching. If this object is null, the find
+   *          operation will find all objects that this session can see.
+   * @return The iterator returning the found objects.
+   * @exception TokenException
+   *              If initializing the find operation fails.
+   * @postconditions (result <> null)
+   */
+  public ObjectIterator iterateObjects(Object templateObject) throws TokenException {
+    return iterateObjects(templateObject, false, ObjectIterator.DEFAULT_INITIAL_BATCH_SIZE,
+        ObjectIterator.DEFAULT_MAX_BATCH_SIZE);
+  }
+
+  /**
+   * Starts a find operation and returns an iterator over the handles of the found objects. No
+   * objects are created; next returns the handles as Long, nextHandle as long.
+   * 
+   * @param templateObject
+   *          The object that serves as a template for searching. If this object is null, the find
+   *          operation will find all objects that this session can see.
+   * @return The iterator returning the handles of the found objects.
+   * @exception TokenException
+   *              If initializing the find operation fails.
+   * @postconditions (result <> null)
+   */
+  public ObjectIterator iterateObjectHandles(Object templateObject) throws TokenException {
+    return iterateObjects(templateObject, true, ObjectIterator.DEFAULT_INITIAL_BATCH_SIZE,
+        ObjectIterator.DEFAULT_MAX_BATCH_SIZE);
+  }
+
+  /**
+   * Starts a find operation and returns an iterator over the found objects or their handles.
+   * 
+   * @param templateObject
+   *          The object that serves as a template for searching. If this object is null, the find
+   *          operation will find all objects that this session can see.
+   * @param handlesOnly
+   *          True, if the iterator shall return the handles only. False, if it shall return
+   *          objects.
+   * @param initialBatchSize
+   *          The number of handles to get with the first call to the module.
+   * @param maxBatchSize
+   *          The maximum number of handles to get with a single call to the module.
+   * @return The iterator.
+   * @exception TokenException
+   *              If initializing the find operation fails.
+   * @preconditions (0 < initialBatchSize <= maxBatchSize)
+   * @postconditions (result <> null)
+   */
+  public ObjectIterator iterateObjects(Object templateObject, boolean handlesOnly,
+      int initialBatchSize, int maxBatchSize) throws TokenException {
+    if ((initialBatchSize <= 0) || (initialBatchSize > maxBatchSize)) {
+      throw new IllegalArgumentException(
+          "The batch sizes must be positive and the initial one must not exceed the maximum.");
+    }
+    findObjectsInit(templateObject);
+
+    return new ObjectIterator(this, handlesOnly, initialBatchSize, maxBatchSize);
+  }
+
   /**
    * Initializes a new encryption operation. The application must call this method before calling
    * any other encrypt* operation. Before initializing a new operation, any currently pending
@@ -662,6 +896,136 @@ public class Session {
     return pkcs11Module_.C_Encrypt(sessionHandle_, data);
   }
 
+  /**
+   * Encrypts the remaining data of the given direct buffer with the key and mechanism given to the
+   * encryptInit method and writes the result to the given direct output buffer. Like
+   * encrypt(byte[]), this method finalizes the current encryption operation. The buffers are handed
+   * to the module without copying their contents to the Java heap. On success, the position of data
+   * is set to its limit and the position of encryptedData is advanced by the number of bytes
+   * written, as for javax.crypto.Cipher.doFinal(ByteBuffer, ByteBuffer). If encryptedData has not
+   * enough space left, the method fails with CKR_BUFFER_TOO_SMALL, the buffers stay unchanged and
+   * the operation can be repeated with a larger output buffer.
+   * 
+   * @param data
+   *          The direct buffer holding the data to encrypt.
+   * @param encryptedData
+   *          The direct buffer that receives the encrypted data.
+   * @return The number of bytes written to encryptedData.
+   * @exception TokenException
+   *              If encrypting failed.
+   * @preconditions (data <> null) and (encryptedData <> null) and data.isDirect() and
+   * encryptedData.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int encrypt(ByteBuffer data, ByteBuffer encryptedData) throws TokenException {
+    return pkcs11Module_.C_Encrypt(sessionHandle_, data, encryptedData);
+  }
+
+  /**
+   * Encrypts the given region of data with the key and mechanism given to the encryptInit method.
+   * This method finalizes the current encryption operation. Unlike encrypt(byte[]), this method
+   * does not allocate a new array for the result but writes it to the given array starting at the
+   * given offset; i.e. the same arrays can be reused for many calls. If the output array has not
+   * enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * 
+   * @param data
+   *          The array holding the data to encrypt.
+   * @param dataOffset
+   *          The offset of the data to encrypt in data.
+   * @param dataLength
+   *          The length of the data to encrypt.
+   * @param encryptedData
+   *          The array that receives the encrypted data.
+   * @param encryptedDataOffset
+   *          The offset in encryptedData at which to start writing.
+   * @return The number of bytes written to encryptedData.
+   * @exception TokenException
+   *              If encrypting failed.
+   * @preconditions (data <> null) and (encryptedData <> null)
+   * @postconditions (result >= 0)
+   */
+  public int encrypt(byte[] data, int dataOffset, int dataLength, byte[] encryptedData,
+      int encryptedDataOffset) throws TokenException {
+    return pkcs11Module_.C_Encrypt(sessionHandle_, data, dataOffset, dataLength, encryptedData,
+        encryptedDataOffset);
+  }
+
+  /**
+   * Encrypts many pieces of data with an AEAD mechanism, CKM_AES_GCM or CKM_AES_CCM, and the
+   * same key in a single call to the native part, each with an IV (or nonce) and additional
+   * authenticated data of its own. The parameters of the mechanism serve as a template; only the
+   * IV, the AAD and, for CCM, the data length are replaced for each piece of data. A piece that
+   * cannot be encrypted does not stop the batch; check the error codes of the returned result. No
+   * encryption operation remains active after this call.
+   * 
+   * @param mechanism
+   *          The mechanism to use with template parameters; e.g. a CKM_AES_GCM mechanism with
+   *          GcmParameters holding the tag length.
+   * @param key
+   *          The encryption key to use.
+   * @param ivs
+   *          The IV or nonce of each piece of data.
+   * @param aads
+   *          The additional authenticated data of each piece of data, or null to use the one of
+   *          the template parameters.
+   * @param data
+   *          The pieces of data to encrypt.
+   * @return The encrypted pieces of data, each with its tag, and error codes in the order of the
+   *         pieces of data.
+   * @exception TokenException
+   *              If the batch could not be run at all.
+   * @preconditions (mechanism <> null) and (key <> null) and (ivs <> null) and (data <> null)
+   * @postconditions (result <> null) and (result.size() == data.length)
+   */
+  public BatchResult encryptBatchAead(Mechanism mechanism, Key key, byte[][] ivs, byte[][] aads,
+      byte[][] data) throws TokenException {
+    if (data == null) {
+      throw new NullPointerException("Argument \"data\" must not be null.");
+    }
+    if (ivs == null) {
+      throw new NullPointerException("Argument \"ivs\" must not be null.");
+    }
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+    long[] errorCodes = new long[data.length];
+
+    byte[][] results = pkcs11Module_.C_EncryptBatchAead(sessionHandle_, ckMechanism,
+        key.getObjectHandle(), ivs, aads, data, errorCodes, useUtf8Encoding_);
+
+    return new BatchResult(results, errorCodes);
+  }
+
+  /**
+   * Encrypts the given data with the given mechanism and key in a single call to the native part.
+   * This is the same as calling encryptInit and encrypt, but takes one call instead of two. If
+   * either step fails, no encryption operation remains active.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.DES_CBC.
+   * @param key
+   *          The encryption key to use.
+   * @param data
+   *          The data to encrypt.
+   * @return The encrypted data.
+   * @exception TokenException
+   *              If encrypting failed.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] encrypt(Mechanism mechanism, Key key, byte[] data) throws TokenException {
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+
+    return pkcs11Module_.C_EncryptOneShot(sessionHandle_, ckMechanism, key.getObjectHandle(), data,
+        useUtf8Encoding_);
+  }
+
   /**
    * This method can be used to encrypt multiple pieces of data; e.g. buffer-size pieces when
    * reading the data from a stream. Encrypts the given data with the key and mechansim given to the
@@ -681,6 +1045,74 @@ public class Session {
     return pkcs11Module_.C_EncryptUpdate(sessionHandle_, part);
   }
 
+  /**
+   * Encrypts the given region of a piece of data with the key and mechanism given to the
+   * encryptInit method. The application must call encryptFinal to get the final result of the
+   * encryption after feeding in all data using this method. Unlike encryptUpdate(byte[]), this
+   * method does not allocate a new array for the result but writes it to the given array starting
+   * at the given offset; i.e. the same arrays can be reused for many calls. If the output array has
+   * not enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains
+   * active.
+   * 
+   * @param part
+   *          The array holding the piece of data to encrypt.
+   * @param partOffset
+   *          The offset of the piece of data in part.
+   * @param partLength
+   *          The length of the piece of data.
+   * @param encryptedPart
+   *          The array that receives the intermediate encryption result.
+   * @param encryptedPartOffset
+   *          The offset in encryptedPart at which to start writing.
+   * @return The number of bytes written to encryptedPart.
+   * @exception TokenException
+   *              If encrypting the data failed.
+   * @preconditions (part <> null) and (encryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int encryptUpdate(byte[] part, int partOffset, int partLength, byte[] encryptedPart,
+      int encryptedPartOffset) throws TokenException {
+    return pkcs11Module_.C_EncryptUpdate(sessionHandle_, part, partOffset, partLength,
+        encryptedPart, encryptedPartOffset);
+  }
+
+  /**
+   * Feeds several pieces of data to the encryption operation in a single call to the native part,
+   * as if calling encryptUpdate for each piece in turn, but without concatenating them first; e.g.
+   * for a message made of a header, a body and a trailer.
+   * 
+   * @param parts
+   *          The pieces of data to encrypt.
+   * @return The intermediate encryption result of all parts. May be empty. To get the final
+   *         result call encryptFinal.
+   * @exception TokenException
+   *              If encrypting the data failed.
+   * @preconditions (parts <> null)
+   * 
+   */
+  public byte[] encryptUpdate(byte[][] parts) throws TokenException {
+    return pkcs11Module_.C_EncryptUpdate(sessionHandle_, parts);
+  }
+
+  /**
+   * Feeds the remaining data of several direct buffers to the encryption operation in a single call
+   * to the native part, like encryptUpdate(byte[][]). The buffers are handed to the module without
+   * copying their contents to the Java heap. On success, the position of each buffer is set to its
+   * limit.
+   * 
+   * @param parts
+   *          The direct buffers holding the pieces of data to encrypt.
+   * @return The intermediate encryption result of all parts. May be empty. To get the final
+   *         result call encryptFinal.
+   * @exception TokenException
+   *              If encrypting the data failed.
+   * @preconditions (parts <> null) and all buffers are direct
+   * 
+   */
+  public byte[] encryptUpdate(ByteBuffer[] parts) throws TokenException {
+    return pkcs11Module_.C_EncryptUpdate(sessionHandle_, parts);
+  }
+
   /**
    * This method finalizes an encrpytion operation and returns the final result. Use this method, if
    * you fed in the data using encryptUpdate. If you used the encrypt(byte[]) method, you need not
@@ -696,6 +1128,27 @@ public class Session {
     return pkcs11Module_.C_EncryptFinal(sessionHandle_);
   }
 
+  /**
+   * This method finalizes an encryption operation and writes the final result to the given array.
+   * Use this method, if you fed in the data using encryptUpdate. Unlike encryptFinal(), this method
+   * does not allocate a new array for the result but writes it to the given array starting at the
+   * given offset; i.e. the same arrays can be reused for many calls. If the output array has not
+   * enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * 
+   * @param encryptedPart
+   *          The array that receives the final result of the encryption.
+   * @param encryptedPartOffset
+   *          The offset in encryptedPart at which to start writing.
+   * @return The number of bytes written to encryptedPart.
+   * @exception TokenException
+   *              If calculating the final result failed.
+   * @preconditions (encryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int encryptFinal(byte[] encryptedPart, int encryptedPartOffset) throws TokenException {
+    return pkcs11Module_.C_EncryptFinal(sessionHandle_, encryptedPart, encryptedPartOffset);
+  }
+
   /**
    * Initializes a new decryption operation. The application must call this method before calling
    * any other decrypt* operation. Before initializing a new operation, any currently pending
@@ -743,6 +1196,136 @@ public class Session {
     return pkcs11Module_.C_Decrypt(sessionHandle_, data);
   }
 
+  /**
+   * Decrypts the remaining data of the given direct buffer with the key and mechanism given to the
+   * decryptInit method and writes the result to the given direct output buffer. Like
+   * decrypt(byte[]), this method finalizes the current decryption operation. The buffers are handed
+   * to the module without copying their contents to the Java heap. On success, the position of data
+   * is set to its limit and the position of decryptedData is advanced by the number of bytes
+   * written, as for javax.crypto.Cipher.doFinal(ByteBuffer, ByteBuffer). If decryptedData has not
+   * enough space left, the method fails with CKR_BUFFER_TOO_SMALL, the buffers stay unchanged and
+   * the operation can be repeated with a larger output buffer.
+   * 
+   * @param data
+   *          The direct buffer holding the data to decrypt.
+   * @param decryptedData
+   *          The direct buffer that receives the decrypted data.
+   * @return The number of bytes written to decryptedData.
+   * @exception TokenException
+   *              If decrypting failed.
+   * @preconditions (data <> null) and (decryptedData <> null) and data.isDirect() and
+   * decryptedData.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int decrypt(ByteBuffer data, ByteBuffer decryptedData) throws TokenException {
+    return pkcs11Module_.C_Decrypt(sessionHandle_, data, decryptedData);
+  }
+
+  /**
+   * Decrypts the given region of data with the key and mechanism given to the decryptInit method.
+   * This method finalizes the current decryption operation. Unlike decrypt(byte[]), this method
+   * does not allocate a new array for the result but writes it to the given array starting at the
+   * given offset; i.e. the same arrays can be reused for many calls. If the output array has not
+   * enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * 
+   * @param data
+   *          The array holding the data to decrypt.
+   * @param dataOffset
+   *          The offset of the data to decrypt in data.
+   * @param dataLength
+   *          The length of the data to decrypt.
+   * @param decryptedData
+   *          The array that receives the decrypted data.
+   * @param decryptedDataOffset
+   *          The offset in decryptedData at which to start writing.
+   * @return The number of bytes written to decryptedData.
+   * @exception TokenException
+   *              If decrypting failed.
+   * @preconditions (data <> null) and (decryptedData <> null)
+   * @postconditions (result >= 0)
+   */
+  public int decrypt(byte[] data, int dataOffset, int dataLength, byte[] decryptedData,
+      int decryptedDataOffset) throws TokenException {
+    return pkcs11Module_.C_Decrypt(sessionHandle_, data, dataOffset, dataLength, decryptedData,
+        decryptedDataOffset);
+  }
+
+  /**
+   * Decrypts many pieces of data with an AEAD mechanism, CKM_AES_GCM or CKM_AES_CCM, and the
+   * same key in a single call to the native part, each with an IV (or nonce) and additional
+   * authenticated data of its own. The parameters of the mechanism serve as a template; only the
+   * IV, the AAD and, for CCM, the data length are replaced for each piece of data. A piece that
+   * cannot be decrypted does not stop the batch; check the error codes of the returned result. No
+   * decryption operation remains active after this call.
+   * 
+   * @param mechanism
+   *          The mechanism to use with template parameters; e.g. a CKM_AES_GCM mechanism with
+   *          GcmParameters holding the tag length.
+   * @param key
+   *          The decryption key to use.
+   * @param ivs
+   *          The IV or nonce of each piece of data.
+   * @param aads
+   *          The additional authenticated data of each piece of data, or null to use the one of
+   *          the template parameters.
+   * @param encryptedData
+   *          The pieces of encrypted data, each with its tag.
+   * @return The decrypted pieces of data and error codes in the order of the pieces of data.
+   * @exception TokenException
+   *              If the batch could not be run at all.
+   * @preconditions (mechanism <> null) and (key <> null) and (ivs <> null) and
+   *                (encryptedData <> null)
+   * @postconditions (result <> null) and (result.size() == encryptedData.length)
+   */
+  public BatchResult decryptBatchAead(Mechanism mechanism, Key key, byte[][] ivs, byte[][] aads,
+      byte[][] encryptedData) throws TokenException {
+    if (encryptedData == null) {
+      throw new NullPointerException("Argument \"encryptedData\" must not be null.");
+    }
+    if (ivs == null) {
+      throw new NullPointerException("Argument \"ivs\" must not be null.");
+    }
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+    long[] errorCodes = new long[encryptedData.length];
+
+    byte[][] results = pkcs11Module_.C_DecryptBatchAead(sessionHandle_, ckMechanism,
+        key.getObjectHandle(), ivs, aads, encryptedData, errorCodes, useUtf8Encoding_);
+
+    return new BatchResult(results, errorCodes);
+  }
+
+  /**
+   * Decrypts the given data with the given mechanism and key in a single call to the native part.
+   * This is the same as calling decryptInit and decrypt, but takes one call instead of two. If
+   * either step fails, no decryption operation remains active.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.DES_CBC.
+   * @param key
+   *          The decryption key to use.
+   * @param data
+   *          The data to decrypt.
+   * @return The decrypted data.
+   * @exception TokenException
+   *              If decrypting failed.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] decrypt(Mechanism mechanism, Key key, byte[] data) throws TokenException {
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+
+    return pkcs11Module_.C_DecryptOneShot(sessionHandle_, ckMechanism, key.getObjectHandle(), data,
+        useUtf8Encoding_);
+  }
+
   /**
    * This method can be used to decrypt multiple pieces of data; e.g. buffer-size pieces when
    * reading the data from a stream. Decrypts the given data with the key and mechansim given to the
@@ -762,6 +1345,37 @@ public class Session {
     return pkcs11Module_.C_DecryptUpdate(sessionHandle_, encryptedPart);
   }
 
+  /**
+   * Decrypts the given region of a piece of encrypted data with the key and mechanism given to the
+   * decryptInit method. The application must call decryptFinal to get the final result of the
+   * decryption after feeding in all data using this method. Unlike decryptUpdate(byte[]), this
+   * method does not allocate a new array for the result but writes it to the given array starting
+   * at the given offset; i.e. the same arrays can be reused for many calls. If the output array has
+   * not enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains
+   * active.
+   * 
+   * @param encryptedPart
+   *          The array holding the piece of encrypted data to decrypt.
+   * @param encryptedPartOffset
+   *          The offset of the piece of encrypted data in encryptedPart.
+   * @param encryptedPartLength
+   *          The length of the piece of encrypted data.
+   * @param decryptedPart
+   *          The array that receives the intermediate decryption result.
+   * @param decryptedPartOffset
+   *          The offset in decryptedPart at which to start writing.
+   * @return The number of bytes written to decryptedPart.
+   * @exception TokenException
+   *              If decrypting the data failed.
+   * @preconditions (encryptedPart <> null) and (decryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int decryptUpdate(byte[] encryptedPart, int encryptedPartOffset, int encryptedPartLength,
+      byte[] decryptedPart, int decryptedPartOffset) throws TokenException {
+    return pkcs11Module_.C_DecryptUpdate(sessionHandle_, encryptedPart, encryptedPartOffset,
+        encryptedPartLength, decryptedPart, decryptedPartOffset);
+  }
+
   /**
    * This method finalizes a decrpytion operation and returns the final result. Use this method, if
    * you fed in the data using decryptUpdate. If you used the decrypt(byte[]) method, you need not
@@ -777,6 +1391,27 @@ public class Session {
     return pkcs11Module_.C_DecryptFinal(sessionHandle_);
   }
 
+  /**
+   * This method finalizes a decryption operation and writes the final result to the given array.
+   * Use this method, if you fed in the data using decryptUpdate. Unlike decryptFinal(), this method
+   * does not allocate a new array for the result but writes it to the given array starting at the
+   * given offset; i.e. the same arrays can be reused for many calls. If the output array has not
+   * enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * 
+   * @param decryptedPart
+   *          The array that receives the final result of the decryption.
+   * @param decryptedPartOffset
+   *          The offset in decryptedPart at which to start writing.
+   * @return The number of bytes written to decryptedPart.
+   * @exception TokenException
+   *              If calculating the final result failed.
+   * @preconditions (decryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int decryptFinal(byte[] decryptedPart, int decryptedPartOffset) throws TokenException {
+    return pkcs11Module_.C_DecryptFinal(sessionHandle_, decryptedPart, decryptedPartOffset);
+  }
+
   /**
    * Initializes a new digesting operation. The application must call this method before calling any
    * other digest* operation. Before initializing a new operation, any currently pending operation
@@ -820,7 +1455,119 @@ public class Session {
   }
 
   /**
-   * This method can be used to digest multiple pieces of data; e.g. buffer-size pieces when reading
+   * Digests the remaining data of the given direct buffer with the mechanism given to the
+   * digestInit method and writes the result to the given direct output buffer. Like digest(byte[]),
+   * this method finalizes the current digesting operation. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of data is set to its
+   * limit and the position of digest is advanced by the number of bytes written, as for
+   * javax.crypto.Cipher.doFinal(ByteBuffer, ByteBuffer). If digest has not enough space left, the
+   * method fails with CKR_BUFFER_TOO_SMALL, the buffers stay unchanged and the operation can be
+   * repeated with a larger output buffer.
+   * 
+   * @param data
+   *          The direct buffer holding the data to digest.
+   * @param digest
+   *          The direct buffer that receives the message digest.
+   * @return The number of bytes written to digest.
+   * @exception TokenException
+   *              If digesting the data failed.
+   * @preconditions (data <> null) and (digest <> null) and data.isDirect() and digest.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int digest(ByteBuffer data, ByteBuffer digest) throws TokenException {
+    return pkcs11Module_.C_Digest(sessionHandle_, data, digest);
+  }
+
+  /**
+   * Digests the given region of data with the mechanism given to the digestInit method. This method
+   * finalizes the current digesting operation. Unlike digest(byte[]), this method does not allocate
+   * a new array for the result but writes it to the given array starting at the given offset; i.e.
+   * the same arrays can be reused for many calls. If the output array has not enough space left,
+   * the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * 
+   * @param data
+   *          The array holding the data to digest.
+   * @param dataOffset
+   *          The offset of the data to digest in data.
+   * @param dataLength
+   *          The length of the data to digest.
+   * @param digest
+   *          The array that receives the message digest.
+   * @param digestOffset
+   *          The offset in digest at which to start writing.
+   * @return The number of bytes written to digest.
+   * @exception TokenException
+   *              If digesting the data failed.
+   * @preconditions (data <> null) and (digest <> null)
+   * @postconditions (result >= 0)
+   */
+  public int digest(byte[] data, int dataOffset, int dataLength, byte[] digest,
+      int digestOffset) throws TokenException {
+    return pkcs11Module_.C_Digest(sessionHandle_, data, dataOffset, dataLength, digest,
+        digestOffset);
+  }
+
+  /**
+   * Digests many pieces of data with the same mechanism in a single call to the native part. This
+   * is the same as calling digestInit and digest for each piece of data, but much cheaper for many
+   * small pieces. The digests are packed into one array; see BatchResult.getPackedResults. A piece
+   * that cannot be digested does not stop the batch; check the error codes of the returned result.
+   * No digesting operation remains active after this call.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA_1.
+   * @param data
+   *          The pieces of data to digest.
+   * @return The packed digests and error codes in the order of the pieces of data.
+   * @exception TokenException
+   *              If the batch could not be run at all.
+   * @preconditions (mechanism <> null) and (data <> null)
+   * @postconditions (result <> null) and (result.size() == data.length)
+   */
+  public BatchResult digestBatch(Mechanism mechanism, byte[][] data) throws TokenException {
+    if (data == null) {
+      throw new NullPointerException("Argument \"data\" must not be null.");
+    }
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+    long[] errorCodes = new long[data.length];
+
+    byte[] digests = pkcs11Module_.C_DigestBatch(sessionHandle_, ckMechanism, data, errorCodes,
+        useUtf8Encoding_);
+
+    return new BatchResult(digests, errorCodes);
+  }
+
+  /**
+   * Digests the given data with the given mechanism in a single call to the native part. This is
+   * the same as calling digestInit and digest, but takes one call instead of two. If either step
+   * fails, no digesting operation remains active.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA_1.
+   * @param data
+   *          The data to digest.
+   * @return The digested data.
+   * @exception TokenException
+   *              If digesting the data failed.
+   * @preconditions (mechanism <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] digest(Mechanism mechanism, byte[] data) throws TokenException {
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+
+    return pkcs11Module_.C_DigestOneShot(sessionHandle_, ckMechanism, data, useUtf8Encoding_);
+  }
+
+  /**
+   * This method can be used to digest multiple pieces of data; e.g. buffer-size pieces when reading
    * the data from a stream. Digests the given data with the mechansim given to the digestInit
    * method. The application must call digestFinal to get the final result of the digesting after
    * feeding in all data using this method.
@@ -836,6 +1583,60 @@ public class Session {
     pkcs11Module_.C_DigestUpdate(sessionHandle_, part);
   }
 
+  /**
+   * Digests the given region of a piece of data with the mechanism given to the digestInit
+   * method. Unlike digestUpdate(byte[]), this method takes the piece of data
+   * from the given region of the array; i.e. parts of a larger buffer can be fed without copying
+   * them into arrays of their own.
+   * 
+   * @param part
+   *          The array holding the piece of data to digest.
+   * @param partOffset
+   *          The offset of the piece of data in part.
+   * @param partLength
+   *          The length of the piece of data.
+   * @exception TokenException
+   *              If digesting the data failed.
+   * @preconditions (part <> null)
+   * 
+   */
+  public void digestUpdate(byte[] part, int partOffset, int partLength) throws TokenException {
+    pkcs11Module_.C_DigestUpdate(sessionHandle_, part, partOffset, partLength);
+  }
+
+  /**
+   * Feeds several pieces of data to the digesting operation in a single call to the native part, as
+   * if calling digestUpdate for each piece in turn, but without concatenating them first; e.g. for
+   * a message made of a header, a body and a trailer.
+   * 
+   * @param parts
+   *          The pieces of data to digest.
+   * @exception TokenException
+   *              If digesting the data failed.
+   * @preconditions (parts <> null)
+   * 
+   */
+  public void digestUpdate(byte[][] parts) throws TokenException {
+    pkcs11Module_.C_DigestUpdate(sessionHandle_, parts);
+  }
+
+  /**
+   * Feeds the remaining data of several direct buffers to the digesting operation in a single call
+   * to the native part, like digestUpdate(byte[][]). The buffers are handed to the module without
+   * copying their contents to the Java heap. On success, the position of each buffer is set to its
+   * limit.
+   * 
+   * @param parts
+   *          The direct buffers holding the pieces of data to digest.
+   * @exception TokenException
+   *              If digesting the data failed.
+   * @preconditions (parts <> null) and all buffers are direct
+   * 
+   */
+  public void digestUpdate(ByteBuffer[] parts) throws TokenException {
+    pkcs11Module_.C_DigestUpdate(sessionHandle_, parts);
+  }
+
   /**
    * This method is similar to digestUpdate and can be combined with it during one digesting
    * operation. This method digests the value of the given secret key.
@@ -914,6 +1715,160 @@ public class Session {
     return pkcs11Module_.C_Sign(sessionHandle_, data);
   }
 
+  /**
+   * Signs the remaining data of the given direct buffer with the key and mechanism given to the
+   * signInit method and writes the result to the given direct output buffer. Like sign(byte[]),
+   * this method finalizes the current signing operation. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of data is set to its
+   * limit and the position of signature is advanced by the number of bytes written, as for
+   * javax.crypto.Cipher.doFinal(ByteBuffer, ByteBuffer). If signature has not enough space left,
+   * the method fails with CKR_BUFFER_TOO_SMALL, the buffers stay unchanged and the operation can be
+   * repeated with a larger output buffer.
+   * 
+   * @param data
+   *          The direct buffer holding the data to sign.
+   * @param signature
+   *          The direct buffer that receives the signature.
+   * @return The number of bytes written to signature.
+   * @exception TokenException
+   *              If signing the data failed.
+   * @preconditions (data <> null) and (signature <> null) and data.isDirect() and
+   * signature.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int sign(ByteBuffer data, ByteBuffer signature) throws TokenException {
+    return pkcs11Module_.C_Sign(sessionHandle_, data, signature);
+  }
+
+  /**
+   * Signs the given region of data with the key and mechanism given to the signInit method. This
+   * method finalizes the current signing operation. Unlike sign(byte[]), this method does not
+   * allocate a new array for the result but writes it to the given array starting at the given
+   * offset; i.e. the same arrays can be reused for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * 
+   * @param data
+   *          The array holding the data to sign.
+   * @param dataOffset
+   *          The offset of the data to sign in data.
+   * @param dataLength
+   *          The length of the data to sign.
+   * @param signature
+   *          The array that receives the signature.
+   * @param signatureOffset
+   *          The offset in signature at which to start writing.
+   * @return The number of bytes written to signature.
+   * @exception TokenException
+   *              If signing the data failed.
+   * @preconditions (data <> null) and (signature <> null)
+   * @postconditions (result >= 0)
+   */
+  public int sign(byte[] data, int dataOffset, int dataLength, byte[] signature,
+      int signatureOffset) throws TokenException {
+    return pkcs11Module_.C_Sign(sessionHandle_, data, dataOffset, dataLength, signature,
+        signatureOffset);
+  }
+
+  /**
+   * Signs many pieces of data with the same mechanism and key in a single call to the native
+   * part. This is the same as calling signInit and sign for each piece of data, but much cheaper
+   * for many small pieces. A piece that cannot be signed does not stop the batch; check the error
+   * codes of the returned result. No signing operation remains active after this call.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA1_RSA_PKCS.
+   * @param key
+   *          The signing key to use.
+   * @param data
+   *          The pieces of data to sign.
+   * @return The signatures and error codes in the order of the pieces of data.
+   * @exception TokenException
+   *              If the batch could not be run at all.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null) and (result.size() == data.length)
+   */
+  public BatchResult signBatch(Mechanism mechanism, Key key, byte[][] data)
+      throws TokenException {
+    if (data == null) {
+      throw new NullPointerException("Argument \"data\" must not be null.");
+    }
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+    long[] errorCodes = new long[data.length];
+
+    byte[][] signatures = pkcs11Module_.C_SignBatch(sessionHandle_, ckMechanism,
+        key.getObjectHandle(), data, errorCodes, useUtf8Encoding_);
+
+    return new BatchResult(signatures, errorCodes);
+  }
+
+  /**
+   * Computes MACs of many pieces of data with the same mechanism and key in a single call to the
+   * native part. This works like signBatch, but packs the results into one array; see
+   * BatchResult.getPackedResults. Use it for MACs, like HMAC, and other signatures of a fixed
+   * length. No signing operation remains active after this call.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA_1_HMAC.
+   * @param key
+   *          The MAC key to use.
+   * @param data
+   *          The pieces of data to compute the MACs of.
+   * @return The packed MACs and error codes in the order of the pieces of data.
+   * @exception TokenException
+   *              If the batch could not be run at all.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null) and (result.size() == data.length)
+   */
+  public BatchResult macBatch(Mechanism mechanism, Key key, byte[][] data)
+      throws TokenException {
+    if (data == null) {
+      throw new NullPointerException("Argument \"data\" must not be null.");
+    }
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+    long[] errorCodes = new long[data.length];
+
+    byte[] macs = pkcs11Module_.C_SignBatchPacked(sessionHandle_, ckMechanism,
+        key.getObjectHandle(), data, errorCodes, useUtf8Encoding_);
+
+    return new BatchResult(macs, errorCodes);
+  }
+
+  /**
+   * Signs the given data with the given mechanism and key in a single call to the native part.
+   * This is the same as calling signInit and sign, but takes one call instead of two. If either
+   * step fails, no signing operation remains active.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA1_RSA_PKCS.
+   * @param key
+   *          The signing key to use.
+   * @param data
+   *          The data to sign.
+   * @return The signature.
+   * @exception TokenException
+   *              If signing the data failed.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] sign(Mechanism mechanism, Key key, byte[] data) throws TokenException {
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+
+    return pkcs11Module_.C_SignOneShot(sessionHandle_, ckMechanism, key.getObjectHandle(), data,
+        useUtf8Encoding_);
+  }
+
   /**
    * This method can be used to sign multiple pieces of data; e.g. buffer-size pieces when reading
    * the data from a stream. Signs the given data with the mechansim given to the signInit method.
@@ -931,6 +1886,60 @@ public class Session {
     pkcs11Module_.C_SignUpdate(sessionHandle_, part);
   }
 
+  /**
+   * Signs the given region of a piece of data with the key and mechanism given to the signInit
+   * method. Unlike signUpdate(byte[]), this method takes the piece of data
+   * from the given region of the array; i.e. parts of a larger buffer can be fed without copying
+   * them into arrays of their own.
+   * 
+   * @param part
+   *          The array holding the piece of data to sign.
+   * @param partOffset
+   *          The offset of the piece of data in part.
+   * @param partLength
+   *          The length of the piece of data.
+   * @exception TokenException
+   *              If signing the data failed.
+   * @preconditions (part <> null)
+   * 
+   */
+  public void signUpdate(byte[] part, int partOffset, int partLength) throws TokenException {
+    pkcs11Module_.C_SignUpdate(sessionHandle_, part, partOffset, partLength);
+  }
+
+  /**
+   * Feeds several pieces of data to the signing operation in a single call to the native part, as
+   * if calling signUpdate for each piece in turn, but without concatenating them first; e.g. for a
+   * message made of a header, a body and a trailer.
+   * 
+   * @param parts
+   *          The pieces of data to sign.
+   * @exception TokenException
+   *              If signing the data failed.
+   * @preconditions (parts <> null)
+   * 
+   */
+  public void signUpdate(byte[][] parts) throws TokenException {
+    pkcs11Module_.C_SignUpdate(sessionHandle_, parts);
+  }
+
+  /**
+   * Feeds the remaining data of several direct buffers to the signing operation in a single call to
+   * the native part, like signUpdate(byte[][]). The buffers are handed to the module without
+   * copying their contents to the Java heap. On success, the position of each buffer is set to its
+   * limit.
+   * 
+   * @param parts
+   *          The direct buffers holding the pieces of data to sign.
+   * @exception TokenException
+   *              If signing the data failed.
+   * @preconditions (parts <> null) and all buffers are direct
+   * 
+   */
+  public void signUpdate(ByteBuffer[] parts) throws TokenException {
+    pkcs11Module_.C_SignUpdate(sessionHandle_, parts);
+  }
+
   /**
    * This method finalizes a signing operation and returns the final result. Use this method, if you
    * fed in the data using signUpdate. If you used the sign(byte[]) method, you need not (and shall
@@ -1043,6 +2052,141 @@ public class Session {
     pkcs11Module_.C_Verify(sessionHandle_, data, signature);
   }
 
+  /**
+   * Verifies the signature held in the given region of an array against the data held in the given
+   * region of another (or the same) array with the key and mechanism given to the verifyInit
+   * method. Like verify(byte[], byte[]), this method finalizes the current verification operation
+   * and throws an exception, if the verification of the signature fails. Neither the data nor the
+   * signature needs to be copied into an array of its own.
+   * 
+   * @param data
+   *          The array holding the data that was signed.
+   * @param dataOffset
+   *          The offset of the data in data.
+   * @param dataLength
+   *          The length of the data.
+   * @param signature
+   *          The array holding the signature or MAC to verify.
+   * @param signatureOffset
+   *          The offset of the signature in signature.
+   * @param signatureLength
+   *          The length of the signature.
+   * @exception TokenException
+   *              If verifying the signature fails. This is also the case, if the signature is
+   *              forged.
+   * @preconditions (data <> null) and (signature <> null)
+   * 
+   */
+  public void verify(byte[] data, int dataOffset, int dataLength, byte[] signature,
+      int signatureOffset, int signatureLength) throws TokenException {
+    pkcs11Module_.C_Verify(sessionHandle_, data, dataOffset, dataLength, signature,
+        signatureOffset, signatureLength);
+  }
+
+  /**
+   * Verifies the signature held in the given direct buffer against the remaining data of the other
+   * given direct buffer with the key and mechanism given to the verifyInit method. Like
+   * verify(byte[], byte[]), this method finalizes the current verification operation and throws an
+   * exception, if the verification of the signature fails. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the positions of both buffers are
+   * set to their limits.
+   * 
+   * @param data
+   *          The direct buffer holding the data that was signed.
+   * @param signature
+   *          The direct buffer holding the signature or MAC to verify.
+   * @exception TokenException
+   *              If verifying the signature fails. This is also the case, if the signature is
+   *              forged.
+   * @preconditions (data <> null) and (signature <> null) and data.isDirect() and
+   * signature.isDirect()
+   * 
+   */
+  public void verify(ByteBuffer data, ByteBuffer signature) throws TokenException {
+    pkcs11Module_.C_Verify(sessionHandle_, data, signature);
+  }
+
+  /**
+   * Verifies many signatures with the same mechanism and key in a single call to the native part.
+   * This is the same as calling verifyInit and verify for each pair of data and signature, but an
+   * invalid signature does not throw an exception. Instead, the result for this pair is false. No
+   * verification operation remains active after this call.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA1_RSA_PKCS.
+   * @param key
+   *          The verification key to use.
+   * @param data
+   *          The pieces of data that were signed.
+   * @param signatures
+   *          The signatures or MACs to verify, one for each piece of data.
+   * @return For each pair in the order of the data, true, if the signature is valid, and false, if
+   *         the module rejected the signature or the data.
+   * @exception TokenException
+   *              If verifying failed for another reason; e.g. an invalid key handle.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null)
+   *                and (signatures <> null) and (data.length == signatures.length)
+   * @postconditions (result <> null) and (result.length == data.length)
+   */
+  public boolean[] verifyBatch(Mechanism mechanism, Key key, byte[][] data, byte[][] signatures)
+      throws TokenException {
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+
+    long[] errorCodes = pkcs11Module_.C_VerifyBatch(sessionHandle_, ckMechanism,
+        key.getObjectHandle(), data, signatures, useUtf8Encoding_);
+
+    boolean[] results = new boolean[errorCodes.length];
+    for (int i = 0; i < errorCodes.length; i++) {
+      long errorCode = errorCodes[i];
+      if (errorCode == PKCS11Constants.CKR_OK) {
+        results[i] = true;
+      } else if ((errorCode != PKCS11Constants.CKR_SIGNATURE_INVALID)
+          && (errorCode != PKCS11Constants.CKR_SIGNATURE_LEN_RANGE)
+          && (errorCode != PKCS11Constants.CKR_DATA_INVALID)
+          && (errorCode != PKCS11Constants.CKR_DATA_LEN_RANGE)) {
+        throw new PKCS11Exception(errorCode);
+      }
+    }
+
+    return results;
+  }
+
+  /**
+   * Verifies the given signature against the given data with the given mechanism and key in a
+   * single call to the native part. This is the same as calling verifyInit and verify, but takes
+   * one call instead of two. If either step fails, no verification operation remains active.
+   * 
+   * @param mechanism
+   *          The mechanism to use; e.g. Mechanism.SHA1_RSA_PKCS.
+   * @param key
+   *          The verification key to use.
+   * @param data
+   *          The data that was signed.
+   * @param signature
+   *          The signature or MAC to verify.
+   * @exception TokenException
+   *              If verifying the signature fails. This is also the case, if the signature is
+   *              forged.
+   * @preconditions (mechanism <> null) and (key <> null) and (data <> null) and
+   *                (signature <> null)
+   * 
+   */
+  public void verify(Mechanism mechanism, Key key, byte[] data, byte[] signature)
+      throws TokenException {
+    CK_MECHANISM ckMechanism = new CK_MECHANISM();
+    ckMechanism.mechanism = mechanism.getMechanismCode();
+    Parameters parameters = mechanism.getParameters();
+    ckMechanism.pParameter = (parameters != null) ? parameters.getPKCS11ParamsObject()
+        : null;
+
+    pkcs11Module_.C_VerifyOneShot(sessionHandle_, ckMechanism, key.getObjectHandle(), data,
+        signature, useUtf8Encoding_);
+  }
+
   /**
    * This method can be used to verify a signature with multiple pieces of data; e.g. buffer-size
    * pieces when reading the data from a stream. To verify the signature or MAC call verifyFinal
@@ -1059,6 +2203,60 @@ public class Session {
     pkcs11Module_.C_VerifyUpdate(sessionHandle_, part);
   }
 
+  /**
+   * Feeds the given region of a piece of data to the verification operation started with
+   * verifyInit. Unlike verifyUpdate(byte[]), this method takes the piece of data
+   * from the given region of the array; i.e. parts of a larger buffer can be fed without copying
+   * them into arrays of their own.
+   * 
+   * @param part
+   *          The array holding the piece of data to verify against.
+   * @param partOffset
+   *          The offset of the piece of data in part.
+   * @param partLength
+   *          The length of the piece of data.
+   * @exception TokenException
+   *              If verifying the data failed.
+   * @preconditions (part <> null)
+   * 
+   */
+  public void verifyUpdate(byte[] part, int partOffset, int partLength) throws TokenException {
+    pkcs11Module_.C_VerifyUpdate(sessionHandle_, part, partOffset, partLength);
+  }
+
+  /**
+   * Feeds several pieces of data to the verification operation in a single call to the native part,
+   * as if calling verifyUpdate for each piece in turn, but without concatenating them first; e.g.
+   * for a message made of a header, a body and a trailer.
+   * 
+   * @param parts
+   *          The pieces of data that were signed.
+   * @exception TokenException
+   *              If verifying the data failed.
+   * @preconditions (parts <> null)
+   * 
+   */
+  public void verifyUpdate(byte[][] parts) throws TokenException {
+    pkcs11Module_.C_VerifyUpdate(sessionHandle_, parts);
+  }
+
+  /**
+   * Feeds the remaining data of several direct buffers to the verification operation in a single
+   * call to the native part, like verifyUpdate(byte[][]). The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of each buffer is set
+   * to its limit.
+   * 
+   * @param parts
+   *          The direct buffers holding the pieces of data that were signed.
+   * @exception TokenException
+   *              If verifying the data failed.
+   * @preconditions (parts <> null) and all buffers are direct
+   * 
+   */
+  public void verifyUpdate(ByteBuffer[] parts) throws TokenException {
+    pkcs11Module_.C_VerifyUpdate(sessionHandle_, parts);
+  }
+
   /**
    * This method finalizes a verification operation. Use this method, if you fed in the data using
    * verifyUpdate. If you used the verify(byte[]) method, you need not (and shall not) call this
@@ -1221,6 +2419,7 @@ public class Session {
 
     long objectHandle = pkcs11Module_.C_GenerateKey(sessionHandle_, ckMechanism,
         ckAttributes, useUtf8Encoding_);
+    invalidateCachedAttributes(objectHandle);
 
     return Object.getInstance(this, objectHandle);
   }
@@ -1255,6 +2454,8 @@ public class Session {
 
     long[] objectHandles = pkcs11Module_.C_GenerateKeyPair(sessionHandle_, ckMechanism,
         ckPublicKeyAttributes, ckPrivateKeyAttributes, useUtf8Encoding_);
+    invalidateCachedAttributes(objectHandles[0]);
+    invalidateCachedAttributes(objectHandles[1]);
 
     PublicKey publicKey = (PublicKey) Object.getInstance(this, objectHandles[0]);
     PrivateKey privateKey = (PrivateKey) Object.getInstance(this, objectHandles[1]);
@@ -1319,6 +2520,7 @@ public class Session {
 
     long objectHandle = pkcs11Module_.C_UnwrapKey(sessionHandle_, ckMechanism,
         unwrappingKey.getObjectHandle(), wrappedKey, ckAttributes, useUtf8Encoding_);
+    invalidateCachedAttributes(objectHandle);
 
     return (Key) Object.getInstance(this, objectHandle);
   }
@@ -1355,6 +2557,7 @@ public class Session {
 
     long objectHandle = pkcs11Module_.C_DeriveKey(sessionHandle_, ckMechanism,
         baseKey.getObjectHandle(), ckAttributes, useUtf8Encoding_);
+    invalidateCachedAttributes(objectHandle);
 
     /*
      * for certain mechanisms we must copy back the returned values the the parameters object of the
@@ -0,0 +1,736 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+package iaik.pkcs.pkcs11;
+
+import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
+import iaik.pkcs.pkcs11.wrapper.PKCS11Exception;
+
+import java.util.Arrays;
+import java.util.Hashtable;
+import java.util.Vector;
+
+/**
+ * A pool of open sessions of a token, which threads borrow for a sequence of operations and return
+ * afterwards. A Session object must not be used by several threads at the same time; and opening
+ * and logging in a session takes considerable time on many tokens. The pool opens sessions as
+ * needed up to a maximum, which never exceeds the maximum session count of the token, and keeps
+ * them open. If the pool has a PIN, it logs in each new session. Example:
+ * <code>
+ *   SessionPool pool = token.createSessionPool(2, 16, Token.SessionReadWriteBehavior.RO_SESSION,
+ *       Session.UserType.USER, pin);
+ *   Session session = pool.borrowSession();
+ *   try {
+ *     session.signInit(mechanism, key);
+ *     signature = session.sign(data);
+ *   } finally {
+ *     pool.returnSession(session);
+ *   }
+ * </code>
+ * <p>
+ * Each thread gets the session that it used last, if that is free; this needs no lock on the pool
+ * and keeps the state of a thread on the same session. A session that has been idle for the health
+ * check interval is checked with C_GetSessionInfo before it is handed out; if the pool has a PIN
+ * and the session is not logged in anymore, e.g. after a logout in another session, it is logged
+ * in again. A session that the module reports as closed (CKR_SESSION_CLOSED or
+ * CKR_SESSION_HANDLE_INVALID), e.g. after the token was removed and inserted again, is replaced
+ * by a new one. The same happens, if the application returns a session with such an error; see
+ * returnSession(Session, Exception).
+ * 
+ * @author Karl Scheibelhofer
+ * @version 1.0
+ * @invariants (token_ <> null) and (entries_ <> null) and (0 <= minSize_ <= maxSize_)
+ */
+public class SessionPool {
+
+  /**
+   * A session of the pool and its state.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (session_ <> null)
+   */
+  protected static class Entry {
+
+    /**
+     * The pooled session.
+     */
+    protected Session session_;
+
+    /**
+     * True, if a thread has borrowed the session. Guarded by the monitor of this entry.
+     */
+    protected boolean borrowed_;
+
+    /**
+     * True, if the session has been removed from the pool. Guarded by the monitor of this entry.
+     */
+    protected boolean retired_;
+
+    /**
+     * The time of the last return or health check of the session in milliseconds.
+     */
+    protected long lastUsed_;
+
+    /**
+     * Constructor taking the session.
+     * 
+     * @param session
+     *          The pooled session.
+     */
+    protected Entry(Session session) {
+      session_ = session;
+      lastUsed_ = System.currentTimeMillis();
+    }
+
+  }
+
+  /**
+   * The default time in milliseconds that a session may be idle before it is checked.
+   */
+  public static final long DEFAULT_HEALTH_CHECK_INTERVAL = 10000L;
+
+  /**
+   * The maximum time in milliseconds that a waiting thread sleeps before it looks for a free
+   * session again.
+   */
+  protected static final long WAIT_SLICE = 50L;
+
+  /**
+   * The token of the sessions.
+   */
+  protected Token token_;
+
+  /**
+   * The number of sessions that the pool opens in advance and keeps open.
+   */
+  protected int minSize_;
+
+  /**
+   * The maximum number of sessions of the pool.
+   */
+  protected int maxSize_;
+
+  /**
+   * True, if the pool opens read-write sessions.
+   */
+  protected boolean rwSession_;
+
+  /**
+   * The type of user to log in; see Session.UserType.
+   */
+  protected boolean userType_;
+
+  /**
+   * The PIN to log in new sessions with, or null if the pool does not log in.
+   */
+  protected char[] pin_;
+
+  /**
+   * The entries of all sessions of the pool. Guarded by the monitor of the pool.
+   */
+  protected Vector entries_ = new Vector();
+
+  /**
+   * The entries by their sessions. Guarded by the monitor of the pool for writing.
+   */
+  protected Hashtable entriesBySession_ = new Hashtable();
+
+  /**
+   * The entry of the session that the current thread has borrowed last.
+   */
+  protected ThreadLocal affinity_ = new ThreadLocal();
+
+  /**
+   * The time in milliseconds that a session may be idle before it is checked.
+   */
+  protected long healthCheckInterval_ = DEFAULT_HEALTH_CHECK_INTERVAL;
+
+  /**
+   * The number of sessions that threads are opening for the pool right now. Guarded by the monitor
+   * of the pool.
+   */
+  protected int opening_;
+
+  /**
+   * The number of threads waiting for a free session.
+   */
+  protected volatile int waiters_;
+
+  /**
+   * True, if the pool has been closed.
+   */
+  protected volatile boolean closed_;
+
+  /**
+   * Constructor taking the token and the properties of the pool. It opens minSize sessions
+   * immediately.
+   * 
+   * @param token
+   *          The token of the sessions.
+   * @param minSize
+   *          The number of sessions to open in advance and to keep open.
+   * @param maxSize
+   *          The maximum number of sessions. If the token allows less sessions, the pool uses the
+   *          maximum of the token.
+   * @param rwSession
+   *          Token.SessionReadWriteBehavior.RW_SESSION for read-write sessions, or
+   *          Token.SessionReadWriteBehavior.RO_SESSION for read-only sessions.
+   * @param userType
+   *          Session.UserType.USER or Session.UserType.SO.
+   * @param pin
+   *          The PIN to log in each session, or null to leave the sessions as they are opened.
+   * @exception TokenException
+   *              If opening or logging in a session fails.
+   * @preconditions (token <> null) and (0 <= minSize <= maxSize) and (maxSize > 0)
+   */
+  protected SessionPool(Token token, int minSize, int maxSize, boolean rwSession,
+      boolean userType, char[] pin) throws TokenException {
+    if (token == null) {
+      throw new NullPointerException("Argument \"token\" must not be null.");
+    }
+    if ((minSize < 0) || (maxSize <= 0) || (minSize > maxSize)) {
+      throw new IllegalArgumentException(
+          "The sizes must not be negative, and the minimum must not exceed the maximum.");
+    }
+    token_ = token;
+    rwSession_ = rwSession;
+    userType_ = userType;
+    pin_ = (pin != null) ? (char[]) pin.clone() : null;
+
+    TokenInfo tokenInfo = token.getTokenInfo();
+    long tokenMaxSize = rwSession ? tokenInfo.getMaxRwSessionCount() : tokenInfo
+        .getMaxSessionCount();
+    if ((tokenMaxSize != TokenInfo.EFFECTIVELY_INFINITE)
+        && (tokenMaxSize != TokenInfo.UNAVAILABLE_INFORMATION) && (tokenMaxSize < maxSize)) {
+      maxSize = (int) tokenMaxSize;
+    }
+    maxSize_ = maxSize;
+    minSize_ = Math.min(minSize, maxSize);
+
+    try {
+      synchronized (this) {
+        while (entries_.size() < minSize_) {
+          addEntry(openSession());
+        }
+      }
+    } catch (TokenException ex) {
+      close();
+      throw ex;
+    }
+  }
+
+  /**
+   * Borrow a session, waiting as long as it takes for one to become free.
+   * 
+   * @return The session, which the current thread may use until it returns it.
+   * @exception TokenException
+   *              If opening a new session fails, or if the pool is closed.
+   * @postconditions (result <> null)
+   */
+  public Session borrowSession() throws TokenException {
+    return borrowSession(0L);
+  }
+
+  /**
+   * Borrow a session. If all sessions are borrowed and the pool has its maximum size, the current
+   * thread waits until one is returned or the timeout expires.
+   * 
+   * @param timeout
+   *          The maximum time to wait in milliseconds, or 0 to wait as long as it takes.
+   * @return The session, which the current thread may use until it returns it.
+   * @exception TokenException
+   *              If no session became free in time, if opening a new session fails, or if the pool
+   *              is closed.
+   * @postconditions (result <> null)
+   */
+  public Session borrowSession(long timeout) throws TokenException {
+    // fast path: the session that this thread used last, which needs no lock on the pool
+    Entry entry = (Entry) affinity_.get();
+    if ((entry == null) || !claim(entry)) {
+      entry = claimAny(timeout);
+      affinity_.set(entry);
+    }
+    if (System.currentTimeMillis() - entry.lastUsed_ >= healthCheckInterval_) {
+      entry = checkHealth(entry);
+    }
+
+    return entry.session_;
+  }
+
+  /**
+   * Return a session that the current thread has borrowed from this pool. The session must not be
+   * used afterwards. Any operation of the session must be finished.
+   * 
+   * @param session
+   *          The borrowed session.
+   * @preconditions (session <> null)
+   */
+  public void returnSession(Session session) {
+    returnSession(session, null);
+  }
+
+  /**
+   * Return a session that the current thread has borrowed from this pool, together with the last
+   * error that occurred with it. If the error says that the session is closed, the pool drops the
+   * session and opens a new one when needed.
+   * 
+   * @param session
+   *          The borrowed session.
+   * @param lastError
+   *          The last error that occurred with the session, or null.
+   * @preconditions (session <> null)
+   */
+  public void returnSession(Session session, Exception lastError) {
+    if (session == null) {
+      throw new NullPointerException("Argument \"session\" must not be null.");
+    }
+    Entry entry = (Entry) affinity_.get();
+    if ((entry == null) || (entry.session_ != session)) {
+      entry = (Entry) entriesBySession_.get(session);
+    }
+    if ((entry == null) || (entry.session_ != session)) {
+      throw new IllegalArgumentException("The session does not belong to this pool.");
+    }
+
+    if (closed_ || isSessionLost(lastError)) {
+      retire(entry);
+    } else {
+      entry.lastUsed_ = System.currentTimeMillis();
+      synchronized (entry) {
+        entry.borrowed_ = false;
+      }
+    }
+    if (waiters_ > 0) {
+      synchronized (this) {
+        notifyAll();
+      }
+    }
+  }
+
+  /**
+   * Check all sessions that are not borrowed with C_GetSessionInfo and replace those which are
+   * closed. Afterwards, the pool has at least its minimum size again. Applications may call this
+   * regularly, e.g. from a timer.
+   * 
+   * @exception TokenException
+   *              If checking a session fails for another reason than the session being closed, or
+   *              if opening a new session fails.
+   */
+  public void checkIdleSessions() throws TokenException {
+    Entry[] entries;
+    synchronized (this) {
+      entries = new Entry[entries_.size()];
+      entries_.copyInto(entries);
+    }
+    for (int i = 0; i < entries.length; i++) {
+      if (claim(entries[i])) {
+        release(checkHealth(entries[i]));
+      }
+    }
+    while (true) {
+      synchronized (this) {
+        int size = entries_.size() + opening_;
+        if (closed_ || (size >= minSize_) || (size >= maxSize_)) {
+          break;
+        }
+        opening_++;
+      }
+      // like claimAny, open and log in without holding the monitor of the pool
+      release(openEntry());
+    }
+  }
+
+  /**
+   * Close all sessions and the pool. Sessions that are borrowed are closed when they are returned.
+   * Afterwards, borrowing fails.
+   */
+  public void close() {
+    Entry[] entries;
+    synchronized (this) {
+      closed_ = true;
+      entries = new Entry[entries_.size()];
+      entries_.copyInto(entries);
+      notifyAll();
+    }
+    for (int i = 0; i < entries.length; i++) {
+      if (claim(entries[i])) {
+        retire(entries[i]);
+      }
+    }
+    if (pin_ != null) {
+      Arrays.fill(pin_, '\0');
+    }
+  }
+
+  /**
+   * Set the time that a session may be idle before it is checked when it is borrowed. The default
+   * is DEFAULT_HEALTH_CHECK_INTERVAL.
+   * 
+   * @param healthCheckInterval
+   *          The time in milliseconds. 0 checks the session on each borrow.
+   */
+  public void setHealthCheckInterval(long healthCheckInterval) {
+    healthCheckInterval_ = healthCheckInterval;
+  }
+
+  /**
+   * Get the time that a session may be idle before it is checked when it is borrowed.
+   * 
+   * @return The time in milliseconds.
+   */
+  public long getHealthCheckInterval() {
+    return healthCheckInterval_;
+  }
+
+  /**
+   * Get the number of open sessions of this pool, borrowed or not.
+   * 
+   * @return The number of sessions.
+   * @postconditions (result >= 0)
+   */
+  public synchronized int getSize() {
+    return entries_.size();
+  }
+
+  /**
+   * Get the number of sessions that the pool keeps open.
+   * 
+   * @return The minimum size.
+   * @postconditions (result >= 0)
+   */
+  public int getMinSize() {
+    return minSize_;
+  }
+
+  /**
+   * Get the maximum number of sessions of this pool. This may be less than requested, if the
+   * token allows less sessions.
+   * 
+   * @return The maximum size.
+   * @postconditions (result > 0)
+   */
+  public int getMaxSize() {
+    return maxSize_;
+  }
+
+  /**
+   * Get the token of the sessions of this pool.
+   * 
+   * @return The token.
+   * @postconditions (result <> null)
+   */
+  public Token getToken() {
+    return token_;
+  }
+
+  /**
+   * Check, if the given exception says that a session is closed; i.e. if it is a PKCS11Exception
+   * with the error code CKR_SESSION_CLOSED or CKR_SESSION_HANDLE_INVALID.
+   * 
+   * @param exception
+   *          The exception to check. May be null.
+   * @return True, if the session is closed. False, otherwise.
+   */
+  public static boolean isSessionLost(Exception exception) {
+    if (!(exception instanceof PKCS11Exception)) {
+      return false;
+    }
+    long errorCode = ((PKCS11Exception) exception).getErrorCode();
+
+    return (errorCode == PKCS11Constants.CKR_SESSION_CLOSED)
+        || (errorCode == PKCS11Constants.CKR_SESSION_HANDLE_INVALID);
+  }
+
+  /**
+   * Claim the given entry for the current thread, if it is neither borrowed nor retired.
+   * 
+   * @param entry
+   *          The entry to claim.
+   * @return True, if the entry has been claimed. False, otherwise.
+   */
+  protected boolean claim(Entry entry) {
+    synchronized (entry) {
+      if (entry.borrowed_ || entry.retired_) {
+        return false;
+      }
+      entry.borrowed_ = true;
+
+      return true;
+    }
+  }
+
+  /**
+   * Release the given claimed entry.
+   * 
+   * @param entry
+   *          The entry to release.
+   */
+  protected void release(Entry entry) {
+    synchronized (entry) {
+      entry.borrowed_ = false;
+    }
+  }
+
+  /**
+   * Claim any free entry, open a new session if the pool is not at its maximum size, or wait for
+   * a session to be returned.
+   * 
+   * @param timeout
+   *          The maximum time to wait in milliseconds, or 0 to wait as long as it takes.
+   * @return The claimed entry.
+   * @exception TokenException
+   *              If no session became free in time, if opening a new session fails, or if the pool
+   *              is closed.
+   */
+  protected Entry claimAny(long timeout) throws TokenException {
+    long deadline = (timeout > 0) ? System.currentTimeMillis() + timeout : Long.MAX_VALUE;
+    synchronized (this) {
+      while (true) {
+        if (closed_) {
+          throw new TokenException("The session pool is closed.");
+        }
+        for (int i = 0; i < entries_.size(); i++) {
+          Entry entry = (Entry) entries_.elementAt(i);
+          if (claim(entry)) {
+            return entry;
+          }
+        }
+        if (entries_.size() + opening_ < maxSize_) {
+          opening_++;
+          break;
+        }
+
+        long remaining = deadline - System.currentTimeMillis();
+        if (remaining <= 0) {
+          throw new TokenException("No session of the pool became free in time.");
+        }
+        waiters_++;
+        try {
+          // returning threads notify only if they see a waiter, so do not rely on the notification
+          wait(Math.min(remaining, WAIT_SLICE));
+        } catch (InterruptedException ex) {
+          Thread.currentThread().interrupt();
+          throw new TokenException("Interrupted while waiting for a session of the pool.", ex);
+        } finally {
+          waiters_--;
+        }
+      }
+    }
+
+    // opening and logging in may take long; other threads may use the pool meanwhile
+    return openEntry();
+  }
+
+  /**
+   * Check the session of the given claimed entry with C_GetSessionInfo. If the session is closed,
+   * it is replaced by a new session. If the pool has a PIN and the session is in a public state,
+   * it is logged in again.
+   * 
+   * @param entry
+   *          The claimed entry to check.
+   * @return The given entry, or the claimed entry of the new session.
+   * @exception TokenException
+   *              If checking the session fails for another reason than the session being closed,
+   *              or if logging in or opening a new session fails. The entry is released in this
+   *              case.
+   */
+  protected Entry checkHealth(Entry entry) throws TokenException {
+    try {
+      State state = entry.session_.getSessionInfo().getState();
+      if ((pin_ != null)
+          && (State.RO_PUBLIC_SESSION.equals(state) || State.RW_PUBLIC_SESSION.equals(state))) {
+        // the user has been logged out, e.g. by C_Logout in another session
+        login(entry.session_);
+      }
+      entry.lastUsed_ = System.currentTimeMillis();
+
+      return entry;
+    } catch (TokenException ex) {
+      if (!isSessionLost(ex)) {
+        release(entry);
+        throw ex;
+      }
+    }
+
+    retire(entry);
+    synchronized (this) {
+      if (closed_) {
+        throw new TokenException("The session pool is closed.");
+      }
+      opening_++;
+    }
+    Entry newEntry = openEntry();
+    if (affinity_.get() == entry) {
+      affinity_.set(newEntry);
+    }
+
+    return newEntry;
+  }
+
+  /**
+   * Open a new session and log it in, if the pool has a PIN.
+   * 
+   * @return The new session.
+   * @exception TokenException
+   *              If opening or logging in the session fails.
+   * @postconditions (result <> null)
+   */
+  protected Session openSession() throws TokenException {
+    Session session = token_.openSession(Token.SessionType.SERIAL_SESSION, rwSession_, null,
+        null);
+    if (pin_ != null) {
+      try {
+        login(session);
+      } catch (TokenException ex) {
+        session.closeSession();
+        throw ex;
+      }
+    }
+
+    return session;
+  }
+
+  /**
+   * Open a new session for a place in the pool that the caller has reserved by incrementing
+   * opening_, and add it as a claimed entry. The caller must not hold the monitor of the pool.
+   * 
+   * @return The new claimed entry.
+   * @exception TokenException
+   *              If opening or logging in the session fails, or if the pool has been closed
+   *              meanwhile.
+   * @postconditions (result <> null)
+   */
+  protected Entry openEntry() throws TokenException {
+    Session session = null;
+    try {
+      session = openSession();
+    } finally {
+      if (session == null) {
+        synchronized (this) {
+          opening_--;
+          // a waiting thread may open a session instead
+          notifyAll();
+        }
+      }
+    }
+
+    synchronized (this) {
+      opening_--;
+      if (!closed_) {
+        Entry entry = addEntry(session);
+        entry.borrowed_ = true;
+
+        return entry;
+      }
+    }
+    try {
+      session.closeSession();
+    } catch (TokenException ex) {
+      // the pool does not use the session anyway
+    }
+    throw new TokenException("The session pool is closed.");
+  }
+
+  /**
+   * Log in the given session with the PIN of the pool.
+   * 
+   * @param session
+   *          The session to log in.
+   * @exception TokenException
+   *              If logging in fails.
+   * @preconditions (session <> null) and (pin_ <> null)
+   */
+  protected void login(Session session) throws TokenException {
+    try {
+      session.login(userType_, pin_);
+    } catch (PKCS11Exception ex) {
+      // all sessions share the login state, so this is the normal case after the first session
+      if (ex.getErrorCode() != PKCS11Constants.CKR_USER_ALREADY_LOGGED_IN) {
+        throw ex;
+      }
+    }
+  }
+
+  /**
+   * Add a new entry for the given session to the pool. The caller must hold the monitor of the
+   * pool.
+   * 
+   * @param session
+   *          The new session.
+   * @return The new entry.
+   * @postconditions (result <> null)
+   */
+  protected Entry addEntry(Session session) {
+    Entry entry = new Entry(session);
+    entries_.addElement(entry);
+    entriesBySession_.put(session, entry);
+
+    return entry;
+  }
+
+  /**
+   * Remove the given claimed entry from the pool and close its session. Errors on closing are
+   * ignored, because the session is not used anymore anyway.
+   * 
+   * @param entry
+   *          The claimed entry to remove.
+   */
+  protected void retire(Entry entry) {
+    synchronized (entry) {
+      entry.retired_ = true;
+    }
+    synchronized (this) {
+      entries_.removeElement(entry);
+      if (entriesBySession_.get(entry.session_) == entry) {
+        entriesBySession_.remove(entry.session_);
+      }
+    }
+    try {
+      entry.session_.closeSession();
+    } catch (TokenException ex) {
+      // the session is probably closed already
+    }
+  }
+
+}
@@ -48,6 +48,8 @@ import iaik.pkcs.pkcs11.wrapper.CK_TOKEN_INFO;
 import iaik.pkcs.pkcs11.wrapper.PKCS11Constants;
 import iaik.pkcs.pkcs11.wrapper.PKCS11Exception;
 
+import java.util.Arrays;
+
 /**
  * Objects of this class represent PKCS#11 tokens. The application can get information on the token,
  * manage sessions and initialize the token. Notice that objects of this class can become valid at
@@ -144,6 +146,107 @@ public class Token {
 
   }
 
+  /**
+   * Reads the attributes of batches of objects in one session, as part of a parallel scan. All
+   * workers of a scan take the next batch from a shared counter until no batch is left.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (session_ <> null) and (objectHandles_ <> null) and (attributeTypes_ <> null)
+   *             and (parts_ <> null) and (nextBatch_ <> null)
+   */
+  protected static class ScanWorker implements Runnable {
+
+    /**
+     * The session that this worker uses for reading.
+     */
+    protected Session session_;
+
+    /**
+     * The handles of all objects of the scan, in ascending order.
+     */
+    protected long[] objectHandles_;
+
+    /**
+     * The types of the attributes to read of each object.
+     */
+    protected long[] attributeTypes_;
+
+    /**
+     * The results of all batches of the scan; shared by all workers.
+     */
+    protected AttributeValueTable[] parts_;
+
+    /**
+     * The index of the next batch to read in its only element; shared by all workers, which also
+     * synchronize on it.
+     */
+    protected int[] nextBatch_;
+
+    /**
+     * The exception that stopped this worker, or null.
+     */
+    protected Exception exception_;
+
+    /**
+     * Constructor taking the session of this worker and the shared state of the scan.
+     * 
+     * @param session
+     *          The session that this worker uses for reading.
+     * @param objectHandles
+     *          The handles of all objects of the scan.
+     * @param attributeTypes
+     *          The types of the attributes to read of each object.
+     * @param parts
+     *          The results of all batches of the scan.
+     * @param nextBatch
+     *          The shared counter of the next batch to read.
+     */
+    protected ScanWorker(Session session, long[] objectHandles, long[] attributeTypes,
+        AttributeValueTable[] parts, int[] nextBatch) {
+      session_ = session;
+      objectHandles_ = objectHandles;
+      attributeTypes_ = attributeTypes;
+      parts_ = parts;
+      nextBatch_ = nextBatch;
+    }
+
+    /**
+     * Read batches until no batch is left or reading fails. If reading fails, the other workers
+     * stop after their current batch.
+     */
+    public void run() {
+      while (true) {
+        int batch;
+        synchronized (nextBatch_) {
+          batch = nextBatch_[0]++;
+        }
+        if (batch >= parts_.length) {
+          break;
+        }
+        int offset = batch * SCAN_BATCH_SIZE;
+        int length = Math.min(SCAN_BATCH_SIZE, objectHandles_.length - offset);
+        long[] batchHandles = new long[length];
+        System.arraycopy(objectHandles_, offset, batchHandles, 0, length);
+        try {
+          parts_[batch] = session_.getAttributeValues(batchHandles, attributeTypes_);
+        } catch (Exception ex) {
+          exception_ = ex;
+          synchronized (nextBatch_) {
+            nextBatch_[0] = parts_.length;
+          }
+          break;
+        }
+      }
+    }
+
+  }
+
+  /**
+   * The number of objects that a parallel scan reads in a single call.
+   */
+  protected static final int SCAN_BATCH_SIZE = 256;
+
   /**
    * The reference to the slot.
    */
@@ -154,6 +257,11 @@ public class Token {
    */
   protected boolean useUtf8Encoding_;
 
+  /**
+   * The cache for attribute values shared by all sessions of this token, or null.
+   */
+  protected AttributeCache attributeCache_;
+
   /**
    * The constructor that takes a reference to the module and the slot ID.
    * 
@@ -199,6 +307,27 @@ public class Token {
     return slot_;
   }
 
+  /**
+   * Set the cache for attribute values that all sessions of this token use, unless a session has
+   * its own cache. Only sessions opened through this Token object use the cache. If the application
+   * changes objects through other means, it must invalidate the cache itself.
+   * 
+   * @param attributeCache
+   *          The cache to use, or null to read all attributes from the token.
+   */
+  public void setAttributeCache(AttributeCache attributeCache) {
+    attributeCache_ = attributeCache;
+  }
+
+  /**
+   * Get the cache for attribute values that the sessions of this token use.
+   * 
+   * @return The cache, or null if there is none.
+   */
+  public AttributeCache getAttributeCache() {
+    return attributeCache_;
+  }
+
   /**
    * Get the ID of this token. This is the ID of the slot this token resides in.
    * 
@@ -343,6 +472,199 @@ public class Token {
     return newSession;
   }
 
+  /**
+   * Create a pool of sessions of this token, which several threads can share; see SessionPool.
+   * 
+   * @param minSize
+   *          The number of sessions to open in advance and to keep open.
+   * @param maxSize
+   *          The maximum number of sessions. If the token allows less sessions, the pool uses the
+   *          maximum of the token.
+   * @param rwSession
+   *          Must be either SessionReadWriteBehavior.RO_SESSION for read-only sessions or
+   *          SessionReadWriteBehavior.RW_SESSION for read-write sessions.
+   * @param userType
+   *          Session.UserType.USER or Session.UserType.SO.
+   * @param pin
+   *          The PIN to log in each session, or null to leave the sessions as they are opened.
+   * @return The new pool.
+   * @exception TokenException
+   *              If opening or logging in the first sessions fails.
+   * @preconditions (0 <= minSize <= maxSize) and (maxSize > 0)
+   * @postconditions (result <> null)
+   */
+  public SessionPool createSessionPool(int minSize, int maxSize, boolean rwSession,
+      boolean userType, char[] pin) throws TokenException {
+    return new SessionPool(this, minSize, maxSize, rwSession, userType, pin);
+  }
+
+  /**
+   * Create an object that runs operations of this token in the background on worker threads, each
+   * with a session of its own; see AsyncSession.
+   * 
+   * @param threadCount
+   *          The number of worker threads and sessions.
+   * @param queueCapacity
+   *          The maximum number of operations waiting to be run.
+   * @param rwSession
+   *          Must be either SessionReadWriteBehavior.RO_SESSION for read-only sessions or
+   *          SessionReadWriteBehavior.RW_SESSION for read-write sessions.
+   * @return The new async session.
+   * @exception TokenException
+   *              If opening a session fails.
+   * @preconditions (threadCount > 0) and (queueCapacity > 0)
+   * @postconditions (result <> null)
+   */
+  public AsyncSession createAsyncSession(int threadCount, int queueCapacity, boolean rwSession)
+      throws TokenException {
+    return new AsyncSession(this, threadCount, queueCapacity, rwSession);
+  }
+
+  /**
+   * Create an object that runs many small operations of this token on native threads inside the
+   * wrapper library, each with a session of its own; see NativeWorkerPool.
+   * 
+   * @param threadCount
+   *          The number of native threads and sessions.
+   * @param capacity
+   *          The maximum number of requests submitted, whose results were not polled yet.
+   * @param rwSession
+   *          Must be either SessionReadWriteBehavior.RO_SESSION for read-only sessions or
+   *          SessionReadWriteBehavior.RW_SESSION for read-write sessions.
+   * @return The new pool.
+   * @exception TokenException
+   *              If opening a session or starting the threads fails.
+   * @preconditions (threadCount > 0) and (capacity > 0)
+   * @postconditions (result <> null)
+   */
+  public NativeWorkerPool createNativeWorkerPool(int threadCount, int capacity, boolean rwSession)
+      throws TokenException {
+    return new NativeWorkerPool(this, threadCount, capacity, rwSession);
+  }
+
+  /**
+   * Reads the same attributes of all objects that match a template, using several sessions in
+   * parallel. Network HSMs and tokens with several cores process the requests of different sessions
+   * at the same time; for them, this is much faster than reading the objects one after the other;
+   * e.g. for taking an inventory of all keys at startup. The objects are found in one session. The
+   * attributes are read in batches of objects, which the given number of sessions, each in its own
+   * thread, read with Session.getAttributeValues(long[], long[]). The sessions are opened as
+   * read-only sessions and closed before this method returns. If the token refuses to open more
+   * sessions, the scan uses those it could open. As all sessions of an application share the
+   * login state, private objects are found, if the user is logged in.
+   * 
+   * @param templateObject
+   *          The object that serves as a template for searching. If this object is null, all
+   *          objects are read that a session can see.
+   * @param attributeTypes
+   *          The types of the attributes to read of each object. Array attributes like
+   *          CKA_WRAP_TEMPLATE are not supported.
+   * @param parallelism
+   *          The maximum number of sessions to use for reading.
+   * @return The values of the attributes of all found objects, ordered by object handle.
+   * @exception TokenException
+   *              If opening a session, finding the objects or reading the attributes fails.
+   * @preconditions (attributeTypes <> null) and (parallelism > 0)
+   * @postconditions (result <> null)
+   */
+  public AttributeValueTable parallelScan(iaik.pkcs.pkcs11.objects.Object templateObject,
+      long[] attributeTypes, int parallelism) throws TokenException {
+    if (attributeTypes == null) {
+      throw new NullPointerException("Argument \"attributeTypes\" must not be null.");
+    }
+    if (parallelism <= 0) {
+      throw new IllegalArgumentException("Argument \"parallelism\" must be positive.");
+    }
+
+    Session[] sessions = new Session[parallelism];
+    try {
+      sessions[0] = openSession(SessionType.SERIAL_SESSION, SessionReadWriteBehavior.RO_SESSION,
+          null, null);
+
+      long[] objectHandles = new long[ObjectIterator.DEFAULT_MAX_BATCH_SIZE];
+      int objectCount = 0;
+      ObjectIterator iterator = sessions[0].iterateObjectHandles(templateObject);
+      try {
+        while (iterator.hasNext()) {
+          if (objectCount == objectHandles.length) {
+            long[] newObjectHandles = new long[2 * objectHandles.length];
+            System.arraycopy(objectHandles, 0, newObjectHandles, 0, objectCount);
+            objectHandles = newObjectHandles;
+          }
+          objectHandles[objectCount++] = iterator.nextHandle();
+        }
+      } catch (TokenRuntimeException ex) {
+        throw new TokenException(ex);
+      } finally {
+        iterator.close();
+      }
+      long[] sortedHandles = new long[objectCount];
+      System.arraycopy(objectHandles, 0, sortedHandles, 0, objectCount);
+      Arrays.sort(sortedHandles);
+
+      AttributeValueTable[] parts = new AttributeValueTable[(objectCount + SCAN_BATCH_SIZE - 1)
+          / SCAN_BATCH_SIZE];
+      int workerCount = Math.max(1, Math.min(parallelism, parts.length));
+      for (int i = 1; i < workerCount; i++) {
+        try {
+          sessions[i] = openSession(SessionType.SERIAL_SESSION,
+              SessionReadWriteBehavior.RO_SESSION, null, null);
+        } catch (TokenException ex) {
+          // e.g. CKR_SESSION_COUNT; scan with the sessions we already have
+          workerCount = i;
+          break;
+        }
+      }
+
+      // the calling thread is the first worker
+      int[] nextBatch = new int[1];
+      ScanWorker[] workers = new ScanWorker[workerCount];
+      Thread[] threads = new Thread[workerCount];
+      for (int i = 0; i < workerCount; i++) {
+        workers[i] = new ScanWorker(sessions[i], sortedHandles, attributeTypes, parts, nextBatch);
+        if (i > 0) {
+          threads[i] = new Thread(workers[i], "PKCS#11 scan " + i);
+          threads[i].start();
+        }
+      }
+      workers[0].run();
+      boolean interrupted = false;
+      for (int i = 1; i < workerCount; i++) {
+        // the sessions must not be closed while a worker still uses them
+        while (threads[i].isAlive()) {
+          try {
+            threads[i].join();
+          } catch (InterruptedException ex) {
+            interrupted = true;
+          }
+        }
+      }
+      if (interrupted) {
+        Thread.currentThread().interrupt();
+      }
+      for (int i = 0; i < workerCount; i++) {
+        Exception exception = workers[i].exception_;
+        if (exception instanceof TokenException) {
+          throw (TokenException) exception;
+        } else if (exception != null) {
+          throw new TokenException(exception);
+        }
+      }
+
+      return AttributeValueTable.concatenate(sortedHandles, attributeTypes, parts);
+    } finally {
+      for (int i = 0; i < sessions.length; i++) {
+        if (sessions[i] != null) {
+          try {
+            sessions[i].closeSession();
+          } catch (TokenException ex) {
+            // must not hide the exception of the scan, if any
+          }
+        }
+      }
+    }
+  }
+
   /**
    * Close all open sessions of this token. All subsequently opened session will be public sessions
    * (i.e. not logged in) by default.
@@ -352,6 +674,10 @@ public class Token {
    */
   public void closeAllSessions() throws TokenException {
     slot_.getModule().getPKCS11Module().C_CloseAllSessions(slot_.getSlotID());
+    AttributeCache attributeCache = attributeCache_;
+    if (attributeCache != null) {
+      attributeCache.retainObjects(PKCS11Constants.CKA_TOKEN, true);
+    }
   }
 
   /**
@@ -186,6 +186,12 @@ public abstract class Attribute implements Cloneable {
    */
   protected CK_ATTRIBUTE ckAttribute_;
 
+  /**
+   * The object that reads the value of this attribute from the token on first access, or null, if
+   * the value has already been read or set. See Session.setLazyAttributeLoading.
+   */
+  protected Object lazyOwner_;
+
   /**
    * Empty constructor. Attention! If you use this constructor, you must set ckAttribute_ to ensure
    * that the class invariant is not violated.
@@ -434,6 +440,7 @@ public abstract class Attribute implements Cloneable {
   public java.lang.Object clone() {
     Attribute clone;
 
+    loadValue();
     try {
       clone = (Attribute) super.clone();
       clone.ckAttribute_ = (CK_ATTRIBUTE) this.ckAttribute_.clone();
@@ -453,6 +460,7 @@ public abstract class Attribute implements Cloneable {
    *          True, if attribute is present.
    */
   public void setPresent(boolean present) {
+    lazyOwner_ = null;
     present_ = present;
   }
 
@@ -464,6 +472,7 @@ public abstract class Attribute implements Cloneable {
    *          True, if attribute is sensitive.
    */
   public void setSensitive(boolean sensitive) {
+    lazyOwner_ = null;
     sensitive_ = sensitive;
   }
 
@@ -492,15 +501,31 @@ public abstract class Attribute implements Cloneable {
     if (ckAttribute == null) {
       throw new NullPointerException("Argument \"ckAttribute\" must not be null.");
     }
+    lazyOwner_ = null;
     ckAttribute_ = ckAttribute;
   }
 
+  /**
+   * Read the value of this attribute from the token, if the object it belongs to has deferred
+   * reading it. Every method that uses the value or the state of this attribute calls this first.
+   * 
+   * @exception TokenRuntimeException
+   *              If reading the value failed.
+   */
+  protected void loadValue() {
+    Object lazyOwner = lazyOwner_;
+    if (lazyOwner != null) {
+      lazyOwner.loadAttribute(this);
+    }
+  }
+
   /**
    * Check, if this attribute is really present in the associated object.
    * 
    * @return True, if this attribute is really present in the associated object.
    */
   public boolean isPresent() {
+    loadValue();
     return present_;
   }
 
@@ -510,6 +535,7 @@ public abstract class Attribute implements Cloneable {
    * @return True, if this attribute is sensitive in the associated object.
    */
   public boolean isSensitive() {
+    loadValue();
     return sensitive_;
   }
 
@@ -527,6 +553,7 @@ public abstract class Attribute implements Cloneable {
    * @return True, if this attribute's status has already been determined.
    */
   public boolean isStateKnown() {
+    loadValue();
     return stateKnown_;
   }
 
@@ -538,6 +565,7 @@ public abstract class Attribute implements Cloneable {
    * @postconditions (result <> null)
    */
   protected CK_ATTRIBUTE getCkAttribute() {
+    loadValue();
     return ckAttribute_;
   }
 
@@ -587,6 +615,8 @@ public abstract class Attribute implements Cloneable {
   public String toString(boolean withName) {
     StringBuffer buffer = new StringBuffer(32);
 
+    loadValue();
+
     if (withName) {
       String typeName = getAttributeName(new Long(ckAttribute_.type));
       buffer.append(typeName);
@@ -648,6 +678,8 @@ public abstract class Attribute implements Cloneable {
 
     if (otherObject instanceof Attribute) {
       Attribute other = (Attribute) otherObject;
+      this.loadValue();
+      other.loadValue();
       if (this == other) {
         equal = true;
       } else if ((this.stateKnown_ == true) && (other.stateKnown_ == true)) {
@@ -697,6 +729,7 @@ public abstract class Attribute implements Cloneable {
    * @return The hash code of this object.
    */
   public int hashCode() {
+    loadValue();
     return ((int) ckAttribute_.type)
         ^ ((ckAttribute_.pValue != null) ? ckAttribute_.pValue.hashCode() : 0);
   }
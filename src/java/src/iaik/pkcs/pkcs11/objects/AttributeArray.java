@@ -88,6 +88,7 @@ public class AttributeArray extends Attribute {
    */
   public void setAttributeArrayValue(Object value) {
 
+    lazyOwner_ = null;
     template_ = value;
 
     List attributeList = new ArrayList();
@@ -109,6 +110,7 @@ public class AttributeArray extends Attribute {
    * @return The attribute array value of this attribute or null.
    */
   public Object getAttributeArrayValue() {
+    loadValue();
     if (template_ == null) {
       if (ckAttribute_.pValue != null
           && ((CK_ATTRIBUTE[]) ckAttribute_.pValue).length > 0) {
@@ -78,6 +78,7 @@ public class BooleanAttribute extends Attribute {
    *          The boolean value to set. May be null.
    */
   public void setBooleanValue(Boolean value) {
+    lazyOwner_ = null;
     ckAttribute_.pValue = value;
     present_ = true;
   }
@@ -88,6 +89,7 @@ public class BooleanAttribute extends Attribute {
    * @return The boolean value of this attribute or null.
    */
   public Boolean getBooleanValue() {
+    loadValue();
     return (Boolean) ckAttribute_.pValue;
   }
 
@@ -81,6 +81,7 @@ public class ByteArrayAttribute extends Attribute {
    *          The byte-array value to set. May be null.
    */
   public void setByteArrayValue(byte[] value) {
+    lazyOwner_ = null;
     ckAttribute_.pValue = value;
     present_ = true;
   }
@@ -91,6 +92,7 @@ public class ByteArrayAttribute extends Attribute {
    * @return The byte-array value of this attribute or null.
    */
   public byte[] getByteArrayValue() {
+    loadValue();
     return (byte[]) ckAttribute_.pValue;
   }
 
@@ -132,6 +134,7 @@ public class ByteArrayAttribute extends Attribute {
    * @return The hash code of this object.
    */
   public int hashCode() {
+    loadValue();
     return (ckAttribute_.pValue != null)
         ? Functions.hashCode((byte[]) ckAttribute_.pValue) : 0;
   }
@@ -81,6 +81,7 @@ public class CharArrayAttribute extends Attribute {
    *          The char-array value to set. May be null.
    */
   public void setCharArrayValue(char[] value) {
+    lazyOwner_ = null;
     ckAttribute_.pValue = value;
     present_ = true;
   }
@@ -91,6 +92,7 @@ public class CharArrayAttribute extends Attribute {
    * @return The char-array value of this attribute or null.
    */
   public char[] getCharArrayValue() {
+    loadValue();
     return (char[]) ckAttribute_.pValue;
   }
 
@@ -132,6 +134,7 @@ public class CharArrayAttribute extends Attribute {
    * @return The hash code of this object.
    */
   public int hashCode() {
+    loadValue();
     return (ckAttribute_.pValue != null)
         ? Functions.hashCode((char[]) ckAttribute_.pValue) : 0;
   }
@@ -84,6 +84,7 @@ public class DateAttribute extends Attribute {
    *          The date value to set. May be null.
    */
   public void setDateValue(Date value) {
+    lazyOwner_ = null;
     ckAttribute_.pValue = Util.convertToCkDate(value);
     present_ = true;
   }
@@ -94,6 +95,7 @@ public class DateAttribute extends Attribute {
    * @return The date value of this attribute or null.
    */
   public Date getDateValue() {
+    loadValue();
     return Util.convertToDate((CK_DATE) ckAttribute_.pValue);
   }
 
@@ -116,6 +118,7 @@ public class DateAttribute extends Attribute {
    * @return The hash code of this object.
    */
   public int hashCode() {
+    loadValue();
     return ((int) ckAttribute_.type) ^ ((ckAttribute_.pValue != null)
         ? Functions.hashCode((CK_DATE) ckAttribute_.pValue) : 0);
   }
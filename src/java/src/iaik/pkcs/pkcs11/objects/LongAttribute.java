@@ -78,6 +78,7 @@ public class LongAttribute extends Attribute {
    *          The long value to set. May be null.
    */
   public void setLongValue(Long value) {
+    lazyOwner_ = null;
     ckAttribute_.pValue = value;
     present_ = true;
   }
@@ -88,6 +89,7 @@ public class LongAttribute extends Attribute {
    * @return The long value of this attribute or null.
    */
   public Long getLongValue() {
+    loadValue();
     return (Long) ckAttribute_.pValue;
   }
 
@@ -126,6 +128,8 @@ public class LongAttribute extends Attribute {
   public String toString(int radix) {
     StringBuffer buffer = new StringBuffer(32);
 
+    loadValue();
+
     if (stateKnown_ == false)
       buffer.append("<Value is not present or sensitive>");
     else if (present_) {
@@ -86,6 +86,7 @@ public class MechanismArrayAttribute extends Attribute {
         values[i] = value[i].getMechanismCode();
       }
     }
+    lazyOwner_ = null;
     ckAttribute_.pValue = values;
     present_ = true;
   }
@@ -98,6 +99,8 @@ public class MechanismArrayAttribute extends Attribute {
    */
   public Mechanism[] getMechanismAttributeArrayValue() {
     Mechanism[] mechanisms = null;
+
+    loadValue();
     if (ckAttribute_.pValue != null) {
       long[] values = (long[]) ckAttribute_.pValue;
       if (values != null && values.length > 0) {
@@ -150,6 +153,7 @@ public class MechanismArrayAttribute extends Attribute {
    * @return The hash code of this object.
    */
   public int hashCode() {
+    loadValue();
     return (ckAttribute_.pValue != null)
         ? Functions.hashCode((long[]) ckAttribute_.pValue) : 0;
   }
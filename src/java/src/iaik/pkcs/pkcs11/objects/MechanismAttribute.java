@@ -83,6 +83,7 @@ public class MechanismAttribute extends LongAttribute {
    *          The mechanism value to set. May be <code>null</code>.
    */
   public void setMechanism(Mechanism mechanism) {
+    lazyOwner_ = null;
     ckAttribute_.pValue = (mechanism != null) ? new Long(mechanism.getMechanismCode())
         : null;
     present_ = true;
@@ -94,6 +95,7 @@ public class MechanismAttribute extends LongAttribute {
    * @return The long value of this attribute or null.
    */
   public Mechanism getMechanism() {
+    loadValue();
     return ((ckAttribute_ != null) && (ckAttribute_.pValue != null))
         ? new Mechanism(((Long) ckAttribute_.pValue).longValue()) : null;
   }
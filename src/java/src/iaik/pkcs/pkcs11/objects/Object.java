@@ -43,6 +43,7 @@
 package iaik.pkcs.pkcs11.objects;
 
 //import java.util.Collections;
+import iaik.pkcs.pkcs11.AttributeCache;
 import iaik.pkcs.pkcs11.Session;
 import iaik.pkcs.pkcs11.TokenException;
 import iaik.pkcs.pkcs11.TokenRuntimeException;
@@ -161,11 +162,107 @@ public class Object implements Cloneable {
 
   }
 
+  /**
+   * The attribute values that getInstance has read in advance for one object. While the object is
+   * created, getAttributeValue and getAttributeValues take the values from here instead of reading
+   * them from the token again.
+   * 
+   * @author Karl Scheibelhofer
+   * @version 1.0
+   * @invariants (session_ <> null) and (attributes_ <> null) and (unavailableTypes_ <> null)
+   */
+  protected static class PrefetchedAttributes {
+
+    /**
+     * The session that has read the attributes.
+     */
+    protected Session session_;
+
+    /**
+     * The handle of the object that the attributes belong to.
+     */
+    protected long objectHandle_;
+
+    /**
+     * The attributes that have been read. The key is the attribute type as Long, the value the
+     * CK_ATTRIBUTE.
+     */
+    protected Hashtable attributes_;
+
+    /**
+     * The types of the attributes that the module did not return, because they are sensitive or
+     * invalid for the object. The key is the attribute type as Long.
+     */
+    protected Hashtable unavailableTypes_;
+
+    /**
+     * The exception that the module reported for the unavailable attributes, or null.
+     */
+    protected PKCS11Exception exception_;
+
+    /**
+     * Get the attribute of the given type, if it has been read.
+     * 
+     * @param type
+     *          The attribute type.
+     * @return A copy of the attribute or null, if it has not been read.
+     */
+    protected CK_ATTRIBUTE getAttribute(long type) {
+      CK_ATTRIBUTE attribute = (CK_ATTRIBUTE) attributes_.get(new Long(type));
+
+      return (attribute != null) ? (CK_ATTRIBUTE) attribute.clone() : null;
+    }
+
+    /**
+     * Check, if the module did not return the attribute of the given type.
+     * 
+     * @param type
+     *          The attribute type.
+     * @return True, if the attribute is sensitive or invalid for the object.
+     */
+    protected boolean isUnavailable(long type) {
+      return unavailableTypes_.containsKey(new Long(type));
+    }
+
+  }
+
   /**
    * The currently set vendor defined object builder, or null.
    */
   protected static VendorDefinedObjectBuilder vendorObjectBuilder_;
 
+  /**
+   * The attribute types that identify the kind of an object. getInstance always reads these in
+   * advance.
+   */
+  protected static final long[] PREFETCH_BASE_TEMPLATE = {
+    PKCS11Constants.CKA_CLASS, PKCS11Constants.CKA_KEY_TYPE, PKCS11Constants.CKA_CERTIFICATE_TYPE };
+
+  /**
+   * The attribute types that getInstance has learned for each kind of object. The key is a String
+   * made of the object class and the key or certificate type, the value the attribute types of an
+   * object of this kind as long[]. Access is synchronized on this table.
+   */
+  protected static Hashtable learnedTemplates_ = new Hashtable();
+
+  /**
+   * The attribute types that getInstance reads in advance in a single call; i.e. the base template
+   * and the union of all learned templates. Null, if nothing has been learned yet. Replaced as a
+   * whole, whenever a new kind of object is learned.
+   */
+  protected static volatile long[] prefetchTemplate_;
+
+  /**
+   * True, if getInstance reads the attributes of an object in advance.
+   */
+  protected static boolean prefetching_ = true;
+
+  /**
+   * The attributes that getInstance has read in advance for the object which the current thread is
+   * creating, or null. Holds a PrefetchedAttributes object.
+   */
+  protected static ThreadLocal prefetchedAttributes_ = new ThreadLocal();
+
   /**
    * A table holding string representations for all known key types. Table key is the key type as
    * Long object.
@@ -189,6 +286,12 @@ public class Object implements Cloneable {
    */
   protected long objectHandle_ = -1;
 
+  /**
+   * The session to use for reading the attributes that have not been read yet, or null, if this
+   * object does not defer reading attributes.
+   */
+  protected Session lazySession_;
+
   /**
    * The default constructor. An application use this constructor to instantiate an object that
    * serves as a template. It may also be useful for working with vendor-defined objects.
@@ -222,7 +325,11 @@ public class Object implements Cloneable {
 
     objectHandle_ = objectHandle;
 
-    readAttributes(session);
+    if (session.isLazyAttributeLoading()) {
+      deferAttributes(session);
+    } else {
+      readAttributes(session);
+    }
   }
 
   /**
@@ -230,7 +337,9 @@ public class Object implements Cloneable {
    * PKCS#11 object. This method reads the object class attribute and calls the getInstance method
    * of the according sub-class. If the object class is a vendor defined it uses the
    * VendorDefinedObjectBuilder set by the application. If no object could be constructed, this
-   * method returns null.
+   * method returns null. Unless prefetching is disabled, this method first reads the attributes
+   * that it has learned for all kinds of objects, in a single call; see setPrefetching. Once a kind
+   * of object has been seen, this usually needs one call per object instead of three.
    * 
    * @param session
    *          The session to use for reading attributes. This session must have the appropriate
@@ -250,6 +359,104 @@ public class Object implements Cloneable {
       throw new NullPointerException("Argument \"session\" must not be null.");
     }
 
+    java.lang.Object previousPrefetch = prefetchedAttributes_.get();
+    Object newObject;
+
+    prefetchedAttributes_.set(prefetchAttributes(session, objectHandle));
+    try {
+      newObject = createInstance(session, objectHandle);
+    } finally {
+      prefetchedAttributes_.set(previousPrefetch);
+    }
+    if (prefetching_) {
+      learnPrefetchTemplate(newObject);
+    }
+
+    return newObject;
+  }
+
+  /**
+   * Remember the attribute types of the given object for its kind; i.e. its object class and its
+   * key or certificate type. If this kind is new, or it has attributes which have not been learned
+   * yet, the prefetch template becomes the union of the base template and all learned templates.
+   * 
+   * @param newObject
+   *          The object that getInstance has just created.
+   * @preconditions (newObject <> null)
+   */
+  protected static void learnPrefetchTemplate(Object newObject) {
+    String kind = getLongAttributeValue(newObject, PKCS11Constants.CKA_CLASS) + "/"
+        + getLongAttributeValue(newObject, PKCS11Constants.CKA_KEY_TYPE) + "/"
+        + getLongAttributeValue(newObject, PKCS11Constants.CKA_CERTIFICATE_TYPE);
+
+    synchronized (learnedTemplates_) {
+      long[] learned = (long[]) learnedTemplates_.get(kind);
+      if ((learned != null) && (learned.length == newObject.attributeTable_.size())) {
+        return;
+      }
+
+      Enumeration types = newObject.attributeTable_.keys();
+      long[] template = new long[newObject.attributeTable_.size()];
+      for (int i = 0; i < template.length; i++) {
+        template[i] = ((Long) types.nextElement()).longValue();
+      }
+      learnedTemplates_.put(kind, template);
+
+      Hashtable union = new Hashtable();
+      for (int i = 0; i < PREFETCH_BASE_TEMPLATE.length; i++) {
+        union.put(new Long(PREFETCH_BASE_TEMPLATE[i]), Boolean.TRUE);
+      }
+      Enumeration templates = learnedTemplates_.elements();
+      while (templates.hasMoreElements()) {
+        long[] kindTemplate = (long[]) templates.nextElement();
+        for (int i = 0; i < kindTemplate.length; i++) {
+          union.put(new Long(kindTemplate[i]), Boolean.TRUE);
+        }
+      }
+      Enumeration unionTypes = union.keys();
+      long[] prefetchTemplate = new long[union.size()];
+      for (int i = 0; i < prefetchTemplate.length; i++) {
+        prefetchTemplate[i] = ((Long) unionTypes.nextElement()).longValue();
+      }
+      prefetchTemplate_ = prefetchTemplate;
+    }
+  }
+
+  /**
+   * Get the value of the long attribute of the given type of an object.
+   * 
+   * @param object
+   *          The object.
+   * @param type
+   *          The attribute type.
+   * @return The value of the attribute or null, if the object has no such attribute or it is not
+   *         present.
+   * @preconditions (object <> null)
+   */
+  protected static Long getLongAttributeValue(Object object, long type) {
+    java.lang.Object attribute = object.attributeTable_.get(new Long(type));
+
+    return ((attribute instanceof LongAttribute) && ((LongAttribute) attribute).isPresent())
+        ? ((LongAttribute) attribute).getLongValue() : null;
+  }
+
+  /**
+   * Reads the object class attribute and calls the getInstance method of the according sub-class.
+   * This does the work of getInstance after the attributes have been read in advance.
+   * 
+   * @param session
+   *          The session to use for reading attributes. This session must have the appropriate
+   *          rights; i.e. it must be a user-session, if it is a private object.
+   * @param objectHandle
+   *          The object handle as given from the PKCS#111 module.
+   * @return The object representing the PKCS#11 object.
+   * @exception TokenException
+   *              If getting the attributes failed.
+   * @preconditions (session <> null)
+   * @postconditions (result <> null)
+   */
+  protected static Object createInstance(Session session, long objectHandle)
+      throws TokenException {
     ObjectClassAttribute objectClassAttribute = new ObjectClassAttribute();
     getAttributeValue(session, objectHandle, objectClassAttribute);
 
@@ -287,6 +494,129 @@ public class Object implements Cloneable {
     return newObject;
   }
 
+  /**
+   * Reads the attributes of the prefetch template in a single call; i.e. the object class, key type
+   * and certificate type together with the attributes that getInstance has learned for any kind of
+   * object. Whatever kind the object turns out to be, this reads all its known attributes at once;
+   * the module reports the types that do not apply to it as invalid. Attributes that are not part
+   * of the template, or that the module did not return, are read later as usual. Since the
+   * template is only a guess, any failure just disables the prefetch for this object.
+   * 
+   * @param session
+   *          The session to use for reading the attributes.
+   * @param objectHandle
+   *          The handle of the object to read.
+   * @return The attributes read in advance or null, if prefetching is disabled or failed.
+   * @preconditions (session <> null)
+   */
+  protected static PrefetchedAttributes prefetchAttributes(Session session, long objectHandle) {
+    long[] template = prefetchTemplate_;
+    if (!prefetching_ || (template == null) || session.isLazyAttributeLoading()) {
+      return null;
+    }
+
+    // attributes in the cache need not be read again
+    AttributeCache attributeCache = session.getAttributeCache();
+    if (attributeCache != null) {
+      long[] uncachedTemplate = new long[template.length];
+      int uncachedCount = 0;
+      for (int i = 0; i < template.length; i++) {
+        if (!attributeCache.contains(objectHandle, template[i])) {
+          uncachedTemplate[uncachedCount++] = template[i];
+        }
+      }
+      if (uncachedCount == 0) {
+        return null;
+      }
+      template = new long[uncachedCount];
+      System.arraycopy(uncachedTemplate, 0, template, 0, uncachedCount);
+    }
+
+    PKCS11 pkcs11Module = session.getPKCS11Module();
+    CK_ATTRIBUTE[] attributeTemplateList = new CK_ATTRIBUTE[template.length];
+    for (int i = 0; i < template.length; i++) {
+      attributeTemplateList[i] = new CK_ATTRIBUTE();
+      attributeTemplateList[i].type = template[i];
+    }
+
+    PrefetchedAttributes prefetched = new PrefetchedAttributes();
+    try {
+      pkcs11Module.C_GetAttributeValue(session.getSessionHandle(), objectHandle,
+          attributeTemplateList, session.isSetUtf8Encoding());
+    } catch (PKCS11Exception ex) {
+      if (ex.getErrorCode() == PKCS11Constants.CKR_ATTRIBUTE_TYPE_INVALID
+          || ex.getErrorCode() == PKCS11Constants.CKR_ATTRIBUTE_SENSITIVE) {
+        prefetched.exception_ = ex;
+      } else {
+        // let the regular reading report this error, if it is not caused by the template
+        return null;
+      }
+    }
+
+    prefetched.session_ = session;
+    prefetched.objectHandle_ = objectHandle;
+    prefetched.attributes_ = new Hashtable(template.length);
+    prefetched.unavailableTypes_ = new Hashtable();
+    for (int i = 0; i < template.length; i++) {
+      if (attributeTemplateList[i] != null) {
+        prefetched.attributes_.put(new Long(template[i]), attributeTemplateList[i]);
+      } else {
+        prefetched.unavailableTypes_.put(new Long(template[i]), Boolean.TRUE);
+      }
+    }
+    if ((prefetched.exception_ != null) && prefetched.unavailableTypes_.isEmpty()) {
+      // the module did not mark the failed attributes; we cannot tell which values are valid
+      return null;
+    }
+
+    return prefetched;
+  }
+
+  /**
+   * Get the attributes that getInstance has read in advance for the given object in this thread.
+   * 
+   * @param session
+   *          The session that reads the object.
+   * @param objectHandle
+   *          The handle of the object.
+   * @return The attributes read in advance for this object or null, if there are none.
+   */
+  protected static PrefetchedAttributes getPrefetchedAttributes(Session session,
+      long objectHandle) {
+    PrefetchedAttributes prefetched = (PrefetchedAttributes) prefetchedAttributes_.get();
+
+    return ((prefetched != null) && (prefetched.session_ == session)
+        && (prefetched.objectHandle_ == objectHandle)) ? prefetched : null;
+  }
+
+  /**
+   * Enable or disable reading the attributes of an object in advance in getInstance. This is
+   * enabled by default. With prefetching, getInstance usually needs only one call to the module
+   * per object instead of three. Disable it for modules that handle large attribute templates
+   * badly.
+   * 
+   * @param prefetching
+   *          True, to read attributes in advance. False, to read them as needed.
+   */
+  public static void setPrefetching(boolean prefetching) {
+    prefetching_ = prefetching;
+    if (!prefetching) {
+      synchronized (learnedTemplates_) {
+        learnedTemplates_.clear();
+        prefetchTemplate_ = null;
+      }
+    }
+  }
+
+  /**
+   * Check, if getInstance reads the attributes of an object in advance.
+   * 
+   * @return True, if prefetching is enabled. False, otherwise.
+   */
+  public static boolean isPrefetching() {
+    return prefetching_;
+  }
+
   /**
    * Try to create an object which has no or an unknown object class attribute. This implementation
    * will try to use a vendor defined object builder, if such has been set. If this is impossible or
@@ -424,9 +754,13 @@ public class Object implements Cloneable {
   public java.lang.Object clone() {
     Object clone;
 
+    // cloning an attribute loads its value; read all deferred ones in a single call instead
+    loadDeferredAttributes();
     try {
       clone = (Object) super.clone();
 
+      clone.lazySession_ = null;
+
       clone.objectClass_ = (ObjectClassAttribute) this.objectClass_.clone();
       clone.attributeTable_ = new Hashtable(32); // a new table for the clone
 
@@ -584,7 +918,8 @@ public class Object implements Cloneable {
   }
 
   /**
-   * Read the values of the attributes of this object from the token.
+   * Read the values of the attributes of this object from the token. This also reads the attributes
+   * that have been deferred; see Session.setLazyAttributeLoading.
    * 
    * @param session
    *          The session handle to use for reading attributes. This session must have the
@@ -603,6 +938,31 @@ public class Object implements Cloneable {
     Attribute[] valueArray = (Attribute[]) valueCollection
         .toArray(new Attribute[valueCollection.size()]);
 
+    synchronized (this) {
+      for (int i = 0; i < valueArray.length; i++) {
+        valueArray[i].lazyOwner_ = null;
+      }
+      lazySession_ = null;
+    }
+    readAttributes(session, valueArray);
+  }
+
+  /**
+   * Read the values of the given attributes of this object from the token in one call. If the
+   * module reports sensitive or invalid attributes without marking them, each attribute is read
+   * separately.
+   * 
+   * @param session
+   *          The session to use for reading the attributes.
+   * @param valueArray
+   *          The attributes to read.
+   * @exception TokenException
+   *              If getting the attributes failed.
+   * @preconditions (session <> null) and (valueArray <> null)
+   * 
+   */
+  protected void readAttributes(Session session, Attribute[] valueArray)
+      throws TokenException {
     try {
       Object.getAttributeValues(session, objectHandle_, valueArray);
     } catch (PKCS11Exception ex) {
@@ -612,7 +972,7 @@ public class Object implements Cloneable {
         // check if module has set length -1 correctly
         boolean missAttrFound = false;
         for (int i = 0; i < valueArray.length; i++) {
-          if (valueArray[i].isStateKnown() == false) {
+          if (valueArray[i].stateKnown_ == false) {
             missAttrFound = true;
           }
         }
@@ -632,6 +992,113 @@ public class Object implements Cloneable {
 
   }
 
+  /**
+   * Defer reading the attributes of this object until they are used. Each attribute reads its
+   * value on first access through loadAttribute.
+   * 
+   * @param session
+   *          The session to use for reading the attributes later.
+   * @preconditions (session <> null)
+   * 
+   */
+  protected synchronized void deferAttributes(Session session) {
+    Enumeration attributesEnumeration = attributeTable_.elements();
+    while (attributesEnumeration.hasMoreElements()) {
+      Attribute attribute = (Attribute) attributesEnumeration.nextElement();
+      attribute.lazyOwner_ = this;
+    }
+    lazySession_ = session;
+  }
+
+  /**
+   * Read the deferred value of the given attribute from the token. To save calls, the attributes
+   * with values of fixed small size (boolean, long and date attributes, like the key usage flags)
+   * are read as one group: accessing one reads all of them that are still deferred. Other
+   * attributes, like the modulus of a key or the value of a certificate, are read one by one, so
+   * that large values that are never used are never read.
+   * 
+   * @param attribute
+   *          The attribute to read.
+   * @exception TokenRuntimeException
+   *              If reading the attribute failed; e.g. because the session has been closed.
+   * @preconditions (attribute <> null)
+   * 
+   */
+  protected synchronized void loadAttribute(Attribute attribute) {
+    if (attribute.lazyOwner_ != this) {
+      // read in the meantime
+      return;
+    }
+
+    Vector group = new Vector();
+    attribute.lazyOwner_ = null;
+    group.addElement(attribute);
+    if (isFixedSize(attribute)) {
+      Enumeration attributesEnumeration = attributeTable_.elements();
+      while (attributesEnumeration.hasMoreElements()) {
+        Attribute other = (Attribute) attributesEnumeration.nextElement();
+        if ((other.lazyOwner_ == this) && isFixedSize(other)) {
+          other.lazyOwner_ = null;
+          group.addElement(other);
+        }
+      }
+    }
+    Attribute[] valueArray = new Attribute[group.size()];
+    group.copyInto(valueArray);
+
+    try {
+      readAttributes(lazySession_, valueArray);
+    } catch (TokenException ex) {
+      throw new TokenRuntimeException("Reading a deferred attribute failed.", ex);
+    }
+  }
+
+  /**
+   * Read the values of all attributes of this object that are still deferred from the token in one
+   * call.
+   * 
+   * @exception TokenRuntimeException
+   *              If reading the attributes failed; e.g. because the session has been closed.
+   */
+  protected synchronized void loadDeferredAttributes() {
+    if (lazySession_ == null) {
+      return;
+    }
+
+    Vector group = new Vector();
+    Enumeration attributesEnumeration = attributeTable_.elements();
+    while (attributesEnumeration.hasMoreElements()) {
+      Attribute attribute = (Attribute) attributesEnumeration.nextElement();
+      if (attribute.lazyOwner_ == this) {
+        attribute.lazyOwner_ = null;
+        group.addElement(attribute);
+      }
+    }
+    if (group.isEmpty()) {
+      return;
+    }
+    Attribute[] valueArray = new Attribute[group.size()];
+    group.copyInto(valueArray);
+
+    try {
+      readAttributes(lazySession_, valueArray);
+    } catch (TokenException ex) {
+      throw new TokenRuntimeException("Reading the deferred attributes failed.", ex);
+    }
+  }
+
+  /**
+   * Check, if the value of the given attribute has a fixed small size.
+   * 
+   * @param attribute
+   *          The attribute to check.
+   * @return True, if it is a boolean, long or date attribute. False, otherwise.
+   */
+  protected static boolean isFixedSize(Attribute attribute) {
+    return (attribute instanceof BooleanAttribute) || (attribute instanceof LongAttribute)
+        || (attribute instanceof DateAttribute);
+  }
+
   /**
    * This method returns a string representation of the current object. The output is only for
    * debugging purposes and should not be used for other purposes.
@@ -784,16 +1251,47 @@ public class Object implements Cloneable {
       throw new NullPointerException("Argument \"session\" must not be null.");
     }
 
-    PKCS11 pkcs11Module = session.getModule().getPKCS11Module();
+    PKCS11 pkcs11Module = session.getPKCS11Module();
     long sessionHandle = session.getSessionHandle();
     long attributeCode = attribute.getCkAttribute().type;
 
+    AttributeCache attributeCache = session.getAttributeCache();
+    if ((attributeCache != null) && !AttributeCache.isCacheable(attributeCode)) {
+      attributeCache = null;
+    }
+    CK_ATTRIBUTE cachedAttribute = (attributeCache != null) ? attributeCache.get(objectHandle,
+        attributeCode) : null;
+    if (cachedAttribute != null) {
+      attribute.setCkAttribute(cachedAttribute);
+      attribute.stateKnown_ = true;
+      attribute.setPresent(true);
+      attribute.setSensitive(false);
+      return;
+    }
+
+    PrefetchedAttributes prefetched = getPrefetchedAttributes(session, objectHandle);
+    CK_ATTRIBUTE prefetchedAttribute = (prefetched != null) ? prefetched
+        .getAttribute(attributeCode) : null;
+    if (prefetchedAttribute != null) {
+      if (attributeCache != null) {
+        attributeCache.put(objectHandle, prefetchedAttribute);
+      }
+      attribute.setCkAttribute(prefetchedAttribute);
+      attribute.stateKnown_ = true;
+      attribute.setPresent(true);
+      attribute.setSensitive(false);
+      return;
+    }
+
     try {
       CK_ATTRIBUTE[] attributeTemplateList = new CK_ATTRIBUTE[1];
       attributeTemplateList[0] = new CK_ATTRIBUTE();
       attributeTemplateList[0].type = attributeCode;
       pkcs11Module.C_GetAttributeValue(sessionHandle, objectHandle, attributeTemplateList,
           session.isSetUtf8Encoding());
+      if (attributeCache != null) {
+        attributeCache.put(objectHandle, attributeTemplateList[0]);
+      }
       attribute.setCkAttribute(attributeTemplateList[0]);
       attribute.stateKnown_ = true;
       attribute.setPresent(true);
@@ -846,31 +1344,65 @@ public class Object implements Cloneable {
       throw new NullPointerException("Argument \"attributes\" must not be null.");
     }
 
-    PKCS11 pkcs11Module = session.getModule().getPKCS11Module();
+    PKCS11 pkcs11Module = session.getPKCS11Module();
     long sessionHandle = session.getSessionHandle();
 
-    // try {
+    // take what is cached or what getInstance has read in advance and read only the rest
+    AttributeCache attributeCache = session.getAttributeCache();
+    PrefetchedAttributes prefetched = getPrefetchedAttributes(session, objectHandle);
     CK_ATTRIBUTE[] attributeTemplateList = new CK_ATTRIBUTE[attributes.length];
+    boolean[] cached = new boolean[attributes.length];
+    int[] readIndices = new int[attributes.length];
+    int readCount = 0;
     for (int i = 0; i < attributes.length; i++) {
-      CK_ATTRIBUTE attribute = new CK_ATTRIBUTE();
-      attribute.type = attributes[i].getCkAttribute().type;
-      attributeTemplateList[i] = attribute;
-    }
-    try {
-      pkcs11Module.C_GetAttributeValue(sessionHandle, objectHandle, attributeTemplateList,
-          session.isSetUtf8Encoding());
-    } catch (PKCS11Exception ex) {
-      if (ex.getErrorCode() == PKCS11Constants.CKR_ATTRIBUTE_TYPE_INVALID
-          || ex.getErrorCode() == PKCS11Constants.CKR_ATTRIBUTE_SENSITIVE) {
-        // delay exception to process all successfully read attributes
-        delayedEx = ex;
+      long type = attributes[i].getCkAttribute().type;
+      if ((attributeCache != null) && AttributeCache.isCacheable(type)) {
+        attributeTemplateList[i] = attributeCache.get(objectHandle, type);
+        cached[i] = (attributeTemplateList[i] != null);
+        if (cached[i]) {
+          continue;
+        }
+      }
+      if (prefetched == null) {
+        readIndices[readCount++] = i;
+      } else if (prefetched.isUnavailable(type)) {
+        delayedEx = prefetched.exception_;
       } else {
-        // there was a different error that we should propagate
-        throw ex;
+        attributeTemplateList[i] = prefetched.getAttribute(type);
+        if (attributeTemplateList[i] == null) {
+          readIndices[readCount++] = i;
+        }
+      }
+    }
+    if (readCount > 0) {
+      CK_ATTRIBUTE[] readTemplateList = new CK_ATTRIBUTE[readCount];
+      for (int i = 0; i < readCount; i++) {
+        CK_ATTRIBUTE attribute = new CK_ATTRIBUTE();
+        attribute.type = attributes[readIndices[i]].getCkAttribute().type;
+        readTemplateList[i] = attribute;
+      }
+      try {
+        pkcs11Module.C_GetAttributeValue(sessionHandle, objectHandle, readTemplateList,
+            session.isSetUtf8Encoding());
+      } catch (PKCS11Exception ex) {
+        if (ex.getErrorCode() == PKCS11Constants.CKR_ATTRIBUTE_TYPE_INVALID
+            || ex.getErrorCode() == PKCS11Constants.CKR_ATTRIBUTE_SENSITIVE) {
+          // delay exception to process all successfully read attributes
+          delayedEx = ex;
+        } else {
+          // there was a different error that we should propagate
+          throw ex;
+        }
+      }
+      for (int i = 0; i < readCount; i++) {
+        attributeTemplateList[readIndices[i]] = readTemplateList[i];
       }
     }
     for (int i = 0; i < attributes.length; i++) {
       if (attributeTemplateList[i] != null) {
+        if ((attributeCache != null) && !cached[i]) {
+          attributeCache.put(objectHandle, attributeTemplateList[i]);
+        }
         attributes[i].setCkAttribute(attributeTemplateList[i]);
         attributes[i].setPresent(true);
         attributes[i].setSensitive(false);
@@ -0,0 +1,106 @@
+// Copyright (c) 2002 Graz University of Technology. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. The end-user documentation included with the redistribution, if any, must
+//    include the following acknowledgment:
+// 
+//    "This product includes software developed by IAIK of Graz University of
+//     Technology."
+// 
+//    Alternately, this acknowledgment may appear in the software itself, if and
+//    wherever such third-party acknowledgments normally appear.
+// 
+// 4. The names "Graz University of Technology" and "IAIK of Graz University of
+//    Technology" must not be used to endorse or promote products derived from this
+//    software without prior written permission.
+// 
+// 5. Products derived from this software may not be called "IAIK PKCS Wrapper",
+//    nor may "IAIK" appear in their name, without prior written permission of
+//    Graz University of Technology.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+// ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+package iaik.pkcs.pkcs11.wrapper;
+
+/**
+ * The mutex functions of the native part of the wrapper. If an object of this class is set as
+ * the mutex functions of a CK_C_INITIALIZE_ARGS object, the wrapper passes mutex functions to the
+ * module, which use the mutexes of the operating system directly; e.g. pthread mutexes. The module
+ * then does not call back to Java for creating, destroying, locking and unlocking mutexes. The
+ * same object must be set for all four mutex functions.
+ * <p>
+ * The Java methods of this class are never called by the wrapper. They only throw an exception.
+ * 
+ * @author Karl Scheibelhofer
+ */
+public class NativeMutexes implements CK_CREATEMUTEX, CK_DESTROYMUTEX, CK_LOCKMUTEX,
+    CK_UNLOCKMUTEX {
+
+  /**
+   * The native part of the wrapper handles native mutexes itself.
+   * 
+   * @return Never returns.
+   * @exception PKCS11Exception
+   *              Always, with error code CKR_FUNCTION_NOT_SUPPORTED.
+   */
+  public Object CK_CREATEMUTEX() throws PKCS11Exception {
+    throw new PKCS11Exception(PKCS11Constants.CKR_FUNCTION_NOT_SUPPORTED);
+  }
+
+  /**
+   * The native part of the wrapper handles native mutexes itself.
+   * 
+   * @param pMutex
+   *          The mutex (lock) object.
+   * @exception PKCS11Exception
+   *              Always, with error code CKR_FUNCTION_NOT_SUPPORTED.
+   */
+  public void CK_DESTROYMUTEX(Object pMutex) throws PKCS11Exception {
+    throw new PKCS11Exception(PKCS11Constants.CKR_FUNCTION_NOT_SUPPORTED);
+  }
+
+  /**
+   * The native part of the wrapper handles native mutexes itself.
+   * 
+   * @param pMutex
+   *          The mutex (lock) object.
+   * @exception PKCS11Exception
+   *              Always, with error code CKR_FUNCTION_NOT_SUPPORTED.
+   */
+  public void CK_LOCKMUTEX(Object pMutex) throws PKCS11Exception {
+    throw new PKCS11Exception(PKCS11Constants.CKR_FUNCTION_NOT_SUPPORTED);
+  }
+
+  /**
+   * The native part of the wrapper handles native mutexes itself.
+   * 
+   * @param pMutex
+   *          The mutex (lock) object.
+   * @exception PKCS11Exception
+   *              Always, with error code CKR_FUNCTION_NOT_SUPPORTED.
+   */
+  public void CK_UNLOCKMUTEX(Object pMutex) throws PKCS11Exception {
+    throw new PKCS11Exception(PKCS11Constants.CKR_FUNCTION_NOT_SUPPORTED);
+  }
+
+}
@@ -42,6 +42,8 @@
 
 package iaik.pkcs.pkcs11.wrapper;
 
+import java.nio.ByteBuffer;
+
 /**
  * If the underlaying PKCS#11 function retuns CK_OK, the method returns normally. If the return
  * value of the underlying function is not CK_OK, it throws PKCS11Exception with the return value as
@@ -422,6 +424,38 @@ public interface PKCS11 {
   public void C_GetAttributeValue(long hSession, long hObject, CK_ATTRIBUTE[] pTemplate,
       boolean useUtf8) throws PKCS11Exception;
 
+  /**
+   * C_GetAttributeValueBulk obtains the values of the same attributes of many objects in one call.
+   * For each object it calls C_GetAttributeValue with buffers of the usual estimated size; an
+   * attribute that does not fit or fails is read again on its own, so that each value gets a return
+   * value of its own, like CKR_ATTRIBUTE_SENSITIVE or CKR_ATTRIBUTE_TYPE_INVALID. A failing value
+   * or object does not stop the call. The values are packed into the returned array in the order
+   * of the objects and, for each object, in the order of the attribute types. Values of type
+   * CK_ULONG and the elements of CKA_ALLOWED_MECHANISMS are stored as 8 byte big-endian numbers;
+   * all other values as the module returns them. Array attributes like CKA_WRAP_TEMPLATE are not
+   * supported. (Object management)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param hObjects
+   *          the handles of the objects to read (PKCS#11 param: CK_OBJECT_HANDLE hObject)
+   * @param attributeTypes
+   *          the types of the attributes to read of each object (PKCS#11 param: CK_ATTRIBUTE_PTR
+   *          pTemplate, CK_ULONG ulCount)
+   * @param pulCells
+   *          receives the offset in the returned array, the length and the return value of each
+   *          value; the cell of attribute j of object i starts at index 3 * (i *
+   *          attributeTypes.length + j)
+   * @return the packed values
+   * @exception PKCS11Exception
+   *              If the call could not be run at all.
+   * @preconditions (hObjects <> null) and (attributeTypes <> null) and (pulCells <> null) and
+   *                (pulCells.length >= 3 * hObjects.length * attributeTypes.length)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_GetAttributeValueBulk(long hSession, long[] hObjects,
+      long[] attributeTypes, long[] pulCells) throws PKCS11Exception;
+
   /**
    * C_SetAttributeValue modifies the value of one or more object attributes (Object management)
    * 
@@ -473,6 +507,28 @@ public interface PKCS11 {
   public long[] C_FindObjects(long hSession, long ulMaxObjectCount)
       throws PKCS11Exception;
 
+  /**
+   * C_FindObjects continues a search for token and session objects that match a template, obtaining
+   * additional object handles. In contrast to C_FindObjects, it writes the handles to an array of
+   * the caller, which can be reused for all calls of a search. (Object management)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param phObject
+   *          receives the object's handles; must hold at least ulMaxObjectCount handles (PKCS#11
+   *          param: CK_OBJECT_HANDLE_PTR phObject)
+   * @param ulMaxObjectCount
+   *          the max. object handles to get (PKCS#11 param: CK_ULONG ulMaxObjectCount)
+   * @return the actual number of objects returned (PKCS#11 param: CK_ULONG_PTR pulObjectCount)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * 
+   * @preconditions (phObject <> null) and (0 <= ulMaxObjectCount <= phObject.length)
+   * @postconditions (0 <= result <= ulMaxObjectCount)
+   */
+  public int C_FindObjectsInto(long hSession, long[] phObject, int ulMaxObjectCount)
+      throws PKCS11Exception;
+
   /**
    * C_FindObjectsFinal finishes a search for token and session objects. (Object management)
    * 
@@ -521,6 +577,123 @@ public interface PKCS11 {
    */
   public byte[] C_Encrypt(long hSession, byte[] pData) throws PKCS11Exception;
 
+  /**
+   * C_Encrypt encrypts single-part data. The data is passed in direct buffers which are handed to
+   * the module as they are, without copying the data to or from the Java heap. The module reads the
+   * remaining bytes of pData and writes the encrypted data to the remaining space of
+   * pEncryptedData. On success, the position of pData is set to its limit and the position of
+   * pEncryptedData is advanced by the number of bytes written. If pEncryptedData has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL, the positions stay unchanged and the
+   * operation remains active. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the direct buffer holding the data to get encrypted (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG ulDataLen)
+   * @param pEncryptedData
+   *          the direct buffer receiving the encrypted data (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedData, CK_ULONG_PTR pulEncryptedDataLen)
+   * @return the number of bytes written to pEncryptedData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pEncryptedData <> null) and pData.isDirect() and
+   * pEncryptedData.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Encrypt(long hSession, ByteBuffer pData, ByteBuffer pEncryptedData)
+      throws PKCS11Exception;
+
+  /**
+   * C_Encrypt encrypts single-part data. The input is read from a region of the given array and the
+   * output is written to the given output array starting at the given offset. This allows to reuse
+   * the same arrays for many calls. If the output array has not enough space left, the method fails
+   * with CKR_BUFFER_TOO_SMALL and the operation remains active. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the array holding the data to get encrypted (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the data to get encrypted in pData
+   * @param dataLength
+   *          the length of the data to get encrypted (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pEncryptedData
+   *          the array receiving the encrypted data (PKCS#11 param: CK_BYTE_PTR pEncryptedData,
+   *          CK_ULONG_PTR pulEncryptedDataLen)
+   * @param encryptedDataOffset
+   *          the offset in pEncryptedData at which to start writing
+   * @return the number of bytes written to pEncryptedData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pEncryptedData <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Encrypt(long hSession, byte[] pData, int dataOffset, int dataLength,
+      byte[] pEncryptedData, int encryptedDataOffset) throws PKCS11Exception;
+
+  /**
+   * C_EncryptBatchAead encrypts many pieces of data with an AEAD mechanism (CKM_AES_GCM or
+   * CKM_AES_CCM) and the same key in one call, each with an IV and additional authenticated data of
+   * its own. The parameters of the given mechanism serve as a template: they are converted only
+   * once and for each piece of data only the IV (or nonce) and the AAD are replaced, and for CCM
+   * also the data length. For each piece of data it calls C_EncryptInit and C_Encrypt. A failing
+   * item does not stop the batch; its return value is stored in pulResults and its output is null.
+   * No encryption operation remains active in the session after this call. (Encryption and
+   * decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the AEAD mechanism with the template parameters (PKCS#11 param: CK_MECHANISM_PTR
+   *          pMechanism)
+   * @param hKey
+   *          the handle of the encryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pIvs
+   *          the IV or nonce of each piece of data; must be at least as long as pData
+   * @param pAads
+   *          the additional authenticated data of each piece of data, or null to use the one of the
+   *          template; a null element means no additional authenticated data
+   * @param pData
+   *          the pieces of data to encrypt (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_EncryptInit or C_Encrypt for each piece of data; must
+   *          be at least as long as pData
+   * @return the encrypted pieces of data in the order of pData, null for the failed items (PKCS#11
+   *         param: CK_BYTE_PTR pEncryptedData, CK_ULONG_PTR pulEncryptedDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pIvs <> null) and (pData <> null) and (pulResults <> null) and
+   *                (pIvs.length >= pData.length) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null) and (result.length == pData.length)
+   */
+  public byte[][] C_EncryptBatchAead(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pIvs, byte[][] pAads, byte[][] pData, long[] pulResults, boolean useUtf8)
+      throws PKCS11Exception;
+
+  /**
+   * C_EncryptOneShot initializes an operation with C_EncryptInit and runs it with C_Encrypt for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the encryption mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the encryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the data to get encrypted (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the encrypted data (PKCS#11 param: CK_BYTE_PTR pEncryptedData, CK_ULONG_PTR
+   *         pulEncryptedDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_EncryptOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pData, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_EncryptUpdate continues a multiple-part encryption operation. (Encryption and decryption)
    * 
@@ -538,6 +711,74 @@ public interface PKCS11 {
    */
   public byte[] C_EncryptUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
 
+  /**
+   * C_EncryptUpdate continues a multiple-part encryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part to get encrypted (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part to get encrypted in pPart
+   * @param partLength
+   *          the length of the data part to get encrypted (PKCS#11 param: CK_ULONG ulPartLen)
+   * @param pEncryptedPart
+   *          the array receiving the encrypted data part (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedPart, CK_ULONG_PTR pulEncryptedPartLen)
+   * @param encryptedPartOffset
+   *          the offset in pEncryptedPart at which to start writing
+   * @return the number of bytes written to pEncryptedPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null) and (pEncryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_EncryptUpdate(long hSession, byte[] pPart, int partOffset, int partLength,
+      byte[] pEncryptedPart, int encryptedPartOffset) throws PKCS11Exception;
+
+  /**
+   * C_EncryptUpdate continues a multiple-part encryption operation with each of the given parts in
+   * turn, in a single call. This is the same as calling C_EncryptUpdate for each part, without
+   * concatenating the parts first. The first failing part stops the loop. (Encryption and
+   * decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts to get encrypted (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @return the encrypted data of all parts, concatenated in the order of pParts (PKCS#11 param:
+   *         CK_BYTE_PTR pEncryptedPart, CK_ULONG_PTR pulEncryptedPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_EncryptUpdate(long hSession, byte[][] pParts) throws PKCS11Exception;
+
+  /**
+   * C_EncryptUpdate continues a multiple-part encryption operation with the remaining data of each
+   * of the given direct buffers in turn, in a single call. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of each buffer is set
+   * to its limit. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts to get encrypted (PKCS#11 param: CK_BYTE_PTR
+   *          pPart, CK_ULONG ulPartLen)
+   * @return the encrypted data of all parts, concatenated in the order of pParts (PKCS#11 param:
+   *         CK_BYTE_PTR pEncryptedPart, CK_ULONG_PTR pulEncryptedPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * @postconditions (result <> null)
+   */
+  public byte[] C_EncryptUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception;
+
   /**
    * C_EncryptFinal finishes a multiple-part encryption operation. (Encryption and decryption)
    * 
@@ -552,6 +793,29 @@ public interface PKCS11 {
    */
   public byte[] C_EncryptFinal(long hSession) throws PKCS11Exception;
 
+  /**
+   * C_EncryptFinal finishes a multiple-part encryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pLastEncryptedPart
+   *          the array receiving the last encrypted data part (PKCS#11 param: CK_BYTE_PTR
+   *          pLastEncryptedPart, CK_ULONG_PTR pulLastEncryptedPartLen)
+   * @param lastEncryptedPartOffset
+   *          the offset in pLastEncryptedPart at which to start writing
+   * @return the number of bytes written to pLastEncryptedPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pLastEncryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_EncryptFinal(long hSession, byte[] pLastEncryptedPart,
+      int lastEncryptedPartOffset) throws PKCS11Exception;
+
   /**
    * C_DecryptInit initializes a decryption operation. (Encryption and decryption)
    * 
@@ -584,6 +848,127 @@ public interface PKCS11 {
    */
   public byte[] C_Decrypt(long hSession, byte[] pEncryptedData) throws PKCS11Exception;
 
+  /**
+   * C_Decrypt decrypts encrypted data. The data is passed in direct buffers which are handed to the
+   * module as they are, without copying the data to or from the Java heap. The module reads the
+   * remaining bytes of pEncryptedData and writes the decrypted data to the remaining space of
+   * pData. On success, the position of pEncryptedData is set to its limit and the position of pData
+   * is advanced by the number of bytes written. If pData has not enough space left, the method
+   * fails with CKR_BUFFER_TOO_SMALL, the positions stay unchanged and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pEncryptedData
+   *          the direct buffer holding the encrypted data to get decrypted (PKCS#11 param:
+   *          CK_BYTE_PTR pEncryptedData, CK_ULONG ulEncryptedDataLen)
+   * @param pData
+   *          the direct buffer receiving the decrypted data (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG_PTR pulDataLen)
+   * @return the number of bytes written to pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pEncryptedData <> null) and (pData <> null) and pEncryptedData.isDirect() and
+   * pData.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Decrypt(long hSession, ByteBuffer pEncryptedData, ByteBuffer pData)
+      throws PKCS11Exception;
+
+  /**
+   * C_Decrypt decrypts encrypted data. The input is read from a region of the given array and the
+   * output is written to the given output array starting at the given offset. This allows to reuse
+   * the same arrays for many calls. If the output array has not enough space left, the method fails
+   * with CKR_BUFFER_TOO_SMALL and the operation remains active. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pEncryptedData
+   *          the array holding the encrypted data to get decrypted (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedData)
+   * @param encryptedDataOffset
+   *          the offset of the encrypted data to get decrypted in pEncryptedData
+   * @param encryptedDataLength
+   *          the length of the encrypted data to get decrypted (PKCS#11 param: CK_ULONG
+   *          ulEncryptedDataLen)
+   * @param pData
+   *          the array receiving the decrypted data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG_PTR
+   *          pulDataLen)
+   * @param dataOffset
+   *          the offset in pData at which to start writing
+   * @return the number of bytes written to pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pEncryptedData <> null) and (pData <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Decrypt(long hSession, byte[] pEncryptedData, int encryptedDataOffset,
+      int encryptedDataLength, byte[] pData, int dataOffset) throws PKCS11Exception;
+
+  /**
+   * C_DecryptBatchAead decrypts many pieces of data with an AEAD mechanism (CKM_AES_GCM or
+   * CKM_AES_CCM) and the same key in one call, each with an IV and additional authenticated data of
+   * its own. The parameters of the given mechanism serve as a template: they are converted only
+   * once and for each piece of data only the IV (or nonce) and the AAD are replaced, and for CCM
+   * also the data length. For each piece of data it calls C_DecryptInit and C_Decrypt. A failing
+   * item does not stop the batch; its return value is stored in pulResults and its output is null.
+   * No decryption operation remains active in the session after this call. (Encryption and
+   * decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the AEAD mechanism with the template parameters (PKCS#11 param: CK_MECHANISM_PTR
+   *          pMechanism)
+   * @param hKey
+   *          the handle of the decryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pIvs
+   *          the IV or nonce of each piece of data; must be at least as long as pEncryptedData
+   * @param pAads
+   *          the additional authenticated data of each piece of data, or null to use the one of the
+   *          template; a null element means no additional authenticated data
+   * @param pEncryptedData
+   *          the pieces of encrypted data, each with its tag (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedData, CK_ULONG ulEncryptedDataLen)
+   * @param pulResults
+   *          receives the return value of C_DecryptInit or C_Decrypt for each piece of data; must
+   *          be at least as long as pEncryptedData
+   * @return the decrypted pieces of data in the order of pEncryptedData, null for the failed items
+   *         (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG_PTR pulDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pIvs <> null) and (pEncryptedData <> null) and (pulResults <> null) and
+   *                (pIvs.length >= pEncryptedData.length) and
+   *                (pulResults.length >= pEncryptedData.length)
+   * @postconditions (result <> null) and (result.length == pEncryptedData.length)
+   */
+  public byte[][] C_DecryptBatchAead(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pIvs, byte[][] pAads, byte[][] pEncryptedData, long[] pulResults, boolean useUtf8)
+      throws PKCS11Exception;
+
+  /**
+   * C_DecryptOneShot initializes an operation with C_DecryptInit and runs it with C_Decrypt for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the decryption mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the decryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pEncryptedData
+   *          the encrypted data to get decrypted (PKCS#11 param: CK_BYTE_PTR pEncryptedData,
+   *          CK_ULONG ulEncryptedDataLen)
+   * @return the decrypted data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG_PTR pulDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pEncryptedData <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_DecryptOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pEncryptedData, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_DecryptUpdate continues a multiple-part decryption operation. (Encryption and decryption)
    * 
@@ -602,6 +987,37 @@ public interface PKCS11 {
   public byte[] C_DecryptUpdate(long hSession, byte[] pEncryptedPart)
       throws PKCS11Exception;
 
+  /**
+   * C_DecryptUpdate continues a multiple-part decryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pEncryptedPart
+   *          the array holding the encrypted data part to get decrypted (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedPart)
+   * @param encryptedPartOffset
+   *          the offset of the encrypted data part to get decrypted in pEncryptedPart
+   * @param encryptedPartLength
+   *          the length of the encrypted data part to get decrypted (PKCS#11 param: CK_ULONG
+   *          ulEncryptedPartLen)
+   * @param pPart
+   *          the array receiving the decrypted data part (PKCS#11 param: CK_BYTE_PTR pPart,
+   *          CK_ULONG_PTR pulPartLen)
+   * @param partOffset
+   *          the offset in pPart at which to start writing
+   * @return the number of bytes written to pPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pEncryptedPart <> null) and (pPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_DecryptUpdate(long hSession, byte[] pEncryptedPart, int encryptedPartOffset,
+      int encryptedPartLength, byte[] pPart, int partOffset) throws PKCS11Exception;
+
   /**
    * C_DecryptFinal finishes a multiple-part decryption operation. (Encryption and decryption)
    * 
@@ -616,6 +1032,29 @@ public interface PKCS11 {
    */
   public byte[] C_DecryptFinal(long hSession) throws PKCS11Exception;
 
+  /**
+   * C_DecryptFinal finishes a multiple-part decryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pLastPart
+   *          the array receiving the last decrypted data part (PKCS#11 param: CK_BYTE_PTR
+   *          pLastPart, CK_ULONG_PTR pulLastPartLen)
+   * @param lastPartOffset
+   *          the offset in pLastPart at which to start writing
+   * @return the number of bytes written to pLastPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pLastPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_DecryptFinal(long hSession, byte[] pLastPart,
+      int lastPartOffset) throws PKCS11Exception;
+
   /*
    * *****************************************************************************
    * Message digesting****************************************************************************
@@ -651,6 +1090,107 @@ public interface PKCS11 {
    */
   public byte[] C_Digest(long hSession, byte[] data) throws PKCS11Exception;
 
+  /**
+   * C_Digest digests data in a single part. The data is passed in direct buffers which are handed
+   * to the module as they are, without copying the data to or from the Java heap. The module reads
+   * the remaining bytes of data and writes the message digest to the remaining space of digest. On
+   * success, the position of data is set to its limit and the position of digest is advanced by the
+   * number of bytes written. If digest has not enough space left, the method fails with
+   * CKR_BUFFER_TOO_SMALL, the positions stay unchanged and the operation remains active. (Message
+   * digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param data
+   *          the direct buffer holding the data to get digested (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG ulDataLen)
+   * @param digest
+   *          the direct buffer receiving the message digest (PKCS#11 param: CK_BYTE_PTR pDigest,
+   *          CK_ULONG_PTR pulDigestLen)
+   * @return the number of bytes written to digest
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (data <> null) and (digest <> null) and data.isDirect() and digest.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Digest(long hSession, ByteBuffer data, ByteBuffer digest)
+      throws PKCS11Exception;
+
+  /**
+   * C_Digest digests data in a single part. The input is read from a region of the given array and
+   * the output is written to the given output array starting at the given offset. This allows to
+   * reuse the same arrays for many calls. If the output array has not enough space left, the method
+   * fails with CKR_BUFFER_TOO_SMALL and the operation remains active. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the array holding the data to get digested (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the data to get digested in pData
+   * @param dataLength
+   *          the length of the data to get digested (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pDigest
+   *          the array receiving the message digest (PKCS#11 param: CK_BYTE_PTR pDigest,
+   *          CK_ULONG_PTR pulDigestLen)
+   * @param digestOffset
+   *          the offset in pDigest at which to start writing
+   * @return the number of bytes written to pDigest
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pDigest <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Digest(long hSession, byte[] pData, int dataOffset, int dataLength, byte[] pDigest,
+      int digestOffset) throws PKCS11Exception;
+
+  /**
+   * C_DigestBatch digests many pieces of data with the same mechanism in one call. For each piece
+   * of data it calls C_DigestInit and C_Digest, but the mechanism is converted only once. The
+   * digests are packed into the returned array with a slot of the same size for each piece of data,
+   * in the order of pData. A failing item does not stop the batch; its return value is stored in
+   * pulResults and its slot is zeroed. No digest operation remains active in the session after
+   * this call. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the digesting mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param pData
+   *          the pieces of data to digest (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_DigestInit or C_Digest for each piece of data; must be
+   *          at least as long as pData
+   * @return the packed digests; the slot size is the length divided by pData.length (PKCS#11
+   *         param: CK_BYTE_PTR pDigest, CK_ULONG_PTR pulDigestLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pulResults <> null) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_DigestBatch(long hSession, CK_MECHANISM pMechanism, byte[][] pData,
+      long[] pulResults, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_DigestOneShot initializes an operation with C_DigestInit and runs it with C_Digest for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the digesting mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param pData
+   *          the data to get digested (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the message digest (PKCS#11 param: CK_BYTE_PTR pDigest, CK_ULONG_PTR pulDigestLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_DigestOneShot(long hSession, CK_MECHANISM pMechanism, byte[] pData,
+      boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_DigestUpdate continues a multiple-part message-digesting operation. (Message digesting)
    * 
@@ -666,6 +1206,62 @@ public interface PKCS11 {
    */
   public void C_DigestUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
 
+  /**
+   * C_DigestUpdate continues a multiple-part message-digesting operation with a region of the
+   * given array. This allows to feed parts of a larger buffer without copying them into arrays
+   * of their own. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part in pPart
+   * @param partLength
+   *          the length of the data part (PKCS#11 param: CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null)
+   * 
+   */
+  public void C_DigestUpdate(long hSession, byte[] pPart, int partOffset, int partLength)
+      throws PKCS11Exception;
+
+  /**
+   * C_DigestUpdate continues a multiple-part message-digesting operation with each of the given
+   * parts in turn, in a single call. This is the same as calling C_DigestUpdate for each part,
+   * without concatenating the parts first. The first failing part stops the loop. (Message
+   * digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts to get digested (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * 
+   */
+  public void C_DigestUpdate(long hSession, byte[][] pParts) throws PKCS11Exception;
+
+  /**
+   * C_DigestUpdate continues a multiple-part message-digesting operation with the remaining data of
+   * each of the given direct buffers in turn, in a single call. The buffers are handed to the
+   * module without copying their contents to the Java heap. On success, the position of each buffer
+   * is set to its limit. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts to get digested (PKCS#11 param: CK_BYTE_PTR
+   *          pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * 
+   */
+  public void C_DigestUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception;
+
   /**
    * C_DigestKey continues a multi-part message-digesting operation, by digesting the value of a
    * secret key as part of the data already digested. (Message digesting)
@@ -734,6 +1330,143 @@ public interface PKCS11 {
    */
   public byte[] C_Sign(long hSession, byte[] pData) throws PKCS11Exception;
 
+  /**
+   * C_Sign signs (encrypts with private key) data in a single part, where the signature is (will
+   * be) an appendix to the data, and plaintext cannot be recovered from the signature. The data is
+   * passed in direct buffers which are handed to the module as they are, without copying the data
+   * to or from the Java heap. The module reads the remaining bytes of pData and writes the
+   * signature to the remaining space of pSignature. On success, the position of pData is set to its
+   * limit and the position of pSignature is advanced by the number of bytes written. If pSignature
+   * has not enough space left, the method fails with CKR_BUFFER_TOO_SMALL, the positions stay
+   * unchanged and the operation remains active. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the direct buffer holding the data to get signed (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the direct buffer receiving the signature (PKCS#11 param: CK_BYTE_PTR pSignature,
+   *          CK_ULONG_PTR pulSignatureLen)
+   * @return the number of bytes written to pSignature
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null) and pData.isDirect() and
+   * pSignature.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Sign(long hSession, ByteBuffer pData, ByteBuffer pSignature)
+      throws PKCS11Exception;
+
+  /**
+   * C_Sign signs (encrypts with private key) data in a single part, where the signature is (will
+   * be) an appendix to the data, and plaintext cannot be recovered from the signature. The input is
+   * read from a region of the given array and the output is written to the given output array
+   * starting at the given offset. This allows to reuse the same arrays for many calls. If the
+   * output array has not enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the
+   * operation remains active. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the array holding the data to get signed (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the data to get signed in pData
+   * @param dataLength
+   *          the length of the data to get signed (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the array receiving the signature (PKCS#11 param: CK_BYTE_PTR pSignature, CK_ULONG_PTR
+   *          pulSignatureLen)
+   * @param signatureOffset
+   *          the offset in pSignature at which to start writing
+   * @return the number of bytes written to pSignature
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Sign(long hSession, byte[] pData, int dataOffset, int dataLength, byte[] pSignature,
+      int signatureOffset) throws PKCS11Exception;
+
+  /**
+   * C_SignBatch signs many pieces of data with the same mechanism and key in one call. For each
+   * piece of data it calls C_SignInit and C_Sign, but the mechanism is converted only once. A
+   * failing item does not stop the batch; its return value is stored in pulResults and its
+   * signature is null. No signature operation remains active in the session after this call.
+   * (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the signature mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the signature key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the pieces of data to sign (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_SignInit or C_Sign for each piece of data; must be at
+   *          least as long as pData
+   * @return the signatures in the order of pData, null for the failed items (PKCS#11 param:
+   *         CK_BYTE_PTR pSignature, CK_ULONG_PTR pulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pulResults <> null) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null) and (result.length == pData.length)
+   */
+  public byte[][] C_SignBatch(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pData, long[] pulResults, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_SignBatchPacked signs many pieces of data with the same mechanism and key in one call, like
+   * C_SignBatch, but packs the signatures into the returned array with a slot of the same size for
+   * each piece of data, in the order of pData. This fits MACs and other signatures of a fixed
+   * length. A failing item does not stop the batch; its return value is stored in pulResults and
+   * its slot is zeroed. No signature operation remains active in the session after this call.
+   * (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the signature mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the signature key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the pieces of data to sign (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_SignInit or C_Sign for each piece of data; must be at
+   *          least as long as pData
+   * @return the packed signatures; the slot size is the length divided by pData.length (PKCS#11
+   *         param: CK_BYTE_PTR pSignature, CK_ULONG_PTR pulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pulResults <> null) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_SignBatchPacked(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pData, long[] pulResults, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_SignOneShot initializes an operation with C_SignInit and runs it with C_Sign for the given
+   * data in a single call. A failure of either step leaves no operation active in the session.
+   * (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the signature mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the signature key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the data to sign (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the signature (PKCS#11 param: CK_BYTE_PTR pSignature, CK_ULONG_PTR pulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_SignOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pData, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_SignUpdate continues a multiple-part signature operation, where the signature is (will be) an
    * appendix to the data, and plaintext cannot be recovered from the signature. (Signing and
@@ -751,6 +1484,61 @@ public interface PKCS11 {
    */
   public void C_SignUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
 
+  /**
+   * C_SignUpdate continues a multiple-part signature operation with a region of the
+   * given array. This allows to feed parts of a larger buffer without copying them into arrays
+   * of their own. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part in pPart
+   * @param partLength
+   *          the length of the data part (PKCS#11 param: CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null)
+   * 
+   */
+  public void C_SignUpdate(long hSession, byte[] pPart, int partOffset, int partLength)
+      throws PKCS11Exception;
+
+  /**
+   * C_SignUpdate continues a multiple-part signature operation with each of the given parts in
+   * turn, in a single call. This is the same as calling C_SignUpdate for each part, without
+   * concatenating the parts first. The first failing part stops the loop. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts to get signed (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * 
+   */
+  public void C_SignUpdate(long hSession, byte[][] pParts) throws PKCS11Exception;
+
+  /**
+   * C_SignUpdate continues a multiple-part signature operation with the remaining data of each of
+   * the given direct buffers in turn, in a single call. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of each buffer is set
+   * to its limit. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts to get signed (PKCS#11 param: CK_BYTE_PTR
+   *          pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * 
+   */
+  public void C_SignUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception;
+
   /**
    * C_SignFinal finishes a multiple-part signature operation, returning the signature. (Signing and
    * MACing)
@@ -843,6 +1631,108 @@ public interface PKCS11 {
   public void C_Verify(long hSession, byte[] pData, byte[] pSignature)
       throws PKCS11Exception;
 
+  /**
+   * C_Verify verifies a signature in a single-part operation, where the data and the signature are
+   * read from regions of the given arrays. This allows to verify a signature that is stored in the
+   * same buffer as the signed data without copying either of them. (Verifying signatures and MACs)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the array holding the signed data (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the signed data in pData
+   * @param dataLength
+   *          the length of the signed data (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the array holding the signature to verify (PKCS#11 param: CK_BYTE_PTR pSignature)
+   * @param signatureOffset
+   *          the offset of the signature in pSignature
+   * @param signatureLength
+   *          the length of the signature (PKCS#11 param: CK_ULONG ulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null)
+   * 
+   */
+  public void C_Verify(long hSession, byte[] pData, int dataOffset, int dataLength,
+      byte[] pSignature, int signatureOffset, int signatureLength) throws PKCS11Exception;
+
+  /**
+   * C_Verify verifies a signature in a single-part operation, where the signature is an appendix to
+   * the data. The data and the signature are passed in direct buffers which are handed to the
+   * module as they are, without copying them to the Java heap. The module reads the remaining bytes
+   * of both buffers. On success, the positions of both buffers are set to their limits. (Signing
+   * and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the direct buffer holding the signed data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG
+   *          ulDataLen)
+   * @param pSignature
+   *          the direct buffer holding the signature to verify (PKCS#11 param: CK_BYTE_PTR
+   *          pSignature, CK_ULONG ulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null) and pData.isDirect() and
+   * pSignature.isDirect()
+   * 
+   */
+  public void C_Verify(long hSession, ByteBuffer pData, ByteBuffer pSignature)
+      throws PKCS11Exception;
+
+  /**
+   * C_VerifyBatch verifies many signatures with the same mechanism and key in one call. For each
+   * pair of data and signature it calls C_VerifyInit and C_Verify, but the mechanism is converted
+   * only once. Instead of throwing an exception, the return value of each verification is stored
+   * in the returned array; CKR_OK means the signature is valid. No verification operation remains
+   * active in the session after this call. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the verification mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the verification key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the signed pieces of data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the signatures to verify, one for each piece of data (PKCS#11 param: CK_BYTE_PTR
+   *          pSignature, CK_ULONG ulSignatureLen)
+   * @return the return value of C_VerifyInit or C_Verify for each pair in the order of pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null) and (pData.length == pSignature.length)
+   * @postconditions (result <> null) and (result.length == pData.length)
+   */
+  public long[] C_VerifyBatch(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pData, byte[][] pSignature, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_VerifyOneShot initializes an operation with C_VerifyInit and runs it with C_Verify for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the verification mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the verification key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the signed data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the signature to verify (PKCS#11 param: CK_BYTE_PTR pSignature, CK_ULONG
+   *          ulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null) and (pSignature <> null)
+   * 
+   */
+  public void C_VerifyOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pData, byte[] pSignature, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_VerifyUpdate continues a multiple-part verification operation, where the signature is an
    * appendix to the data, and plaintext cannot be recovered from the signature. (Signing and
@@ -860,6 +1750,62 @@ public interface PKCS11 {
    */
   public void C_VerifyUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
 
+  /**
+   * C_VerifyUpdate continues a multiple-part verification operation with a region of the
+   * given array. This allows to feed parts of a larger buffer without copying them into arrays
+   * of their own. (Verifying signatures and MACs)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part in pPart
+   * @param partLength
+   *          the length of the data part (PKCS#11 param: CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null)
+   * 
+   */
+  public void C_VerifyUpdate(long hSession, byte[] pPart, int partOffset, int partLength)
+      throws PKCS11Exception;
+
+  /**
+   * C_VerifyUpdate continues a multiple-part verification operation with each of the given parts in
+   * turn, in a single call. This is the same as calling C_VerifyUpdate for each part, without
+   * concatenating the parts first. The first failing part stops the loop. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts of the signed data (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG
+   *          ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * 
+   */
+  public void C_VerifyUpdate(long hSession, byte[][] pParts) throws PKCS11Exception;
+
+  /**
+   * C_VerifyUpdate continues a multiple-part verification operation with the remaining data of each
+   * of the given direct buffers in turn, in a single call. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of each buffer is set
+   * to its limit. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts of the signed data (PKCS#11 param:
+   *          CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * 
+   */
+  public void C_VerifyUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception;
+
   /**
    * C_VerifyFinal finishes a multiple-part verification operation, checking the signature. (Signing
    * and MACing)
@@ -1192,6 +2138,109 @@ public interface PKCS11 {
    */
   public long C_WaitForSlotEvent(long flags, Object pReserved) throws PKCS11Exception;
 
+  /*
+   * *****************************************************************************
+   * Functions of the native worker pool, which runs operations on native threads
+   * ****************************************************************************
+   */
+
+  /**
+   * C_WorkerPoolCreate starts a native thread for each of the given sessions. Each thread runs the
+   * requests submitted with C_WorkerPoolSubmit in whole operations with its session, and provides
+   * the results for C_WorkerPoolPoll. The sessions must stay open, until the pool is destroyed with
+   * C_WorkerPoolDestroy; the application must not use them in the meantime.
+   * 
+   * @param phSessions
+   *          the handles of the sessions, one for each thread
+   * @param capacity
+   *          the maximum number of requests submitted, whose results were not polled yet
+   * @return the native handle of the pool
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (phSessions <> null) and (phSessions.length > 0) and (capacity > 0)
+   * @postconditions (result <> 0)
+   */
+  public long C_WorkerPoolCreate(long[] phSessions, int capacity) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolSubmit submits requests to run the same operation with the same mechanism and key
+   * for many pieces of data. It never blocks; it accepts as many requests, from the first on, as
+   * fit into the capacity of the pool. Each request runs in a single call like C_SignOneShot.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @param operation
+   *          the operation; one of the constants of iaik.pkcs.pkcs11.NativeWorkerPool
+   * @param pMechanism
+   *          the mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the key, ignored for digesting (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pIds
+   *          the ids of the requests, which are returned with their results; must be at least as
+   *          long as pData
+   * @param pData
+   *          the input of each request (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the number of accepted requests
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pIds <> null) and (pData <> null)
+   *                and (pIds.length >= pData.length)
+   * @postconditions (0 <= result <= pData.length)
+   */
+  public int C_WorkerPoolSubmit(long hPool, int operation, CK_MECHANISM pMechanism, long hKey,
+      long[] pIds, byte[][] pData, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolPoll takes the results of finished requests, as many as pIds can hold. If there is
+   * none, it waits for the first one up to the given timeout, unless no request is in flight or
+   * the pool is stopped meanwhile.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @param pIds
+   *          receives the id of each result
+   * @param pulResults
+   *          receives the return value of each result; must be at least as long as pIds
+   * @param pOutputs
+   *          receives the output of each result, null for a failed request; must be at least as
+   *          long as pIds
+   * @param timeout
+   *          the milliseconds to wait for the first result; 0 not to wait, a negative value to wait
+   *          as long as it takes
+   * @return the number of results
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pIds <> null) and (pulResults <> null) and (pOutputs <> null)
+   * @postconditions (0 <= result <= pIds.length)
+   */
+  public int C_WorkerPoolPoll(long hPool, long[] pIds, long[] pulResults, byte[][] pOutputs,
+      long timeout) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolStop makes the pool stop. Waiting and later calls of C_WorkerPoolPoll return at
+   * once, and C_WorkerPoolSubmit accepts no more requests. The pool stays allocated; so calls,
+   * which are still running, may complete safely, before the pool is destroyed with
+   * C_WorkerPoolDestroy.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  public void C_WorkerPoolStop(long hPool) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolDestroy stops the threads of the pool and frees it with all requests and results,
+   * which were not polled yet. No other call may use the pool at the same time or afterwards. The
+   * sessions stay open.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  public void C_WorkerPoolDestroy(long hPool) throws PKCS11Exception;
+
   /**
    * This method can be used to cleanup this object. Made public to enable explicit cleanup, because
    * garbage collection using System.gc() does not always collect the free object immediately.
@@ -44,6 +44,8 @@ package iaik.pkcs.pkcs11.wrapper;
 
 import java.io.File;
 import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
 
 /**
  * This is the default implementation of the PKCS11 interface. It connects to the
@@ -76,6 +78,13 @@ public class PKCS11Implementation implements PKCS11 {
    */
   protected String pkcs11ModulePath_;
 
+  /**
+   * The handle of the native data of the connected PKCS#11 module. It is set by
+   * <code>connect</code> and cleared by <code>disconnect</code>. It is only used by the native
+   * part of the wrapper; 0, if not connected.
+   */
+  private long moduleHandle_;
+
   /**
    * This method does the initialization of the native library. It is called exactly once for this
    * class.
@@ -616,6 +625,38 @@ public class PKCS11Implementation implements PKCS11 {
   public native void C_GetAttributeValue(long hSession, long hObject,
       CK_ATTRIBUTE[] pTemplate, boolean useUtf8) throws PKCS11Exception;
 
+  /**
+   * C_GetAttributeValueBulk obtains the values of the same attributes of many objects in one call.
+   * For each object it calls C_GetAttributeValue with buffers of the usual estimated size; an
+   * attribute that does not fit or fails is read again on its own, so that each value gets a return
+   * value of its own, like CKR_ATTRIBUTE_SENSITIVE or CKR_ATTRIBUTE_TYPE_INVALID. A failing value
+   * or object does not stop the call. The values are packed into the returned array in the order
+   * of the objects and, for each object, in the order of the attribute types. Values of type
+   * CK_ULONG and the elements of CKA_ALLOWED_MECHANISMS are stored as 8 byte big-endian numbers;
+   * all other values as the module returns them. Array attributes like CKA_WRAP_TEMPLATE are not
+   * supported. (Object management)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param hObjects
+   *          the handles of the objects to read (PKCS#11 param: CK_OBJECT_HANDLE hObject)
+   * @param attributeTypes
+   *          the types of the attributes to read of each object (PKCS#11 param: CK_ATTRIBUTE_PTR
+   *          pTemplate, CK_ULONG ulCount)
+   * @param pulCells
+   *          receives the offset in the returned array, the length and the return value of each
+   *          value; the cell of attribute j of object i starts at index 3 * (i *
+   *          attributeTypes.length + j)
+   * @return the packed values
+   * @exception PKCS11Exception
+   *              If the call could not be run at all.
+   * @preconditions (hObjects <> null) and (attributeTypes <> null) and (pulCells <> null) and
+   *                (pulCells.length >= 3 * hObjects.length * attributeTypes.length)
+   * @postconditions (result <> null)
+   */
+  public native byte[] C_GetAttributeValueBulk(long hSession, long[] hObjects,
+      long[] attributeTypes, long[] pulCells) throws PKCS11Exception;
+
   /**
    * C_SetAttributeValue modifies the value of one or more object attributes (Object management)
    * 
@@ -667,6 +708,28 @@ public class PKCS11Implementation implements PKCS11 {
   public native long[] C_FindObjects(long hSession, long ulMaxObjectCount)
       throws PKCS11Exception;
 
+  /**
+   * C_FindObjects continues a search for token and session objects that match a template, obtaining
+   * additional object handles. In contrast to C_FindObjects, it writes the handles to an array of
+   * the caller, which can be reused for all calls of a search. (Object management)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param phObject
+   *          receives the object's handles; must hold at least ulMaxObjectCount handles (PKCS#11
+   *          param: CK_OBJECT_HANDLE_PTR phObject)
+   * @param ulMaxObjectCount
+   *          the max. object handles to get (PKCS#11 param: CK_ULONG ulMaxObjectCount)
+   * @return the actual number of objects returned (PKCS#11 param: CK_ULONG_PTR pulObjectCount)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * 
+   * @preconditions (phObject <> null) and (0 <= ulMaxObjectCount <= phObject.length)
+   * @postconditions (0 <= result <= ulMaxObjectCount)
+   */
+  public native int C_FindObjectsInto(long hSession, long[] phObject, int ulMaxObjectCount)
+      throws PKCS11Exception;
+
   /**
    * C_FindObjectsFinal finishes a search for token and session objects. (Object management)
    * 
@@ -715,6 +778,160 @@ public class PKCS11Implementation implements PKCS11 {
    */
   public native byte[] C_Encrypt(long hSession, byte[] pData) throws PKCS11Exception;
 
+  /**
+   * C_Encrypt encrypts single-part data. The data is passed in direct buffers which are handed to
+   * the module as they are, without copying the data to or from the Java heap. The module reads the
+   * remaining bytes of pData and writes the encrypted data to the remaining space of
+   * pEncryptedData. On success, the position of pData is set to its limit and the position of
+   * pEncryptedData is advanced by the number of bytes written. If pEncryptedData has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL, the positions stay unchanged and the
+   * operation remains active. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the direct buffer holding the data to get encrypted (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG ulDataLen)
+   * @param pEncryptedData
+   *          the direct buffer receiving the encrypted data (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedData, CK_ULONG_PTR pulEncryptedDataLen)
+   * @return the number of bytes written to pEncryptedData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pEncryptedData <> null) and pData.isDirect() and
+   * pEncryptedData.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Encrypt(long hSession, ByteBuffer pData, ByteBuffer pEncryptedData)
+      throws PKCS11Exception {
+    checkDirectBuffer(pData, "pData", false);
+    checkDirectBuffer(pEncryptedData, "pEncryptedData", true);
+    int written = C_EncryptDirect(hSession, pData, pData.position(), pData.remaining(),
+        pEncryptedData, pEncryptedData.position(), pEncryptedData.remaining());
+    pData.position(pData.limit());
+    pEncryptedData.position(pEncryptedData.position() + written);
+
+    return written;
+  }
+
+  /**
+   * Calls C_Encrypt with the given regions of two direct buffers.
+   * 
+   * @return the number of bytes written to pEncryptedData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_EncryptDirect(long hSession, ByteBuffer pData, int pDataOffset,
+      int pDataLength, ByteBuffer pEncryptedData, int pEncryptedDataOffset,
+      int pEncryptedDataLength) throws PKCS11Exception;
+
+  /**
+   * C_Encrypt encrypts single-part data. The input is read from a region of the given array and the
+   * output is written to the given output array starting at the given offset. This allows to reuse
+   * the same arrays for many calls. If the output array has not enough space left, the method fails
+   * with CKR_BUFFER_TOO_SMALL and the operation remains active. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the array holding the data to get encrypted (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the data to get encrypted in pData
+   * @param dataLength
+   *          the length of the data to get encrypted (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pEncryptedData
+   *          the array receiving the encrypted data (PKCS#11 param: CK_BYTE_PTR pEncryptedData,
+   *          CK_ULONG_PTR pulEncryptedDataLen)
+   * @param encryptedDataOffset
+   *          the offset in pEncryptedData at which to start writing
+   * @return the number of bytes written to pEncryptedData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pEncryptedData <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Encrypt(long hSession, byte[] pData, int dataOffset, int dataLength,
+      byte[] pEncryptedData, int encryptedDataOffset) throws PKCS11Exception {
+    checkArrayRegion(pData, "pData", dataOffset, dataLength);
+    checkArrayRegion(pEncryptedData, "pEncryptedData", encryptedDataOffset, 0);
+    return C_EncryptRegion(hSession, pData, dataOffset, dataLength, pEncryptedData,
+        encryptedDataOffset, pEncryptedData.length - encryptedDataOffset);
+  }
+
+  /**
+   * Calls C_Encrypt with a region of the given input array and writes the output to a region of the
+   * given output array.
+   * 
+   * @return the number of bytes written to pEncryptedData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_EncryptRegion(long hSession, byte[] pData, int dataOffset, int dataLength,
+      byte[] pEncryptedData, int encryptedDataOffset,
+      int encryptedDataLength) throws PKCS11Exception;
+
+  /**
+   * C_EncryptBatchAead encrypts many pieces of data with an AEAD mechanism (CKM_AES_GCM or
+   * CKM_AES_CCM) and the same key in one call, each with an IV and additional authenticated data of
+   * its own. The parameters of the given mechanism serve as a template: they are converted only
+   * once and for each piece of data only the IV (or nonce) and the AAD are replaced, and for CCM
+   * also the data length. For each piece of data it calls C_EncryptInit and C_Encrypt. A failing
+   * item does not stop the batch; its return value is stored in pulResults and its output is null.
+   * No encryption operation remains active in the session after this call. (Encryption and
+   * decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the AEAD mechanism with the template parameters (PKCS#11 param: CK_MECHANISM_PTR
+   *          pMechanism)
+   * @param hKey
+   *          the handle of the encryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pIvs
+   *          the IV or nonce of each piece of data; must be at least as long as pData
+   * @param pAads
+   *          the additional authenticated data of each piece of data, or null to use the one of the
+   *          template; a null element means no additional authenticated data
+   * @param pData
+   *          the pieces of data to encrypt (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_EncryptInit or C_Encrypt for each piece of data; must
+   *          be at least as long as pData
+   * @return the encrypted pieces of data in the order of pData, null for the failed items (PKCS#11
+   *         param: CK_BYTE_PTR pEncryptedData, CK_ULONG_PTR pulEncryptedDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pIvs <> null) and (pData <> null) and (pulResults <> null) and
+   *                (pIvs.length >= pData.length) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null) and (result.length == pData.length)
+   */
+  public native byte[][] C_EncryptBatchAead(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pIvs, byte[][] pAads, byte[][] pData, long[] pulResults, boolean useUtf8)
+      throws PKCS11Exception;
+
+  /**
+   * C_EncryptOneShot initializes an operation with C_EncryptInit and runs it with C_Encrypt for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the encryption mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the encryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the data to get encrypted (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the encrypted data (PKCS#11 param: CK_BYTE_PTR pEncryptedData, CK_ULONG_PTR
+   *         pulEncryptedDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null)
+   * @postconditions (result <> null)
+   */
+  public native byte[] C_EncryptOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pData, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_EncryptUpdate continues a multiple-part encryption operation. (Encryption and decryption)
    * 
@@ -733,6 +950,122 @@ public class PKCS11Implementation implements PKCS11 {
   public native byte[] C_EncryptUpdate(long hSession, byte[] pPart)
       throws PKCS11Exception;
 
+  /**
+   * C_EncryptUpdate continues a multiple-part encryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part to get encrypted (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part to get encrypted in pPart
+   * @param partLength
+   *          the length of the data part to get encrypted (PKCS#11 param: CK_ULONG ulPartLen)
+   * @param pEncryptedPart
+   *          the array receiving the encrypted data part (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedPart, CK_ULONG_PTR pulEncryptedPartLen)
+   * @param encryptedPartOffset
+   *          the offset in pEncryptedPart at which to start writing
+   * @return the number of bytes written to pEncryptedPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null) and (pEncryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_EncryptUpdate(long hSession, byte[] pPart, int partOffset, int partLength,
+      byte[] pEncryptedPart, int encryptedPartOffset) throws PKCS11Exception {
+    checkArrayRegion(pPart, "pPart", partOffset, partLength);
+    checkArrayRegion(pEncryptedPart, "pEncryptedPart", encryptedPartOffset, 0);
+    return C_EncryptUpdateRegion(hSession, pPart, partOffset, partLength, pEncryptedPart,
+        encryptedPartOffset, pEncryptedPart.length - encryptedPartOffset);
+  }
+
+  /**
+   * Calls C_EncryptUpdate with a region of the given input array and writes the output to a region
+   * of the given output array.
+   * 
+   * @return the number of bytes written to pEncryptedPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_EncryptUpdateRegion(long hSession, byte[] pPart, int partOffset,
+      int partLength, byte[] pEncryptedPart, int encryptedPartOffset,
+      int encryptedPartLength) throws PKCS11Exception;
+
+  /**
+   * C_EncryptUpdate continues a multiple-part encryption operation with each of the given parts in
+   * turn, in a single call. This is the same as calling C_EncryptUpdate for each part, without
+   * concatenating the parts first. The first failing part stops the loop. (Encryption and
+   * decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts to get encrypted (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @return the encrypted data of all parts, concatenated in the order of pParts (PKCS#11 param:
+   *         CK_BYTE_PTR pEncryptedPart, CK_ULONG_PTR pulEncryptedPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * @postconditions (result <> null)
+   */
+  public byte[] C_EncryptUpdate(long hSession, byte[][] pParts) throws PKCS11Exception {
+    if (pParts == null) {
+      throw new NullPointerException("Argument \"pParts\" must not be null.");
+    }
+    return C_EncryptUpdateVector(hSession, pParts);
+  }
+
+  /**
+   * Calls C_EncryptUpdate for each of the given parts.
+   * 
+   * @return the concatenated output of all parts
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native byte[] C_EncryptUpdateVector(long hSession, byte[][] pParts)
+      throws PKCS11Exception;
+
+  /**
+   * C_EncryptUpdate continues a multiple-part encryption operation with the remaining data of each
+   * of the given direct buffers in turn, in a single call. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of each buffer is set
+   * to its limit. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts to get encrypted (PKCS#11 param: CK_BYTE_PTR
+   *          pPart, CK_ULONG ulPartLen)
+   * @return the encrypted data of all parts, concatenated in the order of pParts (PKCS#11 param:
+   *         CK_BYTE_PTR pEncryptedPart, CK_ULONG_PTR pulEncryptedPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * @postconditions (result <> null)
+   */
+  public byte[] C_EncryptUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception {
+    int[][] regions = getBufferRegions(pParts, "pParts");
+    byte[] encryptedPart = C_EncryptUpdateVectorDirect(hSession, pParts, regions[0], regions[1]);
+    consumeBuffers(pParts);
+
+    return encryptedPart;
+  }
+
+  /**
+   * Calls C_EncryptUpdate for the given region of each of the given direct buffers.
+   * 
+   * @return the concatenated output of all parts
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native byte[] C_EncryptUpdateVectorDirect(long hSession, ByteBuffer[] pParts,
+      int[] offsets, int[] lengths) throws PKCS11Exception;
+
   /**
    * C_EncryptFinal finishes a multiple-part encryption operation. (Encryption and decryption)
    * 
@@ -747,6 +1080,43 @@ public class PKCS11Implementation implements PKCS11 {
    */
   public native byte[] C_EncryptFinal(long hSession) throws PKCS11Exception;
 
+  /**
+   * C_EncryptFinal finishes a multiple-part encryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pLastEncryptedPart
+   *          the array receiving the last encrypted data part (PKCS#11 param: CK_BYTE_PTR
+   *          pLastEncryptedPart, CK_ULONG_PTR pulLastEncryptedPartLen)
+   * @param lastEncryptedPartOffset
+   *          the offset in pLastEncryptedPart at which to start writing
+   * @return the number of bytes written to pLastEncryptedPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pLastEncryptedPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_EncryptFinal(long hSession, byte[] pLastEncryptedPart,
+      int lastEncryptedPartOffset) throws PKCS11Exception {
+    checkArrayRegion(pLastEncryptedPart, "pLastEncryptedPart", lastEncryptedPartOffset, 0);
+    return C_EncryptFinalRegion(hSession, pLastEncryptedPart, lastEncryptedPartOffset,
+        pLastEncryptedPart.length - lastEncryptedPartOffset);
+  }
+
+  /**
+   * Calls C_EncryptFinal and writes the output to a region of the given array.
+   * 
+   * @return the number of bytes written to pLastEncryptedPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_EncryptFinalRegion(long hSession, byte[] pLastEncryptedPart,
+      int lastEncryptedPartOffset, int lastEncryptedPartLength) throws PKCS11Exception;
+
   /**
    * C_DecryptInit initializes a decryption operation. (Encryption and decryption)
    * 
@@ -780,6 +1150,164 @@ public class PKCS11Implementation implements PKCS11 {
   public native byte[] C_Decrypt(long hSession, byte[] pEncryptedData)
       throws PKCS11Exception;
 
+  /**
+   * C_Decrypt decrypts encrypted data. The data is passed in direct buffers which are handed to the
+   * module as they are, without copying the data to or from the Java heap. The module reads the
+   * remaining bytes of pEncryptedData and writes the decrypted data to the remaining space of
+   * pData. On success, the position of pEncryptedData is set to its limit and the position of pData
+   * is advanced by the number of bytes written. If pData has not enough space left, the method
+   * fails with CKR_BUFFER_TOO_SMALL, the positions stay unchanged and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pEncryptedData
+   *          the direct buffer holding the encrypted data to get decrypted (PKCS#11 param:
+   *          CK_BYTE_PTR pEncryptedData, CK_ULONG ulEncryptedDataLen)
+   * @param pData
+   *          the direct buffer receiving the decrypted data (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG_PTR pulDataLen)
+   * @return the number of bytes written to pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pEncryptedData <> null) and (pData <> null) and pEncryptedData.isDirect() and
+   * pData.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Decrypt(long hSession, ByteBuffer pEncryptedData, ByteBuffer pData)
+      throws PKCS11Exception {
+    checkDirectBuffer(pEncryptedData, "pEncryptedData", false);
+    checkDirectBuffer(pData, "pData", true);
+    int written = C_DecryptDirect(hSession, pEncryptedData, pEncryptedData.position(),
+        pEncryptedData.remaining(), pData, pData.position(), pData.remaining());
+    pEncryptedData.position(pEncryptedData.limit());
+    pData.position(pData.position() + written);
+
+    return written;
+  }
+
+  /**
+   * Calls C_Decrypt with the given regions of two direct buffers.
+   * 
+   * @return the number of bytes written to pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_DecryptDirect(long hSession, ByteBuffer pEncryptedData,
+      int pEncryptedDataOffset, int pEncryptedDataLength, ByteBuffer pData, int pDataOffset,
+      int pDataLength) throws PKCS11Exception;
+
+  /**
+   * C_Decrypt decrypts encrypted data. The input is read from a region of the given array and the
+   * output is written to the given output array starting at the given offset. This allows to reuse
+   * the same arrays for many calls. If the output array has not enough space left, the method fails
+   * with CKR_BUFFER_TOO_SMALL and the operation remains active. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pEncryptedData
+   *          the array holding the encrypted data to get decrypted (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedData)
+   * @param encryptedDataOffset
+   *          the offset of the encrypted data to get decrypted in pEncryptedData
+   * @param encryptedDataLength
+   *          the length of the encrypted data to get decrypted (PKCS#11 param: CK_ULONG
+   *          ulEncryptedDataLen)
+   * @param pData
+   *          the array receiving the decrypted data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG_PTR
+   *          pulDataLen)
+   * @param dataOffset
+   *          the offset in pData at which to start writing
+   * @return the number of bytes written to pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pEncryptedData <> null) and (pData <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Decrypt(long hSession, byte[] pEncryptedData, int encryptedDataOffset,
+      int encryptedDataLength, byte[] pData, int dataOffset) throws PKCS11Exception {
+    checkArrayRegion(pEncryptedData, "pEncryptedData", encryptedDataOffset, encryptedDataLength);
+    checkArrayRegion(pData, "pData", dataOffset, 0);
+    return C_DecryptRegion(hSession, pEncryptedData, encryptedDataOffset, encryptedDataLength,
+        pData, dataOffset, pData.length - dataOffset);
+  }
+
+  /**
+   * Calls C_Decrypt with a region of the given input array and writes the output to a region of the
+   * given output array.
+   * 
+   * @return the number of bytes written to pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_DecryptRegion(long hSession, byte[] pEncryptedData, int encryptedDataOffset,
+      int encryptedDataLength, byte[] pData, int dataOffset,
+      int dataLength) throws PKCS11Exception;
+
+  /**
+   * C_DecryptBatchAead decrypts many pieces of data with an AEAD mechanism (CKM_AES_GCM or
+   * CKM_AES_CCM) and the same key in one call, each with an IV and additional authenticated data of
+   * its own. The parameters of the given mechanism serve as a template: they are converted only
+   * once and for each piece of data only the IV (or nonce) and the AAD are replaced, and for CCM
+   * also the data length. For each piece of data it calls C_DecryptInit and C_Decrypt. A failing
+   * item does not stop the batch; its return value is stored in pulResults and its output is null.
+   * No decryption operation remains active in the session after this call. (Encryption and
+   * decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the AEAD mechanism with the template parameters (PKCS#11 param: CK_MECHANISM_PTR
+   *          pMechanism)
+   * @param hKey
+   *          the handle of the decryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pIvs
+   *          the IV or nonce of each piece of data; must be at least as long as pEncryptedData
+   * @param pAads
+   *          the additional authenticated data of each piece of data, or null to use the one of the
+   *          template; a null element means no additional authenticated data
+   * @param pEncryptedData
+   *          the pieces of encrypted data, each with its tag (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedData, CK_ULONG ulEncryptedDataLen)
+   * @param pulResults
+   *          receives the return value of C_DecryptInit or C_Decrypt for each piece of data; must
+   *          be at least as long as pEncryptedData
+   * @return the decrypted pieces of data in the order of pEncryptedData, null for the failed items
+   *         (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG_PTR pulDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pIvs <> null) and (pEncryptedData <> null) and (pulResults <> null) and
+   *                (pIvs.length >= pEncryptedData.length) and
+   *                (pulResults.length >= pEncryptedData.length)
+   * @postconditions (result <> null) and (result.length == pEncryptedData.length)
+   */
+  public native byte[][] C_DecryptBatchAead(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pIvs, byte[][] pAads, byte[][] pEncryptedData, long[] pulResults, boolean useUtf8)
+      throws PKCS11Exception;
+
+  /**
+   * C_DecryptOneShot initializes an operation with C_DecryptInit and runs it with C_Decrypt for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the decryption mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the decryption key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pEncryptedData
+   *          the encrypted data to get decrypted (PKCS#11 param: CK_BYTE_PTR pEncryptedData,
+   *          CK_ULONG ulEncryptedDataLen)
+   * @return the decrypted data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG_PTR pulDataLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pEncryptedData <> null)
+   * @postconditions (result <> null)
+   */
+  public native byte[] C_DecryptOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pEncryptedData, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_DecryptUpdate continues a multiple-part decryption operation. (Encryption and decryption)
    * 
@@ -798,6 +1326,54 @@ public class PKCS11Implementation implements PKCS11 {
   public native byte[] C_DecryptUpdate(long hSession, byte[] pEncryptedPart)
       throws PKCS11Exception;
 
+  /**
+   * C_DecryptUpdate continues a multiple-part decryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pEncryptedPart
+   *          the array holding the encrypted data part to get decrypted (PKCS#11 param: CK_BYTE_PTR
+   *          pEncryptedPart)
+   * @param encryptedPartOffset
+   *          the offset of the encrypted data part to get decrypted in pEncryptedPart
+   * @param encryptedPartLength
+   *          the length of the encrypted data part to get decrypted (PKCS#11 param: CK_ULONG
+   *          ulEncryptedPartLen)
+   * @param pPart
+   *          the array receiving the decrypted data part (PKCS#11 param: CK_BYTE_PTR pPart,
+   *          CK_ULONG_PTR pulPartLen)
+   * @param partOffset
+   *          the offset in pPart at which to start writing
+   * @return the number of bytes written to pPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pEncryptedPart <> null) and (pPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_DecryptUpdate(long hSession, byte[] pEncryptedPart, int encryptedPartOffset,
+      int encryptedPartLength, byte[] pPart, int partOffset) throws PKCS11Exception {
+    checkArrayRegion(pEncryptedPart, "pEncryptedPart", encryptedPartOffset, encryptedPartLength);
+    checkArrayRegion(pPart, "pPart", partOffset, 0);
+    return C_DecryptUpdateRegion(hSession, pEncryptedPart, encryptedPartOffset, encryptedPartLength,
+        pPart, partOffset, pPart.length - partOffset);
+  }
+
+  /**
+   * Calls C_DecryptUpdate with a region of the given input array and writes the output to a region
+   * of the given output array.
+   * 
+   * @return the number of bytes written to pPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_DecryptUpdateRegion(long hSession, byte[] pEncryptedPart,
+      int encryptedPartOffset, int encryptedPartLength, byte[] pPart, int partOffset,
+      int partLength) throws PKCS11Exception;
+
   /**
    * C_DecryptFinal finishes a multiple-part decryption operation. (Encryption and decryption)
    * 
@@ -812,6 +1388,43 @@ public class PKCS11Implementation implements PKCS11 {
    */
   public native byte[] C_DecryptFinal(long hSession) throws PKCS11Exception;
 
+  /**
+   * C_DecryptFinal finishes a multiple-part decryption operation. The input is read from a region
+   * of the given array and the output is written to the given output array starting at the given
+   * offset. This allows to reuse the same arrays for many calls. If the output array has not enough
+   * space left, the method fails with CKR_BUFFER_TOO_SMALL and the operation remains active.
+   * (Encryption and decryption)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pLastPart
+   *          the array receiving the last decrypted data part (PKCS#11 param: CK_BYTE_PTR
+   *          pLastPart, CK_ULONG_PTR pulLastPartLen)
+   * @param lastPartOffset
+   *          the offset in pLastPart at which to start writing
+   * @return the number of bytes written to pLastPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pLastPart <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_DecryptFinal(long hSession, byte[] pLastPart,
+      int lastPartOffset) throws PKCS11Exception {
+    checkArrayRegion(pLastPart, "pLastPart", lastPartOffset, 0);
+    return C_DecryptFinalRegion(hSession, pLastPart, lastPartOffset,
+        pLastPart.length - lastPartOffset);
+  }
+
+  /**
+   * Calls C_DecryptFinal and writes the output to a region of the given array.
+   * 
+   * @return the number of bytes written to pLastPart
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_DecryptFinalRegion(long hSession, byte[] pLastPart, int lastPartOffset,
+      int lastPartLength) throws PKCS11Exception;
+
   /*
    * *****************************************************************************
    * Message digesting****************************************************************************
@@ -848,35 +1461,265 @@ public class PKCS11Implementation implements PKCS11 {
   public native byte[] C_Digest(long hSession, byte[] data) throws PKCS11Exception;
 
   /**
-   * C_DigestUpdate continues a multiple-part message-digesting operation. (Message digesting)
+   * C_Digest digests data in a single part. The data is passed in direct buffers which are handed
+   * to the module as they are, without copying the data to or from the Java heap. The module reads
+   * the remaining bytes of data and writes the message digest to the remaining space of digest. On
+   * success, the position of data is set to its limit and the position of digest is advanced by the
+   * number of bytes written. If digest has not enough space left, the method fails with
+   * CKR_BUFFER_TOO_SMALL, the positions stay unchanged and the operation remains active. (Message
+   * digesting)
    * 
    * @param hSession
    *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
-   * @param pPart
-   *          the data to get digested and the data's length (PKCS#11 param: CK_BYTE_PTR pPart,
-   *          CK_ULONG ulPartLen)
+   * @param data
+   *          the direct buffer holding the data to get digested (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG ulDataLen)
+   * @param digest
+   *          the direct buffer receiving the message digest (PKCS#11 param: CK_BYTE_PTR pDigest,
+   *          CK_ULONG_PTR pulDigestLen)
+   * @return the number of bytes written to digest
    * @exception PKCS11Exception
    *              If function returns other value than CKR_OK.
-   * @preconditions (pPart <> null)
+   * @preconditions (data <> null) and (digest <> null) and data.isDirect() and digest.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Digest(long hSession, ByteBuffer data, ByteBuffer digest)
+      throws PKCS11Exception {
+    checkDirectBuffer(data, "data", false);
+    checkDirectBuffer(digest, "digest", true);
+    int written = C_DigestDirect(hSession, data, data.position(), data.remaining(), digest,
+        digest.position(), digest.remaining());
+    data.position(data.limit());
+    digest.position(digest.position() + written);
+
+    return written;
+  }
+
+  /**
+   * Calls C_Digest with the given regions of two direct buffers.
    * 
+   * @return the number of bytes written to digest
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
    */
-  public native void C_DigestUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
+  private native int C_DigestDirect(long hSession, ByteBuffer data, int dataOffset, int dataLength,
+      ByteBuffer digest, int digestOffset, int digestLength) throws PKCS11Exception;
 
   /**
-   * C_DigestKey continues a multi-part message-digesting operation, by digesting the value of a
-   * secret key as part of the data already digested. (Message digesting)
+   * C_Digest digests data in a single part. The input is read from a region of the given array and
+   * the output is written to the given output array starting at the given offset. This allows to
+   * reuse the same arrays for many calls. If the output array has not enough space left, the method
+   * fails with CKR_BUFFER_TOO_SMALL and the operation remains active. (Message digesting)
    * 
    * @param hSession
    *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
-   * @param hKey
-   *          the handle of the secret key to be digested (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the array holding the data to get digested (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the data to get digested in pData
+   * @param dataLength
+   *          the length of the data to get digested (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pDigest
+   *          the array receiving the message digest (PKCS#11 param: CK_BYTE_PTR pDigest,
+   *          CK_ULONG_PTR pulDigestLen)
+   * @param digestOffset
+   *          the offset in pDigest at which to start writing
+   * @return the number of bytes written to pDigest
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pDigest <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Digest(long hSession, byte[] pData, int dataOffset, int dataLength, byte[] pDigest,
+      int digestOffset) throws PKCS11Exception {
+    checkArrayRegion(pData, "pData", dataOffset, dataLength);
+    checkArrayRegion(pDigest, "pDigest", digestOffset, 0);
+    return C_DigestRegion(hSession, pData, dataOffset, dataLength, pDigest, digestOffset,
+        pDigest.length - digestOffset);
+  }
+
+  /**
+   * Calls C_Digest with a region of the given input array and writes the output to a region of the
+   * given output array.
+   * 
+   * @return the number of bytes written to pDigest
    * @exception PKCS11Exception
    *              If function returns other value than CKR_OK.
    */
-  public native void C_DigestKey(long hSession, long hKey) throws PKCS11Exception;
+  private native int C_DigestRegion(long hSession, byte[] pData, int dataOffset, int dataLength,
+      byte[] pDigest, int digestOffset, int digestLength) throws PKCS11Exception;
 
   /**
-   * C_DigestFinal finishes a multiple-part message-digesting operation. (Message digesting)
+   * C_DigestBatch digests many pieces of data with the same mechanism in one call. For each piece
+   * of data it calls C_DigestInit and C_Digest, but the mechanism is converted only once. The
+   * digests are packed into the returned array with a slot of the same size for each piece of data,
+   * in the order of pData. A failing item does not stop the batch; its return value is stored in
+   * pulResults and its slot is zeroed. No digest operation remains active in the session after
+   * this call. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the digesting mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param pData
+   *          the pieces of data to digest (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_DigestInit or C_Digest for each piece of data; must be
+   *          at least as long as pData
+   * @return the packed digests; the slot size is the length divided by pData.length (PKCS#11
+   *         param: CK_BYTE_PTR pDigest, CK_ULONG_PTR pulDigestLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pulResults <> null) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null)
+   */
+  public native byte[] C_DigestBatch(long hSession, CK_MECHANISM pMechanism, byte[][] pData,
+      long[] pulResults, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_DigestOneShot initializes an operation with C_DigestInit and runs it with C_Digest for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the digesting mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param pData
+   *          the data to get digested (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the message digest (PKCS#11 param: CK_BYTE_PTR pDigest, CK_ULONG_PTR pulDigestLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null)
+   * @postconditions (result <> null)
+   */
+  public native byte[] C_DigestOneShot(long hSession, CK_MECHANISM pMechanism, byte[] pData,
+      boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_DigestUpdate continues a multiple-part message-digesting operation. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the data to get digested and the data's length (PKCS#11 param: CK_BYTE_PTR pPart,
+   *          CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null)
+   * 
+   */
+  public native void C_DigestUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
+
+  /**
+   * C_DigestUpdate continues a multiple-part message-digesting operation with a region of the
+   * given array. This allows to feed parts of a larger buffer without copying them into arrays
+   * of their own. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part in pPart
+   * @param partLength
+   *          the length of the data part (PKCS#11 param: CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null)
+   * 
+   */
+  public void C_DigestUpdate(long hSession, byte[] pPart, int partOffset, int partLength)
+      throws PKCS11Exception {
+    checkArrayRegion(pPart, "pPart", partOffset, partLength);
+    C_DigestUpdateRegion(hSession, pPart, partOffset, partLength);
+  }
+
+  /**
+   * Calls C_DigestUpdate with a region of the given array.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_DigestUpdateRegion(long hSession, byte[] pPart, int partOffset,
+      int partLength) throws PKCS11Exception;
+
+  /**
+   * C_DigestUpdate continues a multiple-part message-digesting operation with each of the given
+   * parts in turn, in a single call. This is the same as calling C_DigestUpdate for each part,
+   * without concatenating the parts first. The first failing part stops the loop. (Message
+   * digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts to get digested (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * 
+   */
+  public void C_DigestUpdate(long hSession, byte[][] pParts) throws PKCS11Exception {
+    if (pParts == null) {
+      throw new NullPointerException("Argument \"pParts\" must not be null.");
+    }
+    C_DigestUpdateVector(hSession, pParts);
+  }
+
+  /**
+   * Calls C_DigestUpdate for each of the given parts.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_DigestUpdateVector(long hSession, byte[][] pParts) throws PKCS11Exception;
+
+  /**
+   * C_DigestUpdate continues a multiple-part message-digesting operation with the remaining data of
+   * each of the given direct buffers in turn, in a single call. The buffers are handed to the
+   * module without copying their contents to the Java heap. On success, the position of each buffer
+   * is set to its limit. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts to get digested (PKCS#11 param: CK_BYTE_PTR
+   *          pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * 
+   */
+  public void C_DigestUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception {
+    int[][] regions = getBufferRegions(pParts, "pParts");
+    C_DigestUpdateVectorDirect(hSession, pParts, regions[0], regions[1]);
+    consumeBuffers(pParts);
+  }
+
+  /**
+   * Calls C_DigestUpdate for the given region of each of the given direct buffers.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_DigestUpdateVectorDirect(long hSession, ByteBuffer[] pParts, int[] offsets,
+      int[] lengths) throws PKCS11Exception;
+
+  /**
+   * C_DigestKey continues a multi-part message-digesting operation, by digesting the value of a
+   * secret key as part of the data already digested. (Message digesting)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param hKey
+   *          the handle of the secret key to be digested (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  public native void C_DigestKey(long hSession, long hKey) throws PKCS11Exception;
+
+  /**
+   * C_DigestFinal finishes a multiple-part message-digesting operation. (Message digesting)
    * 
    * @param hSession
    *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
@@ -930,6 +1773,178 @@ public class PKCS11Implementation implements PKCS11 {
    */
   public native byte[] C_Sign(long hSession, byte[] pData) throws PKCS11Exception;
 
+  /**
+   * C_Sign signs (encrypts with private key) data in a single part, where the signature is (will
+   * be) an appendix to the data, and plaintext cannot be recovered from the signature. The data is
+   * passed in direct buffers which are handed to the module as they are, without copying the data
+   * to or from the Java heap. The module reads the remaining bytes of pData and writes the
+   * signature to the remaining space of pSignature. On success, the position of pData is set to its
+   * limit and the position of pSignature is advanced by the number of bytes written. If pSignature
+   * has not enough space left, the method fails with CKR_BUFFER_TOO_SMALL, the positions stay
+   * unchanged and the operation remains active. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the direct buffer holding the data to get signed (PKCS#11 param: CK_BYTE_PTR pData,
+   *          CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the direct buffer receiving the signature (PKCS#11 param: CK_BYTE_PTR pSignature,
+   *          CK_ULONG_PTR pulSignatureLen)
+   * @return the number of bytes written to pSignature
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null) and pData.isDirect() and
+   * pSignature.isDirect()
+   * @postconditions (result >= 0)
+   */
+  public int C_Sign(long hSession, ByteBuffer pData, ByteBuffer pSignature)
+      throws PKCS11Exception {
+    checkDirectBuffer(pData, "pData", false);
+    checkDirectBuffer(pSignature, "pSignature", true);
+    int written = C_SignDirect(hSession, pData, pData.position(), pData.remaining(), pSignature,
+        pSignature.position(), pSignature.remaining());
+    pData.position(pData.limit());
+    pSignature.position(pSignature.position() + written);
+
+    return written;
+  }
+
+  /**
+   * Calls C_Sign with the given regions of two direct buffers.
+   * 
+   * @return the number of bytes written to pSignature
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_SignDirect(long hSession, ByteBuffer pData, int pDataOffset, int pDataLength,
+      ByteBuffer pSignature, int pSignatureOffset, int pSignatureLength) throws PKCS11Exception;
+
+  /**
+   * C_Sign signs (encrypts with private key) data in a single part, where the signature is (will
+   * be) an appendix to the data, and plaintext cannot be recovered from the signature. The input is
+   * read from a region of the given array and the output is written to the given output array
+   * starting at the given offset. This allows to reuse the same arrays for many calls. If the
+   * output array has not enough space left, the method fails with CKR_BUFFER_TOO_SMALL and the
+   * operation remains active. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the array holding the data to get signed (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the data to get signed in pData
+   * @param dataLength
+   *          the length of the data to get signed (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the array receiving the signature (PKCS#11 param: CK_BYTE_PTR pSignature, CK_ULONG_PTR
+   *          pulSignatureLen)
+   * @param signatureOffset
+   *          the offset in pSignature at which to start writing
+   * @return the number of bytes written to pSignature
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null)
+   * @postconditions (result >= 0)
+   */
+  public int C_Sign(long hSession, byte[] pData, int dataOffset, int dataLength, byte[] pSignature,
+      int signatureOffset) throws PKCS11Exception {
+    checkArrayRegion(pData, "pData", dataOffset, dataLength);
+    checkArrayRegion(pSignature, "pSignature", signatureOffset, 0);
+    return C_SignRegion(hSession, pData, dataOffset, dataLength, pSignature, signatureOffset,
+        pSignature.length - signatureOffset);
+  }
+
+  /**
+   * Calls C_Sign with a region of the given input array and writes the output to a region of the
+   * given output array.
+   * 
+   * @return the number of bytes written to pSignature
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native int C_SignRegion(long hSession, byte[] pData, int dataOffset, int dataLength,
+      byte[] pSignature, int signatureOffset, int signatureLength) throws PKCS11Exception;
+
+  /**
+   * C_SignBatch signs many pieces of data with the same mechanism and key in one call. For each
+   * piece of data it calls C_SignInit and C_Sign, but the mechanism is converted only once. A
+   * failing item does not stop the batch; its return value is stored in pulResults and its
+   * signature is null. No signature operation remains active in the session after this call.
+   * (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the signature mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the signature key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the pieces of data to sign (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_SignInit or C_Sign for each piece of data; must be at
+   *          least as long as pData
+   * @return the signatures in the order of pData, null for the failed items (PKCS#11 param:
+   *         CK_BYTE_PTR pSignature, CK_ULONG_PTR pulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pulResults <> null) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null) and (result.length == pData.length)
+   */
+  public native byte[][] C_SignBatch(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pData, long[] pulResults, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_SignBatchPacked signs many pieces of data with the same mechanism and key in one call, like
+   * C_SignBatch, but packs the signatures into the returned array with a slot of the same size for
+   * each piece of data, in the order of pData. This fits MACs and other signatures of a fixed
+   * length. A failing item does not stop the batch; its return value is stored in pulResults and
+   * its slot is zeroed. No signature operation remains active in the session after this call.
+   * (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the signature mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the signature key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the pieces of data to sign (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pulResults
+   *          receives the return value of C_SignInit or C_Sign for each piece of data; must be at
+   *          least as long as pData
+   * @return the packed signatures; the slot size is the length divided by pData.length (PKCS#11
+   *         param: CK_BYTE_PTR pSignature, CK_ULONG_PTR pulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pulResults <> null) and (pulResults.length >= pData.length)
+   * @postconditions (result <> null)
+   */
+  public native byte[] C_SignBatchPacked(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pData, long[] pulResults, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_SignOneShot initializes an operation with C_SignInit and runs it with C_Sign for the given
+   * data in a single call. A failure of either step leaves no operation active in the session.
+   * (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the signature mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the signature key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the data to sign (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the signature (PKCS#11 param: CK_BYTE_PTR pSignature, CK_ULONG_PTR pulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null)
+   * @postconditions (result <> null)
+   */
+  public native byte[] C_SignOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pData, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_SignUpdate continues a multiple-part signature operation, where the signature is (will be) an
    * appendix to the data, and plaintext cannot be recovered from the signature. (Signing and
@@ -947,6 +1962,99 @@ public class PKCS11Implementation implements PKCS11 {
    */
   public native void C_SignUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
 
+  /**
+   * C_SignUpdate continues a multiple-part signature operation with a region of the
+   * given array. This allows to feed parts of a larger buffer without copying them into arrays
+   * of their own. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part in pPart
+   * @param partLength
+   *          the length of the data part (PKCS#11 param: CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null)
+   * 
+   */
+  public void C_SignUpdate(long hSession, byte[] pPart, int partOffset, int partLength)
+      throws PKCS11Exception {
+    checkArrayRegion(pPart, "pPart", partOffset, partLength);
+    C_SignUpdateRegion(hSession, pPart, partOffset, partLength);
+  }
+
+  /**
+   * Calls C_SignUpdate with a region of the given array.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_SignUpdateRegion(long hSession, byte[] pPart, int partOffset,
+      int partLength) throws PKCS11Exception;
+
+  /**
+   * C_SignUpdate continues a multiple-part signature operation with each of the given parts in
+   * turn, in a single call. This is the same as calling C_SignUpdate for each part, without
+   * concatenating the parts first. The first failing part stops the loop. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts to get signed (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * 
+   */
+  public void C_SignUpdate(long hSession, byte[][] pParts) throws PKCS11Exception {
+    if (pParts == null) {
+      throw new NullPointerException("Argument \"pParts\" must not be null.");
+    }
+    C_SignUpdateVector(hSession, pParts);
+  }
+
+  /**
+   * Calls C_SignUpdate for each of the given parts.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_SignUpdateVector(long hSession, byte[][] pParts) throws PKCS11Exception;
+
+  /**
+   * C_SignUpdate continues a multiple-part signature operation with the remaining data of each of
+   * the given direct buffers in turn, in a single call. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of each buffer is set
+   * to its limit. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts to get signed (PKCS#11 param: CK_BYTE_PTR
+   *          pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * 
+   */
+  public void C_SignUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception {
+    int[][] regions = getBufferRegions(pParts, "pParts");
+    C_SignUpdateVectorDirect(hSession, pParts, regions[0], regions[1]);
+    consumeBuffers(pParts);
+  }
+
+  /**
+   * Calls C_SignUpdate for the given region of each of the given direct buffers.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_SignUpdateVectorDirect(long hSession, ByteBuffer[] pParts, int[] offsets,
+      int[] lengths) throws PKCS11Exception;
+
   /**
    * C_SignFinal finishes a multiple-part signature operation, returning the signature. (Signing and
    * MACing)
@@ -1039,6 +2147,140 @@ public class PKCS11Implementation implements PKCS11 {
   public native void C_Verify(long hSession, byte[] pData, byte[] pSignature)
       throws PKCS11Exception;
 
+  /**
+   * C_Verify verifies a signature in a single-part operation, where the data and the signature are
+   * read from regions of the given arrays. This allows to verify a signature that is stored in the
+   * same buffer as the signed data without copying either of them. (Verifying signatures and MACs)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the array holding the signed data (PKCS#11 param: CK_BYTE_PTR pData)
+   * @param dataOffset
+   *          the offset of the signed data in pData
+   * @param dataLength
+   *          the length of the signed data (PKCS#11 param: CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the array holding the signature to verify (PKCS#11 param: CK_BYTE_PTR pSignature)
+   * @param signatureOffset
+   *          the offset of the signature in pSignature
+   * @param signatureLength
+   *          the length of the signature (PKCS#11 param: CK_ULONG ulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null)
+   * 
+   */
+  public void C_Verify(long hSession, byte[] pData, int dataOffset, int dataLength,
+      byte[] pSignature, int signatureOffset, int signatureLength) throws PKCS11Exception {
+    checkArrayRegion(pData, "pData", dataOffset, dataLength);
+    checkArrayRegion(pSignature, "pSignature", signatureOffset, signatureLength);
+    C_VerifyRegion(hSession, pData, dataOffset, dataLength, pSignature, signatureOffset,
+        signatureLength);
+  }
+
+  /**
+   * Calls C_Verify with regions of the given arrays.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_VerifyRegion(long hSession, byte[] pData, int dataOffset,
+      int dataLength, byte[] pSignature, int signatureOffset, int signatureLength)
+      throws PKCS11Exception;
+
+  /**
+   * C_Verify verifies a signature in a single-part operation, where the signature is an appendix to
+   * the data. The data and the signature are passed in direct buffers which are handed to the
+   * module as they are, without copying them to the Java heap. The module reads the remaining bytes
+   * of both buffers. On success, the positions of both buffers are set to their limits. (Signing
+   * and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pData
+   *          the direct buffer holding the signed data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG
+   *          ulDataLen)
+   * @param pSignature
+   *          the direct buffer holding the signature to verify (PKCS#11 param: CK_BYTE_PTR
+   *          pSignature, CK_ULONG ulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null) and pData.isDirect() and
+   * pSignature.isDirect()
+   * 
+   */
+  public void C_Verify(long hSession, ByteBuffer pData, ByteBuffer pSignature)
+      throws PKCS11Exception {
+    checkDirectBuffer(pData, "pData", false);
+    checkDirectBuffer(pSignature, "pSignature", false);
+    C_VerifyDirect(hSession, pData, pData.position(), pData.remaining(), pSignature,
+        pSignature.position(), pSignature.remaining());
+    pData.position(pData.limit());
+    pSignature.position(pSignature.limit());
+  }
+
+  /**
+   * Calls C_Verify with the given regions of two direct buffers.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_VerifyDirect(long hSession, ByteBuffer pData, int pDataOffset,
+      int pDataLength, ByteBuffer pSignature, int pSignatureOffset,
+      int pSignatureLength) throws PKCS11Exception;
+
+  /**
+   * C_VerifyBatch verifies many signatures with the same mechanism and key in one call. For each
+   * pair of data and signature it calls C_VerifyInit and C_Verify, but the mechanism is converted
+   * only once. Instead of throwing an exception, the return value of each verification is stored
+   * in the returned array; CKR_OK means the signature is valid. No verification operation remains
+   * active in the session after this call. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the verification mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the verification key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the signed pieces of data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the signatures to verify, one for each piece of data (PKCS#11 param: CK_BYTE_PTR
+   *          pSignature, CK_ULONG ulSignatureLen)
+   * @return the return value of C_VerifyInit or C_Verify for each pair in the order of pData
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pData <> null) and (pSignature <> null) and (pData.length == pSignature.length)
+   * @postconditions (result <> null) and (result.length == pData.length)
+   */
+  public native long[] C_VerifyBatch(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[][] pData, byte[][] pSignature, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_VerifyOneShot initializes an operation with C_VerifyInit and runs it with C_Verify for the
+   * given data in a single call. A failure of either step leaves no operation active in the
+   * session. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pMechanism
+   *          the verification mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the verification key (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pData
+   *          the signed data (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @param pSignature
+   *          the signature to verify (PKCS#11 param: CK_BYTE_PTR pSignature, CK_ULONG
+   *          ulSignatureLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pData <> null) and (pSignature <> null)
+   * 
+   */
+  public native void C_VerifyOneShot(long hSession, CK_MECHANISM pMechanism, long hKey,
+      byte[] pData, byte[] pSignature, boolean useUtf8) throws PKCS11Exception;
+
   /**
    * C_VerifyUpdate continues a multiple-part verification operation, where the signature is an
    * appendix to the data, and plaintext cannot be recovered from the signature. (Signing and
@@ -1056,6 +2298,100 @@ public class PKCS11Implementation implements PKCS11 {
    */
   public native void C_VerifyUpdate(long hSession, byte[] pPart) throws PKCS11Exception;
 
+  /**
+   * C_VerifyUpdate continues a multiple-part verification operation with a region of the
+   * given array. This allows to feed parts of a larger buffer without copying them into arrays
+   * of their own. (Verifying signatures and MACs)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pPart
+   *          the array holding the data part (PKCS#11 param: CK_BYTE_PTR pPart)
+   * @param partOffset
+   *          the offset of the data part in pPart
+   * @param partLength
+   *          the length of the data part (PKCS#11 param: CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pPart <> null)
+   * 
+   */
+  public void C_VerifyUpdate(long hSession, byte[] pPart, int partOffset, int partLength)
+      throws PKCS11Exception {
+    checkArrayRegion(pPart, "pPart", partOffset, partLength);
+    C_VerifyUpdateRegion(hSession, pPart, partOffset, partLength);
+  }
+
+  /**
+   * Calls C_VerifyUpdate with a region of the given array.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_VerifyUpdateRegion(long hSession, byte[] pPart, int partOffset,
+      int partLength) throws PKCS11Exception;
+
+  /**
+   * C_VerifyUpdate continues a multiple-part verification operation with each of the given parts in
+   * turn, in a single call. This is the same as calling C_VerifyUpdate for each part, without
+   * concatenating the parts first. The first failing part stops the loop. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the data parts of the signed data (PKCS#11 param: CK_BYTE_PTR pPart, CK_ULONG
+   *          ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null)
+   * 
+   */
+  public void C_VerifyUpdate(long hSession, byte[][] pParts) throws PKCS11Exception {
+    if (pParts == null) {
+      throw new NullPointerException("Argument \"pParts\" must not be null.");
+    }
+    C_VerifyUpdateVector(hSession, pParts);
+  }
+
+  /**
+   * Calls C_VerifyUpdate for each of the given parts.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_VerifyUpdateVector(long hSession, byte[][] pParts) throws PKCS11Exception;
+
+  /**
+   * C_VerifyUpdate continues a multiple-part verification operation with the remaining data of each
+   * of the given direct buffers in turn, in a single call. The buffers are handed to the module
+   * without copying their contents to the Java heap. On success, the position of each buffer is set
+   * to its limit. (Signing and MACing)
+   * 
+   * @param hSession
+   *          the session's handle (PKCS#11 param: CK_SESSION_HANDLE hSession)
+   * @param pParts
+   *          the direct buffers holding the data parts of the signed data (PKCS#11 param:
+   *          CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pParts <> null) and all buffers are direct
+   * 
+   */
+  public void C_VerifyUpdate(long hSession, ByteBuffer[] pParts) throws PKCS11Exception {
+    int[][] regions = getBufferRegions(pParts, "pParts");
+    C_VerifyUpdateVectorDirect(hSession, pParts, regions[0], regions[1]);
+    consumeBuffers(pParts);
+  }
+
+  /**
+   * Calls C_VerifyUpdate for the given region of each of the given direct buffers.
+   * 
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  private native void C_VerifyUpdateVectorDirect(long hSession, ByteBuffer[] pParts, int[] offsets,
+      int[] lengths) throws PKCS11Exception;
+
   /**
    * C_VerifyFinal finishes a multiple-part verification operation, checking the signature. (Signing
    * and MACing)
@@ -1394,6 +2730,108 @@ public class PKCS11Implementation implements PKCS11 {
   public native long C_WaitForSlotEvent(long flags, Object pReserved)
       throws PKCS11Exception;
 
+  /*
+   * *****************************************************************************
+   * Functions of the native worker pool, which runs operations on native threads
+   * ****************************************************************************
+   */
+
+  /**
+   * C_WorkerPoolCreate starts a native thread for each of the given sessions. Each thread runs the
+   * requests submitted with C_WorkerPoolSubmit in whole operations with its session, and provides
+   * the results for C_WorkerPoolPoll. The sessions must stay open, until the pool is destroyed with
+   * C_WorkerPoolDestroy; the application must not use them in the meantime.
+   * 
+   * @param phSessions
+   *          the handles of the sessions, one for each thread
+   * @param capacity
+   *          the maximum number of requests submitted, whose results were not polled yet
+   * @return the native handle of the pool
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (phSessions <> null) and (phSessions.length > 0) and (capacity > 0)
+   * @postconditions (result <> 0)
+   */
+  public native long C_WorkerPoolCreate(long[] phSessions, int capacity) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolSubmit submits requests to run the same operation with the same mechanism and key
+   * for many pieces of data. It never blocks; it accepts as many requests, from the first on, as
+   * fit into the capacity of the pool. Each request runs in a single call like C_SignOneShot.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @param operation
+   *          the operation; one of the constants of iaik.pkcs.pkcs11.NativeWorkerPool
+   * @param pMechanism
+   *          the mechanism (PKCS#11 param: CK_MECHANISM_PTR pMechanism)
+   * @param hKey
+   *          the handle of the key, ignored for digesting (PKCS#11 param: CK_OBJECT_HANDLE hKey)
+   * @param pIds
+   *          the ids of the requests, which are returned with their results; must be at least as
+   *          long as pData
+   * @param pData
+   *          the input of each request (PKCS#11 param: CK_BYTE_PTR pData, CK_ULONG ulDataLen)
+   * @return the number of accepted requests
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pMechanism <> null) and (pIds <> null) and (pData <> null)
+   *                and (pIds.length >= pData.length)
+   * @postconditions (0 <= result <= pData.length)
+   */
+  public native int C_WorkerPoolSubmit(long hPool, int operation, CK_MECHANISM pMechanism,
+      long hKey, long[] pIds, byte[][] pData, boolean useUtf8) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolPoll takes the results of finished requests, as many as pIds can hold. If there is
+   * none, it waits for the first one up to the given timeout.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @param pIds
+   *          receives the id of each result
+   * @param pulResults
+   *          receives the return value of each result; must be at least as long as pIds
+   * @param pOutputs
+   *          receives the output of each result, null for a failed request; must be at least as
+   *          long as pIds
+   * @param timeout
+   *          the milliseconds to wait for the first result; 0 not to wait, a negative value to wait
+   *          as long as it takes
+   * @return the number of results
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   * @preconditions (pIds <> null) and (pulResults <> null) and (pOutputs <> null)
+   * @postconditions (0 <= result <= pIds.length)
+   */
+  public native int C_WorkerPoolPoll(long hPool, long[] pIds, long[] pulResults, byte[][] pOutputs,
+      long timeout) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolStop makes the pool stop. Waiting and later calls of C_WorkerPoolPoll return at
+   * once, and C_WorkerPoolSubmit accepts no more requests. The pool stays allocated; so calls,
+   * which are still running, may complete safely, before the pool is destroyed with
+   * C_WorkerPoolDestroy.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  public native void C_WorkerPoolStop(long hPool) throws PKCS11Exception;
+
+  /**
+   * C_WorkerPoolDestroy stops the threads of the pool and frees it with all requests and results,
+   * which were not polled yet. No other call may use the pool at the same time or afterwards. The
+   * sessions stay open.
+   * 
+   * @param hPool
+   *          the native handle of the pool
+   * @exception PKCS11Exception
+   *              If function returns other value than CKR_OK.
+   */
+  public native void C_WorkerPoolDestroy(long hPool) throws PKCS11Exception;
+
   /**
    * Compares this object with the other object. Returns only true, if both objects refer to the
    * same PKCS#11 library.
@@ -1455,6 +2893,95 @@ public class PKCS11Implementation implements PKCS11 {
     return hashCode;
   }
 
+  /**
+   * Checks if the given buffer can be handed to the module as it is. Only direct buffers have a
+   * fixed address the module can read from or write to.
+   * 
+   * @param buffer
+   *          The buffer to check.
+   * @param name
+   *          The name of the argument for the exception message.
+   * @param output
+   *          True, if the module writes to the buffer.
+   * @exception IllegalArgumentException
+   *              If the buffer is not a direct buffer.
+   * @exception ReadOnlyBufferException
+   *              If the module writes to the buffer and it is read-only.
+   */
+  private static void checkDirectBuffer(ByteBuffer buffer, String name, boolean output) {
+    if (buffer == null) {
+      throw new NullPointerException("Argument \"" + name + "\" must not be null.");
+    }
+    if (!buffer.isDirect()) {
+      throw new IllegalArgumentException("Argument \"" + name + "\" must be a direct buffer.");
+    }
+    if (output && buffer.isReadOnly()) {
+      throw new ReadOnlyBufferException();
+    }
+  }
+
+  /**
+   * Checks the given direct buffers and gets the region between position and limit of each.
+   * 
+   * @param buffers
+   *          The buffers to check.
+   * @param name
+   *          The name of the argument for the exception message.
+   * @return The offsets of the regions followed by their lengths.
+   * @exception IllegalArgumentException
+   *              If a buffer is not a direct buffer.
+   */
+  private static int[][] getBufferRegions(ByteBuffer[] buffers, String name) {
+    if (buffers == null) {
+      throw new NullPointerException("Argument \"" + name + "\" must not be null.");
+    }
+    int[][] regions = new int[2][buffers.length];
+    for (int i = 0; i < buffers.length; i++) {
+      checkDirectBuffer(buffers[i], name + "[" + i + "]", false);
+      regions[0][i] = buffers[i].position();
+      regions[1][i] = buffers[i].remaining();
+    }
+
+    return regions;
+  }
+
+  /**
+   * Sets the position of each of the given buffers to its limit, after the module has read their
+   * remaining data.
+   * 
+   * @param buffers
+   *          The buffers that were read.
+   */
+  private static void consumeBuffers(ByteBuffer[] buffers) {
+    for (int i = 0; i < buffers.length; i++) {
+      buffers[i].position(buffers[i].limit());
+    }
+  }
+
+  /**
+   * Checks if the given region lies within the given array.
+   * 
+   * @param array
+   *          The array to check.
+   * @param name
+   *          The name of the argument for the exception message.
+   * @param offset
+   *          The offset of the region.
+   * @param length
+   *          The length of the region.
+   * @exception ArrayIndexOutOfBoundsException
+   *              If the region exceeds the bounds of the array.
+   */
+  private static void checkArrayRegion(byte[] array, String name, int offset, int length) {
+    if (array == null) {
+      throw new NullPointerException("Argument \"" + name + "\" must not be null.");
+    }
+    if (offset < 0 || length < 0 || offset > array.length - length) {
+      throw new ArrayIndexOutOfBoundsException("The region of argument \"" + name
+          + "\" exceeds the bounds of the array.");
+    }
+  }
+
   /**
    * Returns the string representation of this object.
    * 
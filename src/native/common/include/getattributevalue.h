@@ -65,4 +65,10 @@ int preAllocateAttributeArrayValues(JNIEnv * env, const char *callerMethodName,
  */
 CK_ULONG getRequiredSpace(CK_ATTRIBUTE_TYPE type);
 
+/*
+ * function appends an attribute value to the packed values of a bulk read, growing them if needed
+ */
+CK_RV appendBulkValue(CK_ATTRIBUTE_PTR ckpAttribute, CK_BYTE_PTR * ckpPacked, CK_ULONG_PTR ckpPackedLength,
+		      CK_ULONG_PTR ckpCapacity);
+
 #endif				/* COMMON_INCLUDE_GETATTRIBUTEVALUE_H_ */
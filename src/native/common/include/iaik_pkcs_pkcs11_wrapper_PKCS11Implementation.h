@@ -232,6 +232,14 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ge
 JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1GetAttributeValue
   (JNIEnv *, jobject, jlong, jlong, jobjectArray, jboolean);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_GetAttributeValueBulk
+ * Signature: (J[J[J[J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1GetAttributeValueBulk
+  (JNIEnv *, jobject, jlong, jlongArray, jlongArray, jlongArray);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_SetAttributeValue
@@ -256,6 +264,14 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
 JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1FindObjects
   (JNIEnv *, jobject, jlong, jlong);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_FindObjectsInto
+ * Signature: (J[JI)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1FindObjectsInto
+  (JNIEnv *, jobject, jlong, jlongArray, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_FindObjectsFinal
@@ -280,6 +296,38 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Enc
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Encrypt
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptDirect
+  (JNIEnv *, jobject, jlong, jobject, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptRegion
+ * Signature: (J[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptBatchAead
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[[B[[B[JZ)[[B
+ */
+JNIEXPORT jobjectArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptBatchAead
+  (JNIEnv *, jobject, jlong, jobject, jlong, jobjectArray, jobjectArray, jobjectArray, jlongArray, jboolean);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[BZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptOneShot
+  (JNIEnv *, jobject, jlong, jobject, jlong, jbyteArray, jboolean);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_EncryptUpdate
@@ -288,6 +336,30 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdate
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptUpdateVector
+ * Signature: (J[[B)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdateVector
+  (JNIEnv *, jobject, jlong, jobjectArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdateVectorDirect
+  (JNIEnv *, jobject, jlong, jobjectArray, jintArray, jintArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptUpdateRegion
+ * Signature: (J[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdateRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_EncryptFinal
@@ -296,6 +368,14 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptFinal
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptFinalRegion
+ * Signature: (J[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptFinalRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_DecryptInit
@@ -312,6 +392,38 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dec
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Decrypt
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptDirect
+  (JNIEnv *, jobject, jlong, jobject, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptRegion
+ * Signature: (J[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptBatchAead
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[[B[[B[JZ)[[B
+ */
+JNIEXPORT jobjectArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptBatchAead
+  (JNIEnv *, jobject, jlong, jobject, jlong, jobjectArray, jobjectArray, jobjectArray, jlongArray, jboolean);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[BZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptOneShot
+  (JNIEnv *, jobject, jlong, jobject, jlong, jbyteArray, jboolean);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_DecryptUpdate
@@ -320,6 +432,14 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptUpdate
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptUpdateRegion
+ * Signature: (J[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptUpdateRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_DecryptFinal
@@ -328,6 +448,14 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptFinal
   (JNIEnv *, jobject, jlong);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptFinalRegion
+ * Signature: (J[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptFinalRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_DigestInit
@@ -344,6 +472,38 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dig
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Digest
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestDirect
+  (JNIEnv *, jobject, jlong, jobject, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestRegion
+ * Signature: (J[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestBatch
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;[[B[JZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestBatch
+  (JNIEnv *, jobject, jlong, jobject, jobjectArray, jlongArray, jboolean);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;[BZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestOneShot
+  (JNIEnv *, jobject, jlong, jobject, jbyteArray, jboolean);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_DigestUpdate
@@ -352,6 +512,30 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestUpdate
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestUpdateVector
+ * Signature: (J[[B)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestUpdateVector
+  (JNIEnv *, jobject, jlong, jobjectArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestUpdateVectorDirect
+  (JNIEnv *, jobject, jlong, jobjectArray, jintArray, jintArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestUpdateRegion
+ * Signature: (J[BII)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestUpdateRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_DigestKey
@@ -384,6 +568,46 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sig
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sign
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignDirect
+  (JNIEnv *, jobject, jlong, jobject, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignRegion
+ * Signature: (J[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignBatch
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[JZ)[[B
+ */
+JNIEXPORT jobjectArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignBatch
+  (JNIEnv *, jobject, jlong, jobject, jlong, jobjectArray, jlongArray, jboolean);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignBatchPacked
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[JZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignBatchPacked
+  (JNIEnv *, jobject, jlong, jobject, jlong, jobjectArray, jlongArray, jboolean);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[BZ)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignOneShot
+  (JNIEnv *, jobject, jlong, jobject, jlong, jbyteArray, jboolean);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_SignUpdate
@@ -392,6 +616,30 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdate
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignUpdateVector
+ * Signature: (J[[B)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdateVector
+  (JNIEnv *, jobject, jlong, jobjectArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdateVectorDirect
+  (JNIEnv *, jobject, jlong, jobjectArray, jintArray, jintArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignUpdateRegion
+ * Signature: (J[BII)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdateRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_SignFinal
@@ -432,6 +680,38 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
 JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Verify
   (JNIEnv *, jobject, jlong, jbyteArray, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyDirect
+  (JNIEnv *, jobject, jlong, jobject, jint, jint, jobject, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyRegion
+ * Signature: (J[BII[BII)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint, jbyteArray, jint, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyBatch
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[[BZ)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyBatch
+  (JNIEnv *, jobject, jlong, jobject, jlong, jobjectArray, jobjectArray, jboolean);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[B[BZ)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyOneShot
+  (JNIEnv *, jobject, jlong, jobject, jlong, jbyteArray, jbyteArray, jboolean);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_VerifyUpdate
@@ -440,6 +720,30 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
 JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdate
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyUpdateVector
+ * Signature: (J[[B)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdateVector
+  (JNIEnv *, jobject, jlong, jobjectArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdateVectorDirect
+  (JNIEnv *, jobject, jlong, jobjectArray, jintArray, jintArray);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyUpdateRegion
+ * Signature: (J[BII)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdateRegion
+  (JNIEnv *, jobject, jlong, jbyteArray, jint, jint);
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_VerifyFinal
@@ -576,6 +880,46 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Can
 JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WaitForSlotEvent
   (JNIEnv *, jobject, jlong, jobject);
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolCreate
+ * Signature: ([JI)J
+ */
+JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolCreate
+  (JNIEnv *, jobject, jlongArray, jint);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolSubmit
+ * Signature: (JILiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[J[[BZ)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolSubmit
+  (JNIEnv *, jobject, jlong, jint, jobject, jlong, jlongArray, jobjectArray, jboolean);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolPoll
+ * Signature: (J[J[J[[BJ)I
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolPoll
+  (JNIEnv *, jobject, jlong, jlongArray, jlongArray, jobjectArray, jlong);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolStop
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolStop
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolDestroy
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolDestroy
+  (JNIEnv *, jobject, jlong);
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,6 +88,8 @@
 #define ckFlageToJLong(x) (jlong) x
 
 #define ckVoidPtrToJObject(x) (jobject) x
+#define ptrToJLong(x) (jlong) (size_t) x
+#define jLongToPtr(x) (void *) (size_t) x
 #define jObjectToCKVoidPtr(x) (CK_VOID_PTR) x
 
 #define jIntToCKLong(x) (CK_LONG) x
@@ -148,6 +150,7 @@ static void timeStamp() {
 #define CLASS_DATE "iaik/pkcs/pkcs11/wrapper/CK_DATE"
 #define CLASS_PKCS11EXCEPTION "iaik/pkcs/pkcs11/wrapper/PKCS11Exception"
 #define CLASS_PKCS11RUNTIMEEXCEPTION "iaik/pkcs/pkcs11/wrapper/PKCS11RuntimeException"
+#define CLASS_PKCS11IMPLEMENTATION "iaik/pkcs/pkcs11/wrapper/PKCS11Implementation"
 #define CLASS_FILE_NOT_FOUND_EXCEPTION "java/io/FileNotFoundException"
 #define CLASS_OUT_OF_MEMORY_ERROR "java/lang/OutOfMemoryError"
 #define CLASS_IO_EXCEPTION "java/io/IOException"
@@ -157,6 +160,7 @@ static void timeStamp() {
 #define CLASS_LOCKMUTEX "iaik/pkcs/pkcs11/wrapper/CK_LOCKMUTEX"
 #define CLASS_UNLOCKMUTEX "iaik/pkcs/pkcs11/wrapper/CK_UNLOCKMUTEX"
 #define CLASS_NOTIFY "iaik/pkcs/pkcs11/wrapper/CK_NOTIFY"
+#define CLASS_NATIVE_MUTEXES "iaik/pkcs/pkcs11/wrapper/NativeMutexes"
 #define CLASS_PKCS11UTIL "iaik/pkcs/pkcs11/wrapper/PKCS11UTIL"
 #define METHOD_ENCODER "utf8Encoder"
 #define METHOD_DECODER "utf8Decoder"
@@ -201,6 +205,108 @@ static void timeStamp() {
 
 #define CLASS_NAME(clazz) "L"clazz";"
 
+/*
+ * The cache of the Java classes, field IDs and method IDs used by the wrapper.
+ * It is filled once in JNI_OnLoad and released in JNI_OnUnload. The classes are
+ * held as global references; this pins them and keeps the cached IDs valid as
+ * long as the library is loaded.
+ */
+struct JNICache {
+
+  /* classes of the Java platform */
+  struct { jclass clazz; jmethodID init; jmethodID equals; jmethodID getClass; } object;
+  struct { jclass clazz; jmethodID getName; } clazz;
+  struct { jclass clazz; jmethodID init; jmethodID booleanValue; } booleanObject;
+  struct { jclass clazz; jmethodID byteValue; } byteObject;
+  struct { jclass clazz; jmethodID charValue; } characterObject;
+  struct { jclass clazz; jmethodID intValue; } integerObject;
+  struct { jclass clazz; jmethodID init; jmethodID longValue; } longObject;
+  struct { jclass clazz; } string;
+  struct { jclass clazz; jmethodID init; jmethodID append; } stringBuffer;
+  struct { jclass clazz; } booleanArray;
+  struct { jclass clazz; } byteArray;
+  struct { jclass clazz; } charArray;
+  struct { jclass clazz; } intArray;
+  struct { jclass clazz; } longArray;
+  struct { jclass clazz; jmethodID init; } outOfMemoryError;
+  struct { jclass clazz; jmethodID init; } fileNotFoundException;
+  struct { jclass clazz; jmethodID init; } ioException;
+
+  /* classes of the wrapper */
+  struct { jclass clazz; jmethodID init; jmethodID getErrorCode; } pkcs11Exception;
+  struct { jclass clazz; jmethodID init; jmethodID initMessage; } pkcs11RuntimeException;
+  struct { jclass clazz; jmethodID encoder; jmethodID decoder; } pkcs11Util;
+  struct { jclass clazz; jfieldID moduleHandle_; } pkcs11Implementation;
+  struct { jclass clazz; jfieldID major; jfieldID minor; } version;
+  struct { jclass clazz; jfieldID year; jfieldID month; jfieldID day; } date;
+  struct { jclass clazz; jfieldID cryptokiVersion; jfieldID manufacturerID; jfieldID flags;
+           jfieldID libraryDescription; jfieldID libraryVersion; } info;
+  struct { jclass clazz; jfieldID slotDescription; jfieldID manufacturerID; jfieldID flags;
+           jfieldID hardwareVersion; jfieldID firmwareVersion; } slotInfo;
+  struct { jclass clazz; jfieldID label; jfieldID manufacturerID; jfieldID model; jfieldID serialNumber;
+           jfieldID flags; jfieldID ulMaxSessionCount; jfieldID ulSessionCount; jfieldID ulMaxRwSessionCount;
+           jfieldID ulRwSessionCount; jfieldID ulMaxPinLen; jfieldID ulMinPinLen; jfieldID ulTotalPublicMemory;
+           jfieldID ulFreePublicMemory; jfieldID ulTotalPrivateMemory; jfieldID ulFreePrivateMemory;
+           jfieldID hardwareVersion; jfieldID firmwareVersion; jfieldID utcTime; } tokenInfo;
+  struct { jclass clazz; jfieldID slotID; jfieldID state; jfieldID flags; jfieldID ulDeviceError; } sessionInfo;
+  struct { jclass clazz; jfieldID ulMinKeySize; jfieldID ulMaxKeySize; jfieldID flags; } mechanismInfo;
+  struct { jclass clazz; jfieldID type; jfieldID pValue; } attribute;
+  struct { jclass clazz; jfieldID mechanism; jfieldID pParameter; } mechanism;
+  struct { jclass clazz; jfieldID CreateMutex; jfieldID DestroyMutex; jfieldID LockMutex; jfieldID UnlockMutex;
+           jfieldID flags; jfieldID pReserved; } initializeArgs;
+  struct { jclass clazz; jmethodID callback; } createMutex;
+  struct { jclass clazz; jmethodID callback; } destroyMutex;
+  struct { jclass clazz; jmethodID callback; } lockMutex;
+  struct { jclass clazz; jmethodID callback; } unlockMutex;
+  struct { jclass clazz; jmethodID callback; } notify;
+  struct { jclass clazz; } nativeMutexes;
+
+  /* mechanism parameter classes */
+  struct { jclass clazz; jfieldID hashAlg; jfieldID mgf; jfieldID source; jfieldID pSourceData; } rsaPkcsOaepParams;
+  struct { jclass clazz; jfieldID isSender; jfieldID pRandomA; jfieldID pRandomB; jfieldID pPublicData; } keaDeriveParams;
+  struct { jclass clazz; jfieldID ulEffectiveBits; jfieldID iv; } rc2CbcParams;
+  struct { jclass clazz; jfieldID ulEffectiveBits; jfieldID ulMacLength; } rc2MacGeneralParams;
+  struct { jclass clazz; jfieldID ulWordsize; jfieldID ulRounds; } rc5Params;
+  struct { jclass clazz; jfieldID ulWordsize; jfieldID ulRounds; jfieldID pIv; } rc5CbcParams;
+  struct { jclass clazz; jfieldID ulWordsize; jfieldID ulRounds; jfieldID ulMacLength; } rc5MacGeneralParams;
+  struct { jclass clazz; jfieldID pPassword; jfieldID pPublicData; jfieldID pRandomA; jfieldID pPrimeP;
+           jfieldID pBaseG; jfieldID pSubprimeQ; } skipjackPrivateWrapParams;
+  struct { jclass clazz; jfieldID pOldWrappedX; jfieldID pOldPassword; jfieldID pOldPublicData; jfieldID pOldRandomA;
+           jfieldID pNewPassword; jfieldID pNewPublicData; jfieldID pNewRandomA; } skipjackRelayxParams;
+  struct { jclass clazz; jfieldID pInitVector; jfieldID pPassword; jfieldID pSalt; jfieldID ulIteration; } pbeParams;
+  struct { jclass clazz; jfieldID saltSource; jfieldID pSaltSourceData; jfieldID iterations; jfieldID prf;
+           jfieldID pPrfData; } pkcs5Pbkd2Params;
+  struct { jclass clazz; jfieldID bBC; jfieldID pX; } keyWrapSetOaepParams;
+  struct { jclass clazz; jfieldID pData; } keyDerivationStringData;
+  struct { jclass clazz; jfieldID pClientRandom; jfieldID pServerRandom; } ssl3RandomData;
+  struct { jclass clazz; jfieldID hClientMacSecret; jfieldID hServerMacSecret; jfieldID hClientKey; jfieldID hServerKey;
+           jfieldID pIVClient; jfieldID pIVServer; } ssl3KeyMatOut;
+  struct { jclass clazz; jfieldID RandomInfo; jfieldID pVersion; } ssl3MasterKeyDeriveParams;
+  struct { jclass clazz; jfieldID ulMacSizeInBits; jfieldID ulKeySizeInBits; jfieldID ulIVSizeInBits; jfieldID bIsExport;
+           jfieldID RandomInfo; jfieldID pReturnedKeyMaterial; } ssl3KeyMatParams;
+  struct { jclass clazz; jfieldID hashAlg; jfieldID mgf; jfieldID sLen; } rsaPkcsPssParams;
+  struct { jclass clazz; jfieldID kdf; jfieldID pSharedData; jfieldID pPublicData; } ecdh1DeriveParams;
+  struct { jclass clazz; jfieldID kdf; jfieldID pSharedData; jfieldID pPublicData; jfieldID ulPrivateDataLen;
+           jfieldID hPrivateData; jfieldID pPublicData2; } ecdh2DeriveParams;
+  struct { jclass clazz; jfieldID kdf; jfieldID pOtherInfo; jfieldID pPublicData; } x942Dh1DeriveParams;
+  struct { jclass clazz; jfieldID kdf; jfieldID pOtherInfo; jfieldID pPublicData; jfieldID ulPrivateDataLen;
+           jfieldID hPrivateData; jfieldID pPublicData2; } x942Dh2DeriveParams;
+  struct { jclass clazz; jfieldID iv; jfieldID pData; } desCbcEncryptDataParams;
+  struct { jclass clazz; jfieldID iv; jfieldID pData; } aesCbcEncryptDataParams;
+  struct { jclass clazz; jfieldID pIv; jfieldID pAAD; jfieldID ulTagBits; } gcmParams;
+  struct { jclass clazz; jfieldID pNonce; jfieldID pAAD; jfieldID ulDataLen; jfieldID ulMacLen; } ccmParams;
+
+};
+typedef struct JNICache JNICache;
+
+extern JNICache jniCache;
+
+/* The Java VM that loaded this library, set in JNI_OnLoad. */
+extern JavaVM *cachedJavaVM;
+
+jint initializeJNICache(JNIEnv *env);
+void releaseJNICache(JNIEnv *env);
+
 /*
  * This method retrieves the function pointers from the module.
  */
@@ -224,6 +330,10 @@ void throwDisconnectedRuntimeException(JNIEnv *env);
 
 int jBooleanArrayToCKBBoolArray(JNIEnv *env, const jbooleanArray jArray, CK_BBOOL **ckpArray, CK_ULONG_PTR ckLength);
 int jByteArrayToCKByteArray(JNIEnv *env, const jbyteArray jArray, CK_BYTE_PTR *ckpArray, CK_ULONG_PTR ckLength);
+int jByteArrayToScratchCKByteArray(JNIEnv *env, const jbyteArray jArray, CK_BYTE_PTR *ckpArray, CK_ULONG_PTR ckLength);
+int jDirectBufferToCKBytePtr(JNIEnv *env, jobject jBuffer, jint jOffset, jint jLength, CK_BYTE_PTR *ckpBuffer);
+int checkJByteArrayRegion(JNIEnv *env, const jbyteArray jArray, jint jOffset, jint jLength);
+int jByteArrayRegionToCKByteArray(JNIEnv *env, const jbyteArray jArray, jint jOffset, jint jLength, CK_BYTE_PTR *ckpArray);
 int jLongArrayToCKULongArray(JNIEnv *env, const jlongArray jArray, CK_ULONG_PTR *ckpArray, CK_ULONG_PTR ckLength);
 int jCharArrayToCKCharArray(JNIEnv *env, const jcharArray jArray, CK_CHAR_PTR *ckpArray, CK_ULONG_PTR ckLength);
 int jCharArrayToCKUTF8CharArray(JNIEnv *env, const jcharArray jArray, CK_UTF8CHAR_PTR *ckpArray, CK_ULONG_PTR ckLength);
@@ -235,6 +345,7 @@ int jAttributeArrayToCKAttributeArray(JNIEnv *env, jobjectArray jAArray, CK_ATTR
 /* functions to convert a CK-type array and the array length to a Java array */
 
 jcharArray ckByteArrayToJByteArray(JNIEnv *env, const CK_BYTE_PTR ckpArray, CK_ULONG ckLength);
+void ckByteArrayToJByteArrayRegion(JNIEnv *env, const CK_BYTE_PTR ckpArray, CK_ULONG ckLength, jbyteArray jArray, jint jOffset);
 jlongArray ckULongArrayToJLongArray(JNIEnv *env, const CK_ULONG_PTR ckpArray, CK_ULONG ckLength);
 jcharArray ckCharArrayToJCharArray(JNIEnv *env, const CK_CHAR_PTR ckpArray, CK_ULONG length);
 jcharArray ckUTF8CharArrayToJCharArray(JNIEnv *env, const CK_UTF8CHAR_PTR ckpArray, CK_ULONG ckLength);
@@ -318,6 +429,7 @@ CK_CCM_PARAMS jCcmParamToCKCcmData(JNIEnv *env, jobject jParam);
 CK_C_INITIALIZE_ARGS_PTR makeCKInitArgsAdapter(JNIEnv *env, jobject pInitArgs, jboolean jUseUtf8);
 
 #ifndef NO_CALLBACKS /* if the library should not make callbacks; e.g. no javai.lib or jvm.lib available */
+JNIEnv *getCallbackEnvironment(void);
 CK_RV callJCreateMutex(CK_VOID_PTR_PTR ppMutex);
 CK_RV callJDestroyMutex(CK_VOID_PTR pMutex);
 CK_RV callJLockMutex(CK_VOID_PTR pMutex);
@@ -325,24 +437,16 @@ CK_RV callJUnlockMutex(CK_VOID_PTR pMutex);
 #endif /* NO_CALLBACKS */
 
 
-/* A node of the list of connected modules */
-struct ModuleListNode {
-
-  /* Reference to the object that implements the PKCS11 interface. */
-  jobject pkcs11Implementation;
-
-  /* Reference to this PKCS11 object's data. */
-  ModuleData *moduleData;
-
-  /* Pointer to the next node in the list. */
-  struct ModuleListNode *next;
-
-};
-typedef struct ModuleListNode ModuleListNode;
-
-
+/* The module data of a connected module is referenced by a native handle in
+ * the PKCS11Implementation object. Every native method takes a reference with
+ * getModuleEntry and must give it back with releaseModuleEntry. The module is
+ * unloaded, when disconnect has removed the entry and the last reference is
+ * released.
+ */
+ModuleData * newModuleEntry(JNIEnv *env);
 void putModuleEntry(JNIEnv *env, jobject pkcs11Implementation, ModuleData *moduleData);
 ModuleData * getModuleEntry(JNIEnv *env, jobject pkcs11Implementation);
+void releaseModuleEntry(ModuleData *moduleData);
 int isModulePresent(JNIEnv *env, jobject pkcs11Implementation);
 ModuleData * removeModuleEntry(JNIEnv *env, jobject pkcs11Implementation);
 void removeAllModuleEntries(JNIEnv *env);
@@ -392,4 +496,114 @@ NotifyEncapsulation * removeFirstNotifyEntry(JNIEnv *env);
 jobject createLockObject(JNIEnv *env);
 void destroyLockObject(JNIEnv *env, jobject jLockObject);
 
+/* Output length hints
+ *
+ * To call the functions that return data with a buffer of the right size in a
+ * single call, the expected output length is kept for each session and kind of
+ * operation. It is derived from the mechanism and key when the operation is
+ * initialized and learned from the lengths the module returned before.
+ */
+
+#define OUTPUT_ENCRYPT          0
+#define OUTPUT_ENCRYPT_FINAL    1
+#define OUTPUT_DECRYPT          2
+#define OUTPUT_DECRYPT_FINAL    3
+#define OUTPUT_SIGN             4
+#define OUTPUT_DIGEST           5
+#define OUTPUT_OPERATIONS       6
+
+/* The number of sessions per module, for which hints are kept at a time. */
+#define OUTPUT_LENGTH_SLOTS     64
+
+/* The space added to the input length, if nothing is known about the mechanism. */
+#define DEFAULT_EXTRA_OUTPUT_LENGTH 32
+
+/* The expected output length of one kind of operation. */
+struct OutputLengthHint {
+
+  /* The mechanism and key the operation was initialized with. */
+  CK_MECHANISM_TYPE mechanism;
+  CK_OBJECT_HANDLE hKey;
+
+  /* The output length beyond the input length, as far as mechanism and key
+   * tell it. Only valid, if extraLengthKnown is TRUE.
+   */
+  CK_ULONG extraLength;
+  CK_BBOOL extraLengthKnown;
+
+  /* The largest output length beyond the input length returned so far. */
+  CK_ULONG learnedExtraLength;
+};
+typedef struct OutputLengthHint OutputLengthHint;
+
+/* The hints of one session. The lock is taken with atomicCompareAndSwap. */
+struct OutputLengthSlot {
+  volatile long lock;
+  CK_SESSION_HANDLE hSession;
+  OutputLengthHint hints[OUTPUT_OPERATIONS];
+};
+typedef struct OutputLengthSlot OutputLengthSlot;
+
+/* A function returning data, called through callOutputFunction. */
+typedef CK_RV (*OutputFunction) (CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession,
+                                 CK_BYTE_PTR pInput, CK_ULONG ulInputLen,
+                                 CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen);
+
+OutputLengthSlot * newOutputLengthSlots(void);
+void resetOutputLengthSlots(OutputLengthSlot *slots);
+void initOutputLength(ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession,
+                      int operation, CK_MECHANISM_PTR ckpMechanism, CK_OBJECT_HANDLE hKey);
+CK_ULONG getOutputLength(ModuleData *moduleData, CK_SESSION_HANDLE hSession, int operation, CK_ULONG ulInputLen);
+void learnOutputLength(ModuleData *moduleData, CK_SESSION_HANDLE hSession, int operation, CK_ULONG ulInputLen, CK_ULONG ulOutputLen);
+CK_RV callOutputFunction(ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, OutputFunction function,
+                         int operation, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput, CK_ULONG ulInputLen,
+                         CK_BYTE_PTR *ppOutput, CK_ULONG_PTR pulOutputLen);
+
+/* ************************************************************************** */
+/* Functions to run whole operations in a single call                         */
+/* ************************************************************************** */
+
+/* A function initializing an operation, called through callOneShot, callPackedBatch or callAeadBatch. */
+typedef CK_RV (*InitFunction) (CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession,
+                               CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey);
+
+CK_RV callOneShot(ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, InitFunction init,
+                  OutputFunction function, int operation, CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR ckpMechanism,
+                  CK_OBJECT_HANDLE hKey, CK_BYTE_PTR pInput, CK_ULONG ulInputLen, CK_BYTE_PTR *ppOutput,
+                  CK_ULONG_PTR pulOutputLen);
+
+jbyteArray callPackedBatch(JNIEnv *env, ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, InitFunction init,
+                           OutputFunction function, int operation, CK_SESSION_HANDLE hSession,
+                           CK_MECHANISM_PTR ckpMechanism, CK_OBJECT_HANDLE hKey, jobjectArray jData, jlongArray jResults);
+jobjectArray callAeadBatch(JNIEnv *env, ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, InitFunction init,
+                           OutputFunction function, int operation, CK_SESSION_HANDLE hSession,
+                           CK_MECHANISM_PTR ckpMechanism, CK_OBJECT_HANDLE hKey, jobjectArray jIvs, jobjectArray jAads,
+                           jobjectArray jData, jlongArray jResults);
+jbyteArray callVectorUpdate(JNIEnv *env, ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions,
+                            OutputFunction function, int operation, CK_BBOOL withOutput, CK_SESSION_HANDLE hSession,
+                            jobjectArray jParts, jintArray jOffsets, jintArray jLengths, const char *callerMethodName);
+
+/* ************************************************************************** */
+/* Functions for the per-thread scratch memory                                */
+/* ************************************************************************** */
+
+/*
+ * The temporary buffers of a call, like copies of the input data, the output
+ * buffers and the converted mechanism parameters, are taken from a bump arena
+ * of the calling thread instead of the heap. The arena is empty again, when
+ * all of them are freed. Larger buffers are taken from the heap.
+ */
+
+/* The size of the scratch arena of each thread that calls the module. */
+#define SCRATCH_ARENA_SIZE      65536
+
+/* The alignment of the scratch allocations. */
+#define SCRATCH_ALIGNMENT       16
+
+void *scratchAlloc(size_t size);
+void scratchFree(void *pointer);
+void beginHeapScratch(void);
+void endHeapScratch(void);
+void freeScratchArena(void *arena);
+
 #endif //PKCS11WRAPPER_H_
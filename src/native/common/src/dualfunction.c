@@ -78,24 +78,29 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     rv = (*ckpFunctions->C_DigestEncryptUpdate) (ckSessionHandle, ckpPart, ckPartLength, NULL_PTR,
 						 &ckEncryptedPartLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	scratchFree(ckpPart);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    ckpEncryptedPart = (CK_BYTE_PTR) malloc(ckEncryptedPartLength * sizeof(CK_BYTE));
+    ckpEncryptedPart = (CK_BYTE_PTR) scratchAlloc(ckEncryptedPartLength * sizeof(CK_BYTE));
     if (ckpEncryptedPart == NULL_PTR && ckEncryptedPartLength != 0) {
-	free(ckpPart);
+	scratchFree(ckpPart);
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -106,9 +111,10 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     else
 	jEncryptedPart = NULL_PTR;
 
-    free(ckpPart);
-    free(ckpEncryptedPart);
+    scratchFree(ckpPart);
+    scratchFree(ckpEncryptedPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jEncryptedPart;
 }
@@ -143,24 +149,29 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jEncryptedPart, &ckpEncryptedPart, &ckEncryptedPartLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jEncryptedPart, &ckpEncryptedPart, &ckEncryptedPartLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     rv = (*ckpFunctions->C_DecryptDigestUpdate) (ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength, NULL_PTR,
 						 &ckPartLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	scratchFree(ckpEncryptedPart);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    ckpPart = (CK_BYTE_PTR) malloc(ckPartLength * sizeof(CK_BYTE));
+    ckpPart = (CK_BYTE_PTR) scratchAlloc(ckPartLength * sizeof(CK_BYTE));
     if (ckpPart == NULL_PTR && ckPartLength != 0) {
-	free(ckpEncryptedPart);
+	scratchFree(ckpEncryptedPart);
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -171,9 +182,10 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     else
 	jPart = NULL_PTR;
 
-    free(ckpPart);
-    free(ckpEncryptedPart);
+    scratchFree(ckpPart);
+    scratchFree(ckpEncryptedPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jPart;
 }
@@ -208,24 +220,29 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     rv = (*ckpFunctions->C_SignEncryptUpdate) (ckSessionHandle, ckpPart, ckPartLength, NULL_PTR,
 					       &ckEncryptedPartLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	scratchFree(ckpPart);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    ckpEncryptedPart = (CK_BYTE_PTR) malloc(ckEncryptedPartLength * sizeof(CK_BYTE));
+    ckpEncryptedPart = (CK_BYTE_PTR) scratchAlloc(ckEncryptedPartLength * sizeof(CK_BYTE));
     if (ckpEncryptedPart == NULL_PTR && ckEncryptedPartLength != 0) {
-	free(ckpPart);
+	scratchFree(ckpPart);
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -236,9 +253,10 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     else
 	jEncryptedPart = NULL_PTR;
 
-    free(ckpPart);
-    free(ckpEncryptedPart);
+    scratchFree(ckpPart);
+    scratchFree(ckpEncryptedPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jEncryptedPart;
 }
@@ -273,24 +291,29 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jEncryptedPart, &ckpEncryptedPart, &ckEncryptedPartLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jEncryptedPart, &ckpEncryptedPart, &ckEncryptedPartLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     rv = (*ckpFunctions->C_DecryptVerifyUpdate) (ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength, NULL_PTR,
 						 &ckPartLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	scratchFree(ckpEncryptedPart);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    ckpPart = (CK_BYTE_PTR) malloc(ckPartLength * sizeof(CK_BYTE));
+    ckpPart = (CK_BYTE_PTR) scratchAlloc(ckPartLength * sizeof(CK_BYTE));
     if (ckpPart == NULL_PTR && ckPartLength != 0) {
-	free(ckpEncryptedPart);
+	scratchFree(ckpEncryptedPart);
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -301,9 +324,10 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     else
 	jPart = NULL_PTR;
 
-    free(ckpPart);
-    free(ckpEncryptedPart);
+    scratchFree(ckpPart);
+    scratchFree(ckpEncryptedPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jPart;
 }
@@ -48,18 +48,761 @@
 /* for handling encryption and decryption related functions                   */
 /* ************************************************************************** */
 
-CK_ULONG addLengthDecrypt = 31;
+/*
+ * Adapters to call the functions returning data through callOutputFunction.
+ */
+CK_RV callEncrypt(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                  CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    return (*ckpFunctions->C_Encrypt) (hSession, pInput, ulInputLen, pOutput, pulOutputLen);
+}
+
+CK_RV callEncryptUpdate(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                        CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    return (*ckpFunctions->C_EncryptUpdate) (hSession, pInput, ulInputLen, pOutput, pulOutputLen);
+}
+
+CK_RV callEncryptFinal(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                       CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    /* the final part has no input */
+    return (*ckpFunctions->C_EncryptFinal) (hSession, pOutput, pulOutputLen);
+}
+
+CK_RV callDecrypt(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                  CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    return (*ckpFunctions->C_Decrypt) (hSession, pInput, ulInputLen, pOutput, pulOutputLen);
+}
+
+CK_RV callDecryptUpdate(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                        CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    return (*ckpFunctions->C_DecryptUpdate) (hSession, pInput, ulInputLen, pOutput, pulOutputLen);
+}
+
+CK_RV callDecryptFinal(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                       CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    /* the final part has no input */
+    return (*ckpFunctions->C_DecryptFinal) (hSession, pOutput, pulOutputLen);
+}
+
+/*
+ * Adapters to initialize the operation through callOneShot or callAeadBatch.
+ */
+CK_RV callEncryptInit(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism,
+                      CK_OBJECT_HANDLE hKey)
+{
+    return (*ckpFunctions->C_EncryptInit) (hSession, pMechanism, hKey);
+}
+
+CK_RV callDecryptInit(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism,
+                      CK_OBJECT_HANDLE hKey)
+{
+    return (*ckpFunctions->C_DecryptInit) (hSession, pMechanism, hKey);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptInit
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;JZ)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptInit
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+
+    rv = (*ckpFunctions->C_EncryptInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+	initOutputLength(moduleData, ckpFunctions, ckSessionHandle, OUTPUT_ENCRYPT, &ckMechanism, ckKeyHandle);
+    }
+
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_Encrypt
+ * Signature: (J[B)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @return  jbyteArray jEncryptedData   CK_BYTE_PTR pEncryptedData
+ *                                      CK_ULONG_PTR pulEncryptedDataLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Encrypt
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData = NULL_PTR, ckpEncryptedData;
+    CK_ULONG ckDataLength, ckEncryptedDataLength;
+    jbyteArray jEncryptedData;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* convert jTypes to ckTypes */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* call C_Encrypt with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callEncrypt, OUTPUT_ENCRYPT, ckSessionHandle, ckpData, ckDataLength,
+			    &ckpEncryptedData, &ckEncryptedDataLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jEncryptedData = ckByteArrayToJByteArray(env, ckpEncryptedData, ckEncryptedDataLength);
+    else
+	jEncryptedData = NULL_PTR;
+
+    scratchFree(ckpData);
+    scratchFree(ckpEncryptedData);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jEncryptedData;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jData               CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jobject jEncryptedData      CK_BYTE_PTR pEncryptedData
+ * @param   jint jEncryptedDataOffset
+ * @param   jint jEncryptedDataLength   CK_ULONG_PTR pulEncryptedDataLen
+ * @return  jint                        the number of bytes written to jEncryptedData
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jData, jint jDataOffset, jint jDataLength, jobject jEncryptedData, jint jEncryptedDataOffset, jint jEncryptedDataLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData, ckpEncryptedData;
+    CK_ULONG ckEncryptedDataLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* the buffers are passed to the module as they are, nothing is copied */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jDirectBufferToCKBytePtr(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jDirectBufferToCKBytePtr(env, jEncryptedData, jEncryptedDataOffset, jEncryptedDataLength, &ckpEncryptedData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    ckEncryptedDataLength = jIntToCKULong(jEncryptedDataLength);
+
+    /* call C_Encrypt */
+    rv = (*ckpFunctions->C_Encrypt) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpEncryptedData, &ckEncryptedDataLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK)
+	ckEncryptedDataLength = 0;
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+
+    return ckULongToJInt(ckEncryptedDataLength);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptRegion
+ * Signature: (J[BII[BII)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jbyteArray jEncryptedData   CK_BYTE_PTR pEncryptedData
+ * @param   jint jEncryptedDataOffset
+ * @param   jint jEncryptedDataLength   CK_ULONG_PTR pulEncryptedDataLen
+ * @return  jint                        the number of bytes written to jEncryptedData
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData, jint jDataOffset, jint jDataLength, jbyteArray jEncryptedData, jint jEncryptedDataOffset, jint jEncryptedDataLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData = NULL_PTR, ckpEncryptedData;
+    CK_ULONG ckEncryptedDataLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (checkJByteArrayRegion(env, jEncryptedData, jEncryptedDataOffset, jEncryptedDataLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jByteArrayRegionToCKByteArray(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckEncryptedDataLength = jIntToCKULong(jEncryptedDataLength);
+    ckpEncryptedData = (CK_BYTE_PTR) scratchAlloc((ckEncryptedDataLength + 1) * sizeof(CK_BYTE));
+    if (ckpEncryptedData == NULL_PTR) {
+	scratchFree(ckpData);
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* call C_Encrypt */
+    rv = (*ckpFunctions->C_Encrypt) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpEncryptedData, &ckEncryptedDataLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	ckByteArrayToJByteArrayRegion(env, ckpEncryptedData, ckEncryptedDataLength, jEncryptedData, jEncryptedDataOffset);
+    else
+	ckEncryptedDataLength = 0;
+
+    scratchFree(ckpData);
+    scratchFree(ckpEncryptedData);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+
+    return ckULongToJInt(ckEncryptedDataLength);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptBatchAead
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[[B[[B[JZ)[[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism, the template of the GCM or CCM parameters
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jobjectArray jIvs           the IV or nonce of each item
+ * @param   jobjectArray jAads          the additional authenticated data of each item
+ * @param   jobjectArray jData          CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @param   jlongArray jResults         CK_RV of C_EncryptInit or C_Encrypt for each item
+ * @return  jobjectArray jEncryptedData CK_BYTE_PTR pEncryptedData
+ *                                      CK_ULONG_PTR pulEncryptedDataLen
+ */
+JNIEXPORT jobjectArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptBatchAead
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jobjectArray jIvs,
+     jobjectArray jAads, jobjectArray jData, jlongArray jResults, jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    jobjectArray jEncryptedData = NULL_PTR;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* convert the mechanism once, only the IV and AAD change for each item */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if (!(*env)->ExceptionOccurred(env)) {
+	jEncryptedData = callAeadBatch(env, moduleData, ckpFunctions, callEncryptInit, callEncrypt, OUTPUT_ENCRYPT,
+				      ckSessionHandle, &ckMechanism, ckKeyHandle, jIvs, jAads, jData, jResults);
+    }
+
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jEncryptedData;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[BZ)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @return  jbyteArray jEncryptedData   CK_BYTE_PTR pEncryptedData
+ *                                      CK_ULONG_PTR pulEncryptedDataLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptOneShot
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jbyteArray jData,
+     jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_BYTE_PTR ckpData, ckpEncryptedData;
+    CK_ULONG ckDataLength, ckEncryptedDataLength;
+    jbyteArray jEncryptedData = NULL_PTR;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* convert everything first, a failing conversion must not leave an active operation */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    if ((*env)->ExceptionOccurred(env)) {
+	scratchFree(ckpData);
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    rv = callOneShot(moduleData, ckpFunctions, callEncryptInit, callEncrypt, OUTPUT_ENCRYPT, ckSessionHandle, &ckMechanism,
+		     ckKeyHandle, ckpData, ckDataLength, &ckpEncryptedData, &ckEncryptedDataLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+	jEncryptedData = ckByteArrayToJByteArray(env, ckpEncryptedData, ckEncryptedDataLength);
+    }
+
+    scratchFree(ckpData);
+    scratchFree(ckpEncryptedData);
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jEncryptedData;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptUpdate
+ * Signature: (J[B)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jPart            CK_BYTE_PTR pPart
+ *                                      CK_ULONG ulPartLen
+ * @return  jbyteArray jEncryptedPart   CK_BYTE_PTR pEncryptedPart
+ *                                      CK_ULONG_PTR pulEncryptedPartLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdate
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpPart = NULL_PTR, ckpEncryptedPart;
+    CK_ULONG ckPartLength, ckEncryptedPartLength;
+    jbyteArray jEncryptedPart;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* convert jTypes to ckTypes */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayToScratchCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* call C_EncryptUpdate with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callEncryptUpdate, OUTPUT_ENCRYPT, ckSessionHandle, ckpPart, ckPartLength,
+			    &ckpEncryptedPart, &ckEncryptedPartLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jEncryptedPart = ckByteArrayToJByteArray(env, ckpEncryptedPart, ckEncryptedPartLength);
+    else
+	jEncryptedPart = NULL_PTR;
+
+    scratchFree(ckpPart);
+    scratchFree(ckpEncryptedPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jEncryptedPart;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptUpdateVector
+ * Signature: (J[[B)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part
+ *                                      CK_ULONG ulPartLen
+ * @return  jbyteArray jEncryptedPart   CK_BYTE_PTR pEncryptedPart of all parts
+ *                                      CK_ULONG_PTR pulEncryptedPartLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdateVector
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    jbyteArray jEncryptedPart;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    jEncryptedPart = callVectorUpdate(env, moduleData, ckpFunctions, callEncryptUpdate, OUTPUT_ENCRYPT, TRUE,
+				      ckSessionHandle, jParts, NULL_PTR, NULL_PTR, __FUNCTION__);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jEncryptedPart;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part, direct buffers
+ * @param   jintArray jOffsets          the offset of the part in each buffer
+ * @param   jintArray jLengths          CK_ULONG ulPartLen of each part
+ * @return  jbyteArray jEncryptedPart   CK_BYTE_PTR pEncryptedPart of all parts
+ *                                      CK_ULONG_PTR pulEncryptedPartLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdateVectorDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts, jintArray jOffsets,
+     jintArray jLengths) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    jbyteArray jEncryptedPart;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    jEncryptedPart = callVectorUpdate(env, moduleData, ckpFunctions, callEncryptUpdate, OUTPUT_ENCRYPT, TRUE,
+				      ckSessionHandle, jParts, jOffsets, jLengths, __FUNCTION__);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jEncryptedPart;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptUpdateRegion
+ * Signature: (J[BII[BII)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jPart            CK_BYTE_PTR pPart
+ * @param   jint jPartOffset
+ * @param   jint jPartLength            CK_ULONG ulPartLen
+ * @param   jbyteArray jEncryptedPart   CK_BYTE_PTR pEncryptedPart
+ * @param   jint jEncryptedPartOffset
+ * @param   jint jEncryptedPartLength   CK_ULONG_PTR pulEncryptedPartLen
+ * @return  jint                        the number of bytes written to jEncryptedPart
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdateRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart, jint jPartOffset, jint jPartLength, jbyteArray jEncryptedPart, jint jEncryptedPartOffset, jint jEncryptedPartLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpPart = NULL_PTR, ckpEncryptedPart;
+    CK_ULONG ckEncryptedPartLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (checkJByteArrayRegion(env, jEncryptedPart, jEncryptedPartOffset, jEncryptedPartLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jByteArrayRegionToCKByteArray(env, jPart, jPartOffset, jPartLength, &ckpPart)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckEncryptedPartLength = jIntToCKULong(jEncryptedPartLength);
+    ckpEncryptedPart = (CK_BYTE_PTR) scratchAlloc((ckEncryptedPartLength + 1) * sizeof(CK_BYTE));
+    if (ckpEncryptedPart == NULL_PTR) {
+	scratchFree(ckpPart);
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* call C_EncryptUpdate */
+    rv = (*ckpFunctions->C_EncryptUpdate) (ckSessionHandle, ckpPart, jIntToCKULong(jPartLength), ckpEncryptedPart, &ckEncryptedPartLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	ckByteArrayToJByteArrayRegion(env, ckpEncryptedPart, ckEncryptedPartLength, jEncryptedPart, jEncryptedPartOffset);
+    else
+	ckEncryptedPartLength = 0;
+
+    scratchFree(ckpPart);
+    scratchFree(ckpEncryptedPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+
+    return ckULongToJInt(ckEncryptedPartLength);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_EncryptFinal
+ * Signature: (J)[B
+ * Parametermapping:                        *PKCS11*
+ * @param   jlong jSessionHandle            CK_SESSION_HANDLE hSession
+ * @return  jbyteArray jLastEncryptedPart   CK_BYTE_PTR pLastEncryptedDataPart
+ *                                          CK_ULONG_PTR pulLastEncryptedDataPartLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptFinal
+    (JNIEnv * env, jobject obj, jlong jSessionHandle) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpLastEncryptedPart;
+    CK_ULONG ckLastEncryptedPartLength;
+    jbyteArray jLastEncryptedPart;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+
+    /* call C_EncryptFinal with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callEncryptFinal, OUTPUT_ENCRYPT_FINAL, ckSessionHandle, NULL_PTR, 0,
+			    &ckpLastEncryptedPart, &ckLastEncryptedPartLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jLastEncryptedPart = ckByteArrayToJByteArray(env, ckpLastEncryptedPart, ckLastEncryptedPartLength);
+    else
+	jLastEncryptedPart = NULL_PTR;
+
+    scratchFree(ckpLastEncryptedPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jLastEncryptedPart;
+}
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_EncryptInit
+ * Method:    C_EncryptFinalRegion
+ * Signature: (J[BII)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jLastEncryptedPart CK_BYTE_PTR pLastEncryptedPart
+ * @param   jint jLastEncryptedPartOffset
+ * @param   jint jLastEncryptedPartLength CK_ULONG_PTR pulLastEncryptedPartLen
+ * @return  jint                        the number of bytes written to jLastEncryptedPart
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptFinalRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jLastEncryptedPart, jint jLastEncryptedPartOffset, jint jLastEncryptedPartLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpLastEncryptedPart;
+    CK_ULONG ckLastEncryptedPartLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (checkJByteArrayRegion(env, jLastEncryptedPart, jLastEncryptedPartOffset, jLastEncryptedPartLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckLastEncryptedPartLength = jIntToCKULong(jLastEncryptedPartLength);
+    ckpLastEncryptedPart = (CK_BYTE_PTR) scratchAlloc((ckLastEncryptedPartLength + 1) * sizeof(CK_BYTE));
+    if (ckpLastEncryptedPart == NULL_PTR) {
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* call C_EncryptFinal */
+    rv = (*ckpFunctions->C_EncryptFinal) (ckSessionHandle, ckpLastEncryptedPart, &ckLastEncryptedPartLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	ckByteArrayToJByteArrayRegion(env, ckpLastEncryptedPart, ckLastEncryptedPartLength, jLastEncryptedPart, jLastEncryptedPartOffset);
+    else
+	ckLastEncryptedPartLength = 0;
+
+    scratchFree(ckpLastEncryptedPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+
+    return ckULongToJInt(ckLastEncryptedPartLength);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptInit
  * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;JZ)V
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
  * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
  * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
  */
-JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptInit
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptInit
     (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jboolean jUseUtf8) {
     CK_SESSION_HANDLE ckSessionHandle;
     CK_MECHANISM ckMechanism;
@@ -77,6 +820,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Enc
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -84,33 +828,36 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Enc
     ckKeyHandle = jLongToCKULong(jKeyHandle);
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
 
-    rv = (*ckpFunctions->C_EncryptInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
-    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    rv = (*ckpFunctions->C_DecryptInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+	initOutputLength(moduleData, ckpFunctions, ckSessionHandle, OUTPUT_DECRYPT, &ckMechanism, ckKeyHandle);
+    }
 
     if (ckMechanism.pParameter != NULL_PTR) {
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_Encrypt
+ * Method:    C_Decrypt
  * Signature: (J[B)[B
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
- * @param   jbyteArray jData            CK_BYTE_PTR pData
- *                                      CK_ULONG ulDataLen
- * @return  jbyteArray jEncryptedData   CK_BYTE_PTR pEncryptedData
- *                                      CK_ULONG_PTR pulEncryptedDataLen
+ * @param   jbyteArray jEncryptedData   CK_BYTE_PTR pEncryptedData
+ *                                      CK_ULONG ulEncryptedDataLen
+ * @return  jbyteArray jData            CK_BYTE_PTR pData
+ *                                      CK_ULONG_PTR pulDataLen
  */
-JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Encrypt
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData) {
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Decrypt
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jEncryptedData) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpData = NULL_PTR, ckpEncryptedData;
-    CK_ULONG ckDataLength, ckEncryptedDataLength = 0;
-    jbyteArray jEncryptedData;
+    CK_BYTE_PTR ckpEncryptedData = NULL_PTR, ckpData;
+    CK_ULONG ckEncryptedDataLength, ckDataLength;
+    jbyteArray jData;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -124,62 +871,52 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     /* convert jTypes to ckTypes */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jData, &ckpData, &ckDataLength)) {
-	return NULL_PTR;
-    }
-
-    /* call C_Encrypt to determine DataLength */
-    rv = (*ckpFunctions->C_Encrypt) (ckSessionHandle, ckpData, ckDataLength, NULL_PTR, &ckEncryptedDataLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
-	return NULL_PTR;
-    }
-
-    /* allocate memory for Data */
-    ckpEncryptedData = (CK_BYTE_PTR) malloc(ckEncryptedDataLength * sizeof(CK_BYTE));
-    if (ckpEncryptedData == NULL_PTR && ckEncryptedDataLength != 0) {
-	free(ckpEncryptedData);
-	throwOutOfMemoryError(env);
+    if (jByteArrayToScratchCKByteArray(env, jEncryptedData, &ckpEncryptedData, &ckEncryptedDataLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    /* call C_Encrypt */
-    rv = (*ckpFunctions->C_Encrypt) (ckSessionHandle, ckpData, ckDataLength, ckpEncryptedData, &ckEncryptedDataLength);
+    /* call C_Decrypt with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callDecrypt, OUTPUT_DECRYPT, ckSessionHandle, ckpEncryptedData, ckEncryptedDataLength,
+			    &ckpData, &ckDataLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
-	/* convert ckTypes to jTypes */
-	jEncryptedData = ckByteArrayToJByteArray(env, ckpEncryptedData, ckEncryptedDataLength);
+	jData = ckByteArrayToJByteArray(env, ckpData, ckDataLength);
     else
-	jEncryptedData = NULL_PTR;
+	jData = NULL_PTR;
 
-    free(ckpData);
-    free(ckpEncryptedData);
+    scratchFree(ckpEncryptedData);
+    scratchFree(ckpData);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
-
-    return jEncryptedData;
+    return jData;
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_EncryptUpdate
- * Signature: (J[B)[B
+ * Method:    C_DecryptDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
- * @param   jbyteArray jPart            CK_BYTE_PTR pPart
- *                                      CK_ULONG ulPartLen
- * @return  jbyteArray jEncryptedPart   CK_BYTE_PTR pEncryptedPart
- *                                      CK_ULONG_PTR pulEncryptedPartLen
+ * @param   jobject jEncryptedData      CK_BYTE_PTR pEncryptedData
+ * @param   jint jEncryptedDataOffset
+ * @param   jint jEncryptedDataLength   CK_ULONG ulEncryptedDataLen
+ * @param   jobject jData               CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG_PTR pulDataLen
+ * @return  jint                        the number of bytes written to jData
  */
-JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptUpdate
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart) {
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jEncryptedData, jint jEncryptedDataOffset, jint jEncryptedDataLength, jobject jData, jint jDataOffset, jint jDataLength) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpPart = NULL_PTR, ckpEncryptedPart;
-    CK_ULONG ckPartLength, ckEncryptedPartLength = 0;
-    jbyteArray jEncryptedPart;
+    CK_BYTE_PTR ckpEncryptedData, ckpData;
+    CK_ULONG ckDataLength;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -189,59 +926,56 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     moduleData = getModuleEntry(env, obj);
     if (moduleData == NULL_PTR) {
 	throwDisconnectedRuntimeException(env);
-	return NULL_PTR;
+	return 0;
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
-	return NULL_PTR;
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
+    /* the buffers are passed to the module as they are, nothing is copied */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
-	return NULL_PTR;
-    }
-
-    rv = (*ckpFunctions->C_EncryptUpdate) (ckSessionHandle, ckpPart, ckPartLength, NULL_PTR, &ckEncryptedPartLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
-	return NULL_PTR;
+    if (jDirectBufferToCKBytePtr(env, jEncryptedData, jEncryptedDataOffset, jEncryptedDataLength, &ckpEncryptedData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
-
-    ckpEncryptedPart = (CK_BYTE_PTR) malloc(ckEncryptedPartLength * sizeof(CK_BYTE));
-    if (ckpEncryptedPart == NULL_PTR && ckEncryptedPartLength != 0) {
-	free(ckpEncryptedPart);
-	throwOutOfMemoryError(env);
-	return NULL_PTR;
+    if (jDirectBufferToCKBytePtr(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
+    ckDataLength = jIntToCKULong(jDataLength);
 
-    rv = (*ckpFunctions->C_EncryptUpdate) (ckSessionHandle, ckpPart, ckPartLength, ckpEncryptedPart,
-					   &ckEncryptedPartLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
-	jEncryptedPart = ckByteArrayToJByteArray(env, ckpEncryptedPart, ckEncryptedPartLength);
-    else
-	jEncryptedPart = NULL_PTR;
-
-    free(ckpPart);
-    free(ckpEncryptedPart);
+    /* call C_Decrypt */
+    rv = (*ckpFunctions->C_Decrypt) (ckSessionHandle, ckpEncryptedData, jIntToCKULong(jEncryptedDataLength), ckpData, &ckDataLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK)
+	ckDataLength = 0;
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
-    return jEncryptedPart;
+
+    return ckULongToJInt(ckDataLength);
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_EncryptFinal
- * Signature: (J)[B
- * Parametermapping:                        *PKCS11*
- * @param   jlong jSessionHandle            CK_SESSION_HANDLE hSession
- * @return  jbyteArray jLastEncryptedPart   CK_BYTE_PTR pLastEncryptedDataPart
- *                                          CK_ULONG_PTR pulLastEncryptedDataPartLen
+ * Method:    C_DecryptRegion
+ * Signature: (J[BII[BII)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jEncryptedData   CK_BYTE_PTR pEncryptedData
+ * @param   jint jEncryptedDataOffset
+ * @param   jint jEncryptedDataLength   CK_ULONG ulEncryptedDataLen
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG_PTR pulDataLen
+ * @return  jint                        the number of bytes written to jData
  */
-JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1EncryptFinal
-    (JNIEnv * env, jobject obj, jlong jSessionHandle) {
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jEncryptedData, jint jEncryptedDataOffset, jint jEncryptedDataLength, jbyteArray jData, jint jDataOffset, jint jDataLength) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpLastEncryptedPart;
-    CK_ULONG ckLastEncryptedPartLength = 0;
-    jbyteArray jLastEncryptedPart;
+    CK_BYTE_PTR ckpEncryptedData = NULL_PTR, ckpData;
+    CK_ULONG ckDataLength;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -251,54 +985,73 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     moduleData = getModuleEntry(env, obj);
     if (moduleData == NULL_PTR) {
 	throwDisconnectedRuntimeException(env);
-	return NULL_PTR;
+	return 0;
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
-	return NULL_PTR;
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-
-    rv = (*ckpFunctions->C_EncryptFinal) (ckSessionHandle, NULL_PTR, &ckLastEncryptedPartLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
-	return NULL_PTR;
+    if (checkJByteArrayRegion(env, jData, jDataOffset, jDataLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jByteArrayRegionToCKByteArray(env, jEncryptedData, jEncryptedDataOffset, jEncryptedDataLength, &ckpEncryptedData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
-    ckpLastEncryptedPart = (CK_BYTE_PTR) malloc(ckLastEncryptedPartLength * sizeof(CK_BYTE));
-    if (ckpLastEncryptedPart == NULL_PTR && ckLastEncryptedPartLength != 0) {
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckDataLength = jIntToCKULong(jDataLength);
+    ckpData = (CK_BYTE_PTR) scratchAlloc((ckDataLength + 1) * sizeof(CK_BYTE));
+    if (ckpData == NULL_PTR) {
+	scratchFree(ckpEncryptedData);
 	throwOutOfMemoryError(env);
-	return NULL_PTR;
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
-    rv = (*ckpFunctions->C_EncryptFinal) (ckSessionHandle, ckpLastEncryptedPart, &ckLastEncryptedPartLength);
+    /* call C_Decrypt */
+    rv = (*ckpFunctions->C_Decrypt) (ckSessionHandle, ckpEncryptedData, jIntToCKULong(jEncryptedDataLength), ckpData, &ckDataLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
-	jLastEncryptedPart = ckByteArrayToJByteArray(env, ckpLastEncryptedPart, ckLastEncryptedPartLength);
+	ckByteArrayToJByteArrayRegion(env, ckpData, ckDataLength, jData, jDataOffset);
     else
-	jLastEncryptedPart = NULL_PTR;
+	ckDataLength = 0;
 
-    free(ckpLastEncryptedPart);
+    scratchFree(ckpEncryptedData);
+    scratchFree(ckpData);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 
-    return jLastEncryptedPart;
+    return ckULongToJInt(ckDataLength);
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_DecryptInit
- * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;JZ)V
+ * Method:    C_DecryptBatchAead
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[[B[[B[JZ)[[B
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
- * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism, the template of the GCM or CCM parameters
  * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jobjectArray jIvs           the IV or nonce of each item
+ * @param   jobjectArray jAads          the additional authenticated data of each item
+ * @param   jobjectArray jEncryptedData CK_BYTE_PTR pEncryptedData
+ *                                      CK_ULONG ulEncryptedDataLen
+ * @param   jlongArray jResults         CK_RV of C_DecryptInit or C_Decrypt for each item
+ * @return  jobjectArray jData          CK_BYTE_PTR pData
+ *                                      CK_ULONG_PTR pulDataLen
  */
-JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptInit
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jboolean jUseUtf8) {
+JNIEXPORT jobjectArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptBatchAead
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jobjectArray jIvs,
+     jobjectArray jAads, jobjectArray jEncryptedData, jlongArray jResults, jboolean jUseUtf8) {
     CK_SESSION_HANDLE ckSessionHandle;
     CK_MECHANISM ckMechanism;
     CK_OBJECT_HANDLE ckKeyHandle;
-    CK_RV rv;
+    jobjectArray jData = NULL_PTR;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
 
@@ -307,44 +1060,54 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dec
     moduleData = getModuleEntry(env, obj);
     if (moduleData == NULL_PTR) {
 	throwDisconnectedRuntimeException(env);
-	return;
+	return NULL_PTR;
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
-	return;
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
     }
 
+    /* convert the mechanism once, only the IV and AAD change for each item */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    ckKeyHandle = jLongToCKULong(jKeyHandle);
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
-
-    rv = (*ckpFunctions->C_DecryptInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
-    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if (!(*env)->ExceptionOccurred(env)) {
+	jData = callAeadBatch(env, moduleData, ckpFunctions, callDecryptInit, callDecrypt, OUTPUT_DECRYPT,
+				      ckSessionHandle, &ckMechanism, ckKeyHandle, jIvs, jAads, jEncryptedData, jResults);
+    }
 
     if (ckMechanism.pParameter != NULL_PTR) {
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jData;
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_Decrypt
- * Signature: (J[B)[B
+ * Method:    C_DecryptOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[BZ)[B
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
  * @param   jbyteArray jEncryptedData   CK_BYTE_PTR pEncryptedData
  *                                      CK_ULONG ulEncryptedDataLen
  * @return  jbyteArray jData            CK_BYTE_PTR pData
  *                                      CK_ULONG_PTR pulDataLen
  */
-JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Decrypt
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jEncryptedData) {
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptOneShot
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jbyteArray jEncryptedData,
+     jboolean jUseUtf8) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpData, ckpDataTmp, ckpEncryptedData = NULL_PTR;
-    CK_ULONG ckDataLength, ckEncryptedDataLength;
-    jbyteArray jData;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_BYTE_PTR ckpEncryptedData, ckpData;
+    CK_ULONG ckEncryptedDataLength, ckDataLength;
+    jbyteArray jData = NULL_PTR;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -358,73 +1121,40 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    /* convert jTypes to ckTypes */
+    /* convert everything first, a failing conversion must not leave an active operation */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jEncryptedData, &ckpEncryptedData, &ckEncryptedDataLength)) {
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if (jByteArrayToScratchCKByteArray(env, jEncryptedData, &ckpEncryptedData, &ckEncryptedDataLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
-
-    ckDataLength = ckEncryptedDataLength + addLengthDecrypt;
-
-//      /* call C_Decrypt to determine DataLength */
-//      rv = (*ckpFunctions->C_Decrypt)(ckSessionHandle, ckpEncryptedData, ckEncryptedDataLength, NULL_PTR, &ckDataLength);
-//      if(ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) { return NULL_PTR; }
-
-    /* allocate memory for Data */
-    ckpData = (CK_BYTE_PTR) malloc(ckDataLength * sizeof(CK_BYTE));
-    if (ckpData == NULL_PTR && ckDataLength != 0) {
-	free(ckpEncryptedData);
-	throwOutOfMemoryError(env);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    if ((*env)->ExceptionOccurred(env)) {
+	scratchFree(ckpEncryptedData);
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    /* call C_Decrypt */
-    rv = (*ckpFunctions->C_Decrypt) (ckSessionHandle, ckpEncryptedData, ckEncryptedDataLength, ckpData, &ckDataLength);
-    if (rv == CKR_BUFFER_TOO_SMALL) {
-        TRACE0(tag_debug, __FUNCTION__, "buffer too small, try again");
-        addLengthDecrypt = ckDataLength - ckEncryptedDataLength;
-
-        ckpDataTmp = (CK_BYTE_PTR) realloc(ckpData, ckDataLength * sizeof(CK_BYTE));
-        if (ckpDataTmp == NULL_PTR && ckDataLength != 0) {
-            free(ckpEncryptedData);
-            free(ckpData);
-            throwOutOfMemoryError(env);
-            return NULL_PTR;
-        }
-        ckpData = ckpDataTmp;
-        /* call C_Decrypt again */
-        rv = (*ckpFunctions->C_Decrypt) (ckSessionHandle, ckpEncryptedData, ckEncryptedDataLength, ckpData,
-                         &ckDataLength);
-
-        if (rv == CKR_BUFFER_TOO_SMALL) {
-            TRACE0(tag_debug, __FUNCTION__, "buffer too small again, try again");
-            rv = (*ckpFunctions->C_Decrypt) (ckSessionHandle, ckpEncryptedData, ckEncryptedDataLength, NULL,
-                             &ckDataLength);
-            ckpDataTmp = (CK_BYTE_PTR) realloc(ckpData, ckDataLength * sizeof(CK_BYTE));
-            if (ckpDataTmp == NULL_PTR && ckDataLength != 0) {
-            free(ckpEncryptedData);
-            free(ckpData);
-            throwOutOfMemoryError(env);
-            return NULL_PTR;
-            }
-            ckpData = ckpDataTmp;
-            rv = (*ckpFunctions->C_Decrypt) (ckSessionHandle, ckpEncryptedData, ckEncryptedDataLength, ckpData,
-                             &ckDataLength);
-        }
-    }
-
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
-	/* convert ckTypes to jTypes */
+    rv = callOneShot(moduleData, ckpFunctions, callDecryptInit, callDecrypt, OUTPUT_DECRYPT, ckSessionHandle, &ckMechanism,
+		     ckKeyHandle, ckpEncryptedData, ckEncryptedDataLength, &ckpData, &ckDataLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
 	jData = ckByteArrayToJByteArray(env, ckpData, ckDataLength);
-    else
-	jData = NULL_PTR;
+    }
 
-    free(ckpData);
-    free(ckpEncryptedData);
+    scratchFree(ckpEncryptedData);
+    scratchFree(ckpData);
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jData;
 }
@@ -443,8 +1173,8 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptUpdate
     (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jEncryptedPart) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpPart, ckpPartTmp, ckpEncryptedPart = NULL_PTR;
-    CK_ULONG ckPartLength, ckEncryptedPartLength;
+    CK_BYTE_PTR ckpEncryptedPart = NULL_PTR, ckpPart;
+    CK_ULONG ckEncryptedPartLength, ckPartLength;
     jbyteArray jPart;
     CK_RV rv;
     ModuleData *moduleData;
@@ -459,69 +1189,103 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
+    /* convert jTypes to ckTypes */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jEncryptedPart, &ckpEncryptedPart, &ckEncryptedPartLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jEncryptedPart, &ckpEncryptedPart, &ckEncryptedPartLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
-//      rv = (*ckpFunctions->C_DecryptUpdate)(ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength, NULL_PTR, &ckPartLength);
-//      if(ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) { return NULL_PTR ; }
 
-    ckPartLength = ckEncryptedPartLength + addLengthDecrypt;
+    /* call C_DecryptUpdate with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callDecryptUpdate, OUTPUT_DECRYPT, ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength,
+			    &ckpPart, &ckPartLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jPart = ckByteArrayToJByteArray(env, ckpPart, ckPartLength);
+    else
+	jPart = NULL_PTR;
 
-    ckpPart = (CK_BYTE_PTR) malloc(ckPartLength * sizeof(CK_BYTE));
-    if (ckpPart == NULL_PTR && ckPartLength != 0) {
-	free(ckpEncryptedPart);
-	throwOutOfMemoryError(env);
-	return NULL_PTR;
+    scratchFree(ckpEncryptedPart);
+    scratchFree(ckpPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jPart;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptUpdateRegion
+ * Signature: (J[BII[BII)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jEncryptedPart   CK_BYTE_PTR pEncryptedPart
+ * @param   jint jEncryptedPartOffset
+ * @param   jint jEncryptedPartLength   CK_ULONG ulEncryptedPartLen
+ * @param   jbyteArray jPart            CK_BYTE_PTR pPart
+ * @param   jint jPartOffset
+ * @param   jint jPartLength            CK_ULONG_PTR pulPartLen
+ * @return  jint                        the number of bytes written to jPart
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptUpdateRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jEncryptedPart, jint jEncryptedPartOffset, jint jEncryptedPartLength, jbyteArray jPart, jint jPartOffset, jint jPartLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpEncryptedPart = NULL_PTR, ckpPart;
+    CK_ULONG ckPartLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (checkJByteArrayRegion(env, jPart, jPartOffset, jPartLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jByteArrayRegionToCKByteArray(env, jEncryptedPart, jEncryptedPartOffset, jEncryptedPartLength, &ckpEncryptedPart)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
-    rv = (*ckpFunctions->C_DecryptUpdate) (ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength, ckpPart,
-					   &ckPartLength);
-    if (rv == CKR_BUFFER_TOO_SMALL) {
-        TRACE0(tag_debug, __FUNCTION__, "buffer too small, try again");
-        addLengthDecrypt = ckPartLength - ckEncryptedPartLength;
-
-        ckpPartTmp = (CK_BYTE_PTR) realloc(ckpPart, ckPartLength * sizeof(CK_BYTE));
-        if (ckpPartTmp == NULL_PTR && ckPartLength != 0) {
-            free(ckpEncryptedPart);
-            free(ckpPart);
-            throwOutOfMemoryError(env);
-            return NULL_PTR;
-        }
-        ckpPart = ckpPartTmp;
-        /* call C_DecryptUpdate again */
-        rv = (*ckpFunctions->C_DecryptUpdate) (ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength, ckpPart,
-                               &ckPartLength);
-        if (rv == CKR_BUFFER_TOO_SMALL) {
-            TRACE0(tag_debug, __FUNCTION__, "buffer too small again, try again");
-            rv = (*ckpFunctions->C_DecryptUpdate) (ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength, NULL,
-                               &ckPartLength);
-            ckpPartTmp = (CK_BYTE_PTR) realloc(ckpPart, ckPartLength * sizeof(CK_BYTE));
-            if (ckpPartTmp == NULL_PTR && ckPartLength != 0) {
-            free(ckpEncryptedPart);
-            free(ckpPart);
-            throwOutOfMemoryError(env);
-            return NULL_PTR;
-            }
-            ckpPart = ckpPartTmp;
-        rv = (*ckpFunctions->C_DecryptUpdate) (ckSessionHandle, ckpEncryptedPart, ckEncryptedPartLength, ckpPart,
-                               &ckPartLength);
-        }
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckPartLength = jIntToCKULong(jPartLength);
+    ckpPart = (CK_BYTE_PTR) scratchAlloc((ckPartLength + 1) * sizeof(CK_BYTE));
+    if (ckpPart == NULL_PTR) {
+	scratchFree(ckpEncryptedPart);
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
+    /* call C_DecryptUpdate */
+    rv = (*ckpFunctions->C_DecryptUpdate) (ckSessionHandle, ckpEncryptedPart, jIntToCKULong(jEncryptedPartLength), ckpPart, &ckPartLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
-	jPart = ckByteArrayToJByteArray(env, ckpPart, ckPartLength);
+	ckByteArrayToJByteArrayRegion(env, ckpPart, ckPartLength, jPart, jPartOffset);
     else
-	jPart = NULL_PTR;
+	ckPartLength = 0;
 
-    free(ckpPart);
-    free(ckpEncryptedPart);
+    scratchFree(ckpEncryptedPart);
+    scratchFree(ckpPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
-    return jPart;
+
+    return ckULongToJInt(ckPartLength);
 }
 
 /*
@@ -536,8 +1300,8 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptFinal
     (JNIEnv * env, jobject obj, jlong jSessionHandle) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpLastPart, ckpLastPartTmp;
-    CK_ULONG ckLastPartLength = addLengthDecrypt;
+    CK_BYTE_PTR ckpLastPart;
+    CK_ULONG ckLastPartLength;
     jbyteArray jLastPart;
     CK_RV rv;
     ModuleData *moduleData;
@@ -552,54 +1316,86 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
 
-//      rv = (*ckpFunctions->C_DecryptFinal)(ckSessionHandle, NULL_PTR, &ckLastPartLength);
-//      if(ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) { return NULL_PTR ; }
+    /* call C_DecryptFinal with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callDecryptFinal, OUTPUT_DECRYPT_FINAL, ckSessionHandle, NULL_PTR, 0,
+			    &ckpLastPart, &ckLastPartLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jLastPart = ckByteArrayToJByteArray(env, ckpLastPart, ckLastPartLength);
+    else
+	jLastPart = NULL_PTR;
 
-    ckpLastPart = (CK_BYTE_PTR) malloc(ckLastPartLength * sizeof(CK_BYTE));
-    if (ckpLastPart == NULL_PTR && ckLastPartLength != 0) {
-	throwOutOfMemoryError(env);
-	return NULL_PTR;
+    scratchFree(ckpLastPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jLastPart;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DecryptFinalRegion
+ * Signature: (J[BII)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jLastPart        CK_BYTE_PTR pLastPart
+ * @param   jint jLastPartOffset
+ * @param   jint jLastPartLength        CK_ULONG_PTR pulLastPartLen
+ * @return  jint                        the number of bytes written to jLastPart
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DecryptFinalRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jLastPart, jint jLastPartOffset, jint jLastPartLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpLastPart;
+    CK_ULONG ckLastPartLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
     }
-    rv = (*ckpFunctions->C_DecryptFinal) (ckSessionHandle, ckpLastPart, &ckLastPartLength);
-    if (rv == CKR_BUFFER_TOO_SMALL) {
-        TRACE0(tag_debug, __FUNCTION__, "buffer too small, try again");
-        addLengthDecrypt = ckLastPartLength;
-
-        ckpLastPartTmp = (CK_BYTE_PTR) realloc(ckpLastPart, ckLastPartLength * sizeof(CK_BYTE));
-        if (ckpLastPartTmp == NULL_PTR && ckLastPartLength != 0) {
-            free(ckpLastPart);
-            throwOutOfMemoryError(env);
-            return NULL_PTR;
-        }
-        ckpLastPart = ckpLastPartTmp;
-        /* call C_DecryptFinal again */
-        rv = (*ckpFunctions->C_DecryptFinal) (ckSessionHandle, ckpLastPart, &ckLastPartLength);
-        if (rv == CKR_BUFFER_TOO_SMALL) {
-            TRACE0(tag_debug, __FUNCTION__, "buffer too small again, try again");
-            rv = (*ckpFunctions->C_DecryptFinal) (ckSessionHandle, NULL, &ckLastPartLength);
-            ckpLastPartTmp = (CK_BYTE_PTR) realloc(ckpLastPart, ckLastPartLength * sizeof(CK_BYTE));
-            if (ckpLastPartTmp == NULL_PTR && ckLastPartLength != 0) {
-            free(ckpLastPart);
-            throwOutOfMemoryError(env);
-            return NULL_PTR;
-            }
-            ckpLastPart = ckpLastPartTmp;
-            rv = (*ckpFunctions->C_DecryptFinal) (ckSessionHandle, ckpLastPart, &ckLastPartLength);
-        }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (checkJByteArrayRegion(env, jLastPart, jLastPartOffset, jLastPartLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckLastPartLength = jIntToCKULong(jLastPartLength);
+    ckpLastPart = (CK_BYTE_PTR) scratchAlloc((ckLastPartLength + 1) * sizeof(CK_BYTE));
+    if (ckpLastPart == NULL_PTR) {
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* call C_DecryptFinal */
+    rv = (*ckpFunctions->C_DecryptFinal) (ckSessionHandle, ckpLastPart, &ckLastPartLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
-	jLastPart = ckByteArrayToJByteArray(env, ckpLastPart, ckLastPartLength);
+	ckByteArrayToJByteArrayRegion(env, ckpLastPart, ckLastPartLength, jLastPart, jLastPartOffset);
     else
-	jLastPart = NULL_PTR;
+	ckLastPartLength = 0;
 
-    free(ckpLastPart);
+    scratchFree(ckpLastPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
-    return jLastPart;
+
+    return ckULongToJInt(ckLastPartLength);
 }
@@ -81,14 +81,14 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Get
 	moduleData = getModuleEntry(env, obj);
 	if (moduleData == NULL_PTR) { throwDisconnectedRuntimeException(env); return; }
 	ckpFunctions = getFunctionList(env, moduleData);
-	if (ckpFunctions == NULL_PTR) { return; }
+	if (ckpFunctions == NULL_PTR) { releaseModuleEntry(moduleData); return; }
 
 	TRACE2(tag_debug, __FUNCTION__, "hSession=%d, hObject=%u", (int)jSessionHandle, (unsigned int)jObjectHandle);
 
 	ckSessionHandle = jLongToCKULong(jSessionHandle);
 	ckObjectHandle = jLongToCKULong(jObjectHandle);
 	TRACE1(tag_debug, __FUNCTION__,"jAttributeArrayToCKAttributeArray now with jTemplate = %p", jTemplate);
-	if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) { return; }
+	if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) { releaseModuleEntry(moduleData); return; }
 	TRACE2(tag_debug, __FUNCTION__,"jAttributeArrayToCKAttributeArray finished with ckpAttribute = %p, Length = %d\n", ckpAttributes, (unsigned int)ckAttributesLength);
 
 	/* first set all pValue to NULL_PTR, to get the needed buffer length */
@@ -115,6 +115,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Get
 			/* free previously allocated memory*/
 			freeAttributeArray(&ckpAttributes, ckAttributesLength, CK_FALSE);
 			TRACE0(tag_call, __FUNCTION__, "exiting ");
+			releaseModuleEntry(moduleData);
 			return;
 		}
 		// set to null_ptr to be able to correctly call freeAttributeValue later
@@ -138,6 +139,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Get
 		if(rv2 == EXIT_FAILURE){
 			freeAttributeArray(&ckpAttributes, ckAttributesLength, CK_TRUE);
 			TRACE0(tag_call, __FUNCTION__, "exiting ");
+			releaseModuleEntry(moduleData);
 			return ;
 		}
 	}else{
@@ -160,6 +162,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Get
 			if(rv2 == EXIT_FAILURE){
 				freeAttributeArray(&ckpAttributes, ckAttributesLength, CK_TRUE);
 				TRACE0(tag_call, __FUNCTION__, "exiting ");
+				releaseModuleEntry(moduleData);
 				return ;
 			}
 		}
@@ -206,6 +209,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Get
 		freeAttributeArray(&ckpAttributes, ckAttributesLength, CK_FALSE);
 		freeAttributeArray(&arrayAttributes, arrayAttributesLength, CK_TRUE);
 	}
+	releaseModuleEntry(moduleData);
 	TRACE0(tag_call, __FUNCTION__, "exiting ");
 	return;
 }
@@ -232,7 +236,7 @@ int getAttributeValuesStd(JNIEnv *env, jobject obj, CK_RV *rv, CK_SESSION_HANDLE
 	moduleData = getModuleEntry(env, obj);
 	if (moduleData == NULL_PTR) { throwDisconnectedRuntimeException(env); return EXIT_FAILURE; }
 	ckpFunctions = getFunctionList(env, moduleData);
-	if (ckpFunctions == NULL_PTR) { return EXIT_FAILURE; }
+	if (ckpFunctions == NULL_PTR) { releaseModuleEntry(moduleData); return EXIT_FAILURE; }
 
 	TRACE2(tag_debug, __FUNCTION__, "hSession=%d, hObject=%u", (int)ckSessionHandle, (unsigned int)ckObjectHandle);
 
@@ -240,6 +244,7 @@ int getAttributeValuesStd(JNIEnv *env, jobject obj, CK_RV *rv, CK_SESSION_HANDLE
 	(*rv) = (*ckpFunctions->C_GetAttributeValue)(ckSessionHandle, ckObjectHandle, ckpAttributes, ckAttributesLength);
 	if (ckAssertAttributeReturnValueOK(env, (*rv), __FUNCTION__, ckAttributesLength) != CK_ASSERT_OK) {
 		TRACE0(tag_call, __FUNCTION__, "exiting ");
+		releaseModuleEntry(moduleData);
 		return EXIT_FAILURE;
 	}
 
@@ -263,6 +268,7 @@ int getAttributeValuesStd(JNIEnv *env, jobject obj, CK_RV *rv, CK_SESSION_HANDLE
 						/* free previously allocated memory*/
 						throwOutOfMemoryError(env);
 						TRACE0(tag_call, __FUNCTION__, "exiting ");
+						releaseModuleEntry(moduleData);
 						return EXIT_FAILURE;
 					}
 
@@ -290,6 +296,7 @@ int getAttributeValuesStd(JNIEnv *env, jobject obj, CK_RV *rv, CK_SESSION_HANDLE
 		(*rv) = (*ckpFunctions->C_GetAttributeValue)(ckSessionHandle, ckObjectHandle, ckpAttributes, ckAttributesLength);
 		if(ckAssertAttributeReturnValueOK(env, (*rv), __FUNCTION__, ckAttributesLength) != CK_ASSERT_OK) {
 			TRACE0(tag_call, __FUNCTION__, "exiting ");
+			releaseModuleEntry(moduleData);
 			return EXIT_FAILURE;
 		}
 	}
@@ -328,6 +335,7 @@ int getAttributeValuesStd(JNIEnv *env, jobject obj, CK_RV *rv, CK_SESSION_HANDLE
 							if ((ckAttributeArray[j].pValue == NULL_PTR && ckBufferLength!=0)) {
 								throwOutOfMemoryError(env);
 								TRACE0(tag_call, __FUNCTION__, "exiting ");
+								releaseModuleEntry(moduleData);
 								return EXIT_FAILURE;
 							}
 						}
@@ -341,6 +349,7 @@ int getAttributeValuesStd(JNIEnv *env, jobject obj, CK_RV *rv, CK_SESSION_HANDLE
 				if (ckpAttributes[i].pValue == NULL_PTR && ckBufferLength!=0){
 					throwOutOfMemoryError(env);
 					TRACE0(tag_call, __FUNCTION__, "exiting ");
+					releaseModuleEntry(moduleData);
 					return EXIT_FAILURE;
 				}
 			}
@@ -357,10 +366,12 @@ int getAttributeValuesStd(JNIEnv *env, jobject obj, CK_RV *rv, CK_SESSION_HANDLE
 
 	if(ckAssertAttributeReturnValueOK(env, (*rv), __FUNCTION__, ckAttributesLength) != CK_ASSERT_OK) {
 		TRACE0(tag_call, __FUNCTION__, "exiting ");
+		releaseModuleEntry(moduleData);
 		return EXIT_FAILURE;
 	}
 
 
+	releaseModuleEntry(moduleData);
 	TRACE0(tag_call, __FUNCTION__, "exiting ");
 	return EXIT_SUCCESS;
 }
@@ -660,3 +671,217 @@ void checkArrayAttributePointers(CK_ATTRIBUTE_PTR currentAttribute, CK_ATTRIBUTE
 	TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
+/* ************************************************************************** */
+/* The native implementation of the method GetAttributeValueBulk              */
+/* and used helper functions                                                  */
+/* ************************************************************************** */
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_GetAttributeValueBulk
+ * Signature: (J[J[J[J)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jlongArray jObjectHandles   CK_OBJECT_HANDLE hObject of each call
+ * @param   jlongArray jAttributeTypes  CK_ATTRIBUTE_TYPE of each attribute in pTemplate
+ * @param   jlongArray jCells           the offset, the length and the CK_RV of each value
+ * @return  jbyteArray                  the values of all objects packed into one array
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1GetAttributeValueBulk
+(JNIEnv *env, jobject obj, jlong jSessionHandle, jlongArray jObjectHandles, jlongArray jAttributeTypes, jlongArray jCells)
+{
+	CK_SESSION_HANDLE ckSessionHandle;
+	CK_ATTRIBUTE_PTR ckpTemplate = NULL_PTR;
+	CK_ATTRIBUTE ckAttribute;
+	CK_BYTE_PTR ckpValues = NULL_PTR, ckpPacked = NULL_PTR;
+	CK_ULONG ckObjectsLength, ckTypesLength, ckValuesLength = 0, ckPackedLength = 0, ckCapacity = 0;
+	CK_ULONG i, j;
+	jlong *jpObjectHandles = NULL_PTR, *jpTypes = NULL_PTR, *jpCells = NULL_PTR;
+	jbyteArray jPacked = NULL_PTR;
+	CK_RV rv = CKR_OK, objectRv, attributeRv;
+	ModuleData *moduleData;
+	CK_FUNCTION_LIST_PTR ckpFunctions;
+
+	TRACE0(tag_call, __FUNCTION__, "entering");
+
+	if (jObjectHandles == NULL_PTR || jAttributeTypes == NULL_PTR || jCells == NULL_PTR) {
+		throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The object handles, the attribute types and the cells must not be null."));
+		return NULL_PTR;
+	}
+	ckObjectsLength = (*env)->GetArrayLength(env, jObjectHandles);
+	ckTypesLength = (*env)->GetArrayLength(env, jAttributeTypes);
+	if ((CK_ULONG) (*env)->GetArrayLength(env, jCells) < 3 * ckObjectsLength * ckTypesLength) {
+		throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The cell array must hold three entries for each attribute of each object."));
+		return NULL_PTR;
+	}
+
+	jpTypes = (jlong *) scratchAlloc((ckTypesLength + 1) * sizeof(jlong));
+	if (jpTypes == NULL_PTR) {
+		throwOutOfMemoryError(env);
+		return NULL_PTR;
+	}
+	(*env)->GetLongArrayRegion(env, jAttributeTypes, 0, ckTypesLength, jpTypes);
+	for (j = 0; j < ckTypesLength; j++) {
+		if ((jLongToCKULong(jpTypes[j]) == CKA_WRAP_TEMPLATE) || (jLongToCKULong(jpTypes[j]) == CKA_UNWRAP_TEMPLATE)) {
+			scratchFree(jpTypes);
+			throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "Array attributes cannot be read in bulk."));
+			return NULL_PTR;
+		}
+	}
+
+	moduleData = getModuleEntry(env, obj);
+	if (moduleData == NULL_PTR) {
+		scratchFree(jpTypes);
+		throwDisconnectedRuntimeException(env);
+		return NULL_PTR;
+	}
+	ckpFunctions = getFunctionList(env, moduleData);
+	if (ckpFunctions == NULL_PTR) {
+		scratchFree(jpTypes);
+		releaseModuleEntry(moduleData);
+		return NULL_PTR;
+	}
+
+	ckSessionHandle = jLongToCKULong(jSessionHandle);
+
+	/* the buffers of the first attempt for each object are sized as in preAllocateAttributeArrayValues */
+	ckpTemplate = (CK_ATTRIBUTE_PTR) scratchAlloc((ckTypesLength + 1) * sizeof(CK_ATTRIBUTE));
+	if (ckpTemplate != NULL_PTR) {
+		for (j = 0; j < ckTypesLength; j++) {
+			ckpTemplate[j].type = jLongToCKULong(jpTypes[j]);
+			ckValuesLength += getRequiredSpace(ckpTemplate[j].type);
+		}
+		ckpValues = (CK_BYTE_PTR) scratchAlloc(ckValuesLength + 1);
+	}
+	jpObjectHandles = (jlong *) scratchAlloc((ckObjectsLength + 1) * sizeof(jlong));
+	jpCells = (jlong *) scratchAlloc((3 * ckTypesLength + 1) * sizeof(jlong));
+	if (ckpTemplate == NULL_PTR || ckpValues == NULL_PTR || jpObjectHandles == NULL_PTR || jpCells == NULL_PTR) {
+		rv = CKR_HOST_MEMORY;
+	} else {
+		(*env)->GetLongArrayRegion(env, jObjectHandles, 0, ckObjectsLength, jpObjectHandles);
+	}
+
+	for (i = 0; i < ckObjectsLength && rv == CKR_OK; i++) {
+		TRACE1(tag_debug, __FUNCTION__, "hObject=%u", (unsigned int)jpObjectHandles[i]);
+		ckValuesLength = 0;
+		for (j = 0; j < ckTypesLength; j++) {
+			ckpTemplate[j].pValue = ckpValues + ckValuesLength;
+			ckpTemplate[j].ulValueLen = getRequiredSpace(ckpTemplate[j].type);
+			ckValuesLength += ckpTemplate[j].ulValueLen;
+		}
+		objectRv = (*ckpFunctions->C_GetAttributeValue)(ckSessionHandle, jLongToCKULong(jpObjectHandles[i]), ckpTemplate, ckTypesLength);
+
+		for (j = 0; j < ckTypesLength && rv == CKR_OK; j++) {
+			jpCells[3 * j] = ckULongToJLong(ckPackedLength);
+			jpCells[3 * j + 1] = 0;
+			if ((objectRv != CKR_OK) && (objectRv != CKR_ATTRIBUTE_SENSITIVE) && (objectRv != CKR_ATTRIBUTE_TYPE_INVALID)
+			    && (objectRv != CKR_BUFFER_TOO_SMALL)) {
+				/* the object as a whole could not be read */
+				jpCells[3 * j + 2] = ckULongToJLong(objectRv);
+				continue;
+			}
+			ckAttribute = ckpTemplate[j];
+			if (ckAttribute.ulValueLen == CK_UNAVAILABLE_INFORMATION) {
+				/* ask for this attribute alone to learn why it failed or how much space it takes */
+				ckAttribute.pValue = NULL_PTR;
+				ckAttribute.ulValueLen = 0;
+				attributeRv = (*ckpFunctions->C_GetAttributeValue)(ckSessionHandle, jLongToCKULong(jpObjectHandles[i]), &ckAttribute, 1);
+				if ((attributeRv == CKR_OK) && (ckAttribute.ulValueLen == CK_UNAVAILABLE_INFORMATION)) {
+					attributeRv = CKR_GENERAL_ERROR;
+				}
+				if (attributeRv == CKR_OK) {
+					ckAttribute.pValue = scratchAlloc(ckAttribute.ulValueLen + 1);
+					if (ckAttribute.pValue == NULL_PTR) {
+						rv = CKR_HOST_MEMORY;
+						break;
+					}
+					attributeRv = (*ckpFunctions->C_GetAttributeValue)(ckSessionHandle, jLongToCKULong(jpObjectHandles[i]), &ckAttribute, 1);
+					if (attributeRv == CKR_OK) {
+						rv = appendBulkValue(&ckAttribute, &ckpPacked, &ckPackedLength, &ckCapacity);
+					}
+					scratchFree(ckAttribute.pValue);
+				}
+				jpCells[3 * j + 2] = ckULongToJLong(attributeRv);
+			} else {
+				jpCells[3 * j + 2] = ckULongToJLong(CKR_OK);
+				rv = appendBulkValue(&ckAttribute, &ckpPacked, &ckPackedLength, &ckCapacity);
+			}
+			jpCells[3 * j + 1] = ckULongToJLong(ckPackedLength) - jpCells[3 * j];
+		}
+		(*env)->SetLongArrayRegion(env, jCells, 3 * i * ckTypesLength, 3 * ckTypesLength, jpCells);
+	}
+
+	if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+		jPacked = ckByteArrayToJByteArray(env, ckpPacked, ckPackedLength);
+	}
+
+	scratchFree(ckpPacked);
+	scratchFree(ckpValues);
+	scratchFree(ckpTemplate);
+	scratchFree(jpCells);
+	scratchFree(jpTypes);
+	scratchFree(jpObjectHandles);
+	releaseModuleEntry(moduleData);
+	TRACE0(tag_call, __FUNCTION__, "exiting ");
+	return jPacked;
+}
+
+/*
+ * Appends the value of the given attribute to the packed values of C_GetAttributeValueBulk, which
+ * grow as needed. Values of type CK_ULONG and the elements of CKA_ALLOWED_MECHANISMS are appended
+ * as 8 byte big-endian numbers, so that the Java side need not know the size of a CK_ULONG.
+ *
+ * @param ckpAttribute - the attribute holding the value to append
+ * @param ckpPacked - the packed values; may be replaced by a larger scratch buffer
+ * @param ckpPackedLength - the number of bytes used in the packed values
+ * @param ckpCapacity - the size of the packed values buffer
+ * @return - CKR_OK or CKR_HOST_MEMORY
+ */
+CK_RV appendBulkValue(CK_ATTRIBUTE_PTR ckpAttribute, CK_BYTE_PTR *ckpPacked, CK_ULONG_PTR ckpPackedLength, CK_ULONG_PTR ckpCapacity)
+{
+	CK_BYTE_PTR ckpLarger, ckpTarget;
+	CK_ULONG ckLength, ckValue, i;
+	CK_BBOOL isULong;
+	int k;
+
+	isULong = (ckpAttribute->type == CKA_ALLOWED_MECHANISMS)
+		|| ((getRequiredSpace(ckpAttribute->type) == sizeof(CK_ULONG))
+		    && (ckpAttribute->type != CKA_START_DATE) && (ckpAttribute->type != CKA_END_DATE));
+	if (ckpAttribute->ulValueLen % sizeof(CK_ULONG) != 0) {
+		isULong = FALSE;
+	}
+	ckLength = isULong ? (ckpAttribute->ulValueLen / sizeof(CK_ULONG)) * 8 : ckpAttribute->ulValueLen;
+
+	if (*ckpPackedLength + ckLength > *ckpCapacity) {
+		*ckpCapacity = 2 * (*ckpCapacity);
+		if (*ckpCapacity < *ckpPackedLength + ckLength) {
+			*ckpCapacity = *ckpPackedLength + ckLength;
+		}
+		ckpLarger = (CK_BYTE_PTR) scratchAlloc(*ckpCapacity + 1);
+		if (ckpLarger == NULL_PTR) {
+			return CKR_HOST_MEMORY;
+		}
+		if (*ckpPacked != NULL_PTR) {
+			memcpy(ckpLarger, *ckpPacked, *ckpPackedLength);
+			scratchFree(*ckpPacked);
+		}
+		*ckpPacked = ckpLarger;
+	}
+
+	ckpTarget = *ckpPacked + *ckpPackedLength;
+	if (isULong) {
+		for (i = 0; i < ckpAttribute->ulValueLen / sizeof(CK_ULONG); i++) {
+			memcpy(&ckValue, (CK_BYTE_PTR) ckpAttribute->pValue + i * sizeof(CK_ULONG), sizeof(CK_ULONG));
+			for (k = 7; k >= 0; k--) {
+				ckpTarget[k] = (CK_BYTE) (ckValue & 0xFF);
+				ckValue >>= 8;
+			}
+			ckpTarget += 8;
+		}
+	} else if (ckLength > 0) {
+		memcpy(ckpTarget, ckpAttribute->pValue, ckLength);
+	}
+	*ckpPackedLength += ckLength;
+
+	return CKR_OK;
+}
@@ -81,15 +81,24 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ge
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
     if ((*env)->ExceptionOccurred(env)) {
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
     if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) {
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -133,6 +142,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ge
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jKeyHandle;
 }
@@ -179,6 +189,7 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -186,17 +197,29 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
     if (jAttributeArrayToCKAttributeArray
 	(env, jPublicKeyTemplate, &ckpPublicKeyAttributes, &ckPublicKeyAttributesLength, jUseUtf8)) {
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
     if (jAttributeArrayToCKAttributeArray
 	(env, jPrivateKeyTemplate, &ckpPrivateKeyAttributes, &ckPrivateKeyAttributesLength, jUseUtf8)) {
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
-    ckpKeyHandles = (CK_OBJECT_HANDLE_PTR) malloc(2 * sizeof(CK_OBJECT_HANDLE));
+    ckpKeyHandles = (CK_OBJECT_HANDLE_PTR) scratchAlloc(2 * sizeof(CK_OBJECT_HANDLE));
     if (ckpKeyHandles == NULL_PTR) {
 	free(ckpPublicKeyAttributes);
 	free(ckpPrivateKeyAttributes);
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
     ckpPublicKeyHandle = ckpKeyHandles;	/* first element of array is Public Key */
@@ -244,8 +267,9 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 	freeCKMechanismParameter(&ckMechanism);
     }
 
-    free(ckpKeyHandles);
+    scratchFree(ckpKeyHandles);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jKeyHandles;
 }
@@ -285,6 +309,7 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -296,15 +321,20 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     rv = (*ckpFunctions->C_WrapKey) (ckSessionHandle, &ckMechanism, ckWrappingKeyHandle, ckKeyHandle, NULL_PTR,
 				     &ckWrappedKeyLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    ckpWrappedKey = (CK_BYTE_PTR) malloc(ckWrappedKeyLength * sizeof(CK_BYTE));
+    ckpWrappedKey = (CK_BYTE_PTR) scratchAlloc(ckWrappedKeyLength * sizeof(CK_BYTE));
     if (ckpWrappedKey == NULL_PTR && ckWrappedKeyLength != 0) {
 	if (ckMechanism.pParameter != NULL_PTR) {
-	    free(ckMechanism.pParameter);
+	    freeCKMechanismParameter(&ckMechanism);
 	}
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -315,11 +345,12 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     else
 	jWrappedKey = NULL_PTR;
 
-    free(ckpWrappedKey);
+    scratchFree(ckpWrappedKey);
     if (ckMechanism.pParameter != NULL_PTR) {
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jWrappedKey;
 }
@@ -364,16 +395,26 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Un
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
     ckUnwrappingKeyHandle = jLongToCKULong(jUnwrappingKeyHandle);
-    if (jByteArrayToCKByteArray(env, jWrappedKey, &ckpWrappedKey, &ckWrappedKeyLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jWrappedKey, &ckpWrappedKey, &ckWrappedKeyLength)) {
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
     if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) {
+	scratchFree(ckpWrappedKey);
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -406,11 +447,12 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Un
 	copyBackSetUnwrappedKey(env, &ckMechanism, jMechanism);
     }
 
-    free(ckpWrappedKey);
+    scratchFree(ckpWrappedKey);
     if (ckMechanism.pParameter != NULL_PTR) {
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jKeyHandle;
 }
@@ -451,6 +493,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1De
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -458,6 +501,10 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1De
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
     ckBaseKeyHandle = jLongToCKULong(jBaseKeyHandle);
     if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) {
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -495,6 +542,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1De
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jKeyHandle;
 }
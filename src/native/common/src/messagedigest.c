@@ -48,6 +48,42 @@
 /* for handling message digesting functions                                   */
 /* ************************************************************************** */
 
+/*
+ * Adapters to call the functions returning data through callOutputFunction.
+ */
+CK_RV callDigest(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                 CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    return (*ckpFunctions->C_Digest) (hSession, pInput, ulInputLen, pOutput, pulOutputLen);
+}
+
+CK_RV callDigestFinal(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                      CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    /* the final part has no input */
+    return (*ckpFunctions->C_DigestFinal) (hSession, pOutput, pulOutputLen);
+}
+
+/*
+ * Adapter to feed the parts of a multiple-part operation through callVectorUpdate.
+ */
+CK_RV callDigestUpdate(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                       CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    /* the update returns no data */
+    return (*ckpFunctions->C_DigestUpdate) (hSession, pInput, ulInputLen);
+}
+
+/*
+ * Adapter to initialize the operation through callOneShot or callPackedBatch.
+ */
+CK_RV callDigestInit(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism,
+                     CK_OBJECT_HANDLE hKey)
+{
+    /* digesting needs no key */
+    return (*ckpFunctions->C_DigestInit) (hSession, pMechanism);
+}
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_DigestInit
@@ -73,6 +109,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dig
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -80,12 +117,15 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dig
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
 
     rv = (*ckpFunctions->C_DigestInit) (ckSessionHandle, &ckMechanism);
-    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+	initOutputLength(moduleData, ckpFunctions, ckSessionHandle, OUTPUT_DIGEST, &ckMechanism, CK_INVALID_HANDLE);
+    }
 
     if (ckMechanism.pParameter != NULL_PTR) {
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -104,7 +144,7 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData) {
     CK_SESSION_HANDLE ckSessionHandle;
     CK_BYTE_PTR ckpData = NULL_PTR, ckpDigest;
-    CK_ULONG ckDataLength, ckDigestLength = 0;
+    CK_ULONG ckDataLength, ckDigestLength;
     jbyteArray jDigest;
     CK_RV rv;
     ModuleData *moduleData;
@@ -119,40 +159,282 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     /* convert jTypes to ckTypes */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    /* call C_Encrypt to determine DataLength */
-    rv = (*ckpFunctions->C_Digest) (ckSessionHandle, ckpData, ckDataLength, NULL_PTR, &ckDigestLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
-	return NULL_PTR;
+    /* call C_Digest with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callDigest, OUTPUT_DIGEST, ckSessionHandle, ckpData, ckDataLength,
+			    &ckpDigest, &ckDigestLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jDigest = ckByteArrayToJByteArray(env, ckpDigest, ckDigestLength);
+    else
+	jDigest = NULL_PTR;
+
+    scratchFree(ckpData);
+    scratchFree(ckpDigest);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jDigest;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jData               CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jobject jDigest             CK_BYTE_PTR pDigest
+ * @param   jint jDigestOffset
+ * @param   jint jDigestLength          CK_ULONG_PTR pulDigestLen
+ * @return  jint                        the number of bytes written to jDigest
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jData, jint jDataOffset, jint jDataLength, jobject jDigest, jint jDigestOffset, jint jDigestLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData, ckpDigest;
+    CK_ULONG ckDigestLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* the buffers are passed to the module as they are, nothing is copied */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jDirectBufferToCKBytePtr(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jDirectBufferToCKBytePtr(env, jDigest, jDigestOffset, jDigestLength, &ckpDigest)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    ckDigestLength = jIntToCKULong(jDigestLength);
+
+    /* call C_Digest */
+    rv = (*ckpFunctions->C_Digest) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpDigest, &ckDigestLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK)
+	ckDigestLength = 0;
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+
+    return ckULongToJInt(ckDigestLength);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestRegion
+ * Signature: (J[BII[BII)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jbyteArray jDigest          CK_BYTE_PTR pDigest
+ * @param   jint jDigestOffset
+ * @param   jint jDigestLength          CK_ULONG_PTR pulDigestLen
+ * @return  jint                        the number of bytes written to jDigest
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData, jint jDataOffset, jint jDataLength, jbyteArray jDigest, jint jDigestOffset, jint jDigestLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData = NULL_PTR, ckpDigest;
+    CK_ULONG ckDigestLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (checkJByteArrayRegion(env, jDigest, jDigestOffset, jDigestLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jByteArrayRegionToCKByteArray(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
-    /* allocate memory for Data */
-    ckpDigest = (CK_BYTE_PTR) malloc(ckDigestLength * sizeof(CK_BYTE));
-    if (ckpDigest == NULL_PTR && ckDigestLength != 0) {
-	free(ckpDigest);
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckDigestLength = jIntToCKULong(jDigestLength);
+    ckpDigest = (CK_BYTE_PTR) scratchAlloc((ckDigestLength + 1) * sizeof(CK_BYTE));
+    if (ckpDigest == NULL_PTR) {
+	scratchFree(ckpData);
 	throwOutOfMemoryError(env);
-	return NULL_PTR;
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
-    /* call C_Encrypt */
-    rv = (*ckpFunctions->C_Digest) (ckSessionHandle, ckpData, ckDataLength, ckpDigest, &ckDigestLength);
+    /* call C_Digest */
+    rv = (*ckpFunctions->C_Digest) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpDigest, &ckDigestLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
-	/* convert ckTypes to jTypes */
-	jDigest = ckByteArrayToJByteArray(env, ckpDigest, ckDigestLength);
+	ckByteArrayToJByteArrayRegion(env, ckpDigest, ckDigestLength, jDigest, jDigestOffset);
     else
-	jDigest = NULL_PTR;
+	ckDigestLength = 0;
 
-    free(ckpData);
-    free(ckpDigest);
+    scratchFree(ckpData);
+    scratchFree(ckpDigest);
 
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+
+    return ckULongToJInt(ckDigestLength);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestBatch
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;[[B[JZ)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jobjectArray jData          CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @param   jlongArray jResults         CK_RV of C_DigestInit or C_Digest for each item
+ * @return  jbyteArray jDigests         CK_BYTE_PTR pDigest of each item in a slot of its own
+ *                                      CK_ULONG_PTR pulDigestLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestBatch
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jobjectArray jData, jlongArray jResults,
+     jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    jbyteArray jDigests = NULL_PTR;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* convert the mechanism once for all items */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    if (!(*env)->ExceptionOccurred(env)) {
+	jDigests = callPackedBatch(env, moduleData, ckpFunctions, callDigestInit, callDigest, OUTPUT_DIGEST,
+				   ckSessionHandle, &ckMechanism, CK_INVALID_HANDLE, jData, jResults);
+    }
+
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jDigests;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;[BZ)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @return  jbyteArray jDigest          CK_BYTE_PTR pDigest
+ *                                      CK_ULONG_PTR pulDigestLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestOneShot
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jbyteArray jData,
+     jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_BYTE_PTR ckpData, ckpDigest;
+    CK_ULONG ckDataLength, ckDigestLength;
+    jbyteArray jDigest = NULL_PTR;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* convert everything first, a failing conversion must not leave an active operation */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    if ((*env)->ExceptionOccurred(env)) {
+	scratchFree(ckpData);
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    rv = callOneShot(moduleData, ckpFunctions, callDigestInit, callDigest, OUTPUT_DIGEST, ckSessionHandle, &ckMechanism,
+		     CK_INVALID_HANDLE, ckpData, ckDataLength, &ckpDigest, &ckDigestLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+	jDigest = ckByteArrayToJByteArray(env, ckpDigest, ckDigestLength);
+    }
+
+    scratchFree(ckpData);
+    scratchFree(ckpDigest);
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jDigest;
 }
@@ -184,18 +466,140 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dig
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
 
-    jByteArrayToCKByteArray(env, jPart, &ckpPart, &ckPartLength);
+    jByteArrayToScratchCKByteArray(env, jPart, &ckpPart, &ckPartLength);
 
     rv = (*ckpFunctions->C_DigestUpdate) (ckSessionHandle, ckpPart, ckPartLength);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
-    free(ckpPart);
+    scratchFree(ckpPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestUpdateVector
+ * Signature: (J[[B)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part
+ *                                      CK_ULONG ulPartLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestUpdateVector
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    callVectorUpdate(env, moduleData, ckpFunctions, callDigestUpdate, OUTPUT_DIGEST, FALSE, ckSessionHandle,
+		     jParts, NULL_PTR, NULL_PTR, __FUNCTION__);
 
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part, direct buffers
+ * @param   jintArray jOffsets          the offset of the part in each buffer
+ * @param   jintArray jLengths          CK_ULONG ulPartLen of each part
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestUpdateVectorDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts, jintArray jOffsets,
+     jintArray jLengths) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    callVectorUpdate(env, moduleData, ckpFunctions, callDigestUpdate, OUTPUT_DIGEST, FALSE, ckSessionHandle,
+		     jParts, jOffsets, jLengths, __FUNCTION__);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_DigestUpdateRegion
+ * Signature: (J[BII)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jPart            CK_BYTE_PTR pPart
+ * @param   jint jPartOffset
+ * @param   jint jPartLength            CK_ULONG ulPartLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1DigestUpdateRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart, jint jPartOffset, jint jPartLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpPart = NULL_PTR;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayRegionToCKByteArray(env, jPart, jPartOffset, jPartLength, &ckpPart)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    rv = (*ckpFunctions->C_DigestUpdate) (ckSessionHandle, ckpPart, jIntToCKULong(jPartLength));
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    scratchFree(ckpPart);
+
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -224,6 +628,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dig
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -233,6 +638,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Dig
     rv = (*ckpFunctions->C_DigestKey) (ckSessionHandle, ckKeyHandle);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -249,7 +655,7 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     (JNIEnv * env, jobject obj, jlong jSessionHandle) {
     CK_SESSION_HANDLE ckSessionHandle;
     CK_BYTE_PTR ckpDigest;
-    CK_ULONG ckDigestLength = 0;
+    CK_ULONG ckDigestLength;
     jbyteArray jDigest;
     CK_RV rv;
     ModuleData *moduleData;
@@ -264,30 +670,23 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
 
-    rv = (*ckpFunctions->C_DigestFinal) (ckSessionHandle, NULL_PTR, &ckDigestLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
-	return NULL_PTR;
-    }
-
-    ckpDigest = (CK_BYTE_PTR) malloc(ckDigestLength * sizeof(CK_BYTE));
-    if (ckpDigest == NULL_PTR && ckDigestLength != 0) {
-	throwOutOfMemoryError(env);
-	return NULL_PTR;
-    }
-
-    rv = (*ckpFunctions->C_DigestFinal) (ckSessionHandle, ckpDigest, &ckDigestLength);
+    /* call C_DigestFinal with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callDigestFinal, OUTPUT_DIGEST, ckSessionHandle, NULL_PTR, 0,
+			    &ckpDigest, &ckDigestLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
 	jDigest = ckByteArrayToJByteArray(env, ckpDigest, ckDigestLength);
     else
 	jDigest = NULL_PTR;
 
-    free(ckpDigest);
-    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    scratchFree(ckpDigest);
 
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jDigest;
 }
@@ -47,11 +47,15 @@
 /* Functions for handling modules, mutex and callbacks                        */
 /* ************************************************************************** */
 
-/* The list of currently connected modules. Will normally contain one element,
- * but seldom more than a few.
+/* The module data entries that are no longer used by any connection. They are
+ * kept for reuse and never freed while the library is in use, because a thread
+ * that raced with disconnect may still read their reference count.
  */
-ModuleListNode *moduleListHead = NULL_PTR;
-jobject moduleListLock = NULL_PTR;
+ModuleData * volatile unusedModuleListHead = NULL_PTR;
+jobject unusedModuleListLock = NULL_PTR;
+
+/* The number of currently connected modules. */
+volatile long connectedModuleCount = 0;
 
 /* The list of notify callback handles that are currently active and waiting
  * for callbacks from their sessions.
@@ -83,8 +87,8 @@ CK_C_INITIALIZE_ARGS_PTR ckpGlobalInitArgs = NULL_PTR;
 JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_initializeLibrary
     (JNIEnv * env, jclass thisClass) {
     TRACE0(tag_call, __FUNCTION__, "entering");
-    if (moduleListLock == NULL_PTR) {
-	moduleListLock = createLockObject(env);
+    if (unusedModuleListLock == NULL_PTR) {
+	unusedModuleListLock = createLockObject(env);
     }
 #ifndef NO_CALLBACKS
     if (notifyListLock == NULL_PTR) {
@@ -107,12 +111,12 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_finali
     /* remove all left lists and release the resources and the lock
      * objects that synchronize access to these lists.
      */
-    removeAllModuleEntries(env);
-    if (moduleListHead == NULL_PTR) {	/* check, if we removed the last active module */
-	/* remove also the moduleListLock, it is no longer used */
-	if (moduleListLock != NULL_PTR) {
-	    destroyLockObject(env, moduleListLock);
-	    moduleListLock = NULL_PTR;
+    if (connectedModuleCount == 0) {	/* check, if there is no active module left */
+	removeAllModuleEntries(env);
+	/* remove also the unusedModuleListLock, it is no longer used */
+	if (unusedModuleListLock != NULL_PTR) {
+	    destroyLockObject(env, unusedModuleListLock);
+	    unusedModuleListLock = NULL_PTR;
 	}
 #ifndef NO_CALLBACKS
 	/* remove all left notify callback entries */
@@ -137,15 +141,54 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_finali
 }
 
 /*
- * Add the given pkcs11Implementation object to the list of present modules.
- * Attach the given data to the entry. If the given pkcs11Implementation is
- * already in the list, just override its old module data with the new one.
- * None of the arguments can be NULL_PTR. If one of the arguments is NULL_PTR, this
- * function does nothing.
+ * Get a module data entry for a new connection. Takes an unused entry, if there
+ * is one, otherwise allocates a new one. The returned entry holds the reference
+ * of the connection. Returns NULL_PTR and throws an OutOfMemoryError, if there
+ * is not enough memory.
+ */
+ModuleData *newModuleEntry(JNIEnv * env)
+{
+    ModuleData *moduleData;
+
+    /* Taking entries is synchronized, adding entries is not. This way, no entry
+     * can be taken and put back while we are taking it.
+     */
+    (*env)->MonitorEnter(env, unusedModuleListLock);
+    do {
+	moduleData = unusedModuleListHead;
+    } while ((moduleData != NULL_PTR)
+	     && !atomicCompareAndSwapPointer((void * volatile *) &unusedModuleListHead, moduleData, moduleData->next));
+    (*env)->MonitorExit(env, unusedModuleListLock);
+
+    if (moduleData == NULL_PTR) {
+	moduleData = (ModuleData *) malloc(sizeof(ModuleData));
+	if (moduleData == NULL_PTR) {
+	    throwOutOfMemoryError(env);
+	    return NULL_PTR;
+	}
+	moduleData->outputLengthSlots = newOutputLengthSlots();
+    } else {
+	/* the hints belong to the sessions of the previous module */
+	resetOutputLengthSlots(moduleData->outputLengthSlots);
+    }
+    moduleData->hModule = NULL_PTR;
+    moduleData->ckFunctionListPtr = NULL_PTR;
+    moduleData->applicationMutexHandler = NULL_PTR;
+    moduleData->next = NULL_PTR;
+    moduleData->referenceCount = 1;
+
+    return moduleData;
+}
+
+/*
+ * Set the given module data as the module of the given pkcs11Implementation.
+ * If the pkcs11Implementation is already connected, the old module data is
+ * released. None of the arguments can be NULL_PTR. If one of the arguments is
+ * NULL_PTR, this function does nothing.
  */
 void putModuleEntry(JNIEnv * env, jobject pkcs11Implementation, ModuleData * moduleData)
 {
-    ModuleListNode *currentNode, *newNode;
+    ModuleData *oldModuleData;
 
     if (pkcs11Implementation == NULL_PTR) {
 	return;
@@ -154,167 +197,116 @@ void putModuleEntry(JNIEnv * env, jobject pkcs11Implementation, ModuleData * mod
 	return;
     }
 
-    (*env)->MonitorEnter(env, moduleListLock);	/* synchronize access to list */
-
-    if (moduleListHead == NULL_PTR) {
-	/* this is the first entry */
-	newNode = (ModuleListNode *) malloc(sizeof(ModuleListNode));
-	if (newNode == NULL_PTR) {
-	    throwOutOfMemoryError(env);
-	    return;
-	}
-	newNode->pkcs11Implementation = pkcs11Implementation;
-	newNode->moduleData = moduleData;
-	newNode->next = NULL_PTR;
-
-	moduleListHead = newNode;
+    /* connect and disconnect are synchronized on the pkcs11Implementation */
+    oldModuleData = (ModuleData *) jLongToPtr((*env)->GetLongField(env, pkcs11Implementation, jniCache.pkcs11Implementation.moduleHandle_));
+    (*env)->SetLongField(env, pkcs11Implementation, jniCache.pkcs11Implementation.moduleHandle_, ptrToJLong(moduleData));
+    if (oldModuleData != NULL_PTR) {
+	releaseModuleEntry(oldModuleData);
     } else {
-	/* go to the last entry; i.e. the first node which's 'next' is NULL_PTR.
-	 * we also stop, when we the pkcs11Implementation object is already in the list.
-	 * then we override the old moduleData with the new one
-	 */
-	currentNode = moduleListHead;
-	while ((currentNode->next != NULL_PTR)
-	       && (!equals(env, pkcs11Implementation, currentNode->pkcs11Implementation))) {
-	    currentNode = currentNode->next;
-	}
-	if (!equals(env, pkcs11Implementation, currentNode->pkcs11Implementation)) {
-	    /* this pkcs11Implementation is not present yet, append the new node */
-	    newNode = (ModuleListNode *) malloc(sizeof(ModuleListNode));
-	    if (newNode == NULL_PTR) {
-		throwOutOfMemoryError(env);
-		return;
-	    }
-	    newNode->pkcs11Implementation = pkcs11Implementation;
-	    newNode->moduleData = moduleData;
-	    newNode->next = NULL_PTR;
-
-	    currentNode->next = newNode;
-	} else {
-	    /* this pkcs11Implementation is already present, set the new moduleData */
-	    currentNode->moduleData = moduleData;
-	}
+	atomicIncrement(&connectedModuleCount);
     }
-
-    (*env)->MonitorExit(env, moduleListLock);	/* synchronize access to list */
 }
 
 /*
- * Get the module data of the entry for the given pkcs11Implementation. Returns
- * NULL_PTR, if the pkcs11Implementation is not in the list.
+ * Get the module data of the given pkcs11Implementation and take a reference to
+ * it. The caller must give the reference back with releaseModuleEntry. Returns
+ * NULL_PTR, if the pkcs11Implementation is not connected.
  */
 ModuleData *getModuleEntry(JNIEnv * env, jobject pkcs11Implementation)
 {
-    ModuleListNode *currentNode;
-    ModuleData *moduleDataOfFoundNode;
-
-    moduleDataOfFoundNode = NULL_PTR;
+    ModuleData *moduleData;
+    long referenceCount;
 
     if (pkcs11Implementation == NULL_PTR) {
 	/* Nothing to do. */
 	return NULL_PTR;
     }
 
-    /* We stop, when we the pkcs11Implementation object is already in the list.
-     * We also stop, when we reach the end; i.e. the first node which's 'next'
-     * is NULL_PTR.
-     */
-    (*env)->MonitorEnter(env, moduleListLock);	/* synchronize access to list */
-
-    if (moduleListHead != NULL_PTR) {
-	currentNode = moduleListHead;
-	while ((currentNode->next != NULL_PTR)
-	       && (!equals(env, pkcs11Implementation, currentNode->pkcs11Implementation))) {
-	    currentNode = currentNode->next;
+    for (;;) {
+	moduleData = (ModuleData *) jLongToPtr((*env)->GetLongField(env, pkcs11Implementation, jniCache.pkcs11Implementation.moduleHandle_));
+	if (moduleData == NULL_PTR) {
+	    /* not connected */
+	    return NULL_PTR;
 	}
-	if (equals(env, pkcs11Implementation, currentNode->pkcs11Implementation)) {
-	    /* we found the entry */
-	    moduleDataOfFoundNode = currentNode->moduleData;
-	} else {
-	    /* the entry is not in the list */
-	    moduleDataOfFoundNode = NULL_PTR;
+
+	/* Take a reference, unless the last one was already released. In this
+	 * case disconnect has already cleared the handle and we read it again.
+	 */
+	do {
+	    referenceCount = moduleData->referenceCount;
+	} while ((referenceCount > 0)
+		 && !atomicCompareAndSwap(&moduleData->referenceCount, referenceCount, referenceCount + 1));
+
+	if (referenceCount > 0) {
+	    /* the entry may have been reused for another connection in the meantime */
+	    if (moduleData == (ModuleData *) jLongToPtr((*env)->GetLongField(env, pkcs11Implementation, jniCache.pkcs11Implementation.moduleHandle_))) {
+		return moduleData;
+	    }
+	    releaseModuleEntry(moduleData);
 	}
     }
+}
 
-    (*env)->MonitorExit(env, moduleListLock);	/* synchronize access to list */
-
-    return moduleDataOfFoundNode;
+/*
+ * Give back a reference taken with getModuleEntry or held by a connection. If
+ * this was the last reference, the module gets unloaded and the entry is kept
+ * for reuse.
+ */
+void releaseModuleEntry(ModuleData * moduleData)
+{
+    if (atomicDecrement(&moduleData->referenceCount) == 0) {
+	unloadModule(moduleData);
+	moduleData->ckFunctionListPtr = NULL_PTR;
+	do {
+	    moduleData->next = unusedModuleListHead;
+	} while (!atomicCompareAndSwapPointer((void * volatile *) &unusedModuleListHead, moduleData->next, moduleData));
+    }
 }
 
 /*
- * Removes the entry for the given pkcs11Implementation from the list. Returns
- * the module's data, after the node was removed. If this function returns NULL_PTR
- * the pkcs11Implementation was not in the list.
+ * Removes the module data from the given pkcs11Implementation. Returns the
+ * module's data, which still holds the reference of the connection. If this
+ * function returns NULL_PTR the pkcs11Implementation was not connected.
  */
 ModuleData *removeModuleEntry(JNIEnv * env, jobject pkcs11Implementation)
 {
-    ModuleListNode *currentNode, *previousNode;
-    ModuleData *moduleDataOfFoundNode;
-
-    moduleDataOfFoundNode = NULL_PTR;
+    ModuleData *moduleData;
 
     if (pkcs11Implementation == NULL_PTR) {
 	/* Nothing to do. */
 	return NULL_PTR;
     }
 
-    /* We stop, when we the pkcs11Implementation object is already in the list.
-     * We also stop, when we reach the end; i.e. the first node which's 'next'
-     * is NULL_PTR. We remember the previous node the be able to remove the node
-     * later.
-     */
-    (*env)->MonitorEnter(env, moduleListLock);	/* synchronize access to list */
-
-    if (moduleListHead != NULL_PTR) {
-	currentNode = moduleListHead;
-	previousNode = NULL_PTR;
-	while ((currentNode->next != NULL_PTR)
-	       && (!equals(env, pkcs11Implementation, currentNode->pkcs11Implementation))) {
-	    previousNode = currentNode;
-	    currentNode = currentNode->next;
-	}
-	if (equals(env, pkcs11Implementation, currentNode->pkcs11Implementation)) {
-	    /* we found the entry, so remove it */
-	    if (previousNode == NULL_PTR) {
-		/* it's the first node */
-		moduleListHead = currentNode->next;
-	    } else {
-		previousNode->next = currentNode->next;
-	    }
-	    moduleDataOfFoundNode = currentNode->moduleData;
-	    (*env)->DeleteGlobalRef(env, currentNode->pkcs11Implementation);
-	    free(currentNode);
-	} else {
-	    /* the entry is not in the list */
-	    moduleDataOfFoundNode = NULL_PTR;
-	}
+    /* connect and disconnect are synchronized on the pkcs11Implementation */
+    moduleData = (ModuleData *) jLongToPtr((*env)->GetLongField(env, pkcs11Implementation, jniCache.pkcs11Implementation.moduleHandle_));
+    if (moduleData != NULL_PTR) {
+	(*env)->SetLongField(env, pkcs11Implementation, jniCache.pkcs11Implementation.moduleHandle_, 0L);
+	atomicDecrement(&connectedModuleCount);
     }
 
-    (*env)->MonitorExit(env, moduleListLock);	/* synchronize access to list */
-
-    return moduleDataOfFoundNode;
+    return moduleData;
 }
 
 /*
- * Removes all present entries from the list of modules and frees all
- * associated resources. This function is used for clean-up.
+ * Frees all unused module data entries. This function is used for clean-up,
+ * when no module is connected any longer.
  */
 void removeAllModuleEntries(JNIEnv * env)
 {
-    ModuleListNode *currentNode, *nextNode;
+    ModuleData *moduleData, *nextModuleData;
 
-    (*env)->MonitorEnter(env, moduleListLock);	/* synchronize access to list */
+    (*env)->MonitorEnter(env, unusedModuleListLock);
 
-    currentNode = moduleListHead;
-    while (currentNode != NULL_PTR) {
-	nextNode = currentNode->next;
-	(*env)->DeleteGlobalRef(env, currentNode->pkcs11Implementation);
-	free(currentNode);
-	currentNode = nextNode;
+    moduleData = unusedModuleListHead;
+    unusedModuleListHead = NULL_PTR;
+    while (moduleData != NULL_PTR) {
+	nextModuleData = moduleData->next;
+	free(moduleData->outputLengthSlots);
+	free(moduleData);
+	moduleData = nextModuleData;
     }
-    moduleListHead = NULL_PTR;
 
-    (*env)->MonitorExit(env, moduleListLock);	/* synchronize access to list */
+    (*env)->MonitorExit(env, unusedModuleListLock);
 }
 
 /*
@@ -326,10 +318,8 @@ jobject createLockObject(JNIEnv * env)
     jobject jLockObject;
     jmethodID jConstructor;
 
-    jObjectClass = (*env)->FindClass(env, "java/lang/Object");
-    assert(jObjectClass != 0);
-    jConstructor = (*env)->GetMethodID(env, jObjectClass, "<init>", "()V");
-    assert(jConstructor != 0);
+    jObjectClass = jniCache.object.clazz;
+    jConstructor = jniCache.object.init;
     jLockObject = (*env)->NewObject(env, jObjectClass, jConstructor);
     assert(jLockObject != 0);
     jLockObject = (*env)->NewGlobalRef(env, jLockObject);
@@ -358,6 +348,9 @@ int isModulePresent(JNIEnv * env, jobject pkcs11Implementation)
     ModuleData *moduleData = getModuleEntry(env, pkcs11Implementation);
 
     present = (moduleData != NULL_PTR) ? 1 : 0;
+    if (moduleData != NULL_PTR) {
+	releaseModuleEntry(moduleData);
+    }
 
     return present;
 }
@@ -378,14 +371,11 @@ int isModulePresent(JNIEnv * env, jobject pkcs11Implementation)
 CK_C_INITIALIZE_ARGS_PTR makeCKInitArgsAdapter(JNIEnv * env, jobject jInitArgs, jboolean jUseUtf8)
 {
     CK_C_INITIALIZE_ARGS_PTR ckpInitArgs;
-    jclass jInitArgsClass = (*env)->FindClass(env, CLASS_C_INITIALIZE_ARGS);
     jfieldID fieldID;
     jlong jFlags;
     jobject jReserved;
     CK_ULONG ckReservedLength;
-#ifndef NO_CALLBACKS
     jobject jMutexHandler;
-#endif				/* NO_CALLBACKS */
 
     if (jInitArgs == NULL_PTR) {
 	return NULL_PTR;
@@ -398,61 +388,65 @@ CK_C_INITIALIZE_ARGS_PTR makeCKInitArgsAdapter(JNIEnv * env, jobject jInitArgs,
 	return NULL_PTR;
     }
 
-    /* Set the mutex functions that will call the Java mutex functions, but
-     * only set it, if the field is not NULL_PTR.
+    /* If the application requested the native mutexes of the wrapper, set the
+     * mutex functions that use the mutexes of the operating system directly.
      */
+    fieldID = jniCache.initializeArgs.CreateMutex;
+    jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
+    if ((jMutexHandler != NULL_PTR) && (*env)->IsInstanceOf(env, jMutexHandler, jniCache.nativeMutexes.clazz)) {
+	ckpInitArgs->CreateMutex = &createNativeMutex;
+	ckpInitArgs->DestroyMutex = &destroyNativeMutex;
+	ckpInitArgs->LockMutex = &lockNativeMutex;
+	ckpInitArgs->UnlockMutex = &unlockNativeMutex;
+    } else {
+	/* Set the mutex functions that will call the Java mutex functions, but
+	 * only set it, if the field is not NULL_PTR.
+	 */
 #ifdef NO_CALLBACKS
-    ckpInitArgs->CreateMutex = NULL_PTR;
-    ckpInitArgs->DestroyMutex = NULL_PTR;
-    ckpInitArgs->LockMutex = NULL_PTR;
-    ckpInitArgs->UnlockMutex = NULL_PTR;
+	ckpInitArgs->CreateMutex = NULL_PTR;
+	ckpInitArgs->DestroyMutex = NULL_PTR;
+	ckpInitArgs->LockMutex = NULL_PTR;
+	ckpInitArgs->UnlockMutex = NULL_PTR;
 #else
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "CreateMutex", CLASS_NAME(CLASS_CREATEMUTEX));
-    assert(fieldID != 0);
-    jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
-    ckpInitArgs->CreateMutex = (jMutexHandler != NULL_PTR) ? &callJCreateMutex : NULL_PTR;
-
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "DestroyMutex", CLASS_NAME(CLASS_DESTROYMUTEX));
-    assert(fieldID != 0);
-    jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
-    ckpInitArgs->DestroyMutex = (jMutexHandler != NULL_PTR) ? &callJDestroyMutex : NULL_PTR;
-
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "LockMutex", CLASS_NAME(CLASS_LOCKMUTEX));
-    assert(fieldID != 0);
-    jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
-    ckpInitArgs->LockMutex = (jMutexHandler != NULL_PTR) ? &callJLockMutex : NULL_PTR;
-
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "UnlockMutex", CLASS_NAME(CLASS_UNLOCKMUTEX));
-    assert(fieldID != 0);
-    jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
-    ckpInitArgs->UnlockMutex = (jMutexHandler != NULL_PTR) ? &callJUnlockMutex : NULL_PTR;
-
-    if ((ckpInitArgs->CreateMutex != NULL_PTR)
-	|| (ckpInitArgs->DestroyMutex != NULL_PTR)
-	|| (ckpInitArgs->LockMutex != NULL_PTR)
-	|| (ckpInitArgs->UnlockMutex != NULL_PTR)) {
-	/* we only need to keep a global copy, if we need callbacks */
-	/* set the global object jInitArgs so that the right Java mutex functions will be called */
-	jInitArgsObject = (*env)->NewGlobalRef(env, jInitArgs);
-	ckpGlobalInitArgs = (CK_C_INITIALIZE_ARGS_PTR) malloc(sizeof(CK_C_INITIALIZE_ARGS));
-	if (ckpGlobalInitArgs == NULL_PTR) {
-	    free(ckpInitArgs);
-	    throwOutOfMemoryError(env);
-	    return NULL_PTR;
+	ckpInitArgs->CreateMutex = (jMutexHandler != NULL_PTR) ? &callJCreateMutex : NULL_PTR;
+
+	fieldID = jniCache.initializeArgs.DestroyMutex;
+	jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
+	ckpInitArgs->DestroyMutex = (jMutexHandler != NULL_PTR) ? &callJDestroyMutex : NULL_PTR;
+
+	fieldID = jniCache.initializeArgs.LockMutex;
+	jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
+	ckpInitArgs->LockMutex = (jMutexHandler != NULL_PTR) ? &callJLockMutex : NULL_PTR;
+
+	fieldID = jniCache.initializeArgs.UnlockMutex;
+	jMutexHandler = (*env)->GetObjectField(env, jInitArgs, fieldID);
+	ckpInitArgs->UnlockMutex = (jMutexHandler != NULL_PTR) ? &callJUnlockMutex : NULL_PTR;
+
+	if ((ckpInitArgs->CreateMutex != NULL_PTR)
+	    || (ckpInitArgs->DestroyMutex != NULL_PTR)
+	    || (ckpInitArgs->LockMutex != NULL_PTR)
+	    || (ckpInitArgs->UnlockMutex != NULL_PTR)) {
+	    /* we only need to keep a global copy, if we need callbacks */
+	    /* set the global object jInitArgs so that the right Java mutex functions will be called */
+	    jInitArgsObject = (*env)->NewGlobalRef(env, jInitArgs);
+	    ckpGlobalInitArgs = (CK_C_INITIALIZE_ARGS_PTR) malloc(sizeof(CK_C_INITIALIZE_ARGS));
+	    if (ckpGlobalInitArgs == NULL_PTR) {
+		free(ckpInitArgs);
+		throwOutOfMemoryError(env);
+		return NULL_PTR;
+	    }
+	    memcpy(ckpGlobalInitArgs, ckpInitArgs, sizeof(CK_C_INITIALIZE_ARGS));
 	}
-	memcpy(ckpGlobalInitArgs, ckpInitArgs, sizeof(CK_C_INITIALIZE_ARGS));
-    }
 #endif				/* NO_CALLBACKS */
+    }
 
     /* convert and set the flags field */
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "flags", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.initializeArgs.flags;
     jFlags = (*env)->GetLongField(env, jInitArgs, fieldID);
     ckpInitArgs->flags = jLongToCKULong(jFlags);
 
     /* pReserved should be NULL_PTR in this version */
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "pReserved", "Ljava/lang/Object;");
-    assert(fieldID != 0);
+    fieldID = jniCache.initializeArgs.pReserved;
     jReserved = (*env)->GetObjectField(env, jInitArgs, fieldID);
 
     /* we try to convert the reserved parameter also */
@@ -463,6 +457,30 @@ CK_C_INITIALIZE_ARGS_PTR makeCKInitArgsAdapter(JNIEnv * env, jobject jInitArgs,
 
 #ifndef NO_CALLBACKS
 
+/*
+ * Returns the JNI environment of the calling thread for a callback from the
+ * module. A native thread of the module, which is not attached to the VM yet,
+ * gets attached for the rest of its life; the platform layer detaches it when
+ * the thread terminates. Returns NULL_PTR, if there is no VM.
+ */
+JNIEnv *getCallbackEnvironment(void)
+{
+    JNIEnv *env;
+    jint returnValue;
+
+    if (cachedJavaVM == NULL_PTR) {
+	return NULL_PTR;
+    }
+    returnValue = (*cachedJavaVM)->GetEnv(cachedJavaVM, (void **)&env, JNI_VERSION_1_2);
+    if (returnValue == JNI_EDETACHED) {
+	env = attachCurrentThread(cachedJavaVM);
+    } else if (returnValue != JNI_OK) {
+	env = NULL_PTR;
+    }
+
+    return env;
+}
+
 /*
  * is the function that gets called by PKCS#11 to create a mutex and calls the Java
  * CreateMutex function
@@ -473,59 +491,32 @@ CK_C_INITIALIZE_ARGS_PTR makeCKInitArgsAdapter(JNIEnv * env, jobject jInitArgs,
  */
 CK_RV callJCreateMutex(CK_VOID_PTR_PTR ppMutex)
 {
-    JavaVM *jvm;
     JNIEnv *env;
-    jsize actualNumberVMs;
-    jint returnValue;
     jthrowable pkcs11Exception;
-    jclass pkcs11ExceptionClass;
     jlong errorCode;
     CK_RV rv = CKR_OK;
-    int wasAttached = 1;
-    jclass jCreateMutexClass;
-    jclass jInitArgsClass;
     jmethodID methodID;
     jfieldID fieldID;
     jobject jCreateMutex;
     jobject jMutex;
 
-    /* Get the currently running Java VM */
-    returnValue = JNI_GetCreatedJavaVMs(&jvm, (jsize) 1, &actualNumberVMs);
-    if ((returnValue != 0) || (actualNumberVMs <= 0)) {
+    /* Get the environment of this thread, attach it if it is a thread of the module */
+    env = getCallbackEnvironment();
+    if (env == NULL_PTR) {
 	return rv;
     }				/* there is no VM running */
-
-    /* Determine, if current thread is already attached */
-    returnValue = (*jvm)->GetEnv(jvm, (void **)&env, JNI_VERSION_1_2);
-    if (returnValue == JNI_EDETACHED) {
-	/* thread detached, so attach it */
-	wasAttached = 0;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else if (returnValue == JNI_EVERSION) {
-	/* this version of JNI is not supported, so just try to attach */
-	/* we assume it was attached to ensure that this thread is not detached
-	 * afterwards even though it should not
-	 */
-	wasAttached = 1;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else {
-	/* attached */
-	wasAttached = 1;
+    if ((*env)->PushLocalFrame(env, 16) != 0) {
+	return CKR_HOST_MEMORY;
     }
 
-    jCreateMutexClass = (*env)->FindClass(env, CLASS_CREATEMUTEX);
-    jInitArgsClass = (*env)->FindClass(env, CLASS_C_INITIALIZE_ARGS);
-
     /* get the CreateMutex object out of the jInitArgs object */
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "CreateMutex", CLASS_NAME(CLASS_CREATEMUTEX));
-    assert(fieldID != 0);
+    fieldID = jniCache.initializeArgs.CreateMutex;
     jCreateMutex = (*env)->GetObjectField(env, jInitArgsObject, fieldID);
     assert(jCreateMutex != 0);
 
     /* call the CK_CREATEMUTEX function of the CreateMutex object */
     /* and get the new Java mutex object */
-    methodID = (*env)->GetMethodID(env, jCreateMutexClass, "CK_CREATEMUTEX", "()Ljava/lang/Object;");
-    assert(methodID != 0);
+    methodID = jniCache.createMutex.callback;
     jMutex = (*env)->CallObjectMethod(env, jCreateMutex, methodID);
 
     /* set a global reference on the Java mutex */
@@ -538,17 +529,14 @@ CK_RV callJCreateMutex(CK_VOID_PTR_PTR ppMutex)
 
     if (pkcs11Exception != NULL_PTR) {
 	/* The was an exception thrown, now we get the error-code from it */
-	pkcs11ExceptionClass = (*env)->FindClass(env, CLASS_PKCS11EXCEPTION);
-	methodID = (*env)->GetMethodID(env, pkcs11ExceptionClass, "getErrorCode", "()J");
-	assert(methodID != 0);
+	(*env)->ExceptionClear(env);
+	methodID = jniCache.pkcs11Exception.getErrorCode;
 	errorCode = (*env)->CallLongMethod(env, pkcs11Exception, methodID);
 	rv = jLongToCKULong(errorCode);
     }
 
-    /* if we attached this thread to the VM just for callback, we detach it now */
-    if (wasAttached) {
-	returnValue = (*jvm)->DetachCurrentThread(jvm);
-    }
+    /* a thread of the module stays attached, so free its local references */
+    (*env)->PopLocalFrame(env, NULL_PTR);
 
     return rv;
 }
@@ -563,61 +551,34 @@ CK_RV callJCreateMutex(CK_VOID_PTR_PTR ppMutex)
  */
 CK_RV callJDestroyMutex(CK_VOID_PTR pMutex)
 {
-    JavaVM *jvm;
     JNIEnv *env;
-    jsize actualNumberVMs;
-    jint returnValue;
     jthrowable pkcs11Exception;
-    jclass pkcs11ExceptionClass;
     jlong errorCode;
     CK_RV rv = CKR_OK;
-    int wasAttached = 1;
-    jclass jDestroyMutexClass;
-    jclass jInitArgsClass;
     jmethodID methodID;
     jfieldID fieldID;
     jobject jDestroyMutex;
     jobject jMutex;
 
-    /* Get the currently running Java VM */
-    returnValue = JNI_GetCreatedJavaVMs(&jvm, (jsize) 1, &actualNumberVMs);
-    if ((returnValue != 0) || (actualNumberVMs <= 0)) {
+    /* Get the environment of this thread, attach it if it is a thread of the module */
+    env = getCallbackEnvironment();
+    if (env == NULL_PTR) {
 	return rv;
     }				/* there is no VM running */
-
-    /* Determine, if current thread is already attached */
-    returnValue = (*jvm)->GetEnv(jvm, (void **)&env, JNI_VERSION_1_2);
-    if (returnValue == JNI_EDETACHED) {
-	/* thread detached, so attach it */
-	wasAttached = 0;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else if (returnValue == JNI_EVERSION) {
-	/* this version of JNI is not supported, so just try to attach */
-	/* we assume it was attached to ensure that this thread is not detached
-	 * afterwards even though it should not
-	 */
-	wasAttached = 1;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else {
-	/* attached */
-	wasAttached = 1;
+    if ((*env)->PushLocalFrame(env, 16) != 0) {
+	return CKR_HOST_MEMORY;
     }
 
-    jDestroyMutexClass = (*env)->FindClass(env, CLASS_DESTROYMUTEX);
-    jInitArgsClass = (*env)->FindClass(env, CLASS_C_INITIALIZE_ARGS);
-
     /* convert the CK mutex to a Java mutex */
     jMutex = ckVoidPtrToJObject(pMutex);
 
     /* get the DestroyMutex object out of the jInitArgs object */
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "DestroyMutex", CLASS_NAME(CLASS_DESTROYMUTEX));
-    assert(fieldID != 0);
+    fieldID = jniCache.initializeArgs.DestroyMutex;
     jDestroyMutex = (*env)->GetObjectField(env, jInitArgsObject, fieldID);
     assert(jDestroyMutex != 0);
 
     /* call the CK_DESTROYMUTEX method of the DestroyMutex object */
-    methodID = (*env)->GetMethodID(env, jDestroyMutexClass, "CK_DESTROYMUTEX", "(Ljava/lang/Object;)V");
-    assert(methodID != 0);
+    methodID = jniCache.destroyMutex.callback;
     (*env)->CallVoidMethod(env, jDestroyMutex, methodID, jMutex);
 
     /* delete the global reference on the Java mutex */
@@ -628,17 +589,14 @@ CK_RV callJDestroyMutex(CK_VOID_PTR pMutex)
 
     if (pkcs11Exception != NULL_PTR) {
 	/* The was an exception thrown, now we get the error-code from it */
-	pkcs11ExceptionClass = (*env)->FindClass(env, CLASS_PKCS11EXCEPTION);
-	methodID = (*env)->GetMethodID(env, pkcs11ExceptionClass, "getErrorCode", "()J");
-	assert(methodID != 0);
+	(*env)->ExceptionClear(env);
+	methodID = jniCache.pkcs11Exception.getErrorCode;
 	errorCode = (*env)->CallLongMethod(env, pkcs11Exception, methodID);
 	rv = jLongToCKULong(errorCode);
     }
 
-    /* if we attached this thread to the VM just for callback, we detach it now */
-    if (wasAttached) {
-	returnValue = (*jvm)->DetachCurrentThread(jvm);
-    }
+    /* a thread of the module stays attached, so free its local references */
+    (*env)->PopLocalFrame(env, NULL_PTR);
 
     return rv;
 }
@@ -653,61 +611,34 @@ CK_RV callJDestroyMutex(CK_VOID_PTR pMutex)
  */
 CK_RV callJLockMutex(CK_VOID_PTR pMutex)
 {
-    JavaVM *jvm;
     JNIEnv *env;
-    jsize actualNumberVMs;
-    jint returnValue;
     jthrowable pkcs11Exception;
-    jclass pkcs11ExceptionClass;
     jlong errorCode;
     CK_RV rv = CKR_OK;
-    int wasAttached = 1;
-    jclass jLockMutexClass;
-    jclass jInitArgsClass;
     jmethodID methodID;
     jfieldID fieldID;
     jobject jLockMutex;
     jobject jMutex;
 
-    /* Get the currently running Java VM */
-    returnValue = JNI_GetCreatedJavaVMs(&jvm, (jsize) 1, &actualNumberVMs);
-    if ((returnValue != 0) || (actualNumberVMs <= 0)) {
+    /* Get the environment of this thread, attach it if it is a thread of the module */
+    env = getCallbackEnvironment();
+    if (env == NULL_PTR) {
 	return rv;
     }				/* there is no VM running */
-
-    /* Determine, if current thread is already attached */
-    returnValue = (*jvm)->GetEnv(jvm, (void **)&env, JNI_VERSION_1_2);
-    if (returnValue == JNI_EDETACHED) {
-	/* thread detached, so attach it */
-	wasAttached = 0;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else if (returnValue == JNI_EVERSION) {
-	/* this version of JNI is not supported, so just try to attach */
-	/* we assume it was attached to ensure that this thread is not detached
-	 * afterwards even though it should not
-	 */
-	wasAttached = 1;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else {
-	/* attached */
-	wasAttached = 1;
+    if ((*env)->PushLocalFrame(env, 16) != 0) {
+	return CKR_HOST_MEMORY;
     }
 
-    jLockMutexClass = (*env)->FindClass(env, CLASS_LOCKMUTEX);
-    jInitArgsClass = (*env)->FindClass(env, CLASS_C_INITIALIZE_ARGS);
-
     /* convert the CK mutex to a Java mutex */
     jMutex = ckVoidPtrToJObject(pMutex);
 
     /* get the LockMutex object out of the jInitArgs object */
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "LockMutex", CLASS_NAME(CLASS_LOCKMUTEX));
-    assert(fieldID != 0);
+    fieldID = jniCache.initializeArgs.LockMutex;
     jLockMutex = (*env)->GetObjectField(env, jInitArgsObject, fieldID);
     assert(jLockMutex != 0);
 
     /* call the CK_LOCKMUTEX method of the LockMutex object */
-    methodID = (*env)->GetMethodID(env, jLockMutexClass, "CK_LOCKMUTEX", "(Ljava/lang/Object;)V");
-    assert(methodID != 0);
+    methodID = jniCache.lockMutex.callback;
     (*env)->CallVoidMethod(env, jLockMutex, methodID, jMutex);
 
     /* check, if callback threw an exception */
@@ -715,17 +646,14 @@ CK_RV callJLockMutex(CK_VOID_PTR pMutex)
 
     if (pkcs11Exception != NULL_PTR) {
 	/* The was an exception thrown, now we get the error-code from it */
-	pkcs11ExceptionClass = (*env)->FindClass(env, CLASS_PKCS11EXCEPTION);
-	methodID = (*env)->GetMethodID(env, pkcs11ExceptionClass, "getErrorCode", "()J");
-	assert(methodID != 0);
+	(*env)->ExceptionClear(env);
+	methodID = jniCache.pkcs11Exception.getErrorCode;
 	errorCode = (*env)->CallLongMethod(env, pkcs11Exception, methodID);
 	rv = jLongToCKULong(errorCode);
     }
 
-    /* if we attached this thread to the VM just for callback, we detach it now */
-    if (wasAttached) {
-	returnValue = (*jvm)->DetachCurrentThread(jvm);
-    }
+    /* a thread of the module stays attached, so free its local references */
+    (*env)->PopLocalFrame(env, NULL_PTR);
 
     return rv;
 }
@@ -740,61 +668,34 @@ CK_RV callJLockMutex(CK_VOID_PTR pMutex)
  */
 CK_RV callJUnlockMutex(CK_VOID_PTR pMutex)
 {
-    JavaVM *jvm;
     JNIEnv *env;
-    jsize actualNumberVMs;
-    jint returnValue;
     jthrowable pkcs11Exception;
-    jclass pkcs11ExceptionClass;
     jlong errorCode;
     CK_RV rv = CKR_OK;
-    int wasAttached = 1;
-    jclass jUnlockMutexClass;
-    jclass jInitArgsClass;
     jmethodID methodID;
     jfieldID fieldID;
     jobject jUnlockMutex;
     jobject jMutex;
 
-    /* Get the currently running Java VM */
-    returnValue = JNI_GetCreatedJavaVMs(&jvm, (jsize) 1, &actualNumberVMs);
-    if ((returnValue != 0) || (actualNumberVMs <= 0)) {
+    /* Get the environment of this thread, attach it if it is a thread of the module */
+    env = getCallbackEnvironment();
+    if (env == NULL_PTR) {
 	return rv;
     }				/* there is no VM running */
-
-    /* Determine, if current thread is already attached */
-    returnValue = (*jvm)->GetEnv(jvm, (void **)&env, JNI_VERSION_1_2);
-    if (returnValue == JNI_EDETACHED) {
-	/* thread detached, so attach it */
-	wasAttached = 0;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else if (returnValue == JNI_EVERSION) {
-	/* this version of JNI is not supported, so just try to attach */
-	/* we assume it was attached to ensure that this thread is not detached
-	 * afterwards even though it should not
-	 */
-	wasAttached = 1;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else {
-	/* attached */
-	wasAttached = 1;
+    if ((*env)->PushLocalFrame(env, 16) != 0) {
+	return CKR_HOST_MEMORY;
     }
 
-    jUnlockMutexClass = (*env)->FindClass(env, CLASS_UNLOCKMUTEX);
-    jInitArgsClass = (*env)->FindClass(env, CLASS_C_INITIALIZE_ARGS);
-
     /* convert the CK-type mutex to a Java mutex */
     jMutex = ckVoidPtrToJObject(pMutex);
 
     /* get the UnlockMutex object out of the jInitArgs object */
-    fieldID = (*env)->GetFieldID(env, jInitArgsClass, "UnlockMutex", CLASS_NAME(CLASS_UNLOCKMUTEX));
-    assert(fieldID != 0);
+    fieldID = jniCache.initializeArgs.UnlockMutex;
     jUnlockMutex = (*env)->GetObjectField(env, jInitArgsObject, fieldID);
     assert(jUnlockMutex != 0);
 
     /* call the CK_UNLOCKMUTEX method of the UnLockMutex object */
-    methodID = (*env)->GetMethodID(env, jUnlockMutexClass, "CK_UNLOCKMUTEX", "(Ljava/lang/Object;)V");
-    assert(methodID != 0);
+    methodID = jniCache.unlockMutex.callback;
     (*env)->CallVoidMethod(env, jUnlockMutex, methodID, jMutex);
 
     /* check, if callback threw an exception */
@@ -802,17 +703,14 @@ CK_RV callJUnlockMutex(CK_VOID_PTR pMutex)
 
     if (pkcs11Exception != NULL_PTR) {
 	/* The was an exception thrown, now we get the error-code from it */
-	pkcs11ExceptionClass = (*env)->FindClass(env, CLASS_PKCS11EXCEPTION);
-	methodID = (*env)->GetMethodID(env, pkcs11ExceptionClass, "getErrorCode", "()J");
-	assert(methodID != 0);
+	(*env)->ExceptionClear(env);
+	methodID = jniCache.pkcs11Exception.getErrorCode;
 	errorCode = (*env)->CallLongMethod(env, pkcs11Exception, methodID);
 	rv = jLongToCKULong(errorCode);
     }
 
-    /* if we attached this thread to the VM just for callback, we detach it now */
-    if (wasAttached) {
-	returnValue = (*jvm)->DetachCurrentThread(jvm);
-    }
+    /* a thread of the module stays attached, so free its local references */
+    (*env)->PopLocalFrame(env, NULL_PTR);
 
     return rv;
 }
@@ -959,19 +857,13 @@ CK_RV notifyCallback(CK_SESSION_HANDLE hSession,	/* the session's handle */
     )
 {
     NotifyEncapsulation *notifyEncapsulation;
-    JavaVM *jvm;
     JNIEnv *env;
-    jsize actualNumberVMs;
-    jint returnValue;
     jlong jSessionHandle;
     jlong jEvent;
-    jclass ckNotifyClass;
     jmethodID jmethod;
     jthrowable pkcs11Exception;
-    jclass pkcs11ExceptionClass;
     jlong errorCode;
     CK_RV rv = CKR_OK;
-    int wasAttached = 1;
 
     if (pApplication == NULL_PTR) {
 	return rv;
@@ -979,37 +871,19 @@ CK_RV notifyCallback(CK_SESSION_HANDLE hSession,	/* the session's handle */
 
     notifyEncapsulation = (NotifyEncapsulation *) pApplication;
 
-    /* Get the currently running Java VM */
-    returnValue = JNI_GetCreatedJavaVMs(&jvm, (jsize) 1, &actualNumberVMs);
-    if ((returnValue != 0) || (actualNumberVMs <= 0)) {
+    /* Get the environment of this thread, attach it if it is a thread of the module */
+    env = getCallbackEnvironment();
+    if (env == NULL_PTR) {
 	return rv;
     }				/* there is no VM running */
-
-    /* Determine, if current thread is already attached */
-    returnValue = (*jvm)->GetEnv(jvm, (void **)&env, JNI_VERSION_1_2);
-    if (returnValue == JNI_EDETACHED) {
-	/* thread detached, so attach it */
-	wasAttached = 0;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else if (returnValue == JNI_EVERSION) {
-	/* this version of JNI is not supported, so just try to attach */
-	/* we assume it was attached to ensure that this thread is not detached
-	 * afterwards even though it should not
-	 */
-	wasAttached = 1;
-	returnValue = (*jvm)->AttachCurrentThread(jvm, (void **)&env, NULL_PTR);
-    } else {
-	/* attached */
-	wasAttached = 1;
+    if ((*env)->PushLocalFrame(env, 16) != 0) {
+	return CKR_HOST_MEMORY;
     }
 
     jSessionHandle = ckULongToJLong(hSession);
     jEvent = ckULongToJLong(event);
 
-    ckNotifyClass = (*env)->FindClass(env, CLASS_NOTIFY);
-    assert(ckNotifyClass != 0);
-    jmethod = (*env)->GetMethodID(env, ckNotifyClass, "CK_NOTIFY", "(JJLjava/lang/Object;)V");
-    assert(jmethod != 0);
+    jmethod = jniCache.notify.callback;
     (*env)->CallVoidMethod(env, notifyEncapsulation->jNotifyObject, jmethod,
 			   jSessionHandle, jEvent, notifyEncapsulation->jApplicationData);
 
@@ -1018,17 +892,14 @@ CK_RV notifyCallback(CK_SESSION_HANDLE hSession,	/* the session's handle */
 
     if (pkcs11Exception != NULL_PTR) {
 	/* The was an exception thrown, now we get the error-code from it */
-	pkcs11ExceptionClass = (*env)->FindClass(env, CLASS_PKCS11EXCEPTION);
-	jmethod = (*env)->GetMethodID(env, pkcs11ExceptionClass, "getErrorCode", "()J");
-	assert(jmethod != 0);
+	(*env)->ExceptionClear(env);
+	jmethod = jniCache.pkcs11Exception.getErrorCode;
 	errorCode = (*env)->CallLongMethod(env, pkcs11Exception, jmethod);
 	rv = jLongToCKULong(errorCode);
     }
 
-    /* if we attached this thread to the VM just for callback, we detach it now */
-    if (wasAttached) {
-	returnValue = (*jvm)->DetachCurrentThread(jvm);
-    }
+    /* a thread of the module stays attached, so free its local references */
+    (*env)->PopLocalFrame(env, NULL_PTR);
 
     return rv;
 }
@@ -79,11 +79,13 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Cr
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -106,6 +108,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Cr
 	}
     free(ckpAttributes);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jObjectHandle;
 }
@@ -143,12 +146,14 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Co
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     ckObjectHandle = jLongToCKULong(jObjectHandle);
     if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -172,6 +177,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Co
 	}
     free(ckpAttributes);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 
     return jNewObjectHandle;
@@ -202,6 +208,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Des
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -211,6 +218,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Des
     rv = (*ckpFunctions->C_DestroyObject) (ckSessionHandle, ckObjectHandle);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -242,6 +250,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ge
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -250,11 +259,13 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ge
 
     rv = (*ckpFunctions->C_GetObjectSize) (ckSessionHandle, ckObjectHandle, &ckObjectSize);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
     jObjectSize = ckULongToJLong(ckObjectSize);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jObjectSize;
 }
@@ -289,6 +300,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Set
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -313,6 +325,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Set
     }
     free(ckpAttributes);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -344,6 +357,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -351,6 +365,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     if (jAttributeArrayToCKAttributeArray(env, jTemplate, &ckpAttributes, &ckAttributesLength, jUseUtf8)) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -371,6 +386,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
     }
     free(ckpAttributes);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -404,14 +420,16 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     ckMaxObjectLength = jLongToCKULong(jMaxObjectCount);
-    ckpObjectHandleArray = (CK_OBJECT_HANDLE_PTR) malloc(sizeof(CK_OBJECT_HANDLE) * ckMaxObjectLength);
+    ckpObjectHandleArray = (CK_OBJECT_HANDLE_PTR) scratchAlloc(sizeof(CK_OBJECT_HANDLE) * ckMaxObjectLength);
     if (ckpObjectHandleArray == NULL_PTR && ckMaxObjectLength != 0) {
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -424,12 +442,89 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     } else
 	jObjectHandleArray = NULL_PTR;
 
-    free(ckpObjectHandleArray);
+    scratchFree(ckpObjectHandleArray);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jObjectHandleArray;
 }
 
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_FindObjectsInto
+ * Signature: (J[JI)I
+ * Parametermapping:                        *PKCS11*
+ * @param   jlong jSessionHandle            CK_SESSION_HANDLE hSession
+ * @param   jlongArray jObjectHandleArray   CK_OBJECT_HANDLE_PTR phObject
+ * @param   jint jMaxObjectCount            CK_ULONG ulMaxObjectCount
+ * @return  jint jObjectCount               CK_ULONG_PTR pulObjectCount
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1FindObjectsInto
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jlongArray jObjectHandleArray, jint jMaxObjectCount) {
+    CK_RV rv;
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_ULONG ckMaxObjectLength;
+    CK_OBJECT_HANDLE_PTR ckpObjectHandleArray;
+    CK_ULONG ckActualObjectCount, i;
+    jlong *jpObjectHandles;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    if (jObjectHandleArray == NULL_PTR || jMaxObjectCount < 0
+	|| (*env)->GetArrayLength(env, jObjectHandleArray) < jMaxObjectCount) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The handle array must hold the max. object count."));
+	return 0;
+    }
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* both buffers come from the scratch arena of this thread, so repeated calls do not allocate */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckMaxObjectLength = jLongToCKULong(jMaxObjectCount);
+    ckpObjectHandleArray = (CK_OBJECT_HANDLE_PTR) scratchAlloc(sizeof(CK_OBJECT_HANDLE) * ckMaxObjectLength);
+    jpObjectHandles = (jlong *) scratchAlloc(sizeof(jlong) * ckMaxObjectLength);
+    if (ckpObjectHandleArray == NULL_PTR || jpObjectHandles == NULL_PTR) {
+	scratchFree(jpObjectHandles);
+	scratchFree(ckpObjectHandleArray);
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    ckActualObjectCount = 0;
+    rv = (*ckpFunctions->C_FindObjects) (ckSessionHandle, ckpObjectHandleArray, ckMaxObjectLength,
+					 &ckActualObjectCount);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+	if (ckActualObjectCount > ckMaxObjectLength) {
+	    ckActualObjectCount = ckMaxObjectLength;
+	}
+	for (i = 0; i < ckActualObjectCount; i++) {
+	    jpObjectHandles[i] = ckULongToJLong(ckpObjectHandleArray[i]);
+	}
+	(*env)->SetLongArrayRegion(env, jObjectHandleArray, 0, (jsize) ckActualObjectCount, jpObjectHandles);
+    } else {
+	ckActualObjectCount = 0;
+    }
+
+    scratchFree(jpObjectHandles);
+    scratchFree(ckpObjectHandleArray);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return (jint) ckActualObjectCount;
+}
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_FindObjectsFinal
@@ -453,6 +548,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -460,5 +556,6 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
     rv = (*ckpFunctions->C_FindObjectsFinal) (ckSessionHandle);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
@@ -64,9 +64,14 @@
 #include "sessions.c"
 #include "signature.c"
 #include "slotsandtokens.c"
+#include "util_batch.c"
 #include "util_conversion.c"
 #include "util_conversion_algorithms.c"
 #include "util_errorhandling.c"
+#include "util_jnicache.c"
+#include "util_outputlength.c"
+#include "util_scratch.c"
+#include "workerpool.c"
     
 #include "platform.c"
     
@@ -79,17 +84,45 @@
 /* Functions called by the VM when it loads or unloads this library           */ 
 /* ************************************************************************** */ 
      
+JavaVM *cachedJavaVM = NULL_PTR;
+
 /*
-JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved) 
+ * Fills the cache of Java classes, field IDs and method IDs and remembers the VM
+ * for callbacks from the module. If a class or member cannot be resolved, loading
+ * the library fails with the pending Java error.
+ */
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved)
 {
+  JNIEnv *env;
+
+  if ((*vm)->GetEnv(vm, (void **) &env, JNI_VERSION_1_2) != JNI_OK) {
+    return JNI_ERR;
+  }
+  if (initializeJNICache(env) != JNI_OK) {
+    releaseJNICache(env);
+    return JNI_ERR;
+  }
+  initializeThreadAttachment();
+  initializeScratchArenas();
+  cachedJavaVM = vm;
+
   return JNI_VERSION_1_2 ;
 }
 
+/*
+ * Releases the global class references held by the cache.
+ */
 JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *vm, void *reserved)
 {
+  JNIEnv *env;
 
+  cachedJavaVM = NULL_PTR;
+  finalizeThreadAttachment();
+  finalizeScratchArenas();
+  if ((*vm)->GetEnv(vm, (void **) &env, JNI_VERSION_1_2) == JNI_OK) {
+    releaseJNICache(env);
+  }
 }
-*/ 
     
 /* ************************************************************************** */ 
 /* Helper functions                                                           */ 
@@ -146,10 +179,8 @@ int equals(JNIEnv * env, jobject thisObject, jobject otherObject)
     jboolean jequal = JNI_FALSE;
     int returnValue;
      if (thisObject != NULL_PTR) {
-	jObjectClass = (*env)->FindClass(env, "java/lang/Object");
-	assert(jObjectClass != 0);
-	jequals = (*env)->GetMethodID(env, jObjectClass, "equals", "(Ljava/lang/Object;)Z");
-	assert(jequals != 0);
+	jObjectClass = jniCache.object.clazz;
+	jequals = jniCache.object.equals;
 	
 	    /* We must call the equals method as implemented by the Object class. This
 	     * method compares if both references refer to the same object. This is what
@@ -172,67 +203,67 @@ int equals(JNIEnv * env, jobject thisObject, jobject otherObject)
     case CKM_RSA_PKCS_OAEP:
 	value = ((CK_RSA_PKCS_OAEP_PARAMS_PTR) mechanism->pParameter)->pSourceData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_KEA_KEY_DERIVE:
 	value = ((CK_KEA_DERIVE_PARAMS_PTR) mechanism->pParameter)->pRandomA;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_KEA_DERIVE_PARAMS_PTR) mechanism->pParameter)->pRandomB;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_KEA_DERIVE_PARAMS_PTR) mechanism->pParameter)->pPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_RC5_CBC:
     case CKM_RC5_CBC_PAD:
 	value = ((CK_RC5_CBC_PARAMS_PTR) mechanism->pParameter)->pIv;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_SKIPJACK_PRIVATE_WRAP:
 	value = ((CK_SKIPJACK_PRIVATE_WRAP_PTR) mechanism->pParameter)->pPassword;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_PRIVATE_WRAP_PTR) mechanism->pParameter)->pPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_PRIVATE_WRAP_PTR) mechanism->pParameter)->pRandomA;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_PRIVATE_WRAP_PTR) mechanism->pParameter)->pPrimeP;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_PRIVATE_WRAP_PTR) mechanism->pParameter)->pBaseG;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_PRIVATE_WRAP_PTR) mechanism->pParameter)->pSubprimeQ;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_SKIPJACK_RELAYX:
 	value = ((CK_SKIPJACK_RELAYX_PARAMS_PTR) mechanism->pParameter)->pOldWrappedX;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_RELAYX_PARAMS_PTR) mechanism->pParameter)->pOldPassword;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_RELAYX_PARAMS_PTR) mechanism->pParameter)->pOldPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_RELAYX_PARAMS_PTR) mechanism->pParameter)->pOldRandomA;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_RELAYX_PARAMS_PTR) mechanism->pParameter)->pNewPassword;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_RELAYX_PARAMS_PTR) mechanism->pParameter)->pNewPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SKIPJACK_RELAYX_PARAMS_PTR) mechanism->pParameter)->pNewRandomA;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_PBE_MD2_DES_CBC:
     case CKM_PBE_MD5_DES_CBC:
@@ -253,21 +284,21 @@ int equals(JNIEnv * env, jobject thisObject, jobject otherObject)
     case CKM_PBA_SHA1_WITH_SHA1_HMAC:
 	value = ((CK_PBE_PARAMS_PTR) mechanism->pParameter)->pInitVector;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_PBE_PARAMS_PTR) mechanism->pParameter)->pPassword;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_PBE_PARAMS_PTR) mechanism->pParameter)->pSalt;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_PKCS5_PBKD2:
 	value = ((CK_PKCS5_PBKD2_PARAMS_PTR) mechanism->pParameter)->pSaltSourceData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_PKCS5_PBKD2_PARAMS_PTR) mechanism->pParameter)->pPrfData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_CONCATENATE_BASE_AND_DATA:
     case CKM_XOR_BASE_AND_DATA:
@@ -276,28 +307,28 @@ int equals(JNIEnv * env, jobject thisObject, jobject otherObject)
     case CKM_AES_ECB_ENCRYPT_DATA:
 	value = ((CK_KEY_DERIVATION_STRING_DATA_PTR) mechanism->pParameter)->pData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_AES_GCM:
 	value = ((CK_GCM_PARAMS_PTR) mechanism->pParameter)->pIv;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_GCM_PARAMS_PTR) mechanism->pParameter)->pAAD;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_AES_CCM:
 	value = ((CK_CCM_PARAMS_PTR) mechanism->pParameter)->pNonce;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_CCM_PARAMS_PTR) mechanism->pParameter)->pAAD;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_KEY_WRAP_SET_OAEP:
 	value = ((CK_KEY_WRAP_SET_OAEP_PARAMS_PTR) mechanism->pParameter)->pX;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_SSL3_MASTER_KEY_DERIVE:
     case CKM_SSL3_MASTER_KEY_DERIVE_DH:
@@ -305,73 +336,73 @@ int equals(JNIEnv * env, jobject thisObject, jobject otherObject)
     case CKM_TLS_MASTER_KEY_DERIVE_DH:
 	value = ((CK_SSL3_MASTER_KEY_DERIVE_PARAMS_PTR) mechanism->pParameter)->RandomInfo.pClientRandom;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SSL3_MASTER_KEY_DERIVE_PARAMS_PTR) mechanism->pParameter)->RandomInfo.pServerRandom;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SSL3_MASTER_KEY_DERIVE_PARAMS_PTR) mechanism->pParameter)->pVersion;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_SSL3_KEY_AND_MAC_DERIVE:
     case CKM_TLS_KEY_AND_MAC_DERIVE:
 	value = ((CK_SSL3_KEY_MAT_PARAMS_PTR) mechanism->pParameter)->RandomInfo.pClientRandom;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SSL3_KEY_MAT_PARAMS_PTR) mechanism->pParameter)->RandomInfo.pServerRandom;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SSL3_KEY_MAT_PARAMS_PTR) mechanism->pParameter)->pReturnedKeyMaterial->pIVClient;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_SSL3_KEY_MAT_PARAMS_PTR) mechanism->pParameter)->pReturnedKeyMaterial->pIVServer;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_ECDH1_DERIVE:
     case CKM_ECDH1_COFACTOR_DERIVE:
 	value = ((CK_ECDH1_DERIVE_PARAMS_PTR) mechanism->pParameter)->pSharedData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_ECDH1_DERIVE_PARAMS_PTR) mechanism->pParameter)->pPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_ECMQV_DERIVE:
 	value = ((CK_ECDH2_DERIVE_PARAMS_PTR) mechanism->pParameter)->pSharedData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_ECDH2_DERIVE_PARAMS_PTR) mechanism->pParameter)->pPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_ECDH2_DERIVE_PARAMS_PTR) mechanism->pParameter)->pPublicData2;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_X9_42_DH_DERIVE:
 	value = ((CK_X9_42_DH1_DERIVE_PARAMS_PTR) mechanism->pParameter)->pOtherInfo;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_X9_42_DH1_DERIVE_PARAMS_PTR) mechanism->pParameter)->pPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     case CKM_X9_42_DH_HYBRID_DERIVE:
     case CKM_X9_42_MQV_DERIVE:
 	value = ((CK_X9_42_DH2_DERIVE_PARAMS_PTR) mechanism->pParameter)->pOtherInfo;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_X9_42_DH2_DERIVE_PARAMS_PTR) mechanism->pParameter)->pPublicData;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	value = ((CK_X9_42_DH2_DERIVE_PARAMS_PTR) mechanism->pParameter)->pPublicData2;
 	if (value != NULL_PTR)
-	    free(value);
+	    scratchFree(value);
 	break;
     }
      
 	/* free parameter structure itself */ 
-	free(mechanism->pParameter);
+	scratchFree(mechanism->pParameter);
 }
 
  
@@ -418,11 +449,13 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
      if (jInitArgs != NULL_PTR) {
 	ckpInitArgs = makeCKInitArgsAdapter(env, jInitArgs, jUseUtf8);
 	if (ckpInitArgs == NULL_PTR) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     } else {
@@ -436,6 +469,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
 	}
 	free(ckpInitArgs);
     }
+    releaseModuleEntry(moduleData);
      TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -464,11 +498,13 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
      ckpReserved = jObjectToCKVoidPtr(jReserved);
      rv = (*ckpFunctions->C_Finalize) (ckpReserved);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    releaseModuleEntry(moduleData);
      TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -494,13 +530,16 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Fin
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
      rv = (*ckpFunctions->C_GetInfo) (&ckLibInfo);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
      jInfoObject = ckInfoPtrToJInfo(env, &ckLibInfo);
+    releaseModuleEntry(moduleData);
      TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jInfoObject;
 }
@@ -530,15 +569,18 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1See
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
      ckSessionHandle = jLongToCKULong(jSessionHandle);
     if (jByteArrayToCKByteArray(env, jSeed, &ckpSeed, &ckSeedLength)) {
+	releaseModuleEntry(moduleData);
 	return;
     }
      rv = (*ckpFunctions->C_SeedRandom) (ckSessionHandle, ckpSeed, ckSeedLength);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
      free(ckpSeed);
+    releaseModuleEntry(moduleData);
      TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -567,6 +609,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Gen
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
      ckSessionHandle = jLongToCKULong(jSessionHandle);
@@ -578,6 +621,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Gen
      
 	/* copy back generated bytes */ 
 	(*env)->ReleaseByteArrayElements(env, jRandomData, jRandomBuffer, 0);
+    releaseModuleEntry(moduleData);
      TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -602,6 +646,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Get
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
      ckSessionHandle = jLongToCKULong(jSessionHandle);
@@ -609,6 +654,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Get
 	/* C_GetFunctionStatus should always return CKR_FUNCTION_NOT_PARALLEL */ 
 	rv = (*ckpFunctions->C_GetFunctionStatus) (ckSessionHandle);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    releaseModuleEntry(moduleData);
      TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -633,6 +679,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Can
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
      ckSessionHandle = jLongToCKULong(jSessionHandle);
@@ -640,6 +687,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Can
 	/* C_GetFunctionStatus should always return CKR_FUNCTION_NOT_PARALLEL */ 
 	rv = (*ckpFunctions->C_CancelFunction) (ckSessionHandle);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    releaseModuleEntry(moduleData);
      TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
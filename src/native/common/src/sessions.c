@@ -83,6 +83,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Op
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -94,6 +95,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Op
 	notifyEncapsulation = (NotifyEncapsulation *) malloc(sizeof(NotifyEncapsulation));
 	if (notifyEncapsulation == NULL_PTR) {
 	    throwOutOfMemoryError(env);
+	    releaseModuleEntry(moduleData);
 	    return 0L;
 	}
 	notifyEncapsulation->jApplicationData = (jApplication != NULL_PTR)
@@ -115,6 +117,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Op
 
     rv = (*ckpFunctions->C_OpenSession) (ckSlotID, ckFlags, ckpApplication, ckNotify, &ckSessionHandle);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -129,6 +132,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Op
     }
 #endif				/* NO_CALLBACKS */
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 
     return jSessionHandle;
@@ -160,6 +164,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Clo
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -169,6 +174,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Clo
 
     rv = (*ckpFunctions->C_CloseSession) (ckSessionHandle);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -187,6 +193,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Clo
 	free(notifyEncapsulation);
     }
 #endif				/* NO_CALLBACKS */
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 
 }
@@ -217,6 +224,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Clo
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -224,6 +232,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Clo
 
     rv = (*ckpFunctions->C_CloseAllSessions) (ckSlotID);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -241,6 +250,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Clo
 	free(notifyEncapsulation);
     }
 #endif				/* NO_CALLBACKS */
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -269,6 +279,7 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -276,11 +287,13 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
 
     rv = (*ckpFunctions->C_GetSessionInfo) (ckSessionHandle, &ckSessionInfo);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     jSessionInfo = ckSessionInfoPtrToJSessionInfo(env, &ckSessionInfo);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jSessionInfo;
 }
@@ -313,6 +326,7 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -320,12 +334,14 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 
     rv = (*ckpFunctions->C_GetOperationState) (ckSessionHandle, NULL_PTR, &ckStateLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckpState = (CK_BYTE_PTR) malloc(ckStateLength);
     if (ckpState == NULL_PTR && ckStateLength != 0) {
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -337,6 +353,7 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 
     free(ckpState);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jState;
 }
@@ -372,11 +389,13 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Set
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     if (jByteArrayToCKByteArray(env, jOperationState, &ckpState, &ckStateLength)) {
+	releaseModuleEntry(moduleData);
 	return;
     }
     ckEncryptionKeyHandle = jLongToCKULong(jEncryptionKeyHandle);
@@ -388,6 +407,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Set
 
     free(ckpState);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -422,6 +442,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Log
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -431,10 +452,12 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Log
     ckUseUtf8 = jBooleanToCKBBool(jUseUtf8);
     if (ckUseUtf8 == TRUE) {
 	if (jCharArrayToCKUTF8CharArray(env, jPin, &ckpPinArray, &ckPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     } else {
 	if (jCharArrayToCKCharArray(env, jPin, &ckpPinArray, &ckPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     }
@@ -445,6 +468,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Log
 
     free(ckpPinArray);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -471,6 +495,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Log
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -479,5 +504,6 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Log
     rv = (*ckpFunctions->C_Logout) (ckSessionHandle);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
@@ -48,6 +48,51 @@
 /* for creating and verifying signatures and MACs                             */
 /* ************************************************************************** */
 
+/*
+ * Adapters to call the functions returning data through callOutputFunction.
+ */
+CK_RV callSign(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+               CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    return (*ckpFunctions->C_Sign) (hSession, pInput, ulInputLen, pOutput, pulOutputLen);
+}
+
+CK_RV callSignFinal(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                    CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    /* the final part has no input */
+    return (*ckpFunctions->C_SignFinal) (hSession, pOutput, pulOutputLen);
+}
+
+/*
+ * Adapter to feed the parts of a multiple-part operation through callVectorUpdate.
+ */
+CK_RV callSignUpdate(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                     CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    /* the update returns no data */
+    return (*ckpFunctions->C_SignUpdate) (hSession, pInput, ulInputLen);
+}
+
+/*
+ * Adapter to feed the parts of a multiple-part operation through callVectorUpdate.
+ */
+CK_RV callVerifyUpdate(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput,
+                       CK_ULONG ulInputLen, CK_BYTE_PTR pOutput, CK_ULONG_PTR pulOutputLen)
+{
+    /* the update returns no data */
+    return (*ckpFunctions->C_VerifyUpdate) (hSession, pInput, ulInputLen);
+}
+
+/*
+ * Adapter to initialize the operation through callOneShot or callPackedBatch.
+ */
+CK_RV callSignInit(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism,
+                   CK_OBJECT_HANDLE hKey)
+{
+    return (*ckpFunctions->C_SignInit) (hSession, pMechanism, hKey);
+}
+
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
  * Method:    C_SignInit
@@ -75,6 +120,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sig
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -84,12 +130,15 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sig
 
     TRACE1(tag_call, __FUNCTION__, "calling HSM %ld", ckKeyHandle);
     rv = (*ckpFunctions->C_SignInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
-    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
+	initOutputLength(moduleData, ckpFunctions, ckSessionHandle, OUTPUT_SIGN, &ckMechanism, ckKeyHandle);
+    }
 
     if (ckMechanism.pParameter != NULL_PTR) {
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -107,10 +156,8 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sig
 JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sign
     (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpData = NULL_PTR;
-    CK_BYTE_PTR ckpSignature;
-    CK_ULONG ckDataLength;
-    CK_ULONG ckSignatureLength = 0;
+    CK_BYTE_PTR ckpData = NULL_PTR, ckpSignature;
+    CK_ULONG ckDataLength, ckSignatureLength;
     jbyteArray jSignature;
     CK_RV rv;
     ModuleData *moduleData;
@@ -125,60 +172,111 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
+    /* convert jTypes to ckTypes */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    jByteArrayToCKByteArray(env, jData, &ckpData, &ckDataLength);
-
-    TRACE0(tag_call, __FUNCTION__, "getting necessary buffer length  C_SIGN");
-    rv = (*ckpFunctions->C_Sign) (ckSessionHandle, ckpData, ckDataLength, NULL, &ckSignatureLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
-        TRACE1(tag_debug, __FUNCTION__, "Failed to get necessary buffer lengths. RV: ", rv);
-        free(ckpData);
-        return NULL_PTR;
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
     }
 
-    TRACE1(tag_debug, __FUNCTION__, "necessary buffer length  C_SIGN: %ld", ckDataLength);
-    ckpSignature = (CK_BYTE_PTR) malloc(ckSignatureLength * sizeof(CK_BYTE));
-    if (ckpSignature == NULL_PTR && ckSignatureLength != 0) {
-        free(ckpData);
-        throwOutOfMemoryError(env);
-        return NULL_PTR;
+    /* call C_Sign with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callSign, OUTPUT_SIGN, ckSessionHandle, ckpData, ckDataLength,
+			    &ckpSignature, &ckSignatureLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jSignature = ckByteArrayToJByteArray(env, ckpSignature, ckSignatureLength);
+    else
+	jSignature = NULL_PTR;
+
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jSignature;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jData               CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jobject jSignature          CK_BYTE_PTR pSignature
+ * @param   jint jSignatureOffset
+ * @param   jint jSignatureLength       CK_ULONG_PTR pulSignatureLen
+ * @return  jint                        the number of bytes written to jSignature
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jData, jint jDataOffset, jint jDataLength, jobject jSignature, jint jSignatureOffset, jint jSignatureLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData, ckpSignature;
+    CK_ULONG ckSignatureLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
-    TRACE0(tag_call, __FUNCTION__, "calling C_SIGN");
-    rv = (*ckpFunctions->C_Sign) (ckSessionHandle, ckpData, ckDataLength, ckpSignature, &ckSignatureLength);
-    TRACE0(tag_call, __FUNCTION__, "finished C_SIGN");
 
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
-        TRACE1(tag_debug, __FUNCTION__, "rv is OK: ", rv);
-        jSignature = ckByteArrayToJByteArray(env, ckpSignature, ckSignatureLength);
-    } else {
-        TRACE1(tag_debug, __FUNCTION__, "rv is not OK: ", rv);
-        jSignature = NULL_PTR;
+    /* the buffers are passed to the module as they are, nothing is copied */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jDirectBufferToCKBytePtr(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
+    if (jDirectBufferToCKBytePtr(env, jSignature, jSignatureOffset, jSignatureLength, &ckpSignature)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    ckSignatureLength = jIntToCKULong(jSignatureLength);
 
-    free(ckpData);
-    free(ckpSignature);
+    /* call C_Sign */
+    rv = (*ckpFunctions->C_Sign) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpSignature, &ckSignatureLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK)
+	ckSignatureLength = 0;
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
-    return jSignature;
+
+    return ckULongToJInt(ckSignatureLength);
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_SignUpdate
- * Signature: (J[B)V
+ * Method:    C_SignRegion
+ * Signature: (J[BII[BII)I
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
- * @param   jbyteArray jPart            CK_BYTE_PTR pPart
- *                                      CK_ULONG ulPartLen
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jbyteArray jSignature       CK_BYTE_PTR pSignature
+ * @param   jint jSignatureOffset
+ * @param   jint jSignatureLength       CK_ULONG_PTR pulSignatureLen
+ * @return  jint                        the number of bytes written to jSignature
  */
-JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdate
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart) {
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData, jint jDataOffset, jint jDataLength, jbyteArray jSignature, jint jSignatureOffset, jint jSignatureLength) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpPart = NULL_PTR;
-    CK_ULONG ckPartLength;
+    CK_BYTE_PTR ckpData = NULL_PTR, ckpSignature;
+    CK_ULONG ckSignatureLength;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -188,41 +286,76 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sig
     moduleData = getModuleEntry(env, obj);
     if (moduleData == NULL_PTR) {
 	throwDisconnectedRuntimeException(env);
-	return;
+	return 0;
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
-	return;
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
-	return;
+    if (checkJByteArrayRegion(env, jSignature, jSignatureOffset, jSignatureLength)) {
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+    if (jByteArrayRegionToCKByteArray(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return 0;
     }
 
-    rv = (*ckpFunctions->C_SignUpdate) (ckSessionHandle, ckpPart, ckPartLength);
-    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    /* a NULL_PTR buffer would only query the length, so allocate at least one byte */
+    ckSignatureLength = jIntToCKULong(jSignatureLength);
+    ckpSignature = (CK_BYTE_PTR) scratchAlloc((ckSignatureLength + 1) * sizeof(CK_BYTE));
+    if (ckpSignature == NULL_PTR) {
+	scratchFree(ckpData);
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0;
+    }
+
+    /* call C_Sign */
+    rv = (*ckpFunctions->C_Sign) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpSignature, &ckSignatureLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	ckByteArrayToJByteArrayRegion(env, ckpSignature, ckSignatureLength, jSignature, jSignatureOffset);
+    else
+	ckSignatureLength = 0;
 
-    free(ckpPart);
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
+
+    return ckULongToJInt(ckSignatureLength);
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_SignFinal
- * Signature: (J)[B
+ * Method:    C_SignBatch
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[JZ)[[B
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
- * @return  jbyteArray jSignature       CK_BYTE_PTR pSignature
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jobjectArray jData          CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @param   jlongArray jResults         CK_RV of C_SignInit or C_Sign for each item
+ * @return  jobjectArray jSignatures    CK_BYTE_PTR pSignature
  *                                      CK_ULONG_PTR pulSignatureLen
  */
-JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignFinal
-    (JNIEnv * env, jobject obj, jlong jSessionHandle) {
+JNIEXPORT jobjectArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignBatch
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jobjectArray jData,
+     jlongArray jResults, jboolean jUseUtf8) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpSignature;
-    CK_ULONG ckSignatureLength = 0;
-    jbyteArray jSignature;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_BYTE_PTR ckpData, ckpSignature;
+    CK_ULONG ckDataLength, ckSignatureLength;
+    jobjectArray jSignatures;
+    jbyteArray jItem, jSignature;
+    jlong *jpResults;
+    jsize jCount, i;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -236,51 +369,105 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    ckSessionHandle = jLongToCKULong(jSessionHandle);
-
-    /* first determine the length of the signature */
-    rv = (*ckpFunctions->C_SignFinal) (ckSessionHandle, NULL_PTR, &ckSignatureLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+    if (jData == NULL_PTR || jResults == NULL_PTR
+	|| (*env)->GetArrayLength(env, jResults) < (*env)->GetArrayLength(env, jData)) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The result array must be as long as the data array."));
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
-
-    ckpSignature = (CK_BYTE_PTR) malloc(ckSignatureLength * sizeof(CK_BYTE));
-    if (ckpSignature == NULL_PTR && ckSignatureLength != 0) {
+    jCount = (*env)->GetArrayLength(env, jData);
+    jSignatures = (*env)->NewObjectArray(env, jCount, jniCache.byteArray.clazz, NULL_PTR);
+    if (jSignatures == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+    jpResults = (jlong *) scratchAlloc((jCount + 1) * sizeof(jlong));
+    if (jpResults == NULL_PTR) {
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    /* now get the signature */
-    rv = (*ckpFunctions->C_SignFinal) (ckSessionHandle, ckpSignature, &ckSignatureLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+    /* convert the mechanism once for all items */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if ((*env)->ExceptionOccurred(env)) {
+	jCount = 0;
+	jSignatures = NULL_PTR;
+    }
+
+    for (i = 0; i < jCount; i++) {
+	jItem = (jbyteArray) (*env)->GetObjectArrayElement(env, jData, i);
+	if (jItem == NULL_PTR) {
+	    jpResults[i] = ckULongToJLong(CKR_ARGUMENTS_BAD);
+	    continue;
+	}
+	if (jByteArrayToScratchCKByteArray(env, jItem, &ckpData, &ckDataLength)) {
+	    (*env)->DeleteLocalRef(env, jItem);
+	    jSignatures = NULL_PTR;
+	    break;
+	}
+	(*env)->DeleteLocalRef(env, jItem);
+
+	/* each item is signed in an operation of its own, which a failure leaves terminated */
+	rv = callOneShot(moduleData, ckpFunctions, callSignInit, callSign, OUTPUT_SIGN, ckSessionHandle, &ckMechanism,
+			 ckKeyHandle, ckpData, ckDataLength, &ckpSignature, &ckSignatureLength);
+	scratchFree(ckpData);
+	jpResults[i] = ckULongToJLong(rv);
+	if (rv != CKR_OK) {
+	    continue;
+	}
+
 	jSignature = ckByteArrayToJByteArray(env, ckpSignature, ckSignatureLength);
-    else
-	jSignature = NULL_PTR;
+	scratchFree(ckpSignature);
+	if (jSignature == NULL_PTR) {
+	    jSignatures = NULL_PTR;
+	    break;
+	}
+	(*env)->SetObjectArrayElement(env, jSignatures, i, jSignature);
+	(*env)->DeleteLocalRef(env, jSignature);
+    }
+
+    if (jSignatures != NULL_PTR) {
+	(*env)->SetLongArrayRegion(env, jResults, 0, jCount, jpResults);
+    }
 
-    free(ckpSignature);
+    scratchFree(jpResults);
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
-    return jSignature;
+    return jSignatures;
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_SignRecoverInit
- * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;JZ)V
+ * Method:    C_SignBatchPacked
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[JZ)[B
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
  * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
- * @return  jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jobjectArray jData          CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @param   jlongArray jResults         CK_RV of C_SignInit or C_Sign for each item
+ * @return  jbyteArray jSignatures      CK_BYTE_PTR pSignature of each item in a slot of its own
+ *                                      CK_ULONG_PTR pulSignatureLen
  */
-JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignRecoverInit
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jboolean jUseUtf8) {
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignBatchPacked
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jobjectArray jData,
+     jlongArray jResults, jboolean jUseUtf8) {
     CK_SESSION_HANDLE ckSessionHandle;
     CK_MECHANISM ckMechanism;
     CK_OBJECT_HANDLE ckKeyHandle;
-    CK_RV rv;
+    jbyteArray jSignatures = NULL_PTR;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
 
@@ -289,46 +476,54 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Sig
     moduleData = getModuleEntry(env, obj);
     if (moduleData == NULL_PTR) {
 	throwDisconnectedRuntimeException(env);
-	return;
+	return NULL_PTR;
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
-	return;
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
     }
 
+    /* convert the mechanism once for all items */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
     ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
     ckKeyHandle = jLongToCKULong(jKeyHandle);
-
-    rv = (*ckpFunctions->C_SignRecoverInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
-    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+    if (!(*env)->ExceptionOccurred(env)) {
+	jSignatures = callPackedBatch(env, moduleData, ckpFunctions, callSignInit, callSign, OUTPUT_SIGN,
+				      ckSessionHandle, &ckMechanism, ckKeyHandle, jData, jResults);
+    }
 
     if (ckMechanism.pParameter != NULL_PTR) {
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jSignatures;
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_SignRecover
- * Signature: (J[B)[B
+ * Method:    C_SignOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[BZ)[B
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
  * @param   jbyteArray jData            CK_BYTE_PTR pData
  *                                      CK_ULONG ulDataLen
  * @return  jbyteArray jSignature       CK_BYTE_PTR pSignature
  *                                      CK_ULONG_PTR pulSignatureLen
  */
-JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignRecover
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData) {
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignOneShot
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jbyteArray jData,
+     jboolean jUseUtf8) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpData = NULL_PTR;
-    CK_BYTE_PTR ckpSignature;
-    CK_ULONG ckDataLength;
-    CK_ULONG ckSignatureLength = 0;
-    jbyteArray jSignature;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_BYTE_PTR ckpData, ckpSignature;
+    CK_ULONG ckDataLength, ckSignatureLength;
+    jbyteArray jSignature = NULL_PTR;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -342,55 +537,58 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
+    /* convert everything first, a failing conversion must not leave an active operation */
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jData, &ckpData, &ckDataLength)) {
-	return NULL_PTR;
-    }
-
-    /* first determine the length of the signature */
-    rv = (*ckpFunctions->C_SignRecover) (ckSessionHandle, ckpData, ckDataLength, NULL_PTR, &ckSignatureLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
-
-    ckpSignature = (CK_BYTE_PTR) malloc(ckSignatureLength * sizeof(CK_BYTE));
-    if (ckpSignature == NULL_PTR && ckSignatureLength != 0) {
-	free(ckpData);
-	throwOutOfMemoryError(env);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    if ((*env)->ExceptionOccurred(env)) {
+	scratchFree(ckpData);
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    /* now get the signature */
-    rv = (*ckpFunctions->C_SignRecover) (ckSessionHandle, ckpData, ckDataLength, ckpSignature, &ckSignatureLength);
-    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+    rv = callOneShot(moduleData, ckpFunctions, callSignInit, callSign, OUTPUT_SIGN, ckSessionHandle, &ckMechanism,
+		     ckKeyHandle, ckpData, ckDataLength, &ckpSignature, &ckSignatureLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK) {
 	jSignature = ckByteArrayToJByteArray(env, ckpSignature, ckSignatureLength);
-    else
-	jSignature = NULL_PTR;
+    }
 
-    free(ckpData);
-    free(ckpSignature);
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jSignature;
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_VerifyInit
- * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;JZ)V
+ * Method:    C_SignUpdate
+ * Signature: (J[B)V
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
- * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
- * @return  jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jbyteArray jPart            CK_BYTE_PTR pPart
+ *                                      CK_ULONG ulPartLen
  */
-JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyInit
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jboolean jUseUtf8) {
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdate
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_MECHANISM ckMechanism;
-    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_BYTE_PTR ckpPart = NULL_PTR;
+    CK_ULONG ckPartLength;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -404,42 +602,37 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
-    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if (jByteArrayToScratchCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
 
-    rv = (*ckpFunctions->C_VerifyInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
+    rv = (*ckpFunctions->C_SignUpdate) (ckSessionHandle, ckpPart, ckPartLength);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
-    if (ckMechanism.pParameter != NULL_PTR) {
-	freeCKMechanismParameter(&ckMechanism);
-    }
+    scratchFree(ckpPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_Verify
- * Signature: (J[B[B)V
+ * Method:    C_SignUpdateVector
+ * Signature: (J[[B)V
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
- * @param   jbyteArray jData            CK_BYTE_PTR pData
- *                                      CK_ULONG ulDataLen
- * @param   jbyteArray jSignature       CK_BYTE_PTR pSignature
- *                                      CK_ULONG_PTR pulSignatureLen
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part
+ *                                      CK_ULONG ulPartLen
  */
-JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Verify
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData, jbyteArray jSignature) {
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdateVector
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts) {
     CK_SESSION_HANDLE ckSessionHandle;
-    CK_BYTE_PTR ckpData = NULL_PTR;
-    CK_BYTE_PTR ckpSignature = NULL_PTR;
-    CK_ULONG ckDataLength;
-    CK_ULONG ckSignatureLength;
-    CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
 
@@ -452,41 +645,70 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+    callVectorUpdate(env, moduleData, ckpFunctions, callSignUpdate, OUTPUT_SIGN, FALSE, ckSessionHandle,
+		     jParts, NULL_PTR, NULL_PTR, __FUNCTION__);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part, direct buffers
+ * @param   jintArray jOffsets          the offset of the part in each buffer
+ * @param   jintArray jLengths          CK_ULONG ulPartLen of each part
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdateVectorDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts, jintArray jOffsets,
+     jintArray jLengths) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
 	return;
     }
-    if (jByteArrayToCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
-    /* verify the signature */
-    rv = (*ckpFunctions->C_Verify) (ckSessionHandle, ckpData, ckDataLength, ckpSignature, ckSignatureLength);
-    ckAssertReturnValueOK(env, rv, __FUNCTION__);
-
-    free(ckpData);
-    free(ckpSignature);
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    callVectorUpdate(env, moduleData, ckpFunctions, callSignUpdate, OUTPUT_SIGN, FALSE, ckSessionHandle,
+		     jParts, jOffsets, jLengths, __FUNCTION__);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
- * Method:    C_VerifyUpdate
- * Signature: (J[B)V
+ * Method:    C_SignUpdateRegion
+ * Signature: (J[BII)V
  * Parametermapping:                    *PKCS11*
  * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
  * @param   jbyteArray jPart            CK_BYTE_PTR pPart
- *                                      CK_ULONG ulPartLen
+ * @param   jint jPartOffset
+ * @param   jint jPartLength            CK_ULONG ulPartLen
  */
-JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdate
-    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart) {
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignUpdateRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart, jint jPartOffset, jint jPartLength) {
     CK_SESSION_HANDLE ckSessionHandle;
     CK_BYTE_PTR ckpPart = NULL_PTR;
-    CK_ULONG ckPartLength;
     CK_RV rv;
     ModuleData *moduleData;
     CK_FUNCTION_LIST_PTR ckpFunctions;
@@ -500,19 +722,774 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+    if (jByteArrayRegionToCKByteArray(env, jPart, jPartOffset, jPartLength, &ckpPart)) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
-    rv = (*ckpFunctions->C_VerifyUpdate) (ckSessionHandle, ckpPart, ckPartLength);
+    rv = (*ckpFunctions->C_SignUpdate) (ckSessionHandle, ckpPart, jIntToCKULong(jPartLength));
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    scratchFree(ckpPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignFinal
+ * Signature: (J)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @return  jbyteArray jSignature       CK_BYTE_PTR pSignature
+ *                                      CK_ULONG_PTR pulSignatureLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignFinal
+    (JNIEnv * env, jobject obj, jlong jSessionHandle) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpSignature;
+    CK_ULONG ckSignatureLength;
+    jbyteArray jSignature;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+
+    /* call C_SignFinal with a buffer of the expected length */
+    rv = callOutputFunction(moduleData, ckpFunctions, callSignFinal, OUTPUT_SIGN, ckSessionHandle, NULL_PTR, 0,
+			    &ckpSignature, &ckSignatureLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jSignature = ckByteArrayToJByteArray(env, ckpSignature, ckSignatureLength);
+    else
+	jSignature = NULL_PTR;
+
+    scratchFree(ckpSignature);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jSignature;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignRecoverInit
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;JZ)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @return  jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignRecoverInit
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+
+    rv = (*ckpFunctions->C_SignRecoverInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_SignRecover
+ * Signature: (J[B)[B
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @return  jbyteArray jSignature       CK_BYTE_PTR pSignature
+ *                                      CK_ULONG_PTR pulSignatureLen
+ */
+JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1SignRecover
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData = NULL_PTR;
+    CK_BYTE_PTR ckpSignature;
+    CK_ULONG ckDataLength;
+    CK_ULONG ckSignatureLength = 0;
+    jbyteArray jSignature;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* first determine the length of the signature */
+    rv = (*ckpFunctions->C_SignRecover) (ckSessionHandle, ckpData, ckDataLength, NULL_PTR, &ckSignatureLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	scratchFree(ckpData);
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    ckpSignature = (CK_BYTE_PTR) scratchAlloc(ckSignatureLength * sizeof(CK_BYTE));
+    if (ckpSignature == NULL_PTR && ckSignatureLength != 0) {
+	scratchFree(ckpData);
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* now get the signature */
+    rv = (*ckpFunctions->C_SignRecover) (ckSessionHandle, ckpData, ckDataLength, ckpSignature, &ckSignatureLength);
+    if (ckAssertReturnValueOK(env, rv, __FUNCTION__) == CK_ASSERT_OK)
+	jSignature = ckByteArrayToJByteArray(env, ckpSignature, ckSignatureLength);
+    else
+	jSignature = NULL_PTR;
+
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jSignature;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyInit
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;JZ)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @return  jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyInit
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+
+    rv = (*ckpFunctions->C_VerifyInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_Verify
+ * Signature: (J[B[B)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @param   jbyteArray jSignature       CK_BYTE_PTR pSignature
+ *                                      CK_ULONG_PTR pulSignatureLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Verify
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData, jbyteArray jSignature) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData = NULL_PTR;
+    CK_BYTE_PTR ckpSignature = NULL_PTR;
+    CK_ULONG ckDataLength;
+    CK_ULONG ckSignatureLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+    if (jByteArrayToScratchCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+	scratchFree(ckpData);
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    /* verify the signature */
+    rv = (*ckpFunctions->C_Verify) (ckSessionHandle, ckpData, ckDataLength, ckpSignature, ckSignatureLength);
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyDirect
+ * Signature: (JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;II)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jData               CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jobject jSignature          CK_BYTE_PTR pSignature
+ * @param   jint jSignatureOffset
+ * @param   jint jSignatureLength       CK_ULONG ulSignatureLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jData, jint jDataOffset, jint jDataLength, jobject jSignature, jint jSignatureOffset, jint jSignatureLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData, ckpSignature;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    /* the buffers are passed to the module as they are, nothing is copied */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jDirectBufferToCKBytePtr(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+    if (jDirectBufferToCKBytePtr(env, jSignature, jSignatureOffset, jSignatureLength, &ckpSignature)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    /* verify the signature */
+    rv = (*ckpFunctions->C_Verify) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpSignature, jIntToCKULong(jSignatureLength));
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyRegion
+ * Signature: (J[BII[BII)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ * @param   jint jDataOffset
+ * @param   jint jDataLength            CK_ULONG ulDataLen
+ * @param   jbyteArray jSignature       CK_BYTE_PTR pSignature
+ * @param   jint jSignatureOffset
+ * @param   jint jSignatureLength       CK_ULONG ulSignatureLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jData, jint jDataOffset, jint jDataLength, jbyteArray jSignature, jint jSignatureOffset, jint jSignatureLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpData = NULL_PTR;
+    CK_BYTE_PTR ckpSignature = NULL_PTR;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayRegionToCKByteArray(env, jData, jDataOffset, jDataLength, &ckpData)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+    if (jByteArrayRegionToCKByteArray(env, jSignature, jSignatureOffset, jSignatureLength, &ckpSignature)) {
+	scratchFree(ckpData);
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    /* verify the signature */
+    rv = (*ckpFunctions->C_Verify) (ckSessionHandle, ckpData, jIntToCKULong(jDataLength), ckpSignature,
+				    jIntToCKULong(jSignatureLength));
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyBatch
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[[B[[BZ)[J
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jobjectArray jData          CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @param   jobjectArray jSignatures    CK_BYTE_PTR pSignature
+ *                                      CK_ULONG ulSignatureLen
+ * @return  jlongArray jResults         CK_RV of C_VerifyInit or C_Verify for each item
+ */
+JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyBatch
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jobjectArray jData,
+     jobjectArray jSignatures, jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_BYTE_PTR ckpData, ckpSignature;
+    CK_ULONG ckDataLength, ckSignatureLength;
+    jlongArray jResults;
+    jbyteArray jItem, jSignature;
+    jlong *jpResults;
+    jsize jCount, i;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return NULL_PTR;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    if (jData == NULL_PTR || jSignatures == NULL_PTR
+	|| (*env)->GetArrayLength(env, jSignatures) != (*env)->GetArrayLength(env, jData)) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The signature array must be as long as the data array."));
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+    jCount = (*env)->GetArrayLength(env, jData);
+    jResults = (*env)->NewLongArray(env, jCount);
+    if (jResults == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+    jpResults = (jlong *) scratchAlloc((jCount + 1) * sizeof(jlong));
+    if (jpResults == NULL_PTR) {
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return NULL_PTR;
+    }
+
+    /* convert the mechanism once for all items */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if ((*env)->ExceptionOccurred(env)) {
+	jCount = 0;
+	jResults = NULL_PTR;
+    }
+
+    for (i = 0; i < jCount; i++) {
+	jItem = (jbyteArray) (*env)->GetObjectArrayElement(env, jData, i);
+	jSignature = (jbyteArray) (*env)->GetObjectArrayElement(env, jSignatures, i);
+	if (jItem == NULL_PTR || jSignature == NULL_PTR) {
+	    if (jItem != NULL_PTR) {
+		(*env)->DeleteLocalRef(env, jItem);
+	    }
+	    if (jSignature != NULL_PTR) {
+		(*env)->DeleteLocalRef(env, jSignature);
+	    }
+	    jpResults[i] = ckULongToJLong(CKR_ARGUMENTS_BAD);
+	    continue;
+	}
+	if (jByteArrayToScratchCKByteArray(env, jItem, &ckpData, &ckDataLength)) {
+	    (*env)->DeleteLocalRef(env, jItem);
+	    (*env)->DeleteLocalRef(env, jSignature);
+	    jResults = NULL_PTR;
+	    break;
+	}
+	if (jByteArrayToScratchCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+	    scratchFree(ckpData);
+	    (*env)->DeleteLocalRef(env, jItem);
+	    (*env)->DeleteLocalRef(env, jSignature);
+	    jResults = NULL_PTR;
+	    break;
+	}
+	(*env)->DeleteLocalRef(env, jItem);
+	(*env)->DeleteLocalRef(env, jSignature);
+
+	/* each item is verified in an operation of its own, an invalid signature is just a result */
+	rv = (*ckpFunctions->C_VerifyInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
+	if (rv == CKR_OK) {
+	    rv = (*ckpFunctions->C_Verify) (ckSessionHandle, ckpData, ckDataLength, ckpSignature, ckSignatureLength);
+	}
+	scratchFree(ckpData);
+	scratchFree(ckpSignature);
+	jpResults[i] = ckULongToJLong(rv);
+    }
+
+    if (jResults != NULL_PTR) {
+	(*env)->SetLongArrayRegion(env, jResults, 0, jCount, jpResults);
+    }
+
+    scratchFree(jpResults);
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jResults;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyOneShot
+ * Signature: (JLiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[B[BZ)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jbyteArray jData            CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @param   jbyteArray jSignature       CK_BYTE_PTR pSignature
+ *                                      CK_ULONG_PTR pulSignatureLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyOneShot
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobject jMechanism, jlong jKeyHandle, jbyteArray jData,
+     jbyteArray jSignature, jboolean jUseUtf8) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_MECHANISM ckMechanism;
+    CK_OBJECT_HANDLE ckKeyHandle;
+    CK_BYTE_PTR ckpData = NULL_PTR;
+    CK_BYTE_PTR ckpSignature = NULL_PTR;
+    CK_ULONG ckDataLength;
+    CK_ULONG ckSignatureLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    /* convert everything first, a failing conversion must not leave an active operation */
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    ckKeyHandle = jLongToCKULong(jKeyHandle);
+    if (jByteArrayToScratchCKByteArray(env, jData, &ckpData, &ckDataLength)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+    if (jByteArrayToScratchCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+	scratchFree(ckpData);
+	releaseModuleEntry(moduleData);
+	return;
+    }
+    ckMechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    if ((*env)->ExceptionOccurred(env)) {
+	scratchFree(ckpData);
+	scratchFree(ckpSignature);
+	if (ckMechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&ckMechanism);
+	}
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    /* C_Verify always terminates the operation, it returns no data */
+    rv = (*ckpFunctions->C_VerifyInit) (ckSessionHandle, &ckMechanism, ckKeyHandle);
+    if (rv == CKR_OK) {
+	rv = (*ckpFunctions->C_Verify) (ckSessionHandle, ckpData, ckDataLength, ckpSignature, ckSignatureLength);
+    }
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
+    if (ckMechanism.pParameter != NULL_PTR) {
+	freeCKMechanismParameter(&ckMechanism);
+    }
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyUpdate
+ * Signature: (J[B)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jPart            CK_BYTE_PTR pPart
+ *                                      CK_ULONG ulPartLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdate
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpPart = NULL_PTR;
+    CK_ULONG ckPartLength;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayToScratchCKByteArray(env, jPart, &ckpPart, &ckPartLength)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    rv = (*ckpFunctions->C_VerifyUpdate) (ckSessionHandle, ckpPart, ckPartLength);
+    ckAssertReturnValueOK(env, rv, __FUNCTION__);
+
+    scratchFree(ckpPart);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyUpdateVector
+ * Signature: (J[[B)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part
+ *                                      CK_ULONG ulPartLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdateVector
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    callVectorUpdate(env, moduleData, ckpFunctions, callVerifyUpdate, OUTPUT_SIGN, FALSE, ckSessionHandle,
+		     jParts, NULL_PTR, NULL_PTR, __FUNCTION__);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyUpdateVectorDirect
+ * Signature: (J[Ljava/nio/ByteBuffer;[I[I)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jobjectArray jParts         CK_BYTE_PTR pPart of each part, direct buffers
+ * @param   jintArray jOffsets          the offset of the part in each buffer
+ * @param   jintArray jLengths          CK_ULONG ulPartLen of each part
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdateVectorDirect
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jobjectArray jParts, jintArray jOffsets,
+     jintArray jLengths) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    callVectorUpdate(env, moduleData, ckpFunctions, callVerifyUpdate, OUTPUT_SIGN, FALSE, ckSessionHandle,
+		     jParts, jOffsets, jLengths, __FUNCTION__);
+
+    releaseModuleEntry(moduleData);
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_VerifyUpdateRegion
+ * Signature: (J[BII)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jSessionHandle        CK_SESSION_HANDLE hSession
+ * @param   jbyteArray jPart            CK_BYTE_PTR pPart
+ * @param   jint jPartOffset
+ * @param   jint jPartLength            CK_ULONG ulPartLen
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1VerifyUpdateRegion
+    (JNIEnv * env, jobject obj, jlong jSessionHandle, jbyteArray jPart, jint jPartOffset, jint jPartLength) {
+    CK_SESSION_HANDLE ckSessionHandle;
+    CK_BYTE_PTR ckpPart = NULL_PTR;
+    CK_RV rv;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    ckSessionHandle = jLongToCKULong(jSessionHandle);
+    if (jByteArrayRegionToCKByteArray(env, jPart, jPartOffset, jPartLength, &ckpPart)) {
+	releaseModuleEntry(moduleData);
+	return;
+    }
+
+    rv = (*ckpFunctions->C_VerifyUpdate) (ckSessionHandle, ckpPart, jIntToCKULong(jPartLength));
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
-    free(ckpPart);
+    scratchFree(ckpPart);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -543,11 +1520,13 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -555,8 +1534,9 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
     rv = (*ckpFunctions->C_VerifyFinal) (ckSessionHandle, ckpSignature, ckSignatureLength);
     ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
-    free(ckpSignature);
+    scratchFree(ckpSignature);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -587,6 +1567,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -601,6 +1582,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ver
 	freeCKMechanismParameter(&ckMechanism);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -636,24 +1618,29 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckSessionHandle = jLongToCKULong(jSessionHandle);
-    if (jByteArrayToCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+    if (jByteArrayToScratchCKByteArray(env, jSignature, &ckpSignature, &ckSignatureLength)) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     /* first determine the length of the signature */
     rv = (*ckpFunctions->C_VerifyRecover) (ckSessionHandle, ckpSignature, ckSignatureLength, NULL_PTR, &ckDataLength);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	scratchFree(ckpSignature);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
-    ckpData = (CK_BYTE_PTR) malloc(ckDataLength * sizeof(CK_BYTE));
+    ckpData = (CK_BYTE_PTR) scratchAlloc(ckDataLength * sizeof(CK_BYTE));
     if (ckpData == NULL_PTR && ckDataLength != 0) {
-	free(ckpSignature);
+	scratchFree(ckpSignature);
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -664,9 +1651,10 @@ JNIEXPORT jbyteArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     else
 	jData = NULL_PTR;
 
-    free(ckpData);
-    free(ckpSignature);
+    scratchFree(ckpData);
+    scratchFree(ckpSignature);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jData;
 }
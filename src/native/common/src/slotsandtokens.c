@@ -76,6 +76,7 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -83,6 +84,7 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 
     rv = (*ckpFunctions->C_GetSlotList) (ckTokenPresent, NULL_PTR, &ckTokenNumber);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -90,6 +92,7 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 	ckpSlotList = (CK_SLOT_ID_PTR) malloc(ckTokenNumber * sizeof(CK_SLOT_ID));
 	if (ckpSlotList == NULL_PTR && ckTokenNumber != 0) {
 	    throwOutOfMemoryError(env);
+	    releaseModuleEntry(moduleData);
 	    return NULL_PTR;
 	}
 
@@ -105,6 +108,7 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 	jSlotList = ckULongArrayToJLongArray(env, NULL_PTR, ckTokenNumber);
     }
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jSlotList;
 }
@@ -135,6 +139,7 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -142,11 +147,13 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
 
     rv = (*ckpFunctions->C_GetSlotInfo) (ckSlotID, &ckSlotInfo);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     jSlotInfoObject = ckSlotInfoPtrToJSlotInfo(env, &ckSlotInfo);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jSlotInfoObject;
 }
@@ -177,6 +184,7 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -184,11 +192,13 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
 
     rv = (*ckpFunctions->C_GetTokenInfo) (ckSlotID, &ckTokenInfo);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     jInfoTokenObject = ckTokenInfoPtrToJTokenInfo(env, &ckTokenInfo);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jInfoTokenObject;
 }
@@ -220,6 +230,7 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Wa
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
@@ -227,11 +238,13 @@ JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Wa
 
     rv = (*ckpFunctions->C_WaitForSlotEvent) (ckFlags, &ckSlotID, NULL_PTR);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return 0L;
     }
 
     jSlotID = ckULongToJLong(ckSlotID);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jSlotID;
 }
@@ -264,6 +277,7 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -271,12 +285,14 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 
     rv = (*ckpFunctions->C_GetMechanismList) (ckSlotID, NULL_PTR, &ckMechanismNumber);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     ckpMechanismList = (CK_MECHANISM_TYPE_PTR) malloc(ckMechanismNumber * sizeof(CK_MECHANISM_TYPE));
     if (ckpMechanismList == NULL_PTR && ckMechanismNumber != 0) {
 	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -288,6 +304,7 @@ JNIEXPORT jlongArray JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_
 
     free(ckpMechanismList);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jMechanismList;
 }
@@ -320,6 +337,7 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
@@ -328,11 +346,13 @@ JNIEXPORT jobject JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1
 
     rv = (*ckpFunctions->C_GetMechanismInfo) (ckSlotID, ckMechanismType, &ckMechanismInfo);
     if (ckAssertReturnValueOK(env, rv, __FUNCTION__) != CK_ASSERT_OK) {
+	releaseModuleEntry(moduleData);
 	return NULL_PTR;
     }
 
     jMechanismInfo = ckMechanismInfoPtrToJMechanismInfo(env, &ckMechanismInfo);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
     return jMechanismInfo;
 }
@@ -369,6 +389,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -376,16 +397,20 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
     ckUseUtf8 = jBooleanToCKBBool(jUseUtf8);
     if (ckUseUtf8 == TRUE) {
 	if (jCharArrayToCKUTF8CharArray(env, jPin, &ckpPin, &ckPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
 	if (jCharArrayToCKUTF8CharArray(env, jLabel, &ckpLabel, &ckLabelLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     } else {
 	if (jCharArrayToCKCharArray(env, jPin, &ckpPin, &ckPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
 	if (jCharArrayToCKCharArray(env, jLabel, &ckpLabel, &ckLabelLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     }
@@ -397,6 +422,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
 
     free(ckpPin);
     free(ckpLabel);
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -429,6 +455,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -436,10 +463,12 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
     ckUseUtf8 = jBooleanToCKBBool(jUseUtf8);
     if (ckUseUtf8 == TRUE) {
 	if (jCharArrayToCKUTF8CharArray(env, jPin, &ckpPin, &ckPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     } else {
 	if (jCharArrayToCKCharArray(env, jPin, &ckpPin, &ckPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     }
@@ -449,6 +478,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Ini
 
     free(ckpPin);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
 
@@ -485,6 +515,7 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Set
     }
     ckpFunctions = getFunctionList(env, moduleData);
     if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
 	return;
     }
 
@@ -493,16 +524,20 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Set
     ckUseUtf8 = jBooleanToCKBBool(jUseUtf8);
     if (ckUseUtf8 == TRUE) {
 	if (jCharArrayToCKUTF8CharArray(env, jOldPin, &ckpOldPin, &ckOldPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
 	if (jCharArrayToCKUTF8CharArray(env, jNewPin, &ckpNewPin, &ckNewPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     } else {
 	if (jCharArrayToCKCharArray(env, jOldPin, &ckpOldPin, &ckOldPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
 	if (jCharArrayToCKCharArray(env, jNewPin, &ckpNewPin, &ckNewPinLength)) {
+	    releaseModuleEntry(moduleData);
 	    return;
 	}
     }
@@ -513,5 +548,6 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1Set
     free(ckpOldPin);
     free(ckpNewPin);
 
+    releaseModuleEntry(moduleData);
     TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
@@ -0,0 +1,495 @@
+/* Copyright  (c) 2002 Graz University of Technology. All rights reserved.
+ *
+ * Redistribution and use in  source and binary forms, with or without
+ * modification, are permitted  provided that the following conditions are met:
+ *
+ * 1. Redistributions of  source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in  binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The end-user documentation included with the redistribution, if any, must
+ *    include the following acknowledgment:
+ *
+ *    "This product includes software developed by IAIK of Graz University of
+ *     Technology."
+ *
+ *    Alternately, this acknowledgment may appear in the software itself, if
+ *    and wherever such third-party acknowledgments normally appear.
+ *
+ * 4. The names "Graz University of Technology" and "IAIK of Graz University of
+ *    Technology" must not be used to endorse or promote products derived from
+ *    this software without prior written permission.
+ *
+ * 5. Products derived from this software may not be called
+ *    "IAIK PKCS Wrapper", nor may "IAIK" appear in their name, without prior
+ *    written permission of Graz University of Technology.
+ *
+ *  THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ *  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *  OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ *  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY  OF SUCH DAMAGE.
+ */
+
+#include "pkcs11wrapper.h"
+
+/* ************************************************************************** */
+/* Functions to run whole operations in a single call                         */
+/* ************************************************************************** */
+
+/*
+ * Initialize an operation and run it for a single piece of data. If the
+ * operation was initialized, but the module may still hold it active after a
+ * failure, like CKR_BUFFER_TOO_SMALL after all attempts or no memory for the
+ * output, the operation is terminated by calling init with a NULL_PTR
+ * mechanism, as PKCS#11 v3.0 allows. This leaves the session without an active
+ * operation in any case. If the call succeeds, *ppOutput is a newly allocated
+ * buffer, which has to be freed with scratchFree.
+ *
+ * @param init - the function initializing the operation
+ * @param function - the function returning the output
+ * @param operation - the kind of operation, one of the OUTPUT_* constants
+ * @return the return value of init or function
+ */
+CK_RV callOneShot(ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, InitFunction init,
+		  OutputFunction function, int operation, CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR ckpMechanism,
+		  CK_OBJECT_HANDLE hKey, CK_BYTE_PTR pInput, CK_ULONG ulInputLen, CK_BYTE_PTR *ppOutput,
+		  CK_ULONG_PTR pulOutputLen)
+{
+    CK_RV rv;
+
+    *ppOutput = NULL_PTR;
+    *pulOutputLen = 0;
+
+    rv = (*init) (ckpFunctions, hSession, ckpMechanism, hKey);
+    if (rv != CKR_OK) {
+	return rv;
+    }
+    initOutputLength(moduleData, ckpFunctions, hSession, operation, ckpMechanism, hKey);
+
+    rv = callOutputFunction(moduleData, ckpFunctions, function, operation, hSession, pInput, ulInputLen,
+			    ppOutput, pulOutputLen);
+    if (rv == CKR_BUFFER_TOO_SMALL || rv == CKR_HOST_MEMORY) {
+	/* the result of this is of no interest, a module not knowing it has nothing to terminate */
+	(*init) (ckpFunctions, hSession, NULL_PTR, CK_INVALID_HANDLE);
+    }
+
+    return rv;
+}
+
+/*
+ * Run an operation, which returns data of the same length for each input, for
+ * each element of a Java byte[][]. For each element, the operation is
+ * initialized with the given mechanism and key and then called through
+ * callOutputFunction. The outputs are packed into one jbyteArray with a slot
+ * of the same size for each element; the slot size is the length of the first
+ * output. The return value for each element is stored in jResults. A failed
+ * element leaves its slot zeroed; an output of another length than the slot
+ * counts as CKR_FUNCTION_FAILED. Returns NULL_PTR, if an exception is thrown.
+ *
+ * @param init - the function initializing the operation for each element
+ * @param function - the function returning the output for each element
+ * @param operation - the kind of operation, one of the OUTPUT_* constants
+ * @param jData - the Java byte[][] with the input of each element
+ * @param jResults - the Java long[] receiving the return value of each element
+ * @return the packed outputs, an empty array, if no element succeeded
+ */
+jbyteArray callPackedBatch(JNIEnv *env, ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, InitFunction init,
+			   OutputFunction function, int operation, CK_SESSION_HANDLE hSession,
+			   CK_MECHANISM_PTR ckpMechanism, CK_OBJECT_HANDLE hKey, jobjectArray jData, jlongArray jResults)
+{
+    CK_BYTE_PTR ckpData, ckpOutput, ckpPacked = NULL_PTR;
+    CK_ULONG ckDataLength, ckOutputLength, ckSlotLength = 0;
+    jbyteArray jItem, jPacked;
+    jlong *jpResults;
+    jsize jCount, i;
+    CK_RV rv;
+
+    if (jData == NULL_PTR || jResults == NULL_PTR
+	|| (*env)->GetArrayLength(env, jResults) < (*env)->GetArrayLength(env, jData)) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The result array must be as long as the data array."));
+	return NULL_PTR;
+    }
+    jCount = (*env)->GetArrayLength(env, jData);
+    jpResults = (jlong *) scratchAlloc((jCount + 1) * sizeof(jlong));
+    if (jpResults == NULL_PTR) {
+	throwOutOfMemoryError(env);
+	return NULL_PTR;
+    }
+
+    for (i = 0; i < jCount; i++) {
+	jItem = (jbyteArray) (*env)->GetObjectArrayElement(env, jData, i);
+	if (jItem == NULL_PTR) {
+	    jpResults[i] = ckULongToJLong(CKR_ARGUMENTS_BAD);
+	    continue;
+	}
+	if (jByteArrayToScratchCKByteArray(env, jItem, &ckpData, &ckDataLength)) {
+	    (*env)->DeleteLocalRef(env, jItem);
+	    scratchFree(ckpPacked);
+	    scratchFree(jpResults);
+	    return NULL_PTR;
+	}
+	(*env)->DeleteLocalRef(env, jItem);
+
+	/* each element is processed in an operation of its own, which a failure leaves terminated */
+	rv = callOneShot(moduleData, ckpFunctions, init, function, operation, hSession, ckpMechanism, hKey, ckpData,
+			 ckDataLength, &ckpOutput, &ckOutputLength);
+	scratchFree(ckpData);
+	if (rv == CKR_OK) {
+	    if (ckpPacked == NULL_PTR) {
+		/* the first output determines the slot size, the slots before stay zeroed */
+		ckSlotLength = ckOutputLength;
+		if (ckSlotLength != 0 && (CK_ULONG) jCount > 0x7FFFFFFFUL / ckSlotLength) {
+		    scratchFree(ckpOutput);
+		    scratchFree(jpResults);
+		    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The results do not fit into one array."));
+		    return NULL_PTR;
+		}
+		ckpPacked = (CK_BYTE_PTR) scratchAlloc(jCount * ckSlotLength + 1);
+		if (ckpPacked == NULL_PTR) {
+		    scratchFree(ckpOutput);
+		    scratchFree(jpResults);
+		    throwOutOfMemoryError(env);
+		    return NULL_PTR;
+		}
+		memset(ckpPacked, 0, jCount * ckSlotLength + 1);
+	    }
+	    if (ckOutputLength == ckSlotLength) {
+		memcpy(ckpPacked + i * ckSlotLength, ckpOutput, ckSlotLength);
+	    } else {
+		rv = CKR_FUNCTION_FAILED;
+	    }
+	    scratchFree(ckpOutput);
+	}
+	jpResults[i] = ckULongToJLong(rv);
+    }
+
+    jPacked = ckByteArrayToJByteArray(env, ckpPacked, jCount * ckSlotLength);
+    if (jPacked != NULL_PTR) {
+	(*env)->SetLongArrayRegion(env, jResults, 0, jCount, jpResults);
+    }
+
+    scratchFree(ckpPacked);
+    scratchFree(jpResults);
+
+    return jPacked ;
+}
+
+/*
+ * Run an AEAD encryption or decryption with CKM_AES_GCM or CKM_AES_CCM for
+ * each element of a Java byte[][]. The parameters of the mechanism serve as a
+ * template; for each element, only the IV (or nonce) and the additional
+ * authenticated data are replaced by the ones of the element, and for CCM also
+ * the data length. The template is restored before returning, so the caller
+ * can free the mechanism parameter as usual. The return value for each element
+ * is stored in jResults; the output of a failed element stays null. Returns
+ * NULL_PTR, if an exception is thrown.
+ *
+ * @param init - the function initializing the operation for each element
+ * @param function - the function returning the output for each element
+ * @param operation - OUTPUT_ENCRYPT or OUTPUT_DECRYPT
+ * @param jIvs - the Java byte[][] with the IV or nonce of each element
+ * @param jAads - the Java byte[][] with the additional authenticated data of
+ *                each element, or NULL_PTR to use the one of the template
+ * @param jData - the Java byte[][] with the input of each element
+ * @param jResults - the Java long[] receiving the return value of each element
+ * @return the output of each element
+ */
+jobjectArray callAeadBatch(JNIEnv *env, ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, InitFunction init,
+			   OutputFunction function, int operation, CK_SESSION_HANDLE hSession,
+			   CK_MECHANISM_PTR ckpMechanism, CK_OBJECT_HANDLE hKey, jobjectArray jIvs, jobjectArray jAads,
+			   jobjectArray jData, jlongArray jResults)
+{
+    CK_GCM_PARAMS_PTR ckpGcmParams = NULL_PTR;
+    CK_CCM_PARAMS_PTR ckpCcmParams = NULL_PTR;
+    CK_BYTE_PTR ckpTemplateIv, ckpTemplateAad;
+    CK_ULONG ckTemplateIvLength, ckTemplateAadLength, ckTemplateDataLength = 0;
+    CK_BYTE_PTR ckpIv, ckpAad, ckpData, ckpOutput;
+    CK_ULONG ckIvLength, ckAadLength, ckDataLength, ckOutputLength;
+    jobjectArray jOutputs;
+    jbyteArray jIv, jAad, jItem, jOutput;
+    jlong *jpResults;
+    jsize jCount, i;
+    CK_RV rv;
+
+    if (ckpMechanism->pParameter != NULL_PTR && ckpMechanism->mechanism == CKM_AES_GCM) {
+	ckpGcmParams = (CK_GCM_PARAMS_PTR) ckpMechanism->pParameter;
+	ckpTemplateIv = ckpGcmParams->pIv;
+	ckTemplateIvLength = ckpGcmParams->ulIvLen;
+	ckpTemplateAad = ckpGcmParams->pAAD;
+	ckTemplateAadLength = ckpGcmParams->ulAADLen;
+    } else if (ckpMechanism->pParameter != NULL_PTR && ckpMechanism->mechanism == CKM_AES_CCM) {
+	ckpCcmParams = (CK_CCM_PARAMS_PTR) ckpMechanism->pParameter;
+	ckpTemplateIv = ckpCcmParams->pNonce;
+	ckTemplateIvLength = ckpCcmParams->ulNonceLen;
+	ckpTemplateAad = ckpCcmParams->pAAD;
+	ckTemplateAadLength = ckpCcmParams->ulAADLen;
+	ckTemplateDataLength = ckpCcmParams->ulDataLen;
+    } else {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The mechanism must be CKM_AES_GCM or CKM_AES_CCM with parameters."));
+	return NULL_PTR;
+    }
+
+    if (jData == NULL_PTR || jIvs == NULL_PTR || jResults == NULL_PTR
+	|| (*env)->GetArrayLength(env, jIvs) < (*env)->GetArrayLength(env, jData)
+	|| (jAads != NULL_PTR && (*env)->GetArrayLength(env, jAads) < (*env)->GetArrayLength(env, jData))
+	|| (*env)->GetArrayLength(env, jResults) < (*env)->GetArrayLength(env, jData)) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The IV, AAD and result arrays must be as long as the data array."));
+	return NULL_PTR;
+    }
+    jCount = (*env)->GetArrayLength(env, jData);
+    jOutputs = (*env)->NewObjectArray(env, jCount, jniCache.byteArray.clazz, NULL_PTR);
+    if (jOutputs == NULL_PTR) {
+	return NULL_PTR;
+    }
+    jpResults = (jlong *) scratchAlloc((jCount + 1) * sizeof(jlong));
+    if (jpResults == NULL_PTR) {
+	throwOutOfMemoryError(env);
+	return NULL_PTR;
+    }
+
+    for (i = 0; i < jCount; i++) {
+	jIv = (jbyteArray) (*env)->GetObjectArrayElement(env, jIvs, i);
+	jItem = (jbyteArray) (*env)->GetObjectArrayElement(env, jData, i);
+	if (jIv == NULL_PTR || jItem == NULL_PTR) {
+	    if (jIv != NULL_PTR) {
+		(*env)->DeleteLocalRef(env, jIv);
+	    }
+	    if (jItem != NULL_PTR) {
+		(*env)->DeleteLocalRef(env, jItem);
+	    }
+	    jpResults[i] = ckULongToJLong(CKR_ARGUMENTS_BAD);
+	    continue;
+	}
+	jAad = (jAads != NULL_PTR) ? (jbyteArray) (*env)->GetObjectArrayElement(env, jAads, i) : NULL_PTR;
+
+	ckpIv = ckpAad = ckpData = NULL_PTR;
+	if (jByteArrayToScratchCKByteArray(env, jIv, &ckpIv, &ckIvLength)
+	    || jByteArrayToScratchCKByteArray(env, jAad, &ckpAad, &ckAadLength)
+	    || jByteArrayToScratchCKByteArray(env, jItem, &ckpData, &ckDataLength)) {
+	    scratchFree(ckpData);
+	    scratchFree(ckpAad);
+	    scratchFree(ckpIv);
+	    (*env)->DeleteLocalRef(env, jIv);
+	    (*env)->DeleteLocalRef(env, jItem);
+	    if (jAad != NULL_PTR) {
+		(*env)->DeleteLocalRef(env, jAad);
+	    }
+	    jOutputs = NULL_PTR;
+	    break;
+	}
+	(*env)->DeleteLocalRef(env, jIv);
+	(*env)->DeleteLocalRef(env, jItem);
+	if (jAad != NULL_PTR) {
+	    (*env)->DeleteLocalRef(env, jAad);
+	} else if (jAads == NULL_PTR) {
+	    ckpAad = ckpTemplateAad;
+	    ckAadLength = ckTemplateAadLength;
+	}
+
+	/* patch the template in place, the rest of the parameters stays the same */
+	rv = CKR_OK;
+	if (ckpGcmParams != NULL_PTR) {
+	    ckpGcmParams->pIv = ckpIv;
+	    ckpGcmParams->ulIvLen = ckIvLength;
+	    ckpGcmParams->ulIvBits = ckIvLength * 8;
+	    ckpGcmParams->pAAD = ckpAad;
+	    ckpGcmParams->ulAADLen = ckAadLength;
+	} else {
+	    ckpCcmParams->pNonce = ckpIv;
+	    ckpCcmParams->ulNonceLen = ckIvLength;
+	    ckpCcmParams->pAAD = ckpAad;
+	    ckpCcmParams->ulAADLen = ckAadLength;
+	    if (operation == OUTPUT_ENCRYPT) {
+		ckpCcmParams->ulDataLen = ckDataLength;
+	    } else if (ckDataLength >= ckpCcmParams->ulMACLen) {
+		/* the ciphertext carries the MAC */
+		ckpCcmParams->ulDataLen = ckDataLength - ckpCcmParams->ulMACLen;
+	    } else {
+		rv = CKR_ENCRYPTED_DATA_LEN_RANGE;
+	    }
+	}
+
+	/* each element is processed in an operation of its own, which a failure leaves terminated */
+	if (rv == CKR_OK) {
+	    rv = callOneShot(moduleData, ckpFunctions, init, function, operation, hSession, ckpMechanism, hKey,
+			     ckpData, ckDataLength, &ckpOutput, &ckOutputLength);
+	}
+	scratchFree(ckpData);
+	if (ckpAad != ckpTemplateAad) {
+	    scratchFree(ckpAad);
+	}
+	scratchFree(ckpIv);
+	jpResults[i] = ckULongToJLong(rv);
+	if (rv != CKR_OK) {
+	    continue;
+	}
+
+	jOutput = ckByteArrayToJByteArray(env, ckpOutput, ckOutputLength);
+	scratchFree(ckpOutput);
+	if (jOutput == NULL_PTR) {
+	    jOutputs = NULL_PTR;
+	    break;
+	}
+	(*env)->SetObjectArrayElement(env, jOutputs, i, jOutput);
+	(*env)->DeleteLocalRef(env, jOutput);
+    }
+
+    /* restore the template, the caller frees its IV and AAD */
+    if (ckpGcmParams != NULL_PTR) {
+	ckpGcmParams->pIv = ckpTemplateIv;
+	ckpGcmParams->ulIvLen = ckTemplateIvLength;
+	ckpGcmParams->ulIvBits = ckTemplateIvLength * 8;
+	ckpGcmParams->pAAD = ckpTemplateAad;
+	ckpGcmParams->ulAADLen = ckTemplateAadLength;
+    } else {
+	ckpCcmParams->pNonce = ckpTemplateIv;
+	ckpCcmParams->ulNonceLen = ckTemplateIvLength;
+	ckpCcmParams->pAAD = ckpTemplateAad;
+	ckpCcmParams->ulAADLen = ckTemplateAadLength;
+	ckpCcmParams->ulDataLen = ckTemplateDataLength;
+    }
+
+    if (jOutputs != NULL_PTR) {
+	(*env)->SetLongArrayRegion(env, jResults, 0, jCount, jpResults);
+    }
+    scratchFree(jpResults);
+
+    return jOutputs;
+}
+
+/* ************************************************************************** */
+/* Functions to feed many parts to an operation in a single call              */
+/* ************************************************************************** */
+
+/*
+ * Call the update function of a multiple-part operation for each part of a
+ * Java byte[][] or, if jOffsets is not NULL_PTR, for a region of each direct
+ * buffer of a Java ByteBuffer[]. Byte arrays are copied to scratch memory one
+ * at a time; the memory of direct buffers is handed to the module as it is. If
+ * the update function returns data, like C_EncryptUpdate, the outputs of all
+ * parts are concatenated into one array. The first failing part stops the loop
+ * and its return value is thrown as PKCS11Exception.
+ *
+ * @param function - the update function, called through callOutputFunction, if withOutput is TRUE
+ * @param operation - the kind of operation, one of the OUTPUT_* constants; only used with output
+ * @param withOutput - TRUE, if the update function returns data
+ * @param jParts - the Java byte[][] or ByteBuffer[] with the parts
+ * @param jOffsets - the Java int[] with the offset of the region in each buffer, or NULL_PTR for byte arrays
+ * @param jLengths - the Java int[] with the length of the region in each buffer, or NULL_PTR for byte arrays
+ * @param callerMethodName - the name of the calling native method for the trace
+ * @return the concatenated outputs, if withOutput is TRUE; NULL_PTR otherwise or if an exception is thrown
+ */
+jbyteArray callVectorUpdate(JNIEnv *env, ModuleData *moduleData, CK_FUNCTION_LIST_PTR ckpFunctions,
+			    OutputFunction function, int operation, CK_BBOOL withOutput, CK_SESSION_HANDLE hSession,
+			    jobjectArray jParts, jintArray jOffsets, jintArray jLengths, const char *callerMethodName)
+{
+    CK_BYTE_PTR ckpPart, ckpCopy, ckpOutput, ckpCollected = NULL_PTR, ckpLarger;
+    CK_ULONG ckPartLength, ckOutputLength, ckCollectedLength = 0, ckCapacity = 0;
+    jint *jpRegions = NULL_PTR;
+    jobject jPart;
+    jbyteArray jOutput = NULL_PTR;
+    jsize jCount, i;
+    CK_RV rv = CKR_OK;
+
+    if (jParts == NULL_PTR) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The parts must not be null."));
+	return NULL_PTR;
+    }
+    jCount = (*env)->GetArrayLength(env, jParts);
+    if (jOffsets != NULL_PTR) {
+	if (jLengths == NULL_PTR || (*env)->GetArrayLength(env, jOffsets) < jCount
+	    || (*env)->GetArrayLength(env, jLengths) < jCount) {
+	    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The offset and length arrays must be as long as the parts array."));
+	    return NULL_PTR;
+	}
+	/* the offsets followed by the lengths */
+	jpRegions = (jint *) scratchAlloc((2 * jCount + 1) * sizeof(jint));
+	if (jpRegions == NULL_PTR) {
+	    throwOutOfMemoryError(env);
+	    return NULL_PTR;
+	}
+	(*env)->GetIntArrayRegion(env, jOffsets, 0, jCount, jpRegions);
+	(*env)->GetIntArrayRegion(env, jLengths, 0, jCount, jpRegions + jCount);
+    }
+
+    for (i = 0; i < jCount && rv == CKR_OK; i++) {
+	jPart = (*env)->GetObjectArrayElement(env, jParts, i);
+	ckpCopy = NULL_PTR;
+	if (jpRegions != NULL_PTR) {
+	    if (jDirectBufferToCKBytePtr(env, jPart, jpRegions[i], jpRegions[jCount + i], &ckpPart)) {
+		if (jPart != NULL_PTR) {
+		    (*env)->DeleteLocalRef(env, jPart);
+		}
+		break;
+	    }
+	    ckPartLength = jIntToCKULong(jpRegions[jCount + i]);
+	} else {
+	    if (jByteArrayToScratchCKByteArray(env, (jbyteArray) jPart, &ckpCopy, &ckPartLength)) {
+		if (jPart != NULL_PTR) {
+		    (*env)->DeleteLocalRef(env, jPart);
+		}
+		break;
+	    }
+	    ckpPart = ckpCopy;
+	}
+	if (jPart != NULL_PTR) {
+	    (*env)->DeleteLocalRef(env, jPart);
+	}
+
+	if (!withOutput) {
+	    rv = (*function) (ckpFunctions, hSession, ckpPart, ckPartLength, NULL_PTR, NULL_PTR);
+	    scratchFree(ckpCopy);
+	    continue;
+	}
+
+	rv = callOutputFunction(moduleData, ckpFunctions, function, operation, hSession, ckpPart, ckPartLength,
+				&ckpOutput, &ckOutputLength);
+	scratchFree(ckpCopy);
+	if (rv != CKR_OK) {
+	    break;
+	}
+	if (ckCollectedLength + ckOutputLength > ckCapacity) {
+	    ckCapacity = 2 * ckCapacity;
+	    if (ckCapacity < ckCollectedLength + ckOutputLength) {
+		ckCapacity = ckCollectedLength + ckOutputLength;
+	    }
+	    ckpLarger = (CK_BYTE_PTR) scratchAlloc(ckCapacity + 1);
+	    if (ckpLarger == NULL_PTR) {
+		/* keep the collected output, so that it is freed below */
+		rv = CKR_HOST_MEMORY;
+	    } else {
+		if (ckpCollected != NULL_PTR) {
+		    memcpy(ckpLarger, ckpCollected, ckCollectedLength);
+		    scratchFree(ckpCollected);
+		}
+		ckpCollected = ckpLarger;
+	    }
+	}
+	if (rv == CKR_OK) {
+	    memcpy(ckpCollected + ckCollectedLength, ckpOutput, ckOutputLength);
+	    ckCollectedLength += ckOutputLength;
+	}
+	scratchFree(ckpOutput);
+    }
+
+    if (!(*env)->ExceptionOccurred(env) && ckAssertReturnValueOK(env, rv, callerMethodName) == CK_ASSERT_OK
+	&& withOutput) {
+	jOutput = ckByteArrayToJByteArray(env, ckpCollected, ckCollectedLength);
+    }
+
+    scratchFree(ckpCollected);
+    scratchFree(jpRegions);
+
+    return jOutput;
+}
@@ -60,10 +60,8 @@ jlong throwException(JNIEnv *env, CK_RV returnValue, const char* callerMethodNam
   jthrowable jPKCS11Exception;
   jlong jErrorCode;
 
-  jPKCS11ExceptionClass = (*env)->FindClass(env, CLASS_PKCS11EXCEPTION);
-  assert(jPKCS11ExceptionClass != 0);
-  jConstructor = (*env)->GetMethodID(env, jPKCS11ExceptionClass, "<init>", "(J)V");
-  assert(jConstructor != 0);
+  jPKCS11ExceptionClass = jniCache.pkcs11Exception.clazz;
+  jConstructor = jniCache.pkcs11Exception.init;
   jErrorCode = ckULongToJLong(returnValue);
   jPKCS11Exception = (jthrowable) (*env)->NewObject(env, jPKCS11ExceptionClass, jConstructor, jErrorCode);
   (*env)->Throw(env, jPKCS11Exception);
@@ -177,6 +175,148 @@ int jByteArrayToCKByteArray(JNIEnv *env, const jbyteArray jArray, CK_BYTE_PTR *c
   return 0;
 }
 
+/*
+ * converts a jbyteArray to a CK_BYTE array like jByteArrayToCKByteArray, but takes the memory
+ * from the scratch arena of the calling thread. The allocated memory has to be freed with
+ * scratchFree before the call returns!
+ *
+ * @param env - used to call JNI functions to get the array information
+ * @param jArray - the Java array to convert
+ * @param ckpArray - the reference, where the pointer to the new CK_BYTE array will be stored
+ * @param ckpLength - the reference, where the array length will be stored
+ * @return 0 is successful
+ */
+int jByteArrayToScratchCKByteArray(JNIEnv *env, const jbyteArray jArray, CK_BYTE_PTR *ckpArray, CK_ULONG_PTR ckpLength)
+{
+  jbyte* jpTemp;
+  CK_ULONG i;
+
+  *ckpArray = NULL_PTR;
+  if (jArray == NULL_PTR) {
+    *ckpLength = 0L;
+    return 0;
+  }
+  *ckpLength = (*env)->GetArrayLength(env, jArray);
+  if (*ckpLength == 0L) { return 0; }
+
+  *ckpArray = (CK_BYTE_PTR) scratchAlloc((*ckpLength) * sizeof(CK_BYTE));
+  if (*ckpArray == NULL_PTR) { throwOutOfMemoryError(env); return 1; }
+
+  /* if CK_BYTE is the same size as jbyte, we copy directly into the new array */
+  if (sizeof(CK_BYTE) == sizeof(jbyte)) {
+    (*env)->GetByteArrayRegion(env, jArray, 0, *ckpLength, (jbyte *) *ckpArray);
+  } else {
+    jpTemp = (jbyte*) scratchAlloc((*ckpLength) * sizeof(jbyte));
+    if (jpTemp == NULL_PTR) { scratchFree(*ckpArray); *ckpArray = NULL_PTR; throwOutOfMemoryError(env); return 2; }
+    (*env)->GetByteArrayRegion(env, jArray, 0, *ckpLength, jpTemp);
+    for (i=0; i<(*ckpLength); i++) {
+      (*ckpArray)[i] = jByteToCKByte(jpTemp[i]);
+    }
+    scratchFree(jpTemp);
+  }
+  return 0;
+}
+
+/*
+ * gets the address of a region of a direct java.nio.ByteBuffer. No memory is
+ * allocated and no data is copied; the returned pointer refers to the memory of
+ * the buffer itself and is only valid as long as the buffer object is alive.
+ *
+ * @param env - used to call JNI functions to get the buffer information
+ * @param jBuffer - the direct buffer
+ * @param jOffset - the offset of the region within the buffer
+ * @param jLength - the length of the region
+ * @param ckpBuffer - the reference, where the pointer to the region will be stored
+ * @return 0 is successful
+ */
+int jDirectBufferToCKBytePtr(JNIEnv *env, jobject jBuffer, jint jOffset, jint jLength, CK_BYTE_PTR *ckpBuffer)
+{
+  jbyte *jpAddress;
+  jlong jCapacity;
+
+  *ckpBuffer = NULL_PTR;
+  if (jBuffer == NULL_PTR) {
+    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The buffer must not be null."));
+    return 1;
+  }
+  jpAddress = (jbyte *) (*env)->GetDirectBufferAddress(env, jBuffer);
+  jCapacity = (*env)->GetDirectBufferCapacity(env, jBuffer);
+  if (jpAddress == NULL_PTR || jCapacity < 0) {
+    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The buffer is not a direct buffer."));
+    return 2;
+  }
+  if (jOffset < 0 || jLength < 0 || (jlong) jOffset + (jlong) jLength > jCapacity) {
+    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The region exceeds the capacity of the buffer."));
+    return 3;
+  }
+  *ckpBuffer = (CK_BYTE_PTR) (jpAddress + jOffset);
+  return 0;
+}
+
+/*
+ * checks that a region lies within the bounds of a jbyteArray. If it does not, a
+ * PKCS11RuntimeException is thrown.
+ *
+ * @param env - used to call JNI functions to get the array information
+ * @param jArray - the Java array
+ * @param jOffset - the offset of the region within the array
+ * @param jLength - the length of the region
+ * @return 0 is successful
+ */
+int checkJByteArrayRegion(JNIEnv *env, const jbyteArray jArray, jint jOffset, jint jLength)
+{
+  if (jArray == NULL_PTR) {
+    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The array must not be null."));
+    return 1;
+  }
+  if (jOffset < 0 || jLength < 0 || jOffset > (*env)->GetArrayLength(env, jArray) - jLength) {
+    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The region exceeds the bounds of the array."));
+    return 2;
+  }
+  return 0;
+}
+
+/*
+ * copies a region of a jbyteArray to a new CK_BYTE array in the scratch arena of the calling
+ * thread. The allocated memory has to be freed with scratchFree after use! An empty region
+ * results in a NULL_PTR.
+ *
+ * @param env - used to call JNI functions to get the array information
+ * @param jArray - the Java array to copy from
+ * @param jOffset - the offset of the region within the array
+ * @param jLength - the length of the region
+ * @param ckpArray - the reference, where the pointer to the new CK_BYTE array will be stored
+ * @return 0 is successful
+ */
+int jByteArrayRegionToCKByteArray(JNIEnv *env, const jbyteArray jArray, jint jOffset, jint jLength, CK_BYTE_PTR *ckpArray)
+{
+  *ckpArray = NULL_PTR;
+  if (checkJByteArrayRegion(env, jArray, jOffset, jLength)) { return 1; }
+  if (jLength == 0) { return 0; }
+
+  *ckpArray = (CK_BYTE_PTR) scratchAlloc(jLength * sizeof(CK_BYTE));
+  if (*ckpArray == NULL_PTR) { throwOutOfMemoryError(env); return 2; }
+  (*env)->GetByteArrayRegion(env, jArray, jOffset, jLength, (jbyte *) *ckpArray);
+  return 0;
+}
+
+/*
+ * copies a CK_BYTE array into a jbyteArray starting at the given offset. The caller has to make
+ * sure that the array is large enough, see checkJByteArrayRegion.
+ *
+ * @param env - used to call JNI functions to access the array
+ * @param ckpArray - the CK_BYTE array to copy
+ * @param ckLength - the number of bytes to copy
+ * @param jArray - the Java array to copy to
+ * @param jOffset - the offset within jArray
+ */
+void ckByteArrayToJByteArrayRegion(JNIEnv *env, const CK_BYTE_PTR ckpArray, CK_ULONG ckLength, jbyteArray jArray, jint jOffset)
+{
+  if (ckLength > 0) {
+    (*env)->SetByteArrayRegion(env, jArray, jOffset, ckULongToJInt(ckLength), (jbyte *) ckpArray);
+  }
+}
+
 /*
  * converts a jlongArray to a CK_ULONG array. The allocated memory has to be freed after use!
  *
@@ -268,10 +408,8 @@ int jCharArrayToCKUTF8CharArray(JNIEnv *env, const jcharArray jArray, CK_UTF8CHA
 		*ckpLength = 0L;
 		return 0;
 	}
-	jStringEncoderClass = (*env)->FindClass(env, CLASS_PKCS11UTIL);
-	assert(jStringEncoderClass != 0);
-	jEncoderMethod = (*env)->GetStaticMethodID(env, jStringEncoderClass, METHOD_ENCODER, "([C)[B");
-	assert(jEncoderMethod != 0);
+	jStringEncoderClass = jniCache.pkcs11Util.clazz;
+	jEncoderMethod = jniCache.pkcs11Util.encoder;
 	jValue = (*env)->CallStaticObjectMethod(env, jStringEncoderClass, jEncoderMethod, jArray);
 	if(jValue == 0)
 		return 1;
@@ -514,10 +652,8 @@ jcharArray ckUTF8CharArrayToJCharArray(JNIEnv *env, const CK_UTF8CHAR_PTR ckpArr
 	jArray = (*env)->NewByteArray(env, ckULongToJSize(ckLength));
 	(*env)->SetByteArrayRegion(env, jArray, 0, ckULongToJSize(ckLength), jpTemp);
 
-	jStringDecoderClass = (*env)->FindClass(env, CLASS_PKCS11UTIL);
-	assert(jStringDecoderClass != 0);
-	jDecoderMethod = (*env)->GetStaticMethodID(env, jStringDecoderClass, METHOD_DECODER, "([B)[C");
-	assert(jDecoderMethod != 0);
+	jStringDecoderClass = jniCache.pkcs11Util.clazz;
+	jDecoderMethod = jniCache.pkcs11Util.decoder;
 	jValue = (*env)->CallStaticObjectMethod(env, jStringDecoderClass, jDecoderMethod, jArray);
 
 	free(jpTemp);
@@ -537,8 +673,7 @@ jobject ckAttributeArrayToJAttributeArray(JNIEnv *env, const CK_ATTRIBUTE_PTR ck
 
 	length = ckLength/sizeof(CK_ATTRIBUTE);
 	jlength = ckULongToJSize(length);
-	jAttributeClass = (*env)->FindClass(env, CLASS_ATTRIBUTE);
-	assert(jAttributeClass != 0);
+	jAttributeClass = jniCache.attribute.clazz;
 	/* allocate array, all elements NULL_PTR per default */
 	jAttributeArray = (*env)->NewObjectArray(env, jlength, jAttributeClass, NULL_PTR);
 	assert(jAttributeArray != 0);
@@ -583,10 +718,8 @@ jobject ckBBoolPtrToJBooleanObject(JNIEnv *env, const CK_BBOOL *ckpValue)
 	jobject jValueObject;
 	jboolean jValue;
 
-	jValueObjectClass = (*env)->FindClass(env, "java/lang/Boolean");
-	assert(jValueObjectClass != 0);
-	jConstructor = (*env)->GetMethodID(env, jValueObjectClass, "<init>", "(Z)V");
-	assert(jConstructor != 0);
+	jValueObjectClass = jniCache.booleanObject.clazz;
+	jConstructor = jniCache.booleanObject.init;
 	jValue = ckBBoolToJBoolean(*ckpValue);
 	jValueObject = (*env)->NewObject(env, jValueObjectClass, jConstructor, jValue);
 	assert(jValueObject != 0);
@@ -608,10 +741,8 @@ jobject ckULongPtrToJLongObject(JNIEnv *env, const CK_ULONG_PTR ckpValue)
 	jobject jValueObject;
 	jlong jValue;
 
-	jValueObjectClass = (*env)->FindClass(env, "java/lang/Long");
-	assert(jValueObjectClass != 0);
-	jConstructor = (*env)->GetMethodID(env, jValueObjectClass, "<init>", "(J)V");
-	assert(jConstructor != 0);
+	jValueObjectClass = jniCache.longObject.clazz;
+	jConstructor = jniCache.longObject.init;
 	jValue = ckULongToJLong(*ckpValue);
 	jValueObject = (*env)->NewObject(env, jValueObjectClass, jConstructor, jValue);
 	assert(jValueObject != 0);
@@ -634,27 +765,23 @@ jobject ckDatePtrToJDateObject(JNIEnv *env, const CK_DATE *ckpValue)
 	jfieldID fieldID;
 
 	/* load CK_DATE class */
-	jValueObjectClass = (*env)->FindClass(env, CLASS_DATE);
-	assert(jValueObjectClass != 0);
+	jValueObjectClass = jniCache.date.clazz;
 	/* create new CK_DATE jObject */
 	jValueObject = (*env)->AllocObject(env, jValueObjectClass);
 	assert(jValueObject != 0);
 
 	/* set year */
-	fieldID = (*env)->GetFieldID(env, jValueObjectClass, "year", "[C");
-	assert(fieldID != 0);
+	fieldID = jniCache.date.year;
 	jTempCharArray = ckCharArrayToJCharArray(env, (CK_CHAR_PTR)(ckpValue->year), 4);
 	(*env)->SetObjectField(env, jValueObject, fieldID, jTempCharArray);
 
 	/* set month */
-	fieldID = (*env)->GetFieldID(env, jValueObjectClass, "month", "[C");
-	assert(fieldID != 0);
+	fieldID = jniCache.date.month;
 	jTempCharArray = ckCharArrayToJCharArray(env, (CK_CHAR_PTR)(ckpValue->month), 2);
 	(*env)->SetObjectField(env, jValueObject, fieldID, jTempCharArray);
 
 	/* set day */
-	fieldID = (*env)->GetFieldID(env, jValueObjectClass, "day", "[C");
-	assert(fieldID != 0);
+	fieldID = jniCache.date.day;
 	jTempCharArray = ckCharArrayToJCharArray(env, (CK_CHAR_PTR)(ckpValue->day), 2);
 	(*env)->SetObjectField(env, jValueObject, fieldID, jTempCharArray);
 
@@ -675,18 +802,15 @@ jobject ckVersionPtrToJVersion(JNIEnv *env, const CK_VERSION_PTR ckpVersion)
 	jfieldID jFieldID;
 
 	/* load CK_VERSION class */
-	jVersionClass = (*env)->FindClass(env, CLASS_VERSION);
-	assert(jVersionClass != 0);
+	jVersionClass = jniCache.version.clazz;
 	/* create new CK_VERSION object */
 	jVersionObject = (*env)->AllocObject(env, jVersionClass);
 	assert(jVersionObject != 0);
 	/* set major */
-	jFieldID = (*env)->GetFieldID(env, jVersionClass, "major", "B");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.version.major;
 	(*env)->SetByteField(env, jVersionObject, jFieldID, (jbyte) (ckpVersion->major));
 	/* set minor */
-	jFieldID = (*env)->GetFieldID(env, jVersionClass, "minor", "B");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.version.minor;
 	(*env)->SetByteField(env, jVersionObject, jFieldID, (jbyte) (ckpVersion->minor));
 
 	return jVersionObject ;
@@ -708,38 +832,32 @@ jobject ckInfoPtrToJInfo(JNIEnv *env, const CK_INFO_PTR ckpInfo)
 	jobject jTempVersion;
 
 	/* load CK_INFO class */
-	jInfoClass = (*env)->FindClass(env, CLASS_INFO);
-	assert(jInfoClass != 0);
+	jInfoClass = jniCache.info.clazz;
 	/* create new CK_INFO object */
 	jInfoObject = (*env)->AllocObject(env, jInfoClass);
 	assert(jInfoObject != 0);
 
 	/* set cryptokiVersion */
-	jFieldID = (*env)->GetFieldID(env, jInfoClass, "cryptokiVersion", CLASS_NAME(CLASS_VERSION));
-	assert(jFieldID != 0);
+	jFieldID = jniCache.info.cryptokiVersion;
 	jTempVersion = ckVersionPtrToJVersion(env, &(ckpInfo->cryptokiVersion));
 	(*env)->SetObjectField(env, jInfoObject, jFieldID, jTempVersion);
 
 	/* set manufacturerID */
-	jFieldID = (*env)->GetFieldID(env, jInfoClass, "manufacturerID", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.info.manufacturerID;
 	jTempCharArray = ckUTF8CharArrayToJCharArray(env, &(ckpInfo->manufacturerID[0]), 32);
 	(*env)->SetObjectField(env, jInfoObject, jFieldID, jTempCharArray);
 
 	/* set flags */
-	jFieldID = (*env)->GetFieldID(env, jInfoClass, "flags", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.info.flags;
 	(*env)->SetLongField(env, jInfoObject, jFieldID, ckULongToJLong(ckpInfo->flags));
 
 	/* set libraryDescription */
-	jFieldID = (*env)->GetFieldID(env, jInfoClass, "libraryDescription", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.info.libraryDescription;
 	jTempCharArray = ckUTF8CharArrayToJCharArray(env, &(ckpInfo->libraryDescription[0]) ,32);
 	(*env)->SetObjectField(env, jInfoObject, jFieldID, jTempCharArray);
 
 	/* set libraryVersion */
-	jFieldID = (*env)->GetFieldID(env, jInfoClass, "libraryVersion", CLASS_NAME(CLASS_VERSION));
-	assert(jFieldID != 0);
+	jFieldID = jniCache.info.libraryVersion;
 	jTempVersion = ckVersionPtrToJVersion(env, &(ckpInfo->libraryVersion));
 	(*env)->SetObjectField(env, jInfoObject, jFieldID, jTempVersion);
 
@@ -762,39 +880,33 @@ jobject ckSlotInfoPtrToJSlotInfo(JNIEnv *env, const CK_SLOT_INFO_PTR ckpSlotInfo
 	jobject jTempVersion;
 
 	/* load CK_SLOT_INFO class */
-	jSlotInfoClass = (*env)->FindClass(env, CLASS_SLOT_INFO);
-	assert(jSlotInfoClass != 0);
+	jSlotInfoClass = jniCache.slotInfo.clazz;
 	/* create new CK_SLOT_INFO object */
 	jSlotInfoObject = (*env)->AllocObject(env, jSlotInfoClass);
 	assert(jSlotInfoObject != 0);
 
 
 	/* set slotDescription */
-	jFieldID = (*env)->GetFieldID(env, jSlotInfoClass, "slotDescription", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.slotInfo.slotDescription;
 	jTempCharArray = ckUTF8CharArrayToJCharArray(env, &(ckpSlotInfo->slotDescription[0]) ,64);
 	(*env)->SetObjectField(env, jSlotInfoObject, jFieldID, jTempCharArray);
 
 	/* set manufacturerID */
-	jFieldID = (*env)->GetFieldID(env, jSlotInfoClass, "manufacturerID", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.slotInfo.manufacturerID;
 	jTempCharArray = ckUTF8CharArrayToJCharArray(env, &(ckpSlotInfo->manufacturerID[0]) ,32);
 	(*env)->SetObjectField(env, jSlotInfoObject, jFieldID, jTempCharArray);
 
 	/* set flags */
-	jFieldID = (*env)->GetFieldID(env, jSlotInfoClass, "flags", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.slotInfo.flags;
 	(*env)->SetLongField(env, jSlotInfoObject, jFieldID, ckULongToJLong(ckpSlotInfo->flags));
 
 	/* set hardwareVersion */
-	jFieldID = (*env)->GetFieldID(env, jSlotInfoClass, "hardwareVersion", CLASS_NAME(CLASS_VERSION));
-	assert(jFieldID != 0);
+	jFieldID = jniCache.slotInfo.hardwareVersion;
 	jTempVersion = ckVersionPtrToJVersion(env, &(ckpSlotInfo->hardwareVersion));
 	(*env)->SetObjectField(env, jSlotInfoObject, jFieldID, jTempVersion);
 
 	/* set firmwareVersion */
-	jFieldID = (*env)->GetFieldID(env, jSlotInfoClass, "firmwareVersion", CLASS_NAME(CLASS_VERSION));
-	assert(jFieldID != 0);
+	jFieldID = jniCache.slotInfo.firmwareVersion;
 	jTempVersion = ckVersionPtrToJVersion(env, &(ckpSlotInfo->firmwareVersion));
 	(*env)->SetObjectField(env, jSlotInfoObject, jFieldID, jTempVersion);
 
@@ -817,108 +929,89 @@ jobject ckTokenInfoPtrToJTokenInfo(JNIEnv *env, const CK_TOKEN_INFO_PTR ckpToken
 	jobject jTempVersion;
 
 	/* load CK_SLOT_INFO class */
-	jTokenInfoClass = (*env)->FindClass(env, CLASS_TOKEN_INFO);
-	assert(jTokenInfoClass != 0);
+	jTokenInfoClass = jniCache.tokenInfo.clazz;
 	/* create new CK_SLOT_INFO object */
 	jTokenInfoObject = (*env)->AllocObject(env, jTokenInfoClass);
 	assert(jTokenInfoObject != 0);
 
 
 	/* set label */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "label", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.label;
 	jTempCharArray = ckUTF8CharArrayToJCharArray(env, &(ckpTokenInfo->label[0]) ,32);
 	(*env)->SetObjectField(env, jTokenInfoObject, jFieldID, jTempCharArray);
 
 	/* set manufacturerID */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "manufacturerID", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.manufacturerID;
 	jTempCharArray = ckUTF8CharArrayToJCharArray(env, &(ckpTokenInfo->manufacturerID[0]) ,32);
 	(*env)->SetObjectField(env, jTokenInfoObject, jFieldID, jTempCharArray);
 
 	/* set model */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "model", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.model;
 	jTempCharArray = ckUTF8CharArrayToJCharArray(env, &(ckpTokenInfo->model[0]) ,16);
 	(*env)->SetObjectField(env, jTokenInfoObject, jFieldID, jTempCharArray);
 
 	/* set serialNumber */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "serialNumber", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.serialNumber;
 	jTempCharArray = ckCharArrayToJCharArray(env, &(ckpTokenInfo->serialNumber[0]) ,16);
 	(*env)->SetObjectField(env, jTokenInfoObject, jFieldID, jTempCharArray);
 
 	/* set flags */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "flags", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.flags;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->flags));
 
 	/* set ulMaxSessionCount */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulMaxSessionCount", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulMaxSessionCount;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulMaxSessionCount));
 
 	/* set ulSessionCount */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulSessionCount", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulSessionCount;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulSessionCount));
 
 	/* set ulMaxRwSessionCount */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulMaxRwSessionCount", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulMaxRwSessionCount;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulMaxRwSessionCount));
 
 	/* set ulRwSessionCount */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulRwSessionCount", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulRwSessionCount;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulRwSessionCount));
 
 	/* set ulMaxPinLen */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulMaxPinLen", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulMaxPinLen;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulMaxPinLen));
 
 	/* set ulMinPinLen */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulMinPinLen", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulMinPinLen;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulMinPinLen));
 
 	/* set ulTotalPublicMemory */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulTotalPublicMemory", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulTotalPublicMemory;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulTotalPublicMemory));
 
 	/* set ulFreePublicMemory */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulFreePublicMemory", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulFreePublicMemory;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulFreePublicMemory));
 
 	/* set ulTotalPrivateMemory */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulTotalPrivateMemory", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulTotalPrivateMemory;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulTotalPrivateMemory));
 
 	/* set ulFreePrivateMemory */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "ulFreePrivateMemory", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.ulFreePrivateMemory;
 	(*env)->SetLongField(env, jTokenInfoObject, jFieldID, ckULongToJLong(ckpTokenInfo->ulFreePrivateMemory));
 
 
 	/* set hardwareVersion */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "hardwareVersion", CLASS_NAME(CLASS_VERSION));
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.hardwareVersion;
 	jTempVersion = ckVersionPtrToJVersion(env, &(ckpTokenInfo->hardwareVersion));
 	(*env)->SetObjectField(env, jTokenInfoObject, jFieldID, jTempVersion);
 
 	/* set firmwareVersion */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "firmwareVersion", CLASS_NAME(CLASS_VERSION));
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.firmwareVersion;
 	jTempVersion = ckVersionPtrToJVersion(env, &(ckpTokenInfo->firmwareVersion));
 	(*env)->SetObjectField(env, jTokenInfoObject, jFieldID, jTempVersion);
 
 	/* set utcTime */
-	jFieldID = (*env)->GetFieldID(env, jTokenInfoClass, "utcTime", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.tokenInfo.utcTime;
 	jTempCharArray = ckCharArrayToJCharArray(env, &(ckpTokenInfo->utcTime[0]) ,16);
 	(*env)->SetObjectField(env, jTokenInfoObject, jFieldID, jTempCharArray);
 
@@ -939,30 +1032,25 @@ jobject ckSessionInfoPtrToJSessionInfo(JNIEnv *env, const CK_SESSION_INFO_PTR ck
 	jfieldID jFieldID;
 
 	/* load CK_SESSION_INFO class */
-	jSessionInfoClass = (*env)->FindClass(env, CLASS_SESSION_INFO);
-	assert(jSessionInfoClass != 0);
+	jSessionInfoClass = jniCache.sessionInfo.clazz;
 	/* create new CK_SESSION_INFO object */
 	jSessionInfoObject = (*env)->AllocObject(env, jSessionInfoClass);
 	assert(jSessionInfoObject != 0);
 
 	/* set slotID */
-	jFieldID = (*env)->GetFieldID(env, jSessionInfoClass, "slotID", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.sessionInfo.slotID;
 	(*env)->SetLongField(env, jSessionInfoObject, jFieldID, ckULongToJLong(ckpSessionInfo->slotID));
 
 	/* set state */
-	jFieldID = (*env)->GetFieldID(env, jSessionInfoClass, "state", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.sessionInfo.state;
 	(*env)->SetLongField(env, jSessionInfoObject, jFieldID, ckULongToJLong(ckpSessionInfo->state));
 
 	/* set flags */
-	jFieldID = (*env)->GetFieldID(env, jSessionInfoClass, "flags", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.sessionInfo.flags;
 	(*env)->SetLongField(env, jSessionInfoObject, jFieldID, ckULongToJLong(ckpSessionInfo->flags));
 
 	/* set ulDeviceError */
-	jFieldID = (*env)->GetFieldID(env, jSessionInfoClass, "ulDeviceError", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.sessionInfo.ulDeviceError;
 	(*env)->SetLongField(env, jSessionInfoObject, jFieldID, ckULongToJLong(ckpSessionInfo->ulDeviceError));
 
 	return jSessionInfoObject ;
@@ -982,26 +1070,22 @@ jobject ckMechanismInfoPtrToJMechanismInfo(JNIEnv *env, const CK_MECHANISM_INFO_
 	jfieldID jFieldID;
 
 	/* load CK_MECHANISM_INFO class */
-	jMechanismInfoClass = (*env)->FindClass(env, CLASS_MECHANISM_INFO);
-	assert(jMechanismInfoClass != 0);
+	jMechanismInfoClass = jniCache.mechanismInfo.clazz;
 	/* create new CK_MECHANISM_INFO object */
 	jMechanismInfoObject = (*env)->AllocObject(env, jMechanismInfoClass);
 	assert(jMechanismInfoObject != 0);
 
 
 	/* set ulMinKeySize */
-	jFieldID = (*env)->GetFieldID(env, jMechanismInfoClass, "ulMinKeySize", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.mechanismInfo.ulMinKeySize;
 	(*env)->SetLongField(env, jMechanismInfoObject, jFieldID, ckULongToJLong(ckpMechanismInfo->ulMinKeySize));
 
 	/* set ulMaxKeySize */
-	jFieldID = (*env)->GetFieldID(env, jMechanismInfoClass, "ulMaxKeySize", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.mechanismInfo.ulMaxKeySize;
 	(*env)->SetLongField(env, jMechanismInfoObject, jFieldID, ckULongToJLong(ckpMechanismInfo->ulMaxKeySize));
 
 	/* set flags */
-	jFieldID = (*env)->GetFieldID(env, jMechanismInfoClass, "flags", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.mechanismInfo.flags;
 	(*env)->SetLongField(env, jMechanismInfoObject, jFieldID, ckULongToJLong(ckpMechanismInfo->flags));
 
 	return jMechanismInfoObject ;
@@ -1021,19 +1105,16 @@ jobject ckAttributePtrToJAttribute(JNIEnv *env, const CK_ATTRIBUTE_PTR ckpAttrib
 	jfieldID jFieldID;
 	jobject jPValue = NULL_PTR;
 
-	jAttributeClass = (*env)->FindClass(env, CLASS_ATTRIBUTE);
-	assert(jAttributeClass != 0);
+	jAttributeClass = jniCache.attribute.clazz;
 	jAttribute = (*env)->AllocObject(env, jAttributeClass);
 	assert(jAttribute != 0);
 
 	/* set type */
-	jFieldID = (*env)->GetFieldID(env, jAttributeClass, "type", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.attribute.type;
 	(*env)->SetLongField(env, jAttribute, jFieldID, ckULongToJLong(ckpAttribute->type));
 
 	/* set pValue */
-	jFieldID = (*env)->GetFieldID(env, jAttributeClass, "pValue", "Ljava/lang/Object;");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.attribute.pValue;
 
 	jPValue = ckAttributeValueToJObject(env, ckpAttribute, obj, jSessionHandle, jObjectHandle, UseUtf8);
 	(*env)->SetObjectField(env, jAttribute, jFieldID, jPValue);
@@ -1051,15 +1132,11 @@ jobject ckAttributePtrToJAttribute(JNIEnv *env, const CK_ATTRIBUTE_PTR ckpAttrib
  */
 CK_BBOOL* jBooleanObjectToCKBBoolPtr(JNIEnv *env, jobject jObject)
 {
-	jclass jObjectClass;
 	jmethodID jValueMethod;
 	jboolean jValue;
 	CK_BBOOL *ckpValue;
 
-	jObjectClass = (*env)->FindClass(env, "java/lang/Boolean");
-	assert(jObjectClass != 0);
-	jValueMethod = (*env)->GetMethodID(env, jObjectClass, "booleanValue", "()Z");
-	assert(jValueMethod != 0);
+	jValueMethod = jniCache.booleanObject.booleanValue;
 	jValue = (*env)->CallBooleanMethod(env, jObject, jValueMethod);
 	ckpValue = (CK_BBOOL *) malloc(sizeof(CK_BBOOL));
   if (ckpValue == NULL_PTR) { throwOutOfMemoryError(env); return NULL_PTR; }
@@ -1078,15 +1155,11 @@ CK_BBOOL* jBooleanObjectToCKBBoolPtr(JNIEnv *env, jobject jObject)
  */
 CK_BYTE_PTR jByteObjectToCKBytePtr(JNIEnv *env, jobject jObject)
 {
-	jclass jObjectClass;
 	jmethodID jValueMethod;
 	jbyte jValue;
 	CK_BYTE_PTR ckpValue;
 
-	jObjectClass = (*env)->FindClass(env, "java/lang/Byte");
-	assert(jObjectClass != 0);
-	jValueMethod = (*env)->GetMethodID(env, jObjectClass, "byteValue", "()B");
-	assert(jValueMethod != 0);
+	jValueMethod = jniCache.byteObject.byteValue;
 	jValue = (*env)->CallByteMethod(env, jObject, jValueMethod);
 	ckpValue = (CK_BYTE_PTR) malloc(sizeof(CK_BYTE));
   if (ckpValue == NULL_PTR) { throwOutOfMemoryError(env); return NULL_PTR; }
@@ -1105,15 +1178,11 @@ CK_BYTE_PTR jByteObjectToCKBytePtr(JNIEnv *env, jobject jObject)
  */
 CK_ULONG* jIntegerObjectToCKULongPtr(JNIEnv *env, jobject jObject)
 {
-	jclass jObjectClass;
 	jmethodID jValueMethod;
 	jint jValue;
 	CK_ULONG *ckpValue;
 
-	jObjectClass = (*env)->FindClass(env, "java/lang/Integer");
-	assert(jObjectClass != 0);
-	jValueMethod = (*env)->GetMethodID(env, jObjectClass, "intValue", "()I");
-	assert(jValueMethod != 0);
+	jValueMethod = jniCache.integerObject.intValue;
 	jValue = (*env)->CallIntMethod(env, jObject, jValueMethod);
 	ckpValue = (CK_ULONG *) malloc(sizeof(CK_ULONG));
   if (ckpValue == NULL_PTR) { throwOutOfMemoryError(env); return NULL_PTR; }
@@ -1132,15 +1201,11 @@ CK_ULONG* jIntegerObjectToCKULongPtr(JNIEnv *env, jobject jObject)
  */
 CK_ULONG* jLongObjectToCKULongPtr(JNIEnv *env, jobject jObject)
 {
-	jclass jObjectClass;
 	jmethodID jValueMethod;
 	jlong jValue;
 	CK_ULONG *ckpValue;
 
-	jObjectClass = (*env)->FindClass(env, "java/lang/Long");
-	assert(jObjectClass != 0);
-	jValueMethod = (*env)->GetMethodID(env, jObjectClass, "longValue", "()J");
-	assert(jValueMethod != 0);
+	jValueMethod = jniCache.longObject.longValue;
 	jValue = (*env)->CallLongMethod(env, jObject, jValueMethod);
 	ckpValue = (CK_ULONG *) malloc(sizeof(CK_ULONG));
   if (ckpValue == NULL_PTR) { throwOutOfMemoryError(env); return NULL_PTR; }
@@ -1159,15 +1224,11 @@ CK_ULONG* jLongObjectToCKULongPtr(JNIEnv *env, jobject jObject)
  */
 CK_CHAR_PTR jCharObjectToCKCharPtr(JNIEnv *env, jobject jObject)
 {
-	jclass jObjectClass;
 	jmethodID jValueMethod;
 	jchar jValue;
 	CK_CHAR_PTR ckpValue;
 
-	jObjectClass = (*env)->FindClass(env, "java/lang/Char");
-	assert(jObjectClass != 0);
-	jValueMethod = (*env)->GetMethodID(env, jObjectClass, "charValue", "()C");
-	assert(jValueMethod != 0);
+	jValueMethod = jniCache.characterObject.charValue;
 	jValue = (*env)->CallCharMethod(env, jObject, jValueMethod);
 	ckpValue = (CK_CHAR_PTR) malloc(sizeof(CK_CHAR));
   if (ckpValue == NULL_PTR) { throwOutOfMemoryError(env); return NULL_PTR; }
@@ -1186,7 +1247,6 @@ CK_CHAR_PTR jCharObjectToCKCharPtr(JNIEnv *env, jobject jObject)
 CK_VERSION_PTR jVersionToCKVersionPtr(JNIEnv *env, jobject jVersion)
 {
 	CK_VERSION_PTR ckpVersion;
-	jclass jVersionClass;
 	jfieldID jFieldID;
 	jbyte jMajor, jMinor;
 
@@ -1195,18 +1255,14 @@ CK_VERSION_PTR jVersionToCKVersionPtr(JNIEnv *env, jobject jVersion)
   if (ckpVersion == NULL_PTR) { throwOutOfMemoryError(env); return NULL_PTR; }
 
 	/* get CK_VERSION class */
-	jVersionClass = (*env)->GetObjectClass(env, jVersion);
-	assert(jVersionClass != 0);
 
 	/* get Major */
-	jFieldID = (*env)->GetFieldID(env, jVersionClass, "major", "B");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.version.major;
 	jMajor = (*env)->GetByteField(env, jVersion, jFieldID);
 	ckpVersion->major = jByteToCKByte(jMajor);
 
 	/* get Minor */
-	jFieldID = (*env)->GetFieldID(env, jVersionClass, "minor", "B");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.version.minor;
 	jMinor = (*env)->GetByteField(env, jVersion, jFieldID);
 	ckpVersion->minor = jByteToCKByte(jMinor);
 
@@ -1225,7 +1281,6 @@ CK_DATE * jDateObjectPtrToCKDatePtr(JNIEnv *env, jobject jDate)
 {
 	CK_DATE * ckpDate;
   CK_ULONG ckLength;
-	jclass jDateClass;
 	jfieldID jFieldID;
 	jobject jYear, jMonth, jDay;
   jchar *jTempChars;
@@ -1236,12 +1291,9 @@ CK_DATE * jDateObjectPtrToCKDatePtr(JNIEnv *env, jobject jDate)
   if (ckpDate == NULL_PTR) { throwOutOfMemoryError(env); return NULL_PTR; }
 
 	/* get CK_DATE class */
-	jDateClass = (*env)->FindClass(env, CLASS_DATE);
-	assert(jDateClass != 0);
 
 	/* get Year */
-	jFieldID = (*env)->GetFieldID(env, jDateClass, "year", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.date.year;
 	jYear = (*env)->GetObjectField(env, jDate, jFieldID);
 
   if (jYear == NULL_PTR) {
@@ -1261,8 +1313,7 @@ CK_DATE * jDateObjectPtrToCKDatePtr(JNIEnv *env, jobject jDate)
   }
 
 	/* get Month */
-	jFieldID = (*env)->GetFieldID(env, jDateClass, "month", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.date.month;
 	jMonth = (*env)->GetObjectField(env, jDate, jFieldID);
 
   if (jMonth == NULL_PTR) {
@@ -1280,8 +1331,7 @@ CK_DATE * jDateObjectPtrToCKDatePtr(JNIEnv *env, jobject jDate)
   }
 
 	/* get Day */
-	jFieldID = (*env)->GetFieldID(env, jDateClass, "day", "[C");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.date.day;
 	jDay = (*env)->GetObjectField(env, jDate, jFieldID);
 
   if (jDay == NULL_PTR) {
@@ -1312,7 +1362,6 @@ CK_DATE * jDateObjectPtrToCKDatePtr(JNIEnv *env, jobject jDate)
 CK_ATTRIBUTE jAttributeToCKAttribute(JNIEnv *env, jobject jAttribute, jboolean jUseUtf8)
 {
 	CK_ATTRIBUTE ckAttribute;
-	jclass jAttributeClass;
 	jfieldID jFieldID;
 	jlong jType;
 	jobject jPValue;
@@ -1321,20 +1370,16 @@ CK_ATTRIBUTE jAttributeToCKAttribute(JNIEnv *env, jobject jAttribute, jboolean j
 
   /* get CK_ATTRIBUTE class */
 	TRACE0(tag_debug, __FUNCTION__,"- getting attribute object class");
-	jAttributeClass = (*env)->GetObjectClass(env, jAttribute);
-	assert(jAttributeClass != 0);
 
 	/* get type */
 	TRACE0(tag_debug, __FUNCTION__,"- getting type field");
-	jFieldID = (*env)->GetFieldID(env, jAttributeClass, "type", "J");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.attribute.type;
 	jType = (*env)->GetLongField(env, jAttribute, jFieldID);
 	TRACE1(tag_debug, __FUNCTION__,"  type=0x%X", (int)jType);
 
 	/* get pValue */
 	TRACE0(tag_debug, __FUNCTION__,"- getting pValue field");
-	jFieldID = (*env)->GetFieldID(env, jAttributeClass, "pValue", "Ljava/lang/Object;");
-	assert(jFieldID != 0);
+	jFieldID = jniCache.attribute.pValue;
 	jPValue = (*env)->GetObjectField(env, jAttribute, jFieldID);
 	TRACE1(tag_debug, __FUNCTION__,"  pValue=%p", jPValue);
 
@@ -1367,23 +1412,18 @@ CK_ATTRIBUTE jAttributeToCKAttribute(JNIEnv *env, jobject jAttribute, jboolean j
 CK_MECHANISM jMechanismToCKMechanism(JNIEnv *env, jobject jMechanism, jboolean jUseUtf8)
 {
 	CK_MECHANISM ckMechanism;
-	jclass jMechanismClass;
 	jfieldID fieldID;
 	jlong jMechanismType;
 	jobject jParameter;
 
 	/* get CK_MECHANISM class */
-	jMechanismClass = (*env)->GetObjectClass(env, jMechanism);
-	assert(jMechanismClass != 0);
 
 	/* get mechanism */
-	fieldID = (*env)->GetFieldID(env, jMechanismClass, "mechanism", "J");
-	assert(fieldID != 0);
+	fieldID = jniCache.mechanism.mechanism;
 	jMechanismType = (*env)->GetLongField(env, jMechanism, fieldID);
 
 	/* get pParameter */
-	fieldID = (*env)->GetFieldID(env, jMechanismClass, "pParameter", "Ljava/lang/Object;");
-	assert(fieldID != 0);
+	fieldID = jniCache.mechanism.pParameter;
 	jParameter = (*env)->GetObjectField(env, jMechanism, fieldID);
 
 	ckMechanism.mechanism = jLongToCKULong(jMechanismType);
@@ -1610,27 +1650,25 @@ jobject ckAttributeValueToJObject(JNIEnv *env, const CK_ATTRIBUTE_PTR ckpAttribu
  */
 void jObjectToPrimitiveCKObjectPtrPtr(JNIEnv *env, jobject jObject, CK_VOID_PTR *ckpObjectPtr, CK_ULONG *ckpLength, jboolean jUseUtf8)
 {
-	jclass jBooleanClass     = (*env)->FindClass(env, "java/lang/Boolean");
-	jclass jByteClass        = (*env)->FindClass(env, "java/lang/Byte");
-	jclass jCharacterClass   = (*env)->FindClass(env, "java/lang/Character");
-	jclass jClassClass = (*env)->FindClass(env, "java/lang/Class");
+	jclass jBooleanClass = jniCache.booleanObject.clazz;
+	jclass jByteClass = jniCache.byteObject.clazz;
+	jclass jCharacterClass = jniCache.characterObject.clazz;
 	/* jclass jShortClass       = (*env)->FindClass(env, "java/lang/Short"); */
-	jclass jIntegerClass     = (*env)->FindClass(env, "java/lang/Integer");
-	jclass jLongClass        = (*env)->FindClass(env, "java/lang/Long");
+	jclass jIntegerClass = jniCache.integerObject.clazz;
+	jclass jLongClass = jniCache.longObject.clazz;
 	/* jclass jFloatClass       = (*env)->FindClass(env, "java/lang/Float"); */
 	/* jclass jDoubleClass      = (*env)->FindClass(env, "java/lang/Double"); */
-	jclass jDateClass      = (*env)->FindClass(env, CLASS_DATE);
-	jclass jStringClass      = (*env)->FindClass(env, "java/lang/String");
-	jclass jStringBufferClass      = (*env)->FindClass(env, "java/lang/StringBuffer");
-	jclass jBooleanArrayClass = (*env)->FindClass(env, "[Z");
-	jclass jByteArrayClass    = (*env)->FindClass(env, "[B");
-	jclass jCharArrayClass    = (*env)->FindClass(env, "[C");
+	jclass jDateClass = jniCache.date.clazz;
+	jclass jStringClass = jniCache.string.clazz;
+	jclass jStringBufferClass = jniCache.stringBuffer.clazz;
+	jclass jBooleanArrayClass = jniCache.booleanArray.clazz;
+	jclass jByteArrayClass = jniCache.byteArray.clazz;
+	jclass jCharArrayClass = jniCache.charArray.clazz;
 	/* jclass jShortArrayClass   = (*env)->FindClass(env, "[S"); */
-	jclass jIntArrayClass     = (*env)->FindClass(env, "[I");
-	jclass jLongArrayClass    = (*env)->FindClass(env, "[J");
+	jclass jIntArrayClass = jniCache.intArray.clazz;
+	jclass jLongArrayClass = jniCache.longArray.clazz;
 	/* jclass jFloatArrayClass   = (*env)->FindClass(env, "[F"); */
 	/* jclass jDoubleArrayClass  = (*env)->FindClass(env, "[D"); */
-	jclass jObjectClass = (*env)->FindClass(env, "java/lang/Object");
   /*  jclass jObjectArrayClass = (*env)->FindClass(env, "[java/lang/Object"); */
   /* ATTENTION: jObjectArrayClass is always NULL_PTR !! */
   /* CK_ULONG ckArrayLength; */
@@ -1728,22 +1766,18 @@ void jObjectToPrimitiveCKObjectPtrPtr(JNIEnv *env, jobject jObject, CK_VOID_PTR
 		TRACE0(tag_error, __FUNCTION__, "- Java object of this class cannot be converted to native PKCS#11 type");
 
 		/* type of jObject unknown, throw PKCS11RuntimeException */
-	  jMethod = (*env)->GetMethodID(env, jObjectClass, "getClass", "()Ljava/lang/Class;");
-	  assert(jMethod != 0);
+	  jMethod = jniCache.object.getClass;
     jClassObject = (*env)->CallObjectMethod(env, jObject, jMethod);
 	  assert(jClassObject != 0);
-	  jMethod = (*env)->GetMethodID(env, jClassClass, "getName", "()Ljava/lang/String;");
-	  assert(jMethod != 0);
+	  jMethod = jniCache.clazz.getName;
     jClassNameString = (jstring)
         (*env)->CallObjectMethod(env, jClassObject, jMethod);
 	  assert(jClassNameString != 0);
     jExceptionMessagePrefix = (*env)->NewStringUTF(env, "Java object of this class cannot be converted to native PKCS#11 type: ");
-	  jMethod = (*env)->GetMethodID(env, jStringBufferClass, "<init>", "(Ljava/lang/String;)V");
-	  assert(jMethod != 0);
+	  jMethod = jniCache.stringBuffer.init;
     jExceptionMessageStringBuffer = (*env)->NewObject(env, jStringBufferClass, jMethod, jExceptionMessagePrefix);
 	  assert(jClassNameString != 0);
-	  jMethod = (*env)->GetMethodID(env, jStringBufferClass, "append", "(Ljava/lang/String;)Ljava/lang/StringBuffer;");
-	  assert(jMethod != 0);
+	  jMethod = jniCache.stringBuffer.append;
     jExceptionMessage = (jstring)
          (*env)->CallObjectMethod(env, jExceptionMessageStringBuffer, jMethod, jClassNameString);
 	  assert(jExceptionMessage != 0);
@@ -1785,41 +1819,41 @@ void jObjectToPrimitiveCKObjectPtrPtr(JNIEnv *env, jobject jObject, CK_VOID_PTR
 void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_VOID_PTR *ckpParamPtr, CK_ULONG *ckpLength, jboolean jUseUtf8)
 {
 	/* get all Java mechanism parameter classes */
-	jclass jByteArrayClass    = (*env)->FindClass(env, "[B");
-	jclass jLongClass        = (*env)->FindClass(env, "java/lang/Long");
-	jclass jVersionClass    = (*env)->FindClass(env, CLASS_VERSION);
-	jclass jRsaPkcsOaepParamsClass = (*env)->FindClass(env, CLASS_RSA_PKCS_OAEP_PARAMS);
-	jclass jKeaDeriveParamsClass = (*env)->FindClass(env, CLASS_KEA_DERIVE_PARAMS);
-  jclass jRc2CbcParamsClass = (*env)->FindClass(env, CLASS_RC2_CBC_PARAMS);
-	jclass jRc2MacGeneralParamsClass = (*env)->FindClass(env, CLASS_RC2_MAC_GENERAL_PARAMS);
-	jclass jRc5ParamsClass = (*env)->FindClass(env, CLASS_RC5_PARAMS);
-  jclass jRc5CbcParamsClass = (*env)->FindClass(env, CLASS_RC5_CBC_PARAMS);
-	jclass jRc5MacGeneralParamsClass = (*env)->FindClass(env, CLASS_RC5_MAC_GENERAL_PARAMS);
-	jclass jSkipjackPrivateWrapParamsClass = (*env)->FindClass(env, CLASS_SKIPJACK_PRIVATE_WRAP_PARAMS);
-	jclass jSkipjackRelayxParamsClass = (*env)->FindClass(env, CLASS_SKIPJACK_RELAYX_PARAMS);
-	jclass jPbeParamsClass = (*env)->FindClass(env, CLASS_PBE_PARAMS);
-	jclass jPkcs5Pbkd2ParamsClass = (*env)->FindClass(env, CLASS_PKCS5_PBKD2_PARAMS);
-	jclass jKeyWrapSetOaepParamsClass = (*env)->FindClass(env, CLASS_KEY_WRAP_SET_OAEP_PARAMS);
-  jclass jKeyDerivationStringDataClass = (*env)->FindClass(env, CLASS_KEY_DERIVATION_STRING_DATA);
-	jclass jSsl3MasterKeyDeriveParamsClass = (*env)->FindClass(env, CLASS_SSL3_MASTER_KEY_DERIVE_PARAMS);
-	jclass jSsl3KeyMatParamsClass = (*env)->FindClass(env, CLASS_SSL3_KEY_MAT_PARAMS);
-
-	jclass jRsaPkcsPssParamsClass = (*env)->FindClass(env, CLASS_RSA_PKCS_PSS_PARAMS);
-	jclass jEcdh1DeriveParamsClass = (*env)->FindClass(env, CLASS_ECDH1_DERIVE_PARAMS);
-	jclass jEcdh2DeriveParamsClass = (*env)->FindClass(env, CLASS_ECDH2_DERIVE_PARAMS);
-	jclass jX942Dh1DeriveParamsClass = (*env)->FindClass(env, CLASS_X9_42_DH1_DERIVE_PARAMS);
-	jclass jX942Dh2DeriveParamsClass = (*env)->FindClass(env, CLASS_X9_42_DH2_DERIVE_PARAMS);
-	jclass jDesCbcEncryptDataParamsClass = (*env)->FindClass(env, CLASS_DES_CBC_ENCRYPT_DATA_PARAMS);
-	jclass jAesCbcEncryptDataParamsClass = (*env)->FindClass(env, CLASS_AES_CBC_ENCRYPT_DATA_PARAMS);
-	jclass jGcmParamsClass = (*env)->FindClass(env, CLASS_GCM_PARAMS);
-	jclass jCcmParamsClass = (*env)->FindClass(env, CLASS_CCM_PARAMS);
+	jclass jByteArrayClass = jniCache.byteArray.clazz;
+	jclass jLongClass = jniCache.longObject.clazz;
+	jclass jVersionClass = jniCache.version.clazz;
+	jclass jRsaPkcsOaepParamsClass = jniCache.rsaPkcsOaepParams.clazz;
+	jclass jKeaDeriveParamsClass = jniCache.keaDeriveParams.clazz;
+  jclass jRc2CbcParamsClass = jniCache.rc2CbcParams.clazz;
+	jclass jRc2MacGeneralParamsClass = jniCache.rc2MacGeneralParams.clazz;
+	jclass jRc5ParamsClass = jniCache.rc5Params.clazz;
+  jclass jRc5CbcParamsClass = jniCache.rc5CbcParams.clazz;
+	jclass jRc5MacGeneralParamsClass = jniCache.rc5MacGeneralParams.clazz;
+	jclass jSkipjackPrivateWrapParamsClass = jniCache.skipjackPrivateWrapParams.clazz;
+	jclass jSkipjackRelayxParamsClass = jniCache.skipjackRelayxParams.clazz;
+	jclass jPbeParamsClass = jniCache.pbeParams.clazz;
+	jclass jPkcs5Pbkd2ParamsClass = jniCache.pkcs5Pbkd2Params.clazz;
+	jclass jKeyWrapSetOaepParamsClass = jniCache.keyWrapSetOaepParams.clazz;
+  jclass jKeyDerivationStringDataClass = jniCache.keyDerivationStringData.clazz;
+	jclass jSsl3MasterKeyDeriveParamsClass = jniCache.ssl3MasterKeyDeriveParams.clazz;
+	jclass jSsl3KeyMatParamsClass = jniCache.ssl3KeyMatParams.clazz;
+
+	jclass jRsaPkcsPssParamsClass = jniCache.rsaPkcsPssParams.clazz;
+	jclass jEcdh1DeriveParamsClass = jniCache.ecdh1DeriveParams.clazz;
+	jclass jEcdh2DeriveParamsClass = jniCache.ecdh2DeriveParams.clazz;
+	jclass jX942Dh1DeriveParamsClass = jniCache.x942Dh1DeriveParams.clazz;
+	jclass jX942Dh2DeriveParamsClass = jniCache.x942Dh2DeriveParams.clazz;
+	jclass jDesCbcEncryptDataParamsClass = jniCache.desCbcEncryptDataParams.clazz;
+	jclass jAesCbcEncryptDataParamsClass = jniCache.aesCbcEncryptDataParams.clazz;
+	jclass jGcmParamsClass = jniCache.gcmParams.clazz;
+	jclass jCcmParamsClass = jniCache.ccmParams.clazz;
 
   /* first check the most common cases */
 	if (jParam == NULL_PTR) {
 		*ckpParamPtr = NULL_PTR;
 		*ckpLength = 0;
   } else if ((*env)->IsInstanceOf(env, jParam, jByteArrayClass)) {
-    jByteArrayToCKByteArray(env, jParam, (CK_BYTE_PTR *)ckpParamPtr, ckpLength);
+    jByteArrayToScratchCKByteArray(env, jParam, (CK_BYTE_PTR *)ckpParamPtr, ckpLength);
   } else if ((*env)->IsInstanceOf(env, jParam, jLongClass)) {
 		*ckpParamPtr = jLongObjectToCKULongPtr(env, jParam);
 		*ckpLength = sizeof(CK_ULONG);
@@ -1844,7 +1878,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_RSA_PKCS_OAEP_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_RSA_PKCS_OAEP_PARAMS_PTR) malloc(sizeof(CK_RSA_PKCS_OAEP_PARAMS));
+		ckpParam = (CK_RSA_PKCS_OAEP_PARAMS_PTR) scratchAlloc(sizeof(CK_RSA_PKCS_OAEP_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1861,7 +1895,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_KEA_DERIVE_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_KEA_DERIVE_PARAMS_PTR) malloc(sizeof(CK_KEA_DERIVE_PARAMS));
+		ckpParam = (CK_KEA_DERIVE_PARAMS_PTR) scratchAlloc(sizeof(CK_KEA_DERIVE_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1878,7 +1912,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_RC2_CBC_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_RC2_CBC_PARAMS_PTR) malloc(sizeof(CK_RC2_CBC_PARAMS));
+		ckpParam = (CK_RC2_CBC_PARAMS_PTR) scratchAlloc(sizeof(CK_RC2_CBC_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1895,7 +1929,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_RC2_MAC_GENERAL_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_RC2_MAC_GENERAL_PARAMS_PTR) malloc(sizeof(CK_RC2_MAC_GENERAL_PARAMS));
+		ckpParam = (CK_RC2_MAC_GENERAL_PARAMS_PTR) scratchAlloc(sizeof(CK_RC2_MAC_GENERAL_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1912,7 +1946,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_RC5_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_RC5_PARAMS_PTR) malloc(sizeof(CK_RC5_PARAMS));
+		ckpParam = (CK_RC5_PARAMS_PTR) scratchAlloc(sizeof(CK_RC5_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1929,7 +1963,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_RC5_CBC_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_RC5_CBC_PARAMS_PTR) malloc(sizeof(CK_RC5_CBC_PARAMS));
+		ckpParam = (CK_RC5_CBC_PARAMS_PTR) scratchAlloc(sizeof(CK_RC5_CBC_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1946,7 +1980,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_RC5_MAC_GENERAL_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_RC5_MAC_GENERAL_PARAMS_PTR) malloc(sizeof(CK_RC5_MAC_GENERAL_PARAMS));
+		ckpParam = (CK_RC5_MAC_GENERAL_PARAMS_PTR) scratchAlloc(sizeof(CK_RC5_MAC_GENERAL_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1964,7 +1998,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_SKIPJACK_PRIVATE_WRAP_PTR ckpParam;
 
-		ckpParam = (CK_SKIPJACK_PRIVATE_WRAP_PTR) malloc(sizeof(CK_SKIPJACK_PRIVATE_WRAP_PARAMS));
+		ckpParam = (CK_SKIPJACK_PRIVATE_WRAP_PTR) scratchAlloc(sizeof(CK_SKIPJACK_PRIVATE_WRAP_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1981,7 +2015,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_SKIPJACK_RELAYX_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_SKIPJACK_RELAYX_PARAMS_PTR) malloc(sizeof(CK_SKIPJACK_RELAYX_PARAMS));
+		ckpParam = (CK_SKIPJACK_RELAYX_PARAMS_PTR) scratchAlloc(sizeof(CK_SKIPJACK_RELAYX_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -1998,7 +2032,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_PBE_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_PBE_PARAMS_PTR) malloc(sizeof(CK_PBE_PARAMS));
+		ckpParam = (CK_PBE_PARAMS_PTR) scratchAlloc(sizeof(CK_PBE_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2015,7 +2049,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_PKCS5_PBKD2_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_PKCS5_PBKD2_PARAMS_PTR) malloc(sizeof(CK_PKCS5_PBKD2_PARAMS));
+		ckpParam = (CK_PKCS5_PBKD2_PARAMS_PTR) scratchAlloc(sizeof(CK_PKCS5_PBKD2_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2032,7 +2066,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_KEY_DERIVATION_STRING_DATA_PTR ckpParam;
 
-		ckpParam = (CK_KEY_DERIVATION_STRING_DATA_PTR) malloc(sizeof(CK_KEY_DERIVATION_STRING_DATA));
+		ckpParam = (CK_KEY_DERIVATION_STRING_DATA_PTR) scratchAlloc(sizeof(CK_KEY_DERIVATION_STRING_DATA));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2049,7 +2083,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_KEY_WRAP_SET_OAEP_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_KEY_WRAP_SET_OAEP_PARAMS_PTR) malloc(sizeof(CK_KEY_WRAP_SET_OAEP_PARAMS));
+		ckpParam = (CK_KEY_WRAP_SET_OAEP_PARAMS_PTR) scratchAlloc(sizeof(CK_KEY_WRAP_SET_OAEP_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2066,7 +2100,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_SSL3_MASTER_KEY_DERIVE_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_SSL3_MASTER_KEY_DERIVE_PARAMS_PTR) malloc(sizeof(CK_SSL3_MASTER_KEY_DERIVE_PARAMS));
+		ckpParam = (CK_SSL3_MASTER_KEY_DERIVE_PARAMS_PTR) scratchAlloc(sizeof(CK_SSL3_MASTER_KEY_DERIVE_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2083,7 +2117,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_SSL3_KEY_MAT_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_SSL3_KEY_MAT_PARAMS_PTR) malloc(sizeof(CK_SSL3_KEY_MAT_PARAMS));
+		ckpParam = (CK_SSL3_KEY_MAT_PARAMS_PTR) scratchAlloc(sizeof(CK_SSL3_KEY_MAT_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2100,7 +2134,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_RSA_PKCS_PSS_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_RSA_PKCS_PSS_PARAMS_PTR) malloc(sizeof(CK_RSA_PKCS_PSS_PARAMS));
+		ckpParam = (CK_RSA_PKCS_PSS_PARAMS_PTR) scratchAlloc(sizeof(CK_RSA_PKCS_PSS_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2117,7 +2151,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_ECDH1_DERIVE_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_ECDH1_DERIVE_PARAMS_PTR) malloc(sizeof(CK_ECDH1_DERIVE_PARAMS));
+		ckpParam = (CK_ECDH1_DERIVE_PARAMS_PTR) scratchAlloc(sizeof(CK_ECDH1_DERIVE_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2134,7 +2168,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_ECDH2_DERIVE_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_ECDH2_DERIVE_PARAMS_PTR) malloc(sizeof(CK_ECDH2_DERIVE_PARAMS));
+		ckpParam = (CK_ECDH2_DERIVE_PARAMS_PTR) scratchAlloc(sizeof(CK_ECDH2_DERIVE_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2151,7 +2185,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_X9_42_DH1_DERIVE_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_X9_42_DH1_DERIVE_PARAMS_PTR) malloc(sizeof(CK_X9_42_DH1_DERIVE_PARAMS));
+		ckpParam = (CK_X9_42_DH1_DERIVE_PARAMS_PTR) scratchAlloc(sizeof(CK_X9_42_DH1_DERIVE_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2168,7 +2202,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_X9_42_DH2_DERIVE_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_X9_42_DH2_DERIVE_PARAMS_PTR) malloc(sizeof(CK_X9_42_DH2_DERIVE_PARAMS));
+		ckpParam = (CK_X9_42_DH2_DERIVE_PARAMS_PTR) scratchAlloc(sizeof(CK_X9_42_DH2_DERIVE_PARAMS));
     if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2185,7 +2219,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_DES_CBC_ENCRYPT_DATA_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_DES_CBC_ENCRYPT_DATA_PARAMS_PTR) malloc(sizeof(CK_DES_CBC_ENCRYPT_DATA_PARAMS));
+		ckpParam = (CK_DES_CBC_ENCRYPT_DATA_PARAMS_PTR) scratchAlloc(sizeof(CK_DES_CBC_ENCRYPT_DATA_PARAMS));
 		if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2202,7 +2236,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
 
 		CK_AES_CBC_ENCRYPT_DATA_PARAMS_PTR ckpParam;
 
-		ckpParam = (CK_AES_CBC_ENCRYPT_DATA_PARAMS_PTR) malloc(sizeof(CK_AES_CBC_ENCRYPT_DATA_PARAMS));
+		ckpParam = (CK_AES_CBC_ENCRYPT_DATA_PARAMS_PTR) scratchAlloc(sizeof(CK_AES_CBC_ENCRYPT_DATA_PARAMS));
 		if (ckpParam == NULL_PTR) { *ckpParamPtr = NULL_PTR; throwOutOfMemoryError(env); return; }
 
 		/* convert jParameter to CKParameter */
@@ -2217,7 +2251,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
         * CK_GCM_ENCRYPT_DATA_PARAMS
         */
         CK_GCM_PARAMS_PTR ckpParam;
-        ckpParam = (CK_GCM_PARAMS_PTR) malloc(sizeof(CK_GCM_PARAMS));
+        ckpParam = (CK_GCM_PARAMS_PTR) scratchAlloc(sizeof(CK_GCM_PARAMS));
         if (ckpParam == NULL_PTR) {
             *ckpParamPtr = NULL_PTR;
             throwOutOfMemoryError(env);
@@ -2237,7 +2271,7 @@ void jMechanismParameterToCKMechanismParameter(JNIEnv *env, jobject jParam, CK_V
     	*/
 
         CK_CCM_PARAMS_PTR ckpParam;
-        ckpParam = (CK_CCM_PARAMS_PTR) malloc(sizeof(CK_CCM_PARAMS));
+        ckpParam = (CK_CCM_PARAMS_PTR) scratchAlloc(sizeof(CK_CCM_PARAMS));
         if (ckpParam == NULL_PTR) {
             *ckpParamPtr = NULL_PTR;
             throwOutOfMemoryError(env);
@@ -56,7 +56,6 @@
  */
 CK_DES_CBC_ENCRYPT_DATA_PARAMS jDesCbcEncryptDataParamToCKDesCbcEncryptData(JNIEnv * env, jobject jParam)
 {
-    jclass jDesCbcEncryptDataParamsClass = (*env)->FindClass(env, CLASS_DES_CBC_ENCRYPT_DATA_PARAMS);
     CK_DES_CBC_ENCRYPT_DATA_PARAMS ckParam;
     jfieldID fieldID;
     jobject jObject;
@@ -64,16 +63,14 @@ CK_DES_CBC_ENCRYPT_DATA_PARAMS jDesCbcEncryptDataParamToCKDesCbcEncryptData(JNIE
     CK_ULONG ivLength;
 
     /* get iv */
-    fieldID = (*env)->GetFieldID(env, jDesCbcEncryptDataParamsClass, "iv", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.desCbcEncryptDataParams.iv;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpByte, &ivLength);
     memcpy(ckParam.iv, ckpByte, ivLength);
     free(ckpByte);
 
     /* get pData and length */
-    fieldID = (*env)->GetFieldID(env, jDesCbcEncryptDataParamsClass, "pData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.desCbcEncryptDataParams.pData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpByte, &(ckParam.length));
     ckParam.pData = (CK_VOID_PTR) ckpByte;
@@ -90,7 +87,6 @@ CK_DES_CBC_ENCRYPT_DATA_PARAMS jDesCbcEncryptDataParamToCKDesCbcEncryptData(JNIE
  */
 CK_AES_CBC_ENCRYPT_DATA_PARAMS jAesCbcEncryptDataParamToCKAesCbcEncryptData(JNIEnv * env, jobject jParam)
 {
-    jclass jAesCbcEncryptDataParamsClass = (*env)->FindClass(env, CLASS_AES_CBC_ENCRYPT_DATA_PARAMS);
     CK_AES_CBC_ENCRYPT_DATA_PARAMS ckParam;
     jfieldID fieldID;
     jobject jObject;
@@ -98,16 +94,14 @@ CK_AES_CBC_ENCRYPT_DATA_PARAMS jAesCbcEncryptDataParamToCKAesCbcEncryptData(JNIE
     CK_ULONG ivLength;
 
     /* get iv */
-    fieldID = (*env)->GetFieldID(env, jAesCbcEncryptDataParamsClass, "iv", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.aesCbcEncryptDataParams.iv;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpByte, &ivLength);
     memcpy(ckParam.iv, ckpByte, ivLength);
     free(ckpByte);
 
     /* get pData and length */
-    fieldID = (*env)->GetFieldID(env, jAesCbcEncryptDataParamsClass, "pData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.aesCbcEncryptDataParams.pData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpByte, &(ckParam.length));
     ckParam.pData = (CK_VOID_PTR) ckpByte;
@@ -124,7 +118,6 @@ CK_AES_CBC_ENCRYPT_DATA_PARAMS jAesCbcEncryptDataParamToCKAesCbcEncryptData(JNIE
  */
 CK_GCM_PARAMS jGcmParamToCKGcmData(JNIEnv * env, jobject jParam)
 {
-    jclass jGcmParamsClass = (*env)->FindClass(env, CLASS_GCM_PARAMS);
     CK_GCM_PARAMS ckParam;
     jfieldID fieldID;
     jobject jObject;
@@ -134,8 +127,7 @@ CK_GCM_PARAMS jGcmParamToCKGcmData(JNIEnv * env, jobject jParam)
     CK_ULONG ivLength;
     CK_ULONG aadLength;
 
-    fieldID = (*env)->GetFieldID(env, jGcmParamsClass, "pIv", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.gcmParams.pIv;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpiv, &ivLength);
     ckParam.pIv = (CK_BYTE_PTR) ckpiv;
@@ -143,16 +135,14 @@ CK_GCM_PARAMS jGcmParamToCKGcmData(JNIEnv * env, jobject jParam)
     ckParam.ulIvBits = ivLength * 8;
 
     /* get aad */
-    fieldID = (*env)->GetFieldID(env, jGcmParamsClass, "pAAD", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.gcmParams.pAAD;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpaad, &aadLength);
     ckParam.pAAD = ckpaad;
     ckParam.ulAADLen = aadLength;
 
     /* get ulTagBits */
-    fieldID = (*env)->GetFieldID(env, jGcmParamsClass, "ulTagBits", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.gcmParams.ulTagBits;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulTagBits = jLongToCKULong(jLong);
 
@@ -168,7 +158,6 @@ CK_GCM_PARAMS jGcmParamToCKGcmData(JNIEnv * env, jobject jParam)
  */
 CK_CCM_PARAMS jCcmParamToCKCcmData(JNIEnv * env, jobject jParam)
 {
-    jclass jCcmParamsClass = (*env)->FindClass(env, CLASS_CCM_PARAMS);
     CK_CCM_PARAMS ckParam;
     jfieldID fieldID;
     jobject jObject;
@@ -179,30 +168,26 @@ CK_CCM_PARAMS jCcmParamToCKCcmData(JNIEnv * env, jobject jParam)
     CK_ULONG aadLength;
 
     /* get nonce */
-    fieldID = (*env)->GetFieldID(env, jCcmParamsClass, "pNonce", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ccmParams.pNonce;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpnonce, &nonceLength);
     ckParam.pNonce = (CK_BYTE_PTR) ckpnonce;
     ckParam.ulNonceLen = nonceLength;
 
     /* get aad */
-    fieldID = (*env)->GetFieldID(env, jCcmParamsClass, "pAAD", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ccmParams.pAAD;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpaad, &aadLength);
     ckParam.pAAD = ckpaad;
     ckParam.ulAADLen = aadLength;
 
     /* get DataLen */
-    fieldID = (*env)->GetFieldID(env, jCcmParamsClass, "ulDataLen", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ccmParams.ulDataLen;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulDataLen = jLongToCKULong(jLong);
 
     /* get MacLen */
-    fieldID = (*env)->GetFieldID(env, jCcmParamsClass, "ulMacLen", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ccmParams.ulMacLen;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulMACLen = jLongToCKULong(jLong);
 
@@ -218,7 +203,6 @@ CK_CCM_PARAMS jCcmParamToCKCcmData(JNIEnv * env, jobject jParam)
  */
 CK_RSA_PKCS_OAEP_PARAMS jRsaPkcsOaepParamToCKRsaPkcsOaepParam(JNIEnv * env, jobject jParam)
 {
-    jclass jRsaPkcsOaepParamsClass = (*env)->FindClass(env, CLASS_RSA_PKCS_OAEP_PARAMS);
     CK_RSA_PKCS_OAEP_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
@@ -226,26 +210,22 @@ CK_RSA_PKCS_OAEP_PARAMS jRsaPkcsOaepParamToCKRsaPkcsOaepParam(JNIEnv * env, jobj
     CK_BYTE_PTR ckpByte;
 
     /* get hashAlg */
-    fieldID = (*env)->GetFieldID(env, jRsaPkcsOaepParamsClass, "hashAlg", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rsaPkcsOaepParams.hashAlg;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.hashAlg = jLongToCKULong(jLong);
 
     /* get mgf */
-    fieldID = (*env)->GetFieldID(env, jRsaPkcsOaepParamsClass, "mgf", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rsaPkcsOaepParams.mgf;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.mgf = jLongToCKULong(jLong);
 
     /* get source */
-    fieldID = (*env)->GetFieldID(env, jRsaPkcsOaepParamsClass, "source", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rsaPkcsOaepParams.source;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.source = jLongToCKULong(jLong);
 
     /* get sourceData and sourceDataLength */
-    fieldID = (*env)->GetFieldID(env, jRsaPkcsOaepParamsClass, "pSourceData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.rsaPkcsOaepParams.pSourceData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &ckpByte, &(ckParam.ulSourceDataLen));
     ckParam.pSourceData = (CK_VOID_PTR) ckpByte;
@@ -262,7 +242,6 @@ CK_RSA_PKCS_OAEP_PARAMS jRsaPkcsOaepParamToCKRsaPkcsOaepParam(JNIEnv * env, jobj
  */
 CK_KEA_DERIVE_PARAMS jKeaDeriveParamToCKKeaDeriveParam(JNIEnv * env, jobject jParam)
 {
-    jclass jKeaDeriveParamsClass = (*env)->FindClass(env, CLASS_KEA_DERIVE_PARAMS);
     CK_KEA_DERIVE_PARAMS ckParam;
     jfieldID fieldID;
     jboolean jBoolean;
@@ -270,28 +249,24 @@ CK_KEA_DERIVE_PARAMS jKeaDeriveParamToCKKeaDeriveParam(JNIEnv * env, jobject jPa
     CK_ULONG ckTemp;
 
     /* get isSender */
-    fieldID = (*env)->GetFieldID(env, jKeaDeriveParamsClass, "isSender", "Z");
-    assert(fieldID != 0);
+    fieldID = jniCache.keaDeriveParams.isSender;
     jBoolean = (*env)->GetBooleanField(env, jParam, fieldID);
     ckParam.isSender = jBooleanToCKBBool(jBoolean);
 
     /* get pRandomA and ulRandomLength */
-    fieldID = (*env)->GetFieldID(env, jKeaDeriveParamsClass, "pRandomA", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.keaDeriveParams.pRandomA;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pRandomA), &ckTemp);
 
     /* get pRandomB and ulRandomLength */
-    fieldID = (*env)->GetFieldID(env, jKeaDeriveParamsClass, "pRandomB", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.keaDeriveParams.pRandomB;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pRandomB), &(ckParam.ulRandomLen));
     /* pRandomA and pRandomB must have the same length */
     assert(ckTemp == ckParam.ulRandomLen);	/* pRandomALength == pRandomBLength */
 
     /* get pPublicData and ulPublicDataLength */
-    fieldID = (*env)->GetFieldID(env, jKeaDeriveParamsClass, "pPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.keaDeriveParams.pPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData), &(ckParam.ulPublicDataLen));
 
@@ -307,7 +282,6 @@ CK_KEA_DERIVE_PARAMS jKeaDeriveParamToCKKeaDeriveParam(JNIEnv * env, jobject jPa
  */
 CK_RC2_CBC_PARAMS jRc2CbcParamToCKRc2CbcParam(JNIEnv * env, jobject jParam)
 {
-    jclass jRc2CbcParamsClass = (*env)->FindClass(env, CLASS_RC2_CBC_PARAMS);
     CK_RC2_CBC_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
@@ -318,14 +292,12 @@ CK_RC2_CBC_PARAMS jRc2CbcParamToCKRc2CbcParam(JNIEnv * env, jobject jParam)
     CK_ULONG ckLength;
 
     /* get ulEffectiveBits */
-    fieldID = (*env)->GetFieldID(env, jRc2CbcParamsClass, "ulEffectiveBits", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc2CbcParams.ulEffectiveBits;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulEffectiveBits = jLongToCKULong(jLong);
 
     /* get iv[8] */
-    fieldID = (*env)->GetFieldID(env, jRc2CbcParamsClass, "iv", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc2CbcParams.iv;
     jArray = (jbyteArray) (*env)->GetObjectField(env, jParam, fieldID);
     assert(jArray != NULL_PTR);
 
@@ -355,20 +327,17 @@ CK_RC2_CBC_PARAMS jRc2CbcParamToCKRc2CbcParam(JNIEnv * env, jobject jParam)
  */
 CK_RC2_MAC_GENERAL_PARAMS jRc2MacGeneralParamToCKRc2MacGeneralParam(JNIEnv * env, jobject jParam)
 {
-    jclass jRc2MacGeneralParamsClass = (*env)->FindClass(env, CLASS_RC2_MAC_GENERAL_PARAMS);
     CK_RC2_MAC_GENERAL_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
 
     /* get ulEffectiveBits */
-    fieldID = (*env)->GetFieldID(env, jRc2MacGeneralParamsClass, "ulEffectiveBits", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc2MacGeneralParams.ulEffectiveBits;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulEffectiveBits = jLongToCKULong(jLong);
 
     /* get ulMacLength */
-    fieldID = (*env)->GetFieldID(env, jRc2MacGeneralParamsClass, "ulMacLength", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc2MacGeneralParams.ulMacLength;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulMacLength = jLongToCKULong(jLong);
 
@@ -384,20 +353,17 @@ CK_RC2_MAC_GENERAL_PARAMS jRc2MacGeneralParamToCKRc2MacGeneralParam(JNIEnv * env
  */
 CK_RC5_PARAMS jRc5ParamToCKRc5Param(JNIEnv * env, jobject jParam)
 {
-    jclass jRc5ParamsClass = (*env)->FindClass(env, CLASS_RC5_PARAMS);
     CK_RC5_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
 
     /* get ulWordsize */
-    fieldID = (*env)->GetFieldID(env, jRc5ParamsClass, "ulWordsize", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5Params.ulWordsize;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulWordsize = jLongToCKULong(jLong);
 
     /* get ulRounds */
-    fieldID = (*env)->GetFieldID(env, jRc5ParamsClass, "ulRounds", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5Params.ulRounds;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulRounds = jLongToCKULong(jLong);
 
@@ -413,27 +379,23 @@ CK_RC5_PARAMS jRc5ParamToCKRc5Param(JNIEnv * env, jobject jParam)
  */
 CK_RC5_CBC_PARAMS jRc5CbcParamToCKRc5CbcParam(JNIEnv * env, jobject jParam)
 {
-    jclass jRc5CbcParamsClass = (*env)->FindClass(env, CLASS_RC5_CBC_PARAMS);
     CK_RC5_CBC_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
     jobject jObject;
 
     /* get ulWordsize */
-    fieldID = (*env)->GetFieldID(env, jRc5CbcParamsClass, "ulWordsize", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5CbcParams.ulWordsize;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulWordsize = jLongToCKULong(jLong);
 
     /* get ulRounds */
-    fieldID = (*env)->GetFieldID(env, jRc5CbcParamsClass, "ulRounds", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5CbcParams.ulRounds;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulRounds = jLongToCKULong(jLong);
 
     /* get pIv and ulIvLen */
-    fieldID = (*env)->GetFieldID(env, jRc5CbcParamsClass, "pIv", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5CbcParams.pIv;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pIv), &(ckParam.ulIvLen));
 
@@ -449,26 +411,22 @@ CK_RC5_CBC_PARAMS jRc5CbcParamToCKRc5CbcParam(JNIEnv * env, jobject jParam)
  */
 CK_RC5_MAC_GENERAL_PARAMS jRc5MacGeneralParamToCKRc5MacGeneralParam(JNIEnv * env, jobject jParam)
 {
-    jclass jRc5MacGeneralParamsClass = (*env)->FindClass(env, CLASS_RC5_MAC_GENERAL_PARAMS);
     CK_RC5_MAC_GENERAL_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
 
     /* get ulWordsize */
-    fieldID = (*env)->GetFieldID(env, jRc5MacGeneralParamsClass, "ulWordsize", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5MacGeneralParams.ulWordsize;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulWordsize = jLongToCKULong(jLong);
 
     /* get ulRounds */
-    fieldID = (*env)->GetFieldID(env, jRc5MacGeneralParamsClass, "ulRounds", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5MacGeneralParams.ulRounds;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulRounds = jLongToCKULong(jLong);
 
     /* get ulMacLength */
-    fieldID = (*env)->GetFieldID(env, jRc5MacGeneralParamsClass, "ulMacLength", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rc5MacGeneralParams.ulMacLength;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulMacLength = jLongToCKULong(jLong);
 
@@ -484,47 +442,40 @@ CK_RC5_MAC_GENERAL_PARAMS jRc5MacGeneralParamToCKRc5MacGeneralParam(JNIEnv * env
  */
 CK_SKIPJACK_PRIVATE_WRAP_PARAMS jSkipjackPrivateWrapParamToCKSkipjackPrivateWrapParam(JNIEnv * env, jobject jParam)
 {
-    jclass jSkipjackPrivateWrapParamsClass = (*env)->FindClass(env, CLASS_SKIPJACK_PRIVATE_WRAP_PARAMS);
     CK_SKIPJACK_PRIVATE_WRAP_PARAMS ckParam;
     jfieldID fieldID;
     jobject jObject;
     CK_ULONG ckTemp;
 
     /* get pPassword and ulPasswordLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackPrivateWrapParamsClass, "pPassword", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackPrivateWrapParams.pPassword;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPassword), &(ckParam.ulPasswordLen));
 
     /* get pPublicData and ulPublicDataLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackPrivateWrapParamsClass, "pPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackPrivateWrapParams.pPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData), &(ckParam.ulPublicDataLen));
 
     /* get pRandomA and ulRandomLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackPrivateWrapParamsClass, "pRandomA", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackPrivateWrapParams.pRandomA;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pRandomA), &(ckParam.ulRandomLen));
 
     /* get pPrimeP and ulPandGLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackPrivateWrapParamsClass, "pPrimeP", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackPrivateWrapParams.pPrimeP;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPrimeP), &ckTemp);
 
     /* get pBaseG and ulPAndGLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackPrivateWrapParamsClass, "pBaseG", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackPrivateWrapParams.pBaseG;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pBaseG), &(ckParam.ulPAndGLen));
     /* pPrimeP and pBaseG must have the same length */
     assert(ckTemp == ckParam.ulPAndGLen);
 
     /* get pSubprimeQ and ulQLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackPrivateWrapParamsClass, "pSubprimeQ", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackPrivateWrapParams.pSubprimeQ;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pSubprimeQ), &(ckParam.ulQLen));
 
@@ -540,50 +491,42 @@ CK_SKIPJACK_PRIVATE_WRAP_PARAMS jSkipjackPrivateWrapParamToCKSkipjackPrivateWrap
  */
 CK_SKIPJACK_RELAYX_PARAMS jSkipjackRelayxParamToCKSkipjackRelayxParam(JNIEnv * env, jobject jParam)
 {
-    jclass jSkipjackRelayxParamsClass = (*env)->FindClass(env, CLASS_SKIPJACK_RELAYX_PARAMS);
     CK_SKIPJACK_RELAYX_PARAMS ckParam;
     jfieldID fieldID;
     jobject jObject;
 
     /* get pOldWrappedX and ulOldWrappedXLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackRelayxParamsClass, "pOldWrappedX", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackRelayxParams.pOldWrappedX;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pOldWrappedX), &(ckParam.ulOldWrappedXLen));
 
     /* get pOldPassword and ulOldPasswordLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackRelayxParamsClass, "pOldPassword", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackRelayxParams.pOldPassword;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pOldPassword), &(ckParam.ulOldPasswordLen));
 
     /* get pOldPublicData and ulOldPublicDataLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackRelayxParamsClass, "pOldPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackRelayxParams.pOldPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pOldPublicData), &(ckParam.ulOldPublicDataLen));
 
     /* get pOldRandomA and ulOldRandomLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackRelayxParamsClass, "pOldRandomA", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackRelayxParams.pOldRandomA;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pOldRandomA), &(ckParam.ulOldRandomLen));
 
     /* get pNewPassword and ulNewPasswordLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackRelayxParamsClass, "pNewPassword", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackRelayxParams.pNewPassword;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pNewPassword), &(ckParam.ulNewPasswordLen));
 
     /* get pNewPublicData and ulNewPublicDataLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackRelayxParamsClass, "pNewPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackRelayxParams.pNewPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pNewPublicData), &(ckParam.ulNewPublicDataLen));
 
     /* get pNewRandomA and ulNewRandomLength */
-    fieldID = (*env)->GetFieldID(env, jSkipjackRelayxParamsClass, "pNewRandomA", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.skipjackRelayxParams.pNewRandomA;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pNewRandomA), &(ckParam.ulNewRandomLen));
 
@@ -599,7 +542,6 @@ CK_SKIPJACK_RELAYX_PARAMS jSkipjackRelayxParamToCKSkipjackRelayxParam(JNIEnv * e
  */
 CK_PBE_PARAMS jPbeParamToCKPbeParam(JNIEnv * env, jobject jParam)
 {
-    jclass jPbeParamsClass = (*env)->FindClass(env, CLASS_PBE_PARAMS);
     CK_PBE_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
@@ -607,26 +549,22 @@ CK_PBE_PARAMS jPbeParamToCKPbeParam(JNIEnv * env, jobject jParam)
     CK_ULONG ckTemp;
 
     /* get pInitVector */
-    fieldID = (*env)->GetFieldID(env, jPbeParamsClass, "pInitVector", "[C");
-    assert(fieldID != 0);
+    fieldID = jniCache.pbeParams.pInitVector;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jCharArrayToCKCharArray(env, jObject, &(ckParam.pInitVector), &ckTemp);
 
     /* get pPassword and ulPasswordLength */
-    fieldID = (*env)->GetFieldID(env, jPbeParamsClass, "pPassword", "[C");
-    assert(fieldID != 0);
+    fieldID = jniCache.pbeParams.pPassword;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jCharArrayToCKCharArray(env, jObject, &(ckParam.pPassword), &(ckParam.ulPasswordLen));
 
     /* get pSalt and ulSaltLength */
-    fieldID = (*env)->GetFieldID(env, jPbeParamsClass, "pSalt", "[C");
-    assert(fieldID != 0);
+    fieldID = jniCache.pbeParams.pSalt;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jCharArrayToCKCharArray(env, jObject, &(ckParam.pSalt), &(ckParam.ulSaltLen));
 
     /* get ulIteration */
-    fieldID = (*env)->GetFieldID(env, jPbeParamsClass, "ulIteration", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.pbeParams.ulIteration;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulIteration = jLongToCKULong(jLong);
 
@@ -641,8 +579,6 @@ CK_PBE_PARAMS jPbeParamToCKPbeParam(JNIEnv * env, jobject jParam)
  */
 void copyBackPBEInitializationVector(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject jMechanism)
 {
-    jclass jMechanismClass = (*env)->FindClass(env, CLASS_MECHANISM);
-    jclass jPbeParamsClass = (*env)->FindClass(env, CLASS_PBE_PARAMS);
     CK_PBE_PARAMS *ckParam;
     jfieldID fieldID;
     CK_MECHANISM_TYPE ckMechanismType;
@@ -655,8 +591,7 @@ void copyBackPBEInitializationVector(JNIEnv * env, CK_MECHANISM * ckMechanism, j
     jchar *jInitVectorChars;
 
     /* get mechanism */
-    fieldID = (*env)->GetFieldID(env, jMechanismClass, "mechanism", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.mechanism.mechanism;
     jMechanismType = (*env)->GetLongField(env, jMechanism, fieldID);
     ckMechanismType = jLongToCKULong(jMechanismType);
     if (ckMechanismType != ckMechanism->mechanism) {
@@ -669,11 +604,9 @@ void copyBackPBEInitializationVector(JNIEnv * env, CK_MECHANISM * ckMechanism, j
 	initVector = ckParam->pInitVector;
 	if (initVector != NULL_PTR) {
 	    /* get pParameter */
-	    fieldID = (*env)->GetFieldID(env, jMechanismClass, "pParameter", "Ljava/lang/Object;");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.mechanism.pParameter;
 	    jParameter = (*env)->GetObjectField(env, jMechanism, fieldID);
-	    fieldID = (*env)->GetFieldID(env, jPbeParamsClass, "pInitVektor", "[C");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.pbeParams.pInitVector;
 	    jInitVector = (*env)->GetObjectField(env, jParameter, fieldID);
 
 	    if (jInitVector != NULL_PTR) {
@@ -699,39 +632,33 @@ void copyBackPBEInitializationVector(JNIEnv * env, CK_MECHANISM * ckMechanism, j
  */
 CK_PKCS5_PBKD2_PARAMS jPkcs5Pbkd2ParamToCKPkcs5Pbkd2Param(JNIEnv * env, jobject jParam)
 {
-    jclass jPkcs5Pbkd2ParamsClass = (*env)->FindClass(env, CLASS_PKCS5_PBKD2_PARAMS);
     CK_PKCS5_PBKD2_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
     jobject jObject;
 
     /* get saltSource */
-    fieldID = (*env)->GetFieldID(env, jPkcs5Pbkd2ParamsClass, "saltSource", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.pkcs5Pbkd2Params.saltSource;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.saltSource = jLongToCKULong(jLong);
 
     /* get pSaltSourceData */
-    fieldID = (*env)->GetFieldID(env, jPkcs5Pbkd2ParamsClass, "pSaltSourceData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.pkcs5Pbkd2Params.pSaltSourceData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, (CK_BYTE_PTR *) & (ckParam.pSaltSourceData), &(ckParam.ulSaltSourceDataLen));
 
     /* get iterations */
-    fieldID = (*env)->GetFieldID(env, jPkcs5Pbkd2ParamsClass, "iterations", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.pkcs5Pbkd2Params.iterations;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.iterations = jLongToCKULong(jLong);
 
     /* get prf */
-    fieldID = (*env)->GetFieldID(env, jPkcs5Pbkd2ParamsClass, "prf", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.pkcs5Pbkd2Params.prf;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.prf = jLongToCKULong(jLong);
 
     /* get pPrfData and ulPrfDataLength in byte */
-    fieldID = (*env)->GetFieldID(env, jPkcs5Pbkd2ParamsClass, "pPrfData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.pkcs5Pbkd2Params.pPrfData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, (CK_BYTE_PTR *) & (ckParam.pPrfData), &(ckParam.ulPrfDataLen));
 
@@ -747,21 +674,18 @@ CK_PKCS5_PBKD2_PARAMS jPkcs5Pbkd2ParamToCKPkcs5Pbkd2Param(JNIEnv * env, jobject
  */
 CK_KEY_WRAP_SET_OAEP_PARAMS jKeyWrapSetOaepParamToCKKeyWrapSetOaepParam(JNIEnv * env, jobject jParam)
 {
-    jclass jKeyWrapSetOaepParamsClass = (*env)->FindClass(env, CLASS_KEY_WRAP_SET_OAEP_PARAMS);
     CK_KEY_WRAP_SET_OAEP_PARAMS ckParam;
     jfieldID fieldID;
     jbyte jByte;
     jobject jObject;
 
     /* get bBC */
-    fieldID = (*env)->GetFieldID(env, jKeyWrapSetOaepParamsClass, "bBC", "B");
-    assert(fieldID != 0);
+    fieldID = jniCache.keyWrapSetOaepParams.bBC;
     jByte = (*env)->GetByteField(env, jParam, fieldID);
     ckParam.bBC = jByteToCKByte(jByte);
 
     /* get pX and ulXLength */
-    fieldID = (*env)->GetFieldID(env, jKeyWrapSetOaepParamsClass, "pX", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.keyWrapSetOaepParams.pX;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pX), &(ckParam.ulXLen));
 
@@ -776,8 +700,6 @@ CK_KEY_WRAP_SET_OAEP_PARAMS jKeyWrapSetOaepParamToCKKeyWrapSetOaepParam(JNIEnv *
  */
 void copyBackSetUnwrappedKey(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject jMechanism)
 {
-    jclass jMechanismClass = (*env)->FindClass(env, CLASS_MECHANISM);
-    jclass jSetParamsClass = (*env)->FindClass(env, CLASS_KEY_WRAP_SET_OAEP_PARAMS);
     CK_KEY_WRAP_SET_OAEP_PARAMS *ckKeyWrapSetOaepParams;
     jfieldID fieldID;
     CK_MECHANISM_TYPE ckMechanismType;
@@ -790,8 +712,7 @@ void copyBackSetUnwrappedKey(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject j
     int i;
 
     /* get mechanism */
-    fieldID = (*env)->GetFieldID(env, jMechanismClass, "mechanism", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.mechanism.mechanism;
     jMechanismType = (*env)->GetLongField(env, jMechanism, fieldID);
     ckMechanismType = jLongToCKULong(jMechanismType);
     if (ckMechanismType != ckMechanism->mechanism) {
@@ -804,18 +725,15 @@ void copyBackSetUnwrappedKey(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject j
 	x = ckKeyWrapSetOaepParams->pX;
 	if (x != NULL_PTR) {
 	    /* get pParameter */
-	    fieldID = (*env)->GetFieldID(env, jMechanismClass, "pParameter", "Ljava/lang/Object;");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.mechanism.pParameter;
 	    jParameter = (*env)->GetObjectField(env, jMechanism, fieldID);
 
 	    /* copy back the bBC */
-	    fieldID = (*env)->GetFieldID(env, jSetParamsClass, "bBC", "B");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.keyWrapSetOaepParams.bBC;
 	    (*env)->SetByteField(env, jParameter, fieldID, ckKeyWrapSetOaepParams->bBC);
 
 	    /* copy back the pX */
-	    fieldID = (*env)->GetFieldID(env, jSetParamsClass, "pX", "[B");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.keyWrapSetOaepParams.pX;
 	    jx = (*env)->GetObjectField(env, jParameter, fieldID);
 
 	    if (jx != NULL_PTR) {
@@ -840,9 +758,6 @@ void copyBackSetUnwrappedKey(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject j
  */
 void copyBackClientVersion(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject jMechanism)
 {
-    jclass jMechanismClass = (*env)->FindClass(env, CLASS_MECHANISM);
-    jclass jSSL3MasterKeyDeriveParamsClass = (*env)->FindClass(env, CLASS_SSL3_MASTER_KEY_DERIVE_PARAMS);
-    jclass jVersionClass = (*env)->FindClass(env, CLASS_VERSION);
     CK_SSL3_MASTER_KEY_DERIVE_PARAMS *ckSSL3MasterKeyDeriveParams;
     CK_VERSION *ckVersion;
     jfieldID fieldID;
@@ -852,8 +767,7 @@ void copyBackClientVersion(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject jMe
     jobject jVersion;
 
     /* get mechanism */
-    fieldID = (*env)->GetFieldID(env, jMechanismClass, "mechanism", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.mechanism.mechanism;
     jMechanismType = (*env)->GetLongField(env, jMechanism, fieldID);
     ckMechanismType = jLongToCKULong(jMechanismType);
     if (ckMechanismType != ckMechanism->mechanism) {
@@ -868,25 +782,21 @@ void copyBackClientVersion(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject jMe
 	ckVersion = ckSSL3MasterKeyDeriveParams->pVersion;
 	if (ckVersion != NULL_PTR) {
 	    /* get the Java CK_SSL3_MASTER_KEY_DERIVE_PARAMS (pParameter) */
-	    fieldID = (*env)->GetFieldID(env, jMechanismClass, "pParameter", "Ljava/lang/Object;");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.mechanism.pParameter;
 	    jSSL3MasterKeyDeriveParams = (*env)->GetObjectField(env, jMechanism, fieldID);
 
 	    /* get the Java CK_VERSION */
-	    fieldID = (*env)->GetFieldID(env, jSSL3MasterKeyDeriveParamsClass, "pVersion", "L" CLASS_VERSION ";");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3MasterKeyDeriveParams.pVersion;
 	    jVersion = (*env)->GetObjectField(env, jSSL3MasterKeyDeriveParams, fieldID);
 
 	    /* now copy back the version from the native structure to the Java structure */
 
 	    /* copy back the major version */
-	    fieldID = (*env)->GetFieldID(env, jVersionClass, "major", "B");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.version.major;
 	    (*env)->SetByteField(env, jVersion, fieldID, ckByteToJByte(ckVersion->major));
 
 	    /* copy back the minor version */
-	    fieldID = (*env)->GetFieldID(env, jVersionClass, "minor", "B");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.version.minor;
 	    (*env)->SetByteField(env, jVersion, fieldID, ckByteToJByte(ckVersion->minor));
 	}
     }
@@ -900,9 +810,6 @@ void copyBackClientVersion(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject jMe
  */
 void copyBackSSLKeyMatParams(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject jMechanism)
 {
-    jclass jMechanismClass = (*env)->FindClass(env, CLASS_MECHANISM);
-    jclass jSSL3KeyMatParamsClass = (*env)->FindClass(env, CLASS_SSL3_KEY_MAT_PARAMS);
-    jclass jSSL3KeyMatOutClass = (*env)->FindClass(env, CLASS_SSL3_KEY_MAT_OUT);
     CK_SSL3_KEY_MAT_PARAMS *ckSSL3KeyMatParam;
     CK_SSL3_KEY_MAT_OUT *ckSSL3KeyMatOut;
     jfieldID fieldID;
@@ -917,8 +824,7 @@ void copyBackSSLKeyMatParams(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject j
     int i;
 
     /* get mechanism */
-    fieldID = (*env)->GetFieldID(env, jMechanismClass, "mechanism", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.mechanism.mechanism;
     jMechanismType = (*env)->GetLongField(env, jMechanism, fieldID);
     ckMechanismType = jLongToCKULong(jMechanismType);
     if (ckMechanismType != ckMechanism->mechanism) {
@@ -933,40 +839,32 @@ void copyBackSSLKeyMatParams(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject j
 	ckSSL3KeyMatOut = ckSSL3KeyMatParam->pReturnedKeyMaterial;
 	if (ckSSL3KeyMatOut != NULL_PTR) {
 	    /* get the Java CK_SSL3_KEY_MAT_PARAMS (pParameter) */
-	    fieldID = (*env)->GetFieldID(env, jMechanismClass, "pParameter", "Ljava/lang/Object;");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.mechanism.pParameter;
 	    jSSL3KeyMatParam = (*env)->GetObjectField(env, jMechanism, fieldID);
 
 	    /* get the Java CK_SSL3_KEY_MAT_OUT */
-	    fieldID =
-		(*env)->GetFieldID(env, jSSL3KeyMatParamsClass, "pReturnedKeyMaterial", "L" CLASS_SSL3_KEY_MAT_OUT ";");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3KeyMatParams.pReturnedKeyMaterial;
 	    jSSL3KeyMatOut = (*env)->GetObjectField(env, jSSL3KeyMatParam, fieldID);
 
 	    /* now copy back all the key handles and the initialization vectors */
 	    /* copy back client MAC secret handle */
-	    fieldID = (*env)->GetFieldID(env, jSSL3KeyMatOutClass, "hClientMacSecret", "J");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3KeyMatOut.hClientMacSecret;
 	    (*env)->SetLongField(env, jSSL3KeyMatOut, fieldID, ckULongToJLong(ckSSL3KeyMatOut->hClientMacSecret));
 
 	    /* copy back server MAC secret handle */
-	    fieldID = (*env)->GetFieldID(env, jSSL3KeyMatOutClass, "hServerMacSecret", "J");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3KeyMatOut.hServerMacSecret;
 	    (*env)->SetLongField(env, jSSL3KeyMatOut, fieldID, ckULongToJLong(ckSSL3KeyMatOut->hServerMacSecret));
 
 	    /* copy back client secret key handle */
-	    fieldID = (*env)->GetFieldID(env, jSSL3KeyMatOutClass, "hClientKey", "J");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3KeyMatOut.hClientKey;
 	    (*env)->SetLongField(env, jSSL3KeyMatOut, fieldID, ckULongToJLong(ckSSL3KeyMatOut->hClientKey));
 
 	    /* copy back server secret key handle */
-	    fieldID = (*env)->GetFieldID(env, jSSL3KeyMatOutClass, "hServerKey", "J");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3KeyMatOut.hServerKey;
 	    (*env)->SetLongField(env, jSSL3KeyMatOut, fieldID, ckULongToJLong(ckSSL3KeyMatOut->hServerKey));
 
 	    /* copy back the client IV */
-	    fieldID = (*env)->GetFieldID(env, jSSL3KeyMatOutClass, "pIVClient", "[B");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3KeyMatOut.pIVClient;
 	    jIV = (*env)->GetObjectField(env, jSSL3KeyMatOut, fieldID);
 	    iv = ckSSL3KeyMatOut->pIVClient;
 
@@ -982,8 +880,7 @@ void copyBackSSLKeyMatParams(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject j
 	    }
 
 	    /* copy back the server IV */
-	    fieldID = (*env)->GetFieldID(env, jSSL3KeyMatOutClass, "pIVServer", "[B");
-	    assert(fieldID != 0);
+	    fieldID = jniCache.ssl3KeyMatOut.pIVServer;
 	    jIV = (*env)->GetObjectField(env, jSSL3KeyMatOut, fieldID);
 	    iv = ckSSL3KeyMatOut->pIVServer;
 
@@ -1011,35 +908,27 @@ void copyBackSSLKeyMatParams(JNIEnv * env, CK_MECHANISM * ckMechanism, jobject j
  */
 CK_SSL3_MASTER_KEY_DERIVE_PARAMS jSsl3MasterKeyDeriveParamToCKSsl3MasterKeyDeriveParam(JNIEnv * env, jobject jParam)
 {
-    jclass jSsl3MasterKeyDeriveParamsClass = (*env)->FindClass(env, CLASS_SSL3_MASTER_KEY_DERIVE_PARAMS);
     CK_SSL3_MASTER_KEY_DERIVE_PARAMS ckParam;
     jfieldID fieldID;
     jobject jObject;
-    jclass jSsl3RandomDataClass;
     jobject jRandomInfo;
 
     /* get RandomInfo */
-    jSsl3RandomDataClass = (*env)->FindClass(env, CLASS_SSL3_RANDOM_DATA);
-    fieldID =
-	(*env)->GetFieldID(env, jSsl3MasterKeyDeriveParamsClass, "RandomInfo", CLASS_NAME(CLASS_SSL3_RANDOM_DATA));
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3MasterKeyDeriveParams.RandomInfo;
     jRandomInfo = (*env)->GetObjectField(env, jParam, fieldID);
 
     /* get pClientRandom and ulClientRandomLength out of RandomInfo */
-    fieldID = (*env)->GetFieldID(env, jSsl3RandomDataClass, "pClientRandom", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3RandomData.pClientRandom;
     jObject = (*env)->GetObjectField(env, jRandomInfo, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.RandomInfo.pClientRandom), &(ckParam.RandomInfo.ulClientRandomLen));
 
     /* get pServerRandom and ulServerRandomLength out of RandomInfo */
-    fieldID = (*env)->GetFieldID(env, jSsl3RandomDataClass, "pServerRandom", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3RandomData.pServerRandom;
     jObject = (*env)->GetObjectField(env, jRandomInfo, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.RandomInfo.pServerRandom), &(ckParam.RandomInfo.ulServerRandomLen));
 
     /* get pVersion */
-    fieldID = (*env)->GetFieldID(env, jSsl3MasterKeyDeriveParamsClass, "pVersion", CLASS_NAME(CLASS_VERSION));
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3MasterKeyDeriveParams.pVersion;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     ckParam.pVersion = jVersionToCKVersionPtr(env, jObject);
 
@@ -1055,7 +944,6 @@ CK_SSL3_MASTER_KEY_DERIVE_PARAMS jSsl3MasterKeyDeriveParamToCKSsl3MasterKeyDeriv
  */
 CK_SSL3_KEY_MAT_PARAMS jSsl3KeyMatParamToCKSsl3KeyMatParam(JNIEnv * env, jobject jParam)
 {
-    jclass jSsl3KeyMatParamsClass = (*env)->FindClass(env, CLASS_SSL3_KEY_MAT_PARAMS);
     CK_SSL3_KEY_MAT_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
@@ -1063,57 +951,44 @@ CK_SSL3_KEY_MAT_PARAMS jSsl3KeyMatParamToCKSsl3KeyMatParam(JNIEnv * env, jobject
     jobject jObject;
     jobject jRandomInfo;
     jobject jReturnedKeyMaterial;
-    jclass jSsl3RandomDataClass;
-    jclass jSsl3KeyMatOutClass;
     CK_ULONG ckTemp;
 
     /* get ulMacSizeInBits */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatParamsClass, "ulMacSizeInBits", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatParams.ulMacSizeInBits;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulMacSizeInBits = jLongToCKULong(jLong);
 
     /* get ulKeySizeInBits */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatParamsClass, "ulKeySizeInBits", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatParams.ulKeySizeInBits;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulKeySizeInBits = jLongToCKULong(jLong);
 
     /* get ulIVSizeInBits */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatParamsClass, "ulIVSizeInBits", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatParams.ulIVSizeInBits;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulIVSizeInBits = jLongToCKULong(jLong);
 
     /* get bIsExport */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatParamsClass, "bIsExport", "Z");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatParams.bIsExport;
     jBoolean = (*env)->GetBooleanField(env, jParam, fieldID);
     ckParam.bIsExport = jBooleanToCKBBool(jBoolean);
 
     /* get RandomInfo */
-    jSsl3RandomDataClass = (*env)->FindClass(env, CLASS_SSL3_RANDOM_DATA);
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatParamsClass, "RandomInfo", CLASS_NAME(CLASS_SSL3_RANDOM_DATA));
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatParams.RandomInfo;
     jRandomInfo = (*env)->GetObjectField(env, jParam, fieldID);
 
     /* get pClientRandom and ulClientRandomLength out of RandomInfo */
-    fieldID = (*env)->GetFieldID(env, jSsl3RandomDataClass, "pClientRandom", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3RandomData.pClientRandom;
     jObject = (*env)->GetObjectField(env, jRandomInfo, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.RandomInfo.pClientRandom), &(ckParam.RandomInfo.ulClientRandomLen));
 
     /* get pServerRandom and ulServerRandomLength out of RandomInfo */
-    fieldID = (*env)->GetFieldID(env, jSsl3RandomDataClass, "pServerRandom", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3RandomData.pServerRandom;
     jObject = (*env)->GetObjectField(env, jRandomInfo, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.RandomInfo.pServerRandom), &(ckParam.RandomInfo.ulServerRandomLen));
 
     /* get pReturnedKeyMaterial */
-    jSsl3KeyMatOutClass = (*env)->FindClass(env, CLASS_SSL3_KEY_MAT_OUT);
-    fieldID =
-	(*env)->GetFieldID(env, jSsl3KeyMatParamsClass, "pReturnedKeyMaterial", CLASS_NAME(CLASS_SSL3_KEY_MAT_OUT));
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatParams.pReturnedKeyMaterial;
     jReturnedKeyMaterial = (*env)->GetObjectField(env, jParam, fieldID);
 
     /* allocate memory for pRetrunedKeyMaterial */
@@ -1124,38 +999,32 @@ CK_SSL3_KEY_MAT_PARAMS jSsl3KeyMatParamToCKSsl3KeyMatParam(JNIEnv * env, jobject
     }
 
     /* get hClientMacSecret out of pReturnedKeyMaterial */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatOutClass, "hClientMacSecret", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatOut.hClientMacSecret;
     jLong = (*env)->GetLongField(env, jReturnedKeyMaterial, fieldID);
     ckParam.pReturnedKeyMaterial->hClientMacSecret = jLongToCKULong(jLong);
 
     /* get hServerMacSecret out of pReturnedKeyMaterial */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatOutClass, "hServerMacSecret", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatOut.hServerMacSecret;
     jLong = (*env)->GetLongField(env, jReturnedKeyMaterial, fieldID);
     ckParam.pReturnedKeyMaterial->hServerMacSecret = jLongToCKULong(jLong);
 
     /* get hClientKey out of pReturnedKeyMaterial */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatOutClass, "hClientKey", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatOut.hClientKey;
     jLong = (*env)->GetLongField(env, jReturnedKeyMaterial, fieldID);
     ckParam.pReturnedKeyMaterial->hClientKey = jLongToCKULong(jLong);
 
     /* get hServerKey out of pReturnedKeyMaterial */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatOutClass, "hServerKey", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatOut.hServerKey;
     jLong = (*env)->GetLongField(env, jReturnedKeyMaterial, fieldID);
     ckParam.pReturnedKeyMaterial->hServerKey = jLongToCKULong(jLong);
 
     /* get pIVClient out of pReturnedKeyMaterial */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatOutClass, "pIVClient", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatOut.pIVClient;
     jObject = (*env)->GetObjectField(env, jReturnedKeyMaterial, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pReturnedKeyMaterial->pIVClient), &ckTemp);
 
     /* get pIVServer out of pReturnedKeyMaterial */
-    fieldID = (*env)->GetFieldID(env, jSsl3KeyMatOutClass, "pIVServer", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ssl3KeyMatOut.pIVServer;
     jObject = (*env)->GetObjectField(env, jReturnedKeyMaterial, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pReturnedKeyMaterial->pIVServer), &ckTemp);
 
@@ -1172,14 +1041,12 @@ CK_SSL3_KEY_MAT_PARAMS jSsl3KeyMatParamToCKSsl3KeyMatParam(JNIEnv * env, jobject
  */
 CK_KEY_DERIVATION_STRING_DATA jKeyDerivationStringDataToCKKeyDerivationStringData(JNIEnv * env, jobject jParam)
 {
-    jclass jKeyDerivationStringDataClass = (*env)->FindClass(env, CLASS_KEY_DERIVATION_STRING_DATA);
     CK_KEY_DERIVATION_STRING_DATA ckParam;
     jfieldID fieldID;
     jobject jObject;
 
     /* get pData */
-    fieldID = (*env)->GetFieldID(env, jKeyDerivationStringDataClass, "pData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.keyDerivationStringData.pData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pData), &(ckParam.ulLen));
 
@@ -1195,26 +1062,22 @@ CK_KEY_DERIVATION_STRING_DATA jKeyDerivationStringDataToCKKeyDerivationStringDat
  */
 CK_RSA_PKCS_PSS_PARAMS jRsaPkcsPssParamToCKRsaPkcsPssParam(JNIEnv * env, jobject jParam)
 {
-    jclass jRsaPkcsPssParamsClass = (*env)->FindClass(env, CLASS_RSA_PKCS_PSS_PARAMS);
     CK_RSA_PKCS_PSS_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
 
     /* get hashAlg */
-    fieldID = (*env)->GetFieldID(env, jRsaPkcsPssParamsClass, "hashAlg", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rsaPkcsPssParams.hashAlg;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.hashAlg = jLongToCKULong(jLong);
 
     /* get mgf */
-    fieldID = (*env)->GetFieldID(env, jRsaPkcsPssParamsClass, "mgf", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rsaPkcsPssParams.mgf;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.mgf = jLongToCKULong(jLong);
 
     /* get sLen */
-    fieldID = (*env)->GetFieldID(env, jRsaPkcsPssParamsClass, "sLen", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.rsaPkcsPssParams.sLen;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.sLen = jLongToCKULong(jLong);
 
@@ -1230,27 +1093,23 @@ CK_RSA_PKCS_PSS_PARAMS jRsaPkcsPssParamToCKRsaPkcsPssParam(JNIEnv * env, jobject
  */
 CK_ECDH1_DERIVE_PARAMS jEcdh1DeriveParamToCKEcdh1DeriveParam(JNIEnv * env, jobject jParam)
 {
-    jclass jEcdh1DeriveParamsClass = (*env)->FindClass(env, CLASS_ECDH1_DERIVE_PARAMS);
     CK_ECDH1_DERIVE_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
     jobject jObject;
 
     /* get kdf */
-    fieldID = (*env)->GetFieldID(env, jEcdh1DeriveParamsClass, "kdf", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh1DeriveParams.kdf;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.kdf = jLongToCKULong(jLong);
 
     /* get pSharedData and ulSharedDataLen */
-    fieldID = (*env)->GetFieldID(env, jEcdh1DeriveParamsClass, "pSharedData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh1DeriveParams.pSharedData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pSharedData), &(ckParam.ulSharedDataLen));
 
     /* get pPublicData and ulPublicDataLen */
-    fieldID = (*env)->GetFieldID(env, jEcdh1DeriveParamsClass, "pPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh1DeriveParams.pPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData), &(ckParam.ulPublicDataLen));
 
@@ -1266,45 +1125,38 @@ CK_ECDH1_DERIVE_PARAMS jEcdh1DeriveParamToCKEcdh1DeriveParam(JNIEnv * env, jobje
  */
 CK_ECDH2_DERIVE_PARAMS jEcdh2DeriveParamToCKEcdh2DeriveParam(JNIEnv * env, jobject jParam)
 {
-    jclass jEcdh2DeriveParamsClass = (*env)->FindClass(env, CLASS_ECDH2_DERIVE_PARAMS);
     CK_ECDH2_DERIVE_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
     jobject jObject;
 
     /* get kdf */
-    fieldID = (*env)->GetFieldID(env, jEcdh2DeriveParamsClass, "kdf", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh2DeriveParams.kdf;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.kdf = jLongToCKULong(jLong);
 
     /* get pSharedData and ulSharedDataLen */
-    fieldID = (*env)->GetFieldID(env, jEcdh2DeriveParamsClass, "pSharedData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh2DeriveParams.pSharedData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pSharedData), &(ckParam.ulSharedDataLen));
 
     /* get pPublicData and ulPublicDataLen */
-    fieldID = (*env)->GetFieldID(env, jEcdh2DeriveParamsClass, "pPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh2DeriveParams.pPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData), &(ckParam.ulPublicDataLen));
 
     /* get ulPrivateDataLen */
-    fieldID = (*env)->GetFieldID(env, jEcdh2DeriveParamsClass, "ulPrivateDataLen", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh2DeriveParams.ulPrivateDataLen;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulPrivateDataLen = jLongToCKULong(jLong);
 
     /* get hPrivateData */
-    fieldID = (*env)->GetFieldID(env, jEcdh2DeriveParamsClass, "hPrivateData", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh2DeriveParams.hPrivateData;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.hPrivateData = jLongToCKULong(jLong);
 
     /* get pPublicData2 and ulPublicDataLen2 */
-    fieldID = (*env)->GetFieldID(env, jEcdh2DeriveParamsClass, "pPublicData2", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.ecdh2DeriveParams.pPublicData2;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData2), &(ckParam.ulPublicDataLen2));
 
@@ -1320,27 +1172,23 @@ CK_ECDH2_DERIVE_PARAMS jEcdh2DeriveParamToCKEcdh2DeriveParam(JNIEnv * env, jobje
  */
 CK_X9_42_DH1_DERIVE_PARAMS jX942Dh1DeriveParamToCKX942Dh1DeriveParam(JNIEnv * env, jobject jParam)
 {
-    jclass jX942Dh1DeriveParamsClass = (*env)->FindClass(env, CLASS_X9_42_DH1_DERIVE_PARAMS);
     CK_X9_42_DH1_DERIVE_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
     jobject jObject;
 
     /* get kdf */
-    fieldID = (*env)->GetFieldID(env, jX942Dh1DeriveParamsClass, "kdf", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh1DeriveParams.kdf;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.kdf = jLongToCKULong(jLong);
 
     /* get pOtherInfo and ulOtherInfoLen */
-    fieldID = (*env)->GetFieldID(env, jX942Dh1DeriveParamsClass, "pOtherInfo", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh1DeriveParams.pOtherInfo;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pOtherInfo), &(ckParam.ulOtherInfoLen));
 
     /* get pPublicData and ulPublicDataLen */
-    fieldID = (*env)->GetFieldID(env, jX942Dh1DeriveParamsClass, "pPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh1DeriveParams.pPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData), &(ckParam.ulPublicDataLen));
 
@@ -1356,45 +1204,38 @@ CK_X9_42_DH1_DERIVE_PARAMS jX942Dh1DeriveParamToCKX942Dh1DeriveParam(JNIEnv * en
  */
 CK_X9_42_DH2_DERIVE_PARAMS jX942Dh2DeriveParamToCKX942Dh2DeriveParam(JNIEnv * env, jobject jParam)
 {
-    jclass jX942Dh2DeriveParamsClass = (*env)->FindClass(env, CLASS_X9_42_DH2_DERIVE_PARAMS);
     CK_X9_42_DH2_DERIVE_PARAMS ckParam;
     jfieldID fieldID;
     jlong jLong;
     jobject jObject;
 
     /* get kdf */
-    fieldID = (*env)->GetFieldID(env, jX942Dh2DeriveParamsClass, "kdf", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh2DeriveParams.kdf;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.kdf = jLongToCKULong(jLong);
 
     /* get pOtherInfo and ulOtherInfoLen */
-    fieldID = (*env)->GetFieldID(env, jX942Dh2DeriveParamsClass, "pOtherInfo", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh2DeriveParams.pOtherInfo;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pOtherInfo), &(ckParam.ulOtherInfoLen));
 
     /* get pPublicData and ulPublicDataLen */
-    fieldID = (*env)->GetFieldID(env, jX942Dh2DeriveParamsClass, "pPublicData", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh2DeriveParams.pPublicData;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData), &(ckParam.ulPublicDataLen));
 
     /* get ulPrivateDataLen */
-    fieldID = (*env)->GetFieldID(env, jX942Dh2DeriveParamsClass, "ulPrivateDataLen", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh2DeriveParams.ulPrivateDataLen;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.ulPrivateDataLen = jLongToCKULong(jLong);
 
     /* get hPrivateData */
-    fieldID = (*env)->GetFieldID(env, jX942Dh2DeriveParamsClass, "hPrivateData", "J");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh2DeriveParams.hPrivateData;
     jLong = (*env)->GetLongField(env, jParam, fieldID);
     ckParam.hPrivateData = jLongToCKULong(jLong);
 
     /* get pPublicData2 and ulPublicDataLen2 */
-    fieldID = (*env)->GetFieldID(env, jX942Dh2DeriveParamsClass, "pPublicData2", "[B");
-    assert(fieldID != 0);
+    fieldID = jniCache.x942Dh2DeriveParams.pPublicData2;
     jObject = (*env)->GetObjectField(env, jParam, fieldID);
     jByteArrayToCKByteArray(env, jObject, &(ckParam.pPublicData2), &(ckParam.ulPublicDataLen2));
 
@@ -103,16 +103,9 @@ jlong ckAssertAttributeReturnValueOK(JNIEnv * env, CK_RV returnValue, const char
  */
 void throwOutOfMemoryError(JNIEnv * env)
 {
-    jclass jOutOfMemoryErrorClass;
-    jmethodID jConstructor;
     jthrowable jOutOfMemoryError;
 
-    jOutOfMemoryErrorClass = (*env)->FindClass(env, CLASS_OUT_OF_MEMORY_ERROR);
-    assert(jOutOfMemoryErrorClass != 0);
-
-    jConstructor = (*env)->GetMethodID(env, jOutOfMemoryErrorClass, "<init>", "()V");
-    assert(jConstructor != 0);
-    jOutOfMemoryError = (jthrowable) (*env)->NewObject(env, jOutOfMemoryErrorClass, jConstructor);
+    jOutOfMemoryError = (jthrowable) (*env)->NewObject(env, jniCache.outOfMemoryError.clazz, jniCache.outOfMemoryError.init);
     (*env)->Throw(env, jOutOfMemoryError);
 }
 
@@ -124,16 +117,9 @@ void throwOutOfMemoryError(JNIEnv * env)
  */
 void throwFileNotFoundException(JNIEnv * env, jstring jmessage)
 {
-    jclass jFileNotFoundExceptionClass;
-    jmethodID jConstructor;
     jthrowable jFileNotFoundException;
 
-    jFileNotFoundExceptionClass = (*env)->FindClass(env, CLASS_FILE_NOT_FOUND_EXCEPTION);
-    assert(jFileNotFoundExceptionClass != 0);
-
-    jConstructor = (*env)->GetMethodID(env, jFileNotFoundExceptionClass, "<init>", "(Ljava/lang/String;)V");
-    assert(jConstructor != 0);
-    jFileNotFoundException = (jthrowable) (*env)->NewObject(env, jFileNotFoundExceptionClass, jConstructor, jmessage);
+    jFileNotFoundException = (jthrowable) (*env)->NewObject(env, jniCache.fileNotFoundException.clazz, jniCache.fileNotFoundException.init, jmessage);
     (*env)->Throw(env, jFileNotFoundException);
 }
 
@@ -145,12 +131,7 @@ void throwFileNotFoundException(JNIEnv * env, jstring jmessage)
  */
 void throwIOException(JNIEnv * env, const char *message)
 {
-    jclass jIOExceptionClass;
-
-    jIOExceptionClass = (*env)->FindClass(env, CLASS_IO_EXCEPTION);
-    assert(jIOExceptionClass != 0);
-
-    (*env)->ThrowNew(env, jIOExceptionClass, message);
+    (*env)->ThrowNew(env, jniCache.ioException.clazz, message);
 }
 
 /*
@@ -162,16 +143,11 @@ void throwIOException(JNIEnv * env, const char *message)
  */
 void throwIOExceptionUnicodeMessage(JNIEnv * env, const unsigned short *message)
 {
-    jclass jIOExceptionClass;
-    jmethodID jConstructor;
     jthrowable jIOException;
     jstring jmessage;
     jsize length;
     short *currentCharacter;
 
-    jIOExceptionClass = (*env)->FindClass(env, CLASS_IO_EXCEPTION);
-    assert(jIOExceptionClass != 0);
-
     length = 0;
     if (message != NULL_PTR) {
 	currentCharacter = (short *)message;
@@ -181,9 +157,7 @@ void throwIOExceptionUnicodeMessage(JNIEnv * env, const unsigned short *message)
 
     jmessage = (*env)->NewString(env, message, length);
 
-    jConstructor = (*env)->GetMethodID(env, jIOExceptionClass, "<init>", "(Ljava/lang/String;)V");
-    assert(jConstructor != 0);
-    jIOException = (jthrowable) (*env)->NewObject(env, jIOExceptionClass, jConstructor, jmessage);
+    jIOException = (jthrowable) (*env)->NewObject(env, jniCache.ioException.clazz, jniCache.ioException.init, jmessage);
     (*env)->Throw(env, jIOException);
 }
 
@@ -197,23 +171,15 @@ void throwIOExceptionUnicodeMessage(JNIEnv * env, const unsigned short *message)
  */
 void throwPKCS11RuntimeException(JNIEnv * env, jstring jmessage)
 {
-    jclass jPKCS11RuntimeExceptionClass;
-    jmethodID jConstructor;
     jthrowable jPKCS11RuntimeException;
 
-    jPKCS11RuntimeExceptionClass = (*env)->FindClass(env, CLASS_PKCS11RUNTIMEEXCEPTION);
-    assert(jPKCS11RuntimeExceptionClass != 0);
-
     if (jmessage == NULL_PTR) {
-	jConstructor = (*env)->GetMethodID(env, jPKCS11RuntimeExceptionClass, "<init>", "()V");
-	assert(jConstructor != 0);
-	jPKCS11RuntimeException = (jthrowable) (*env)->NewObject(env, jPKCS11RuntimeExceptionClass, jConstructor);
+	jPKCS11RuntimeException =
+	    (jthrowable) (*env)->NewObject(env, jniCache.pkcs11RuntimeException.clazz, jniCache.pkcs11RuntimeException.init);
 	(*env)->Throw(env, jPKCS11RuntimeException);
     } else {
-	jConstructor = (*env)->GetMethodID(env, jPKCS11RuntimeExceptionClass, "<init>", "(Ljava/lang/String;)V");
-	assert(jConstructor != 0);
 	jPKCS11RuntimeException =
-	    (jthrowable) (*env)->NewObject(env, jPKCS11RuntimeExceptionClass, jConstructor, jmessage);
+	    (jthrowable) (*env)->NewObject(env, jniCache.pkcs11RuntimeException.clazz, jniCache.pkcs11RuntimeException.initMessage, jmessage);
 	(*env)->Throw(env, jPKCS11RuntimeException);
     }
 }
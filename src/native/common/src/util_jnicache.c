@@ -0,0 +1,443 @@
+/* Copyright  (c) 2002 Graz University of Technology. All rights reserved.
+ *
+ * Redistribution and use in  source and binary forms, with or without
+ * modification, are permitted  provided that the following conditions are met:
+ *
+ * 1. Redistributions of  source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in  binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The end-user documentation included with the redistribution, if any, must
+ *    include the following acknowledgment:
+ *
+ *    "This product includes software developed by IAIK of Graz University of
+ *     Technology."
+ *
+ *    Alternately, this acknowledgment may appear in the software itself, if
+ *    and wherever such third-party acknowledgments normally appear.
+ *
+ * 4. The names "Graz University of Technology" and "IAIK of Graz University of
+ *    Technology" must not be used to endorse or promote products derived from
+ *    this software without prior written permission.
+ *
+ * 5. Products derived from this software may not be called
+ *    "IAIK PKCS Wrapper", nor may "IAIK" appear in their name, without prior
+ *    written permission of Graz University of Technology.
+ *
+ *  THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ *  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *  OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ *  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY  OF SUCH DAMAGE.
+ */
+
+#include "pkcs11wrapper.h"
+
+/* ************************************************************************** */
+/* Functions to fill and release the cache of Java classes and member IDs     */
+/* ************************************************************************** */
+
+/*
+ * The one and only cache instance. All members are NULL until
+ * initializeJNICache has been called by JNI_OnLoad.
+ */
+JNICache jniCache;
+
+/*
+ * The cache members holding a global class reference, in the order they were
+ * filled. releaseJNICache walks this list to delete the references again.
+ */
+#define MAX_CACHED_CLASSES 96
+jclass *cachedClasses[MAX_CACHED_CLASSES];
+int cachedClassCount = 0;
+
+/*
+ * looks up the class with the given name and stores a global reference to it
+ * in the given target.
+ *
+ * @param env - used to call JNI functions
+ * @param target - the reference, where the global class reference will be stored
+ * @param className - the name of the class in JNI notation
+ * @return 0 if successful, -1 if the class could not be found
+ */
+int cacheClass(JNIEnv *env, jclass *target, const char *className)
+{
+    jclass jLocalClass;
+
+    jLocalClass = (*env)->FindClass(env, className);
+    if (jLocalClass == NULL) {
+	TRACE1(tag_error, __FUNCTION__, "class %s not found", className);
+	return -1;
+    }
+    *target = (jclass) (*env)->NewGlobalRef(env, jLocalClass);
+    (*env)->DeleteLocalRef(env, jLocalClass);
+    if (*target == NULL) {
+	return -1;
+    }
+    assert(cachedClassCount < MAX_CACHED_CLASSES);
+    cachedClasses[cachedClassCount++] = target;
+
+    return 0;
+}
+
+/*
+ * The following macros abort the cache initialization if a class or member
+ * cannot be resolved. The JVM has a pending NoClassDefFoundError,
+ * NoSuchFieldError or NoSuchMethodError in this case.
+ */
+#define CACHE_CLASS(entry, className) \
+    if (cacheClass(env, &(jniCache.entry.clazz), className) != 0) return JNI_ERR;
+#define CACHE_FIELD(entry, member, signature) \
+    if ((jniCache.entry.member = (*env)->GetFieldID(env, jniCache.entry.clazz, #member, signature)) == NULL) return JNI_ERR;
+#define CACHE_METHOD(entry, member, methodName, signature) \
+    if ((jniCache.entry.member = (*env)->GetMethodID(env, jniCache.entry.clazz, methodName, signature)) == NULL) return JNI_ERR;
+#define CACHE_STATIC_METHOD(entry, member, methodName, signature) \
+    if ((jniCache.entry.member = (*env)->GetStaticMethodID(env, jniCache.entry.clazz, methodName, signature)) == NULL) return JNI_ERR;
+
+/*
+ * fills the cache with global references to all classes and with all field
+ * and method IDs the wrapper uses. This function is called from JNI_OnLoad.
+ *
+ * @param env - used to call JNI functions
+ * @return JNI_OK if successful, JNI_ERR if a class or member could not be found
+ */
+jint initializeJNICache(JNIEnv *env)
+{
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    /* classes of the Java platform */
+    CACHE_CLASS(object, "java/lang/Object");
+    CACHE_METHOD(object, init, "<init>", "()V");
+    CACHE_METHOD(object, equals, "equals", "(Ljava/lang/Object;)Z");
+    CACHE_METHOD(object, getClass, "getClass", "()Ljava/lang/Class;");
+
+    CACHE_CLASS(clazz, "java/lang/Class");
+    CACHE_METHOD(clazz, getName, "getName", "()Ljava/lang/String;");
+
+    CACHE_CLASS(booleanObject, "java/lang/Boolean");
+    CACHE_METHOD(booleanObject, init, "<init>", "(Z)V");
+    CACHE_METHOD(booleanObject, booleanValue, "booleanValue", "()Z");
+
+    CACHE_CLASS(byteObject, "java/lang/Byte");
+    CACHE_METHOD(byteObject, byteValue, "byteValue", "()B");
+
+    CACHE_CLASS(characterObject, "java/lang/Character");
+    CACHE_METHOD(characterObject, charValue, "charValue", "()C");
+
+    CACHE_CLASS(integerObject, "java/lang/Integer");
+    CACHE_METHOD(integerObject, intValue, "intValue", "()I");
+
+    CACHE_CLASS(longObject, "java/lang/Long");
+    CACHE_METHOD(longObject, init, "<init>", "(J)V");
+    CACHE_METHOD(longObject, longValue, "longValue", "()J");
+
+    CACHE_CLASS(string, "java/lang/String");
+
+    CACHE_CLASS(stringBuffer, "java/lang/StringBuffer");
+    CACHE_METHOD(stringBuffer, init, "<init>", "(Ljava/lang/String;)V");
+    CACHE_METHOD(stringBuffer, append, "append", "(Ljava/lang/String;)Ljava/lang/StringBuffer;");
+
+    CACHE_CLASS(booleanArray, "[Z");
+    CACHE_CLASS(byteArray, "[B");
+    CACHE_CLASS(charArray, "[C");
+    CACHE_CLASS(intArray, "[I");
+    CACHE_CLASS(longArray, "[J");
+
+    CACHE_CLASS(outOfMemoryError, CLASS_OUT_OF_MEMORY_ERROR);
+    CACHE_METHOD(outOfMemoryError, init, "<init>", "()V");
+
+    CACHE_CLASS(fileNotFoundException, CLASS_FILE_NOT_FOUND_EXCEPTION);
+    CACHE_METHOD(fileNotFoundException, init, "<init>", "(Ljava/lang/String;)V");
+
+    CACHE_CLASS(ioException, CLASS_IO_EXCEPTION);
+    CACHE_METHOD(ioException, init, "<init>", "(Ljava/lang/String;)V");
+
+    /* classes of the wrapper */
+    CACHE_CLASS(pkcs11Exception, CLASS_PKCS11EXCEPTION);
+    CACHE_METHOD(pkcs11Exception, init, "<init>", "(J)V");
+    CACHE_METHOD(pkcs11Exception, getErrorCode, "getErrorCode", "()J");
+
+    CACHE_CLASS(pkcs11RuntimeException, CLASS_PKCS11RUNTIMEEXCEPTION);
+    CACHE_METHOD(pkcs11RuntimeException, init, "<init>", "()V");
+    CACHE_METHOD(pkcs11RuntimeException, initMessage, "<init>", "(Ljava/lang/String;)V");
+
+    CACHE_CLASS(pkcs11Util, CLASS_PKCS11UTIL);
+    CACHE_STATIC_METHOD(pkcs11Util, encoder, METHOD_ENCODER, "([C)[B");
+    CACHE_STATIC_METHOD(pkcs11Util, decoder, METHOD_DECODER, "([B)[C");
+
+    CACHE_CLASS(pkcs11Implementation, CLASS_PKCS11IMPLEMENTATION);
+    CACHE_FIELD(pkcs11Implementation, moduleHandle_, "J");
+
+    CACHE_CLASS(version, CLASS_VERSION);
+    CACHE_FIELD(version, major, "B");
+    CACHE_FIELD(version, minor, "B");
+
+    CACHE_CLASS(date, CLASS_DATE);
+    CACHE_FIELD(date, year, "[C");
+    CACHE_FIELD(date, month, "[C");
+    CACHE_FIELD(date, day, "[C");
+
+    CACHE_CLASS(info, CLASS_INFO);
+    CACHE_FIELD(info, cryptokiVersion, CLASS_NAME(CLASS_VERSION));
+    CACHE_FIELD(info, manufacturerID, "[C");
+    CACHE_FIELD(info, flags, "J");
+    CACHE_FIELD(info, libraryDescription, "[C");
+    CACHE_FIELD(info, libraryVersion, CLASS_NAME(CLASS_VERSION));
+
+    CACHE_CLASS(slotInfo, CLASS_SLOT_INFO);
+    CACHE_FIELD(slotInfo, slotDescription, "[C");
+    CACHE_FIELD(slotInfo, manufacturerID, "[C");
+    CACHE_FIELD(slotInfo, flags, "J");
+    CACHE_FIELD(slotInfo, hardwareVersion, CLASS_NAME(CLASS_VERSION));
+    CACHE_FIELD(slotInfo, firmwareVersion, CLASS_NAME(CLASS_VERSION));
+
+    CACHE_CLASS(tokenInfo, CLASS_TOKEN_INFO);
+    CACHE_FIELD(tokenInfo, label, "[C");
+    CACHE_FIELD(tokenInfo, manufacturerID, "[C");
+    CACHE_FIELD(tokenInfo, model, "[C");
+    CACHE_FIELD(tokenInfo, serialNumber, "[C");
+    CACHE_FIELD(tokenInfo, flags, "J");
+    CACHE_FIELD(tokenInfo, ulMaxSessionCount, "J");
+    CACHE_FIELD(tokenInfo, ulSessionCount, "J");
+    CACHE_FIELD(tokenInfo, ulMaxRwSessionCount, "J");
+    CACHE_FIELD(tokenInfo, ulRwSessionCount, "J");
+    CACHE_FIELD(tokenInfo, ulMaxPinLen, "J");
+    CACHE_FIELD(tokenInfo, ulMinPinLen, "J");
+    CACHE_FIELD(tokenInfo, ulTotalPublicMemory, "J");
+    CACHE_FIELD(tokenInfo, ulFreePublicMemory, "J");
+    CACHE_FIELD(tokenInfo, ulTotalPrivateMemory, "J");
+    CACHE_FIELD(tokenInfo, ulFreePrivateMemory, "J");
+    CACHE_FIELD(tokenInfo, hardwareVersion, CLASS_NAME(CLASS_VERSION));
+    CACHE_FIELD(tokenInfo, firmwareVersion, CLASS_NAME(CLASS_VERSION));
+    CACHE_FIELD(tokenInfo, utcTime, "[C");
+
+    CACHE_CLASS(sessionInfo, CLASS_SESSION_INFO);
+    CACHE_FIELD(sessionInfo, slotID, "J");
+    CACHE_FIELD(sessionInfo, state, "J");
+    CACHE_FIELD(sessionInfo, flags, "J");
+    CACHE_FIELD(sessionInfo, ulDeviceError, "J");
+
+    CACHE_CLASS(mechanismInfo, CLASS_MECHANISM_INFO);
+    CACHE_FIELD(mechanismInfo, ulMinKeySize, "J");
+    CACHE_FIELD(mechanismInfo, ulMaxKeySize, "J");
+    CACHE_FIELD(mechanismInfo, flags, "J");
+
+    CACHE_CLASS(attribute, CLASS_ATTRIBUTE);
+    CACHE_FIELD(attribute, type, "J");
+    CACHE_FIELD(attribute, pValue, "Ljava/lang/Object;");
+
+    CACHE_CLASS(mechanism, CLASS_MECHANISM);
+    CACHE_FIELD(mechanism, mechanism, "J");
+    CACHE_FIELD(mechanism, pParameter, "Ljava/lang/Object;");
+
+    CACHE_CLASS(initializeArgs, CLASS_C_INITIALIZE_ARGS);
+    CACHE_FIELD(initializeArgs, CreateMutex, CLASS_NAME(CLASS_CREATEMUTEX));
+    CACHE_FIELD(initializeArgs, DestroyMutex, CLASS_NAME(CLASS_DESTROYMUTEX));
+    CACHE_FIELD(initializeArgs, LockMutex, CLASS_NAME(CLASS_LOCKMUTEX));
+    CACHE_FIELD(initializeArgs, UnlockMutex, CLASS_NAME(CLASS_UNLOCKMUTEX));
+    CACHE_FIELD(initializeArgs, flags, "J");
+    CACHE_FIELD(initializeArgs, pReserved, "Ljava/lang/Object;");
+
+    CACHE_CLASS(createMutex, CLASS_CREATEMUTEX);
+    CACHE_METHOD(createMutex, callback, "CK_CREATEMUTEX", "()Ljava/lang/Object;");
+
+    CACHE_CLASS(destroyMutex, CLASS_DESTROYMUTEX);
+    CACHE_METHOD(destroyMutex, callback, "CK_DESTROYMUTEX", "(Ljava/lang/Object;)V");
+
+    CACHE_CLASS(lockMutex, CLASS_LOCKMUTEX);
+    CACHE_METHOD(lockMutex, callback, "CK_LOCKMUTEX", "(Ljava/lang/Object;)V");
+
+    CACHE_CLASS(unlockMutex, CLASS_UNLOCKMUTEX);
+    CACHE_METHOD(unlockMutex, callback, "CK_UNLOCKMUTEX", "(Ljava/lang/Object;)V");
+
+    CACHE_CLASS(notify, CLASS_NOTIFY);
+    CACHE_METHOD(notify, callback, "CK_NOTIFY", "(JJLjava/lang/Object;)V");
+
+    CACHE_CLASS(nativeMutexes, CLASS_NATIVE_MUTEXES);
+
+    /* mechanism parameter classes */
+    CACHE_CLASS(rsaPkcsOaepParams, CLASS_RSA_PKCS_OAEP_PARAMS);
+    CACHE_FIELD(rsaPkcsOaepParams, hashAlg, "J");
+    CACHE_FIELD(rsaPkcsOaepParams, mgf, "J");
+    CACHE_FIELD(rsaPkcsOaepParams, source, "J");
+    CACHE_FIELD(rsaPkcsOaepParams, pSourceData, "[B");
+
+    CACHE_CLASS(keaDeriveParams, CLASS_KEA_DERIVE_PARAMS);
+    CACHE_FIELD(keaDeriveParams, isSender, "Z");
+    CACHE_FIELD(keaDeriveParams, pRandomA, "[B");
+    CACHE_FIELD(keaDeriveParams, pRandomB, "[B");
+    CACHE_FIELD(keaDeriveParams, pPublicData, "[B");
+
+    CACHE_CLASS(rc2CbcParams, CLASS_RC2_CBC_PARAMS);
+    CACHE_FIELD(rc2CbcParams, ulEffectiveBits, "J");
+    CACHE_FIELD(rc2CbcParams, iv, "[B");
+
+    CACHE_CLASS(rc2MacGeneralParams, CLASS_RC2_MAC_GENERAL_PARAMS);
+    CACHE_FIELD(rc2MacGeneralParams, ulEffectiveBits, "J");
+    CACHE_FIELD(rc2MacGeneralParams, ulMacLength, "J");
+
+    CACHE_CLASS(rc5Params, CLASS_RC5_PARAMS);
+    CACHE_FIELD(rc5Params, ulWordsize, "J");
+    CACHE_FIELD(rc5Params, ulRounds, "J");
+
+    CACHE_CLASS(rc5CbcParams, CLASS_RC5_CBC_PARAMS);
+    CACHE_FIELD(rc5CbcParams, ulWordsize, "J");
+    CACHE_FIELD(rc5CbcParams, ulRounds, "J");
+    CACHE_FIELD(rc5CbcParams, pIv, "[B");
+
+    CACHE_CLASS(rc5MacGeneralParams, CLASS_RC5_MAC_GENERAL_PARAMS);
+    CACHE_FIELD(rc5MacGeneralParams, ulWordsize, "J");
+    CACHE_FIELD(rc5MacGeneralParams, ulRounds, "J");
+    CACHE_FIELD(rc5MacGeneralParams, ulMacLength, "J");
+
+    CACHE_CLASS(skipjackPrivateWrapParams, CLASS_SKIPJACK_PRIVATE_WRAP_PARAMS);
+    CACHE_FIELD(skipjackPrivateWrapParams, pPassword, "[B");
+    CACHE_FIELD(skipjackPrivateWrapParams, pPublicData, "[B");
+    CACHE_FIELD(skipjackPrivateWrapParams, pRandomA, "[B");
+    CACHE_FIELD(skipjackPrivateWrapParams, pPrimeP, "[B");
+    CACHE_FIELD(skipjackPrivateWrapParams, pBaseG, "[B");
+    CACHE_FIELD(skipjackPrivateWrapParams, pSubprimeQ, "[B");
+
+    CACHE_CLASS(skipjackRelayxParams, CLASS_SKIPJACK_RELAYX_PARAMS);
+    CACHE_FIELD(skipjackRelayxParams, pOldWrappedX, "[B");
+    CACHE_FIELD(skipjackRelayxParams, pOldPassword, "[B");
+    CACHE_FIELD(skipjackRelayxParams, pOldPublicData, "[B");
+    CACHE_FIELD(skipjackRelayxParams, pOldRandomA, "[B");
+    CACHE_FIELD(skipjackRelayxParams, pNewPassword, "[B");
+    CACHE_FIELD(skipjackRelayxParams, pNewPublicData, "[B");
+    CACHE_FIELD(skipjackRelayxParams, pNewRandomA, "[B");
+
+    CACHE_CLASS(pbeParams, CLASS_PBE_PARAMS);
+    CACHE_FIELD(pbeParams, pInitVector, "[C");
+    CACHE_FIELD(pbeParams, pPassword, "[C");
+    CACHE_FIELD(pbeParams, pSalt, "[C");
+    CACHE_FIELD(pbeParams, ulIteration, "J");
+
+    CACHE_CLASS(pkcs5Pbkd2Params, CLASS_PKCS5_PBKD2_PARAMS);
+    CACHE_FIELD(pkcs5Pbkd2Params, saltSource, "J");
+    CACHE_FIELD(pkcs5Pbkd2Params, pSaltSourceData, "[B");
+    CACHE_FIELD(pkcs5Pbkd2Params, iterations, "J");
+    CACHE_FIELD(pkcs5Pbkd2Params, prf, "J");
+    CACHE_FIELD(pkcs5Pbkd2Params, pPrfData, "[B");
+
+    CACHE_CLASS(keyWrapSetOaepParams, CLASS_KEY_WRAP_SET_OAEP_PARAMS);
+    CACHE_FIELD(keyWrapSetOaepParams, bBC, "B");
+    CACHE_FIELD(keyWrapSetOaepParams, pX, "[B");
+
+    CACHE_CLASS(keyDerivationStringData, CLASS_KEY_DERIVATION_STRING_DATA);
+    CACHE_FIELD(keyDerivationStringData, pData, "[B");
+
+    CACHE_CLASS(ssl3RandomData, CLASS_SSL3_RANDOM_DATA);
+    CACHE_FIELD(ssl3RandomData, pClientRandom, "[B");
+    CACHE_FIELD(ssl3RandomData, pServerRandom, "[B");
+
+    CACHE_CLASS(ssl3KeyMatOut, CLASS_SSL3_KEY_MAT_OUT);
+    CACHE_FIELD(ssl3KeyMatOut, hClientMacSecret, "J");
+    CACHE_FIELD(ssl3KeyMatOut, hServerMacSecret, "J");
+    CACHE_FIELD(ssl3KeyMatOut, hClientKey, "J");
+    CACHE_FIELD(ssl3KeyMatOut, hServerKey, "J");
+    CACHE_FIELD(ssl3KeyMatOut, pIVClient, "[B");
+    CACHE_FIELD(ssl3KeyMatOut, pIVServer, "[B");
+
+    CACHE_CLASS(ssl3MasterKeyDeriveParams, CLASS_SSL3_MASTER_KEY_DERIVE_PARAMS);
+    CACHE_FIELD(ssl3MasterKeyDeriveParams, RandomInfo, CLASS_NAME(CLASS_SSL3_RANDOM_DATA));
+    CACHE_FIELD(ssl3MasterKeyDeriveParams, pVersion, CLASS_NAME(CLASS_VERSION));
+
+    CACHE_CLASS(ssl3KeyMatParams, CLASS_SSL3_KEY_MAT_PARAMS);
+    CACHE_FIELD(ssl3KeyMatParams, ulMacSizeInBits, "J");
+    CACHE_FIELD(ssl3KeyMatParams, ulKeySizeInBits, "J");
+    CACHE_FIELD(ssl3KeyMatParams, ulIVSizeInBits, "J");
+    CACHE_FIELD(ssl3KeyMatParams, bIsExport, "Z");
+    CACHE_FIELD(ssl3KeyMatParams, RandomInfo, CLASS_NAME(CLASS_SSL3_RANDOM_DATA));
+    CACHE_FIELD(ssl3KeyMatParams, pReturnedKeyMaterial, CLASS_NAME(CLASS_SSL3_KEY_MAT_OUT));
+
+    CACHE_CLASS(rsaPkcsPssParams, CLASS_RSA_PKCS_PSS_PARAMS);
+    CACHE_FIELD(rsaPkcsPssParams, hashAlg, "J");
+    CACHE_FIELD(rsaPkcsPssParams, mgf, "J");
+    CACHE_FIELD(rsaPkcsPssParams, sLen, "J");
+
+    CACHE_CLASS(ecdh1DeriveParams, CLASS_ECDH1_DERIVE_PARAMS);
+    CACHE_FIELD(ecdh1DeriveParams, kdf, "J");
+    CACHE_FIELD(ecdh1DeriveParams, pSharedData, "[B");
+    CACHE_FIELD(ecdh1DeriveParams, pPublicData, "[B");
+
+    CACHE_CLASS(ecdh2DeriveParams, CLASS_ECDH2_DERIVE_PARAMS);
+    CACHE_FIELD(ecdh2DeriveParams, kdf, "J");
+    CACHE_FIELD(ecdh2DeriveParams, pSharedData, "[B");
+    CACHE_FIELD(ecdh2DeriveParams, pPublicData, "[B");
+    CACHE_FIELD(ecdh2DeriveParams, ulPrivateDataLen, "J");
+    CACHE_FIELD(ecdh2DeriveParams, hPrivateData, "J");
+    CACHE_FIELD(ecdh2DeriveParams, pPublicData2, "[B");
+
+    CACHE_CLASS(x942Dh1DeriveParams, CLASS_X9_42_DH1_DERIVE_PARAMS);
+    CACHE_FIELD(x942Dh1DeriveParams, kdf, "J");
+    CACHE_FIELD(x942Dh1DeriveParams, pOtherInfo, "[B");
+    CACHE_FIELD(x942Dh1DeriveParams, pPublicData, "[B");
+
+    CACHE_CLASS(x942Dh2DeriveParams, CLASS_X9_42_DH2_DERIVE_PARAMS);
+    CACHE_FIELD(x942Dh2DeriveParams, kdf, "J");
+    CACHE_FIELD(x942Dh2DeriveParams, pOtherInfo, "[B");
+    CACHE_FIELD(x942Dh2DeriveParams, pPublicData, "[B");
+    CACHE_FIELD(x942Dh2DeriveParams, ulPrivateDataLen, "J");
+    CACHE_FIELD(x942Dh2DeriveParams, hPrivateData, "J");
+    CACHE_FIELD(x942Dh2DeriveParams, pPublicData2, "[B");
+
+    CACHE_CLASS(desCbcEncryptDataParams, CLASS_DES_CBC_ENCRYPT_DATA_PARAMS);
+    CACHE_FIELD(desCbcEncryptDataParams, iv, "[B");
+    CACHE_FIELD(desCbcEncryptDataParams, pData, "[B");
+
+    CACHE_CLASS(aesCbcEncryptDataParams, CLASS_AES_CBC_ENCRYPT_DATA_PARAMS);
+    CACHE_FIELD(aesCbcEncryptDataParams, iv, "[B");
+    CACHE_FIELD(aesCbcEncryptDataParams, pData, "[B");
+
+    CACHE_CLASS(gcmParams, CLASS_GCM_PARAMS);
+    CACHE_FIELD(gcmParams, pIv, "[B");
+    CACHE_FIELD(gcmParams, pAAD, "[B");
+    CACHE_FIELD(gcmParams, ulTagBits, "J");
+
+    CACHE_CLASS(ccmParams, CLASS_CCM_PARAMS);
+    CACHE_FIELD(ccmParams, pNonce, "[B");
+    CACHE_FIELD(ccmParams, pAAD, "[B");
+    CACHE_FIELD(ccmParams, ulDataLen, "J");
+    CACHE_FIELD(ccmParams, ulMacLen, "J");
+
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return JNI_OK;
+}
+
+#undef CACHE_CLASS
+#undef CACHE_FIELD
+#undef CACHE_METHOD
+#undef CACHE_STATIC_METHOD
+
+/*
+ * deletes the global references of all cached classes and clears the cache.
+ * This function is called from JNI_OnUnload and if initializeJNICache failed.
+ *
+ * @param env - used to call JNI functions
+ */
+void releaseJNICache(JNIEnv *env)
+{
+    int i;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    for (i = 0; i < cachedClassCount; i++) {
+	(*env)->DeleteGlobalRef(env, *(cachedClasses[i]));
+	*(cachedClasses[i]) = NULL;
+    }
+    cachedClassCount = 0;
+    memset(&jniCache, 0, sizeof(JNICache));
+
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
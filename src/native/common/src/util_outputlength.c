@@ -0,0 +1,492 @@
+/* Copyright  (c) 2002 Graz University of Technology. All rights reserved.
+ *
+ * Redistribution and use in  source and binary forms, with or without
+ * modification, are permitted  provided that the following conditions are met:
+ *
+ * 1. Redistributions of  source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in  binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The end-user documentation included with the redistribution, if any, must
+ *    include the following acknowledgment:
+ *
+ *    "This product includes software developed by IAIK of Graz University of
+ *     Technology."
+ *
+ *    Alternately, this acknowledgment may appear in the software itself, if
+ *    and wherever such third-party acknowledgments normally appear.
+ *
+ * 4. The names "Graz University of Technology" and "IAIK of Graz University of
+ *    Technology" must not be used to endorse or promote products derived from
+ *    this software without prior written permission.
+ *
+ * 5. Products derived from this software may not be called
+ *    "IAIK PKCS Wrapper", nor may "IAIK" appear in their name, without prior
+ *    written permission of Graz University of Technology.
+ *
+ *  THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ *  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *  OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ *  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY  OF SUCH DAMAGE.
+ */
+
+#include "pkcs11wrapper.h"
+
+/* ************************************************************************** */
+/* Functions to size the output buffers of encryption, decryption, signing    */
+/* and digesting from hints instead of asking the module for the length first */
+/* ************************************************************************** */
+
+/*
+ * Allocate the hint slots for a new module entry. Returns NULL_PTR, if there
+ * is not enough memory; the hints are only an optimization and callers work
+ * without them.
+ */
+OutputLengthSlot *newOutputLengthSlots(void)
+{
+    return (OutputLengthSlot *) calloc(OUTPUT_LENGTH_SLOTS, sizeof(OutputLengthSlot));
+}
+
+/*
+ * Forget all hints, e.g. when a module entry is reused for another module.
+ */
+void resetOutputLengthSlots(OutputLengthSlot * slots)
+{
+    if (slots != NULL_PTR) {
+	memset(slots, 0, OUTPUT_LENGTH_SLOTS * sizeof(OutputLengthSlot));
+    }
+}
+
+/* The number of times to check a held slot lock before letting other threads run. */
+#define OUTPUT_LENGTH_SPIN_COUNT 64
+
+/*
+ * Get the index of the slot of the given session. Modules often hand out
+ * handles in steps, e.g. multiples of the slot count, so the bits of the
+ * handle are mixed before the index is taken.
+ */
+static CK_ULONG getOutputLengthSlotIndex(CK_SESSION_HANDLE hSession)
+{
+    unsigned long hash = (unsigned long) hSession;
+
+    hash ^= hash >> 16;
+    hash *= 0x45D9F3BUL;
+    hash ^= hash >> 16;
+
+    return (CK_ULONG) (hash % OUTPUT_LENGTH_SLOTS);
+}
+
+/*
+ * Get and lock the slot of the given session. The slot may belong to another
+ * session, which shares the same index.
+ */
+OutputLengthSlot *lockOutputLengthSlot(ModuleData * moduleData, CK_SESSION_HANDLE hSession)
+{
+    OutputLengthSlot *slot;
+    int spins = 0;
+
+    if (moduleData->outputLengthSlots == NULL_PTR) {
+	return NULL_PTR;
+    }
+    slot = &moduleData->outputLengthSlots[getOutputLengthSlotIndex(hSession)];
+    while (!atomicCompareAndSwap(&slot->lock, 0, 1)) {
+	/* the lock is only held to copy a few values; if it stays taken, its
+	 * holder was preempted and needs the processor
+	 */
+	while (slot->lock != 0) {
+	    if (++spins >= OUTPUT_LENGTH_SPIN_COUNT) {
+		yieldNativeThread();
+		spins = 0;
+	    }
+	}
+    }
+
+    return slot;
+}
+
+void unlockOutputLengthSlot(OutputLengthSlot * slot)
+{
+    atomicDecrement(&slot->lock);
+}
+
+/*
+ * Get the length of the digests of the given digest or HMAC mechanism. Returns
+ * 0, if the mechanism is unknown.
+ */
+CK_ULONG getDigestLength(CK_MECHANISM_TYPE mechanism)
+{
+    switch (mechanism) {
+    case CKM_MD2:
+    case CKM_MD2_HMAC:
+    case CKM_MD5:
+    case CKM_MD5_HMAC:
+    case CKM_RIPEMD128:
+    case CKM_RIPEMD128_HMAC:
+	return 16;
+    case CKM_SHA_1:
+    case CKM_SHA_1_HMAC:
+    case CKM_RIPEMD160:
+    case CKM_RIPEMD160_HMAC:
+	return 20;
+    case CKM_SHA256:
+    case CKM_SHA256_HMAC:
+	return 32;
+    case CKM_SHA384:
+    case CKM_SHA384_HMAC:
+	return 48;
+    case CKM_SHA512:
+    case CKM_SHA512_HMAC:
+	return 64;
+    default:
+	return 0;
+    }
+}
+
+/*
+ * Get the block size of the given block cipher mechanism. Returns 0, if the
+ * mechanism is no block cipher mechanism known here.
+ */
+CK_ULONG getBlockSize(CK_MECHANISM_TYPE mechanism)
+{
+    switch (mechanism) {
+    case CKM_DES_ECB:
+    case CKM_DES_CBC:
+    case CKM_DES_CBC_PAD:
+    case CKM_DES3_ECB:
+    case CKM_DES3_CBC:
+    case CKM_DES3_CBC_PAD:
+    case CKM_DES_OFB64:
+    case CKM_DES_OFB8:
+    case CKM_DES_CFB64:
+    case CKM_DES_CFB8:
+    case CKM_BLOWFISH_CBC:
+	return 8;
+    case CKM_AES_ECB:
+    case CKM_AES_CBC:
+    case CKM_AES_CBC_PAD:
+    case CKM_TWOFISH_CBC:
+	return 16;
+    default:
+	return 0;
+    }
+}
+
+/*
+ * Returns TRUE, if the given mechanism uses an RSA key and its output has the
+ * length of the modulus.
+ */
+CK_BBOOL isRSAMechanism(CK_MECHANISM_TYPE mechanism)
+{
+    switch (mechanism) {
+    case CKM_RSA_PKCS:
+    case CKM_RSA_9796:
+    case CKM_RSA_X_509:
+    case CKM_RSA_PKCS_OAEP:
+    case CKM_RSA_X9_31:
+    case CKM_RSA_PKCS_PSS:
+    case CKM_MD2_RSA_PKCS:
+    case CKM_MD5_RSA_PKCS:
+    case CKM_SHA1_RSA_PKCS:
+    case CKM_SHA256_RSA_PKCS:
+    case CKM_SHA384_RSA_PKCS:
+    case CKM_SHA512_RSA_PKCS:
+    case CKM_RIPEMD128_RSA_PKCS:
+    case CKM_RIPEMD160_RSA_PKCS:
+    case CKM_SHA1_RSA_X9_31:
+    case CKM_SHA1_RSA_PKCS_PSS:
+    case CKM_SHA256_RSA_PKCS_PSS:
+    case CKM_SHA384_RSA_PKCS_PSS:
+    case CKM_SHA512_RSA_PKCS_PSS:
+	return TRUE;
+    default:
+	return FALSE;
+    }
+}
+
+/*
+ * Get the length of the modulus of the given RSA key. Returns 0, if the module
+ * does not tell it.
+ */
+CK_ULONG getModulusLength(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hKey)
+{
+    CK_ATTRIBUTE ckAttribute;
+    CK_RV rv;
+
+    ckAttribute.type = CKA_MODULUS;
+    ckAttribute.pValue = NULL_PTR;
+    ckAttribute.ulValueLen = 0;
+    rv = (*ckpFunctions->C_GetAttributeValue) (hSession, hKey, &ckAttribute, 1);
+    if (rv != CKR_OK || ckAttribute.ulValueLen == (CK_ULONG) -1) {
+	return 0;
+    }
+
+    return ckAttribute.ulValueLen;
+}
+
+/*
+ * Get the output length beyond the input length of the given operation, as far
+ * as mechanism and key tell it. Returns FALSE, if it is not known.
+ */
+CK_BBOOL getMechanismExtraLength(CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession, int operation,
+				 CK_MECHANISM_PTR ckpMechanism, CK_OBJECT_HANDLE hKey, CK_ULONG_PTR ckpExtraLength)
+{
+    CK_MECHANISM_TYPE mechanism = ckpMechanism->mechanism;
+    CK_ULONG length;
+
+    switch (operation) {
+    case OUTPUT_DIGEST:
+    case OUTPUT_SIGN:
+	/* the length of the digest or MAC */
+	length = getDigestLength(mechanism);
+	if (length == 0 && ckpMechanism->pParameter != NULL_PTR && ckpMechanism->ulParameterLen == sizeof(CK_ULONG)) {
+	    switch (mechanism) {
+	    case CKM_MD2_HMAC_GENERAL:
+	    case CKM_MD5_HMAC_GENERAL:
+	    case CKM_SHA_1_HMAC_GENERAL:
+	    case CKM_RIPEMD128_HMAC_GENERAL:
+	    case CKM_RIPEMD160_HMAC_GENERAL:
+	    case CKM_SHA256_HMAC_GENERAL:
+	    case CKM_SHA384_HMAC_GENERAL:
+	    case CKM_SHA512_HMAC_GENERAL:
+	    case CKM_DES_MAC_GENERAL:
+	    case CKM_DES3_MAC_GENERAL:
+	    case CKM_AES_MAC_GENERAL:
+		/* CK_MAC_GENERAL_PARAMS is the length of the MAC */
+		length = *((CK_ULONG_PTR) ckpMechanism->pParameter);
+		break;
+	    }
+	}
+	if (length == 0 && operation == OUTPUT_SIGN) {
+	    if (mechanism == CKM_DES_MAC || mechanism == CKM_DES3_MAC) {
+		length = 4;
+	    } else if (mechanism == CKM_AES_MAC) {
+		length = 8;
+	    } else if (isRSAMechanism(mechanism)) {
+		length = getModulusLength(ckpFunctions, hSession, hKey);
+	    }
+	}
+	*ckpExtraLength = length;
+	return (length != 0) ? TRUE : FALSE;
+    case OUTPUT_ENCRYPT:
+    case OUTPUT_ENCRYPT_FINAL:
+    case OUTPUT_DECRYPT:
+    case OUTPUT_DECRYPT_FINAL:
+	if (isRSAMechanism(mechanism)) {
+	    /* the ciphertext has the length of the modulus, the plaintext is shorter */
+	    if (operation == OUTPUT_DECRYPT || operation == OUTPUT_DECRYPT_FINAL) {
+		*ckpExtraLength = 0;
+		return TRUE;
+	    }
+	    length = getModulusLength(ckpFunctions, hSession, hKey);
+	    *ckpExtraLength = length;
+	    return (length != 0) ? TRUE : FALSE;
+	}
+	/* at most one block held back by a previous part or added as padding */
+	length = getBlockSize(mechanism);
+	if (length == 0 && (mechanism == CKM_AES_GCM || mechanism == CKM_AES_CCM)) {
+	    /* one block and the longest tag */
+	    length = 32;
+	}
+	*ckpExtraLength = length;
+	return (length != 0) ? TRUE : FALSE;
+    default:
+	return FALSE;
+    }
+}
+
+/*
+ * Set the hints of a session for an operation which was initialized with the
+ * given mechanism and key. For encryption and decryption, this also sets the
+ * hints of the final part. An unknown mechanism keeps the lengths learned so
+ * far, if the mechanism did not change.
+ */
+void initOutputLength(ModuleData * moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, CK_SESSION_HANDLE hSession,
+		      int operation, CK_MECHANISM_PTR ckpMechanism, CK_OBJECT_HANDLE hKey)
+{
+    OutputLengthSlot *slot;
+    OutputLengthHint *hint;
+    CK_ULONG extraLength;
+    CK_BBOOL extraLengthKnown;
+    int i, count;
+
+    slot = lockOutputLengthSlot(moduleData, hSession);
+    if (slot == NULL_PTR) {
+	return;
+    }
+    hint = &slot->hints[operation];
+    if (slot->hSession == hSession && hint->mechanism == ckpMechanism->mechanism && hint->hKey == hKey
+	&& hint->extraLengthKnown) {
+	/* same as last time, e.g. the next message signed with the same key */
+	unlockOutputLengthSlot(slot);
+	return;
+    }
+    unlockOutputLengthSlot(slot);
+
+    /* this may ask the module for the key size, so it is done without the lock */
+    extraLengthKnown = getMechanismExtraLength(ckpFunctions, hSession, operation, ckpMechanism, hKey, &extraLength);
+
+    count = (operation == OUTPUT_ENCRYPT || operation == OUTPUT_DECRYPT) ? 2 : 1;
+    slot = lockOutputLengthSlot(moduleData, hSession);
+    if (slot->hSession != hSession) {
+	/* take over the slot from the other session */
+	memset(slot->hints, 0, sizeof(slot->hints));
+	slot->hSession = hSession;
+    }
+    for (i = 0; i < count; i++) {
+	hint = &slot->hints[operation + i];
+	if (hint->mechanism != ckpMechanism->mechanism) {
+	    hint->mechanism = ckpMechanism->mechanism;
+	    hint->learnedExtraLength = 0;
+	}
+	hint->hKey = hKey;
+	hint->extraLength = extraLength;
+	hint->extraLengthKnown = extraLengthKnown;
+    }
+    unlockOutputLengthSlot(slot);
+}
+
+/*
+ * Get the buffer length to use for the given operation of a session. Returns 0
+ * for signing and digesting, if nothing is known; the caller has to ask the
+ * module for the length in this case.
+ */
+CK_ULONG getOutputLength(ModuleData * moduleData, CK_SESSION_HANDLE hSession, int operation, CK_ULONG ulInputLen)
+{
+    OutputLengthSlot *slot;
+    OutputLengthHint *hint;
+    CK_ULONG extraLength = 0;
+    CK_BBOOL known = FALSE;
+
+    slot = lockOutputLengthSlot(moduleData, hSession);
+    if (slot != NULL_PTR) {
+	if (slot->hSession == hSession) {
+	    hint = &slot->hints[operation];
+	    if (hint->extraLengthKnown) {
+		extraLength = hint->extraLength;
+		known = TRUE;
+	    }
+	    if (hint->learnedExtraLength > extraLength) {
+		extraLength = hint->learnedExtraLength;
+		known = TRUE;
+	    }
+	}
+	unlockOutputLengthSlot(slot);
+    }
+
+    if (!known) {
+	if (operation == OUTPUT_SIGN || operation == OUTPUT_DIGEST) {
+	    return 0;
+	}
+	extraLength = DEFAULT_EXTRA_OUTPUT_LENGTH;
+    }
+
+    return ulInputLen + extraLength;
+}
+
+/*
+ * Remember the output length the module returned for the given input length.
+ */
+void learnOutputLength(ModuleData * moduleData, CK_SESSION_HANDLE hSession, int operation, CK_ULONG ulInputLen,
+		       CK_ULONG ulOutputLen)
+{
+    OutputLengthSlot *slot;
+    OutputLengthHint *hint;
+
+    if (ulOutputLen <= ulInputLen) {
+	return;
+    }
+    slot = lockOutputLengthSlot(moduleData, hSession);
+    if (slot == NULL_PTR) {
+	return;
+    }
+    if (slot->hSession != hSession) {
+	/* the operation was initialized before the slot was taken over */
+	memset(slot->hints, 0, sizeof(slot->hints));
+	slot->hSession = hSession;
+    }
+    hint = &slot->hints[operation];
+    if (ulOutputLen - ulInputLen > hint->learnedExtraLength) {
+	hint->learnedExtraLength = ulOutputLen - ulInputLen;
+    }
+    unlockOutputLengthSlot(slot);
+}
+
+/*
+ * Call a function returning data with a buffer of the expected length. Usually
+ * this is a single call to the module. If the buffer is too small, it is
+ * enlarged to the length the module requires and the function is called again.
+ * If the call succeeds, *ppOutput is a newly allocated buffer, which has to be
+ * freed after use; otherwise it is NULL_PTR.
+ *
+ * @param function - the function to call
+ * @param operation - the kind of operation, one of the OUTPUT_* constants
+ * @return the return value of the module or CKR_HOST_MEMORY
+ */
+CK_RV callOutputFunction(ModuleData * moduleData, CK_FUNCTION_LIST_PTR ckpFunctions, OutputFunction function,
+			 int operation, CK_SESSION_HANDLE hSession, CK_BYTE_PTR pInput, CK_ULONG ulInputLen,
+			 CK_BYTE_PTR * ppOutput, CK_ULONG_PTR pulOutputLen)
+{
+    CK_ULONG ulHintInputLen, ulLength, ulBufferLength;
+    CK_RV rv;
+    int attempt;
+
+    *ppOutput = NULL_PTR;
+    *pulOutputLen = 0;
+
+    /* the length of a signature or digest does not depend on the input */
+    ulHintInputLen = (operation == OUTPUT_SIGN || operation == OUTPUT_DIGEST) ? 0 : ulInputLen;
+    ulLength = getOutputLength(moduleData, hSession, operation, ulHintInputLen);
+    if (ulLength == 0) {
+	TRACE0(tag_debug, __FUNCTION__, "output length unknown, asking the module");
+	rv = (*function) (ckpFunctions, hSession, pInput, ulInputLen, NULL_PTR, &ulLength);
+	if (rv != CKR_OK) {
+	    return rv;
+	}
+    }
+
+    for (attempt = 0;; attempt++) {
+	/* never pass NULL_PTR, that would only ask for the length */
+	ulBufferLength = ulLength;
+	*ppOutput = (CK_BYTE_PTR) scratchAlloc((ulBufferLength + 1) * sizeof(CK_BYTE));
+	if (*ppOutput == NULL_PTR) {
+	    return CKR_HOST_MEMORY;
+	}
+	rv = (*function) (ckpFunctions, hSession, pInput, ulInputLen, *ppOutput, &ulLength);
+	if (rv != CKR_BUFFER_TOO_SMALL || attempt == 2) {
+	    break;
+	}
+	scratchFree(*ppOutput);
+	*ppOutput = NULL_PTR;
+
+	TRACE1(tag_debug, __FUNCTION__, "buffer of %lu bytes too small, trying again", (unsigned long) ulBufferLength);
+	if (ulLength <= ulBufferLength) {
+	    /* the module did not tell the length it needs */
+	    rv = (*function) (ckpFunctions, hSession, pInput, ulInputLen, NULL_PTR, &ulLength);
+	    if (rv != CKR_OK) {
+		return rv;
+	    }
+	}
+    }
+
+    if (rv != CKR_OK) {
+	scratchFree(*ppOutput);
+	*ppOutput = NULL_PTR;
+	return rv;
+    }
+
+    learnOutputLength(moduleData, hSession, operation, ulHintInputLen, ulLength);
+    *pulOutputLen = ulLength;
+
+    return CKR_OK;
+}
@@ -0,0 +1,209 @@
+/* Copyright  (c) 2002 Graz University of Technology. All rights reserved.
+ *
+ * Redistribution and use in  source and binary forms, with or without
+ * modification, are permitted  provided that the following conditions are met:
+ *
+ * 1. Redistributions of  source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in  binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The end-user documentation included with the redistribution, if any, must
+ *    include the following acknowledgment:
+ *
+ *    "This product includes software developed by IAIK of Graz University of
+ *     Technology."
+ *
+ *    Alternately, this acknowledgment may appear in the software itself, if
+ *    and wherever such third-party acknowledgments normally appear.
+ *
+ * 4. The names "Graz University of Technology" and "IAIK of Graz University of
+ *    Technology" must not be used to endorse or promote products derived from
+ *    this software without prior written permission.
+ *
+ * 5. Products derived from this software may not be called
+ *    "IAIK PKCS Wrapper", nor may "IAIK" appear in their name, without prior
+ *    written permission of Graz University of Technology.
+ *
+ *  THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ *  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *  OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ *  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY  OF SUCH DAMAGE.
+ */
+
+#include "pkcs11wrapper.h"
+
+/* ************************************************************************** */
+/* Functions for the per-thread scratch memory, from which the temporary      */
+/* buffers of a call are allocated                                            */
+/* ************************************************************************** */
+
+/* The scratch arena of a thread. The memory follows directly after this
+ * header. Allocations bump the used size; each starts with a block header,
+ * which links it to the allocation before. When the topmost allocation is
+ * freed, the used size goes back over it and over all freed allocations
+ * below it; so the arena is reused, even if an allocation lives across a
+ * loop, whose iterations allocate and free.
+ */
+struct ScratchArena {
+  size_t used;
+  size_t top;
+  size_t heapOnly;
+};
+typedef struct ScratchArena ScratchArena;
+
+/* The header of an allocation in the arena. */
+struct ScratchBlock {
+  size_t previous;
+  size_t freed;
+};
+typedef struct ScratchBlock ScratchBlock;
+
+/* The value of top and previous, if there is no allocation. */
+#define SCRATCH_NO_BLOCK ((size_t) -1)
+
+/* The size of the header, rounded up to keep the first allocation aligned. */
+#define SCRATCH_HEADER_SIZE (((sizeof(ScratchArena) + SCRATCH_ALIGNMENT - 1) / SCRATCH_ALIGNMENT) * SCRATCH_ALIGNMENT)
+
+#define scratchMemory(arena) (((char *) (arena)) + SCRATCH_HEADER_SIZE)
+
+/* The size of the block header, rounded up to keep the allocations aligned. */
+#define SCRATCH_BLOCK_HEADER_SIZE (((sizeof(ScratchBlock) + SCRATCH_ALIGNMENT - 1) / SCRATCH_ALIGNMENT) * SCRATCH_ALIGNMENT)
+
+#define scratchBlock(arena, offset) ((ScratchBlock *) (scratchMemory(arena) + (offset)))
+
+/*
+ * Get the scratch arena of the calling thread, create it on first use.
+ * Returns NULL_PTR, if there is none and it cannot be created.
+ */
+static ScratchArena *getScratchArena(void)
+{
+    ScratchArena *arena;
+
+    arena = (ScratchArena *) getThreadScratchArena();
+    if (arena == NULL_PTR) {
+	arena = (ScratchArena *) malloc(SCRATCH_HEADER_SIZE + SCRATCH_ARENA_SIZE);
+	if (arena == NULL_PTR) { return NULL_PTR; }
+	arena->used = 0;
+	arena->top = SCRATCH_NO_BLOCK;
+	arena->heapOnly = 0;
+	if (!setThreadScratchArena(arena)) {
+	    free(arena);
+	    return NULL_PTR;
+	}
+    }
+
+    return arena ;
+}
+
+/*
+ * Allocate temporary memory for the current call. The memory is taken from
+ * the arena of the calling thread; if it does not fit there, it is taken from
+ * the heap. The memory must be freed with scratchFree on the same thread
+ * before the call returns. Returns NULL_PTR, if there is not enough memory.
+ */
+void *scratchAlloc(size_t size)
+{
+    ScratchArena *arena;
+    ScratchBlock *block;
+    size_t alignedSize;
+
+    alignedSize = ((size + SCRATCH_ALIGNMENT - 1) / SCRATCH_ALIGNMENT) * SCRATCH_ALIGNMENT;
+    if (alignedSize == 0) { alignedSize = SCRATCH_ALIGNMENT; }
+    if (alignedSize < size || alignedSize > SCRATCH_ARENA_SIZE - SCRATCH_BLOCK_HEADER_SIZE) {
+	return malloc(size);
+    }
+    alignedSize += SCRATCH_BLOCK_HEADER_SIZE;
+
+    arena = getScratchArena();
+    if (arena == NULL_PTR || arena->heapOnly > 0 || alignedSize > SCRATCH_ARENA_SIZE - arena->used) {
+	return malloc(size);
+    }
+
+    block = scratchBlock(arena, arena->used);
+    block->previous = arena->top;
+    block->freed = 0;
+    arena->top = arena->used;
+    arena->used += alignedSize;
+
+    return ((char *) block) + SCRATCH_BLOCK_HEADER_SIZE;
+}
+
+/*
+ * Free memory allocated by scratchAlloc. Memory from the heap is freed, so
+ * this may also be called for memory allocated with malloc. NULL_PTR is
+ * ignored.
+ */
+void scratchFree(void *pointer)
+{
+    ScratchArena *arena;
+    ScratchBlock *block;
+    char *memory;
+
+    if (pointer == NULL_PTR) { return; }
+
+    arena = (ScratchArena *) getThreadScratchArena();
+    if (arena != NULL_PTR) {
+	memory = scratchMemory(arena);
+	if ((char *) pointer >= memory && (char *) pointer < memory + SCRATCH_ARENA_SIZE) {
+	    block = (ScratchBlock *) (((char *) pointer) - SCRATCH_BLOCK_HEADER_SIZE);
+	    block->freed = 1;
+	    /* give back the topmost allocations, as far as they are freed */
+	    while (arena->top != SCRATCH_NO_BLOCK && scratchBlock(arena, arena->top)->freed) {
+		arena->used = arena->top;
+		arena->top = scratchBlock(arena, arena->top)->previous;
+	    }
+	    return;
+	}
+    }
+
+    free(pointer);
+}
+
+/*
+ * Let the scratch allocations of the calling thread come from the heap until
+ * endHeapScratch is called. Memory allocated so may outlive the call and may be
+ * freed with scratchFree on any thread; e.g. a mechanism, which is converted
+ * once and used by other threads. Calls may be nested.
+ */
+void beginHeapScratch(void)
+{
+    ScratchArena *arena;
+
+    arena = getScratchArena();
+    if (arena != NULL_PTR) {
+	arena->heapOnly++;
+    }
+}
+
+/*
+ * End the heap allocations started with beginHeapScratch.
+ */
+void endHeapScratch(void)
+{
+    ScratchArena *arena;
+
+    arena = (ScratchArena *) getThreadScratchArena();
+    if (arena != NULL_PTR && arena->heapOnly > 0) {
+	arena->heapOnly--;
+    }
+}
+
+/*
+ * Free the scratch arena of a thread. This is called, when the thread
+ * terminates.
+ */
+void freeScratchArena(void *arena)
+{
+    free(arena);
+}
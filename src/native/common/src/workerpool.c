@@ -0,0 +1,825 @@
+/* Copyright  (c) 2002 Graz University of Technology. All rights reserved.
+ *
+ * Redistribution and use in  source and binary forms, with or without
+ * modification, are permitted  provided that the following conditions are met:
+ *
+ * 1. Redistributions of  source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in  binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. The end-user documentation included with the redistribution, if any, must
+ *    include the following acknowledgment:
+ *
+ *    "This product includes software developed by IAIK of Graz University of
+ *     Technology."
+ *
+ *    Alternately, this acknowledgment may appear in the software itself, if
+ *    and wherever such third-party acknowledgments normally appear.
+ *
+ * 4. The names "Graz University of Technology" and "IAIK of Graz University of
+ *    Technology" must not be used to endorse or promote products derived from
+ *    this software without prior written permission.
+ *
+ * 5. Products derived from this software may not be called
+ *    "IAIK PKCS Wrapper", nor may "IAIK" appear in their name, without prior
+ *    written permission of Graz University of Technology.
+ *
+ *  THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESSED OR IMPLIED
+ *  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE LICENSOR BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+ *  OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ *  OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ *  OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY  OF SUCH DAMAGE.
+ */
+
+#include "pkcs11wrapper.h"
+
+/* ************************************************************************** */
+/* The native worker pool, which runs whole operations on C threads, each     */
+/* with a session of its own                                                  */
+/* ************************************************************************** */
+
+/*
+ * Java submits requests to a lock-free submission ring and takes the results
+ * from a lock-free completion ring. Each worker thread owns one session; it
+ * takes requests from the submission ring, runs each in a single call with
+ * callOneShot and puts the result to the completion ring. The number of
+ * requests submitted, but whose results were not polled yet, is limited to the
+ * capacity of the pool; so neither ring ever overflows. Threads only sleep on
+ * a signal, if there is nothing to do; the signals are only raised, if a
+ * thread sleeps.
+ */
+
+/* The operations of a request; they must match the constants of the
+ * NativeWorkerPool class.
+ */
+#define WORKER_SIGN             0
+#define WORKER_ENCRYPT          1
+#define WORKER_DECRYPT          2
+#define WORKER_DIGEST           3
+
+/* The largest capacity of a pool. */
+#define WORKER_MAX_CAPACITY     (1L << 24)
+
+/* The longest timeout in milliseconds of a poll; a week. */
+#define WORKER_MAX_TIMEOUT      (7L * 24L * 3600L * 1000L)
+
+/* The longest time in milliseconds that a poller sleeps before it checks
+ * again, whether any request is in flight at all.
+ */
+#define WORKER_WAIT_SLICE       100L
+
+/* The size of a cache line, which separates the positions of a ring. */
+#define WORKER_CACHE_LINE       64
+
+/* Positions of a ring are counted in unsigned arithmetic, so that they may wrap. */
+#define ringAdvance(position, count) ((long) ((unsigned long) (position) + (unsigned long) (count)))
+#define ringDistance(position1, position2) ((long) ((unsigned long) (position1) - (unsigned long) (position2)))
+
+/* A mechanism shared by the requests of one submission. It is freed, when the
+ * last request has run.
+ */
+struct WorkerMechanism {
+    CK_MECHANISM mechanism;
+    volatile long referenceCount;
+};
+typedef struct WorkerMechanism WorkerMechanism;
+
+/* A request and, after it has run, its result. */
+struct WorkerTask {
+    jlong id;
+    int operation;
+    WorkerMechanism *mechanism;
+    CK_OBJECT_HANDLE hKey;
+    CK_BYTE_PTR pInput;
+    CK_ULONG ulInputLen;
+    CK_RV rv;
+    CK_BYTE_PTR pOutput;
+    CK_ULONG ulOutputLen;
+};
+typedef struct WorkerTask WorkerTask;
+
+/* A slot of a ring. Its sequence tells, whether the slot is free for the put
+ * at a position or holds the task for the take at a position.
+ */
+struct WorkerRingSlot {
+    volatile long sequence;
+    WorkerTask * volatile task;
+};
+typedef struct WorkerRingSlot WorkerRingSlot;
+
+/* A bounded ring, which many threads may put to and take from at the same
+ * time. The capacity is a power of two.
+ */
+struct WorkerRing {
+    WorkerRingSlot *slots;
+    long mask;
+    char padding1[WORKER_CACHE_LINE];
+    volatile long putPosition;
+    char padding2[WORKER_CACHE_LINE];
+    volatile long takePosition;
+    char padding3[WORKER_CACHE_LINE];
+};
+typedef struct WorkerRing WorkerRing;
+
+struct WorkerPool;
+
+/* A worker thread and its session. */
+struct WorkerThread {
+    struct WorkerPool *pool;
+    CK_SESSION_HANDLE hSession;
+    void *thread;
+};
+typedef struct WorkerThread WorkerThread;
+
+struct WorkerPool {
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+    WorkerRing submissions;
+    WorkerRing completions;
+
+    /* The maximum and current number of requests submitted, but not taken by a
+     * poller yet.
+     */
+    long capacity;
+    volatile long inFlight;
+
+    /* The number of threads sleeping or about to sleep on the signals. */
+    volatile long idleWorkers;
+    volatile long waitingPollers;
+    void *workSignal;
+    void *completionSignal;
+
+    volatile long stopping;
+    WorkerThread *workers;
+    long workerCount;
+};
+typedef struct WorkerPool WorkerPool;
+
+/*
+ * Add delta to a counter, which other threads change at the same time.
+ */
+static void addWorkerCount(volatile long *value, long delta)
+{
+    long oldValue;
+
+    do {
+	oldValue = *value;
+    } while (!atomicCompareAndSwap(value, oldValue, oldValue + delta));
+}
+
+/*
+ * Allocate the slots of an empty ring. The capacity must be a power of two.
+ * Returns 0, if there is not enough memory.
+ */
+static int initWorkerRing(WorkerRing *ring, long capacity)
+{
+    long i;
+
+    ring->slots = (WorkerRingSlot *) malloc(capacity * sizeof(WorkerRingSlot));
+    if (ring->slots == NULL_PTR) {
+	return 0;
+    }
+    for (i = 0; i < capacity; i++) {
+	ring->slots[i].sequence = i;
+	ring->slots[i].task = NULL_PTR;
+    }
+    ring->mask = capacity - 1;
+    ring->putPosition = 0;
+    ring->takePosition = 0;
+    memoryBarrier();
+
+    return 1;
+}
+
+/*
+ * Put a task to a ring. Returns 0, if the ring is full.
+ */
+static int putWorkerTask(WorkerRing *ring, WorkerTask *task)
+{
+    WorkerRingSlot *slot;
+    long position, distance;
+
+    position = ring->putPosition;
+    for (;;) {
+	slot = &(ring->slots[position & ring->mask]);
+	distance = ringDistance(slot->sequence, position);
+	memoryBarrier();
+	if (distance == 0) {
+	    /* the slot is free; claim the position */
+	    if (atomicCompareAndSwap(&(ring->putPosition), position, ringAdvance(position, 1))) {
+		break;
+	    }
+	} else if (distance < 0) {
+	    /* the slot still holds the task of the previous round */
+	    return 0;
+	}
+	position = ring->putPosition;
+    }
+
+    slot->task = task;
+    memoryBarrier();
+    slot->sequence = ringAdvance(position, 1);
+
+    return 1;
+}
+
+/*
+ * Take the oldest task from a ring. Returns NULL_PTR, if the ring is empty.
+ */
+static WorkerTask *takeWorkerTask(WorkerRing *ring)
+{
+    WorkerRingSlot *slot;
+    WorkerTask *task;
+    long position, distance;
+
+    position = ring->takePosition;
+    for (;;) {
+	slot = &(ring->slots[position & ring->mask]);
+	distance = ringDistance(slot->sequence, ringAdvance(position, 1));
+	memoryBarrier();
+	if (distance == 0) {
+	    /* the slot holds a task; claim the position */
+	    if (atomicCompareAndSwap(&(ring->takePosition), position, ringAdvance(position, 1))) {
+		break;
+	    }
+	} else if (distance < 0) {
+	    /* the task for this position has not been put yet */
+	    return NULL_PTR;
+	}
+	position = ring->takePosition;
+    }
+
+    task = slot->task;
+    memoryBarrier();
+    slot->sequence = ringAdvance(position, ring->mask + 1);
+
+    return task;
+}
+
+/*
+ * Give back a reference to a shared mechanism and free it with the last one.
+ */
+static void releaseWorkerMechanism(WorkerMechanism *mechanism)
+{
+    if (atomicDecrement(&(mechanism->referenceCount)) == 0) {
+	if (mechanism->mechanism.pParameter != NULL_PTR) {
+	    freeCKMechanismParameter(&(mechanism->mechanism));
+	}
+	free(mechanism);
+    }
+}
+
+/*
+ * Free a task with its input or output.
+ */
+static void freeWorkerTask(WorkerTask *task)
+{
+    if (task->mechanism != NULL_PTR) {
+	releaseWorkerMechanism(task->mechanism);
+    }
+    free(task->pInput);
+    scratchFree(task->pOutput);
+    free(task);
+}
+
+/*
+ * Run a request with the session of a worker and store the result in the task.
+ * The input and mechanism are given back.
+ */
+static void runWorkerTask(WorkerPool *pool, CK_SESSION_HANDLE hSession, WorkerTask *task)
+{
+    InitFunction init;
+    OutputFunction function;
+    int operation;
+
+    switch (task->operation) {
+    case WORKER_SIGN:
+	init = callSignInit;
+	function = callSign;
+	operation = OUTPUT_SIGN;
+	break;
+    case WORKER_ENCRYPT:
+	init = callEncryptInit;
+	function = callEncrypt;
+	operation = OUTPUT_ENCRYPT;
+	break;
+    case WORKER_DECRYPT:
+	init = callDecryptInit;
+	function = callDecrypt;
+	operation = OUTPUT_DECRYPT;
+	break;
+    case WORKER_DIGEST:
+	init = callDigestInit;
+	function = callDigest;
+	operation = OUTPUT_DIGEST;
+	break;
+    default:
+	init = NULL_PTR;
+	function = NULL_PTR;
+	operation = OUTPUT_OPERATIONS;
+	break;
+    }
+
+    if (init != NULL_PTR) {
+	task->rv = callOneShot(pool->moduleData, pool->ckpFunctions, init, function, operation, hSession,
+			       &(task->mechanism->mechanism), task->hKey, task->pInput, task->ulInputLen,
+			       &(task->pOutput), &(task->ulOutputLen));
+    } else {
+	task->rv = CKR_FUNCTION_NOT_SUPPORTED;
+    }
+
+    free(task->pInput);
+    task->pInput = NULL_PTR;
+    task->ulInputLen = 0;
+    releaseWorkerMechanism(task->mechanism);
+    task->mechanism = NULL_PTR;
+}
+
+/*
+ * The function of a worker thread. It runs requests until the pool stops. The
+ * outputs are taken from the heap, so that the polling thread can free them.
+ */
+static void runWorker(void *argument)
+{
+    WorkerThread *worker = (WorkerThread *) argument;
+    WorkerPool *pool = worker->pool;
+    WorkerTask *task;
+
+    beginHeapScratch();
+    while (!pool->stopping) {
+	task = takeWorkerTask(&(pool->submissions));
+	if (task == NULL_PTR) {
+	    /* check again after announcing the sleep, a submitter may have missed it */
+	    atomicIncrement(&(pool->idleWorkers));
+	    task = takeWorkerTask(&(pool->submissions));
+	    if (task == NULL_PTR && !pool->stopping) {
+		waitNativeSignal(pool->workSignal, -1);
+	    }
+	    atomicDecrement(&(pool->idleWorkers));
+	    if (task == NULL_PTR) {
+		continue;
+	    }
+	}
+
+	runWorkerTask(pool, worker->hSession, task);
+	putWorkerTask(&(pool->completions), task);
+	memoryBarrier();
+	if (pool->waitingPollers > 0) {
+	    raiseNativeSignal(pool->completionSignal, 1);
+	}
+    }
+    endHeapScratch();
+}
+
+/*
+ * Take up to max - count results from the completion ring to tasks[count], ...
+ * and return the new count. The results taken are no longer in flight.
+ */
+static jsize takeWorkerResults(WorkerPool *pool, WorkerTask **tasks, jsize count, jsize max)
+{
+    WorkerTask *task;
+    jsize first = count;
+
+    while (count < max && (task = takeWorkerTask(&(pool->completions))) != NULL_PTR) {
+	tasks[count++] = task;
+    }
+    if (count > first) {
+	addWorkerCount(&(pool->inFlight), -((long) (count - first)));
+    }
+
+    return count;
+}
+
+/*
+ * Make a pool stop and wake up its sleeping threads and pollers. The pool
+ * stays allocated, so that running calls may complete.
+ */
+static void stopWorkerPool(WorkerPool *pool)
+{
+    long waitingPollers;
+
+    pool->stopping = 1;
+    memoryBarrier();
+    /* a poller about to sleep checks stopping after announcing the sleep */
+    waitingPollers = pool->waitingPollers;
+    if (pool->completionSignal != NULL_PTR && waitingPollers > 0) {
+	raiseNativeSignal(pool->completionSignal, waitingPollers);
+    }
+    if (pool->workers != NULL_PTR && pool->workSignal != NULL_PTR) {
+	raiseNativeSignal(pool->workSignal, pool->workerCount);
+    }
+}
+
+/*
+ * Stop the threads of a pool, free all pending tasks and the pool itself and
+ * give back the reference to the module. No other call may use the pool at the
+ * same time; the Java side stops the pool and waits for its running calls
+ * first. This also works for a pool, which was created only in part.
+ */
+static void destroyWorkerPool(WorkerPool *pool)
+{
+    WorkerTask *task;
+    long i;
+
+    stopWorkerPool(pool);
+    if (pool->workers != NULL_PTR) {
+	for (i = 0; i < pool->workerCount; i++) {
+	    if (pool->workers[i].thread != NULL_PTR) {
+		joinNativeThread(pool->workers[i].thread);
+	    }
+	}
+	free(pool->workers);
+    }
+
+    if (pool->submissions.slots != NULL_PTR) {
+	while ((task = takeWorkerTask(&(pool->submissions))) != NULL_PTR) {
+	    freeWorkerTask(task);
+	}
+	free(pool->submissions.slots);
+    }
+    if (pool->completions.slots != NULL_PTR) {
+	while ((task = takeWorkerTask(&(pool->completions))) != NULL_PTR) {
+	    freeWorkerTask(task);
+	}
+	free(pool->completions.slots);
+    }
+    if (pool->workSignal != NULL_PTR) {
+	destroyNativeSignal(pool->workSignal);
+    }
+    if (pool->completionSignal != NULL_PTR) {
+	destroyNativeSignal(pool->completionSignal);
+    }
+
+    releaseModuleEntry(pool->moduleData);
+    free(pool);
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolCreate
+ * Signature: ([JI)J
+ * Parametermapping:                    *PKCS11*
+ * @param   jlongArray jSessionHandles  CK_SESSION_HANDLE hSession of each worker thread
+ * @param   jint jCapacity              the maximum number of requests submitted, but not polled
+ * @return  jlong jPool                 the native handle of the pool
+ */
+JNIEXPORT jlong JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolCreate
+    (JNIEnv *env, jobject obj, jlongArray jSessionHandles, jint jCapacity)
+{
+    WorkerPool *pool;
+    jlong *jpSessionHandles;
+    long ringCapacity;
+    jsize jCount, i;
+    ModuleData *moduleData;
+    CK_FUNCTION_LIST_PTR ckpFunctions;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    moduleData = getModuleEntry(env, obj);
+    if (moduleData == NULL_PTR) {
+	throwDisconnectedRuntimeException(env);
+	return 0L;
+    }
+    ckpFunctions = getFunctionList(env, moduleData);
+    if (ckpFunctions == NULL_PTR) {
+	releaseModuleEntry(moduleData);
+	return 0L;
+    }
+
+    if (jSessionHandles == NULL_PTR || (*env)->GetArrayLength(env, jSessionHandles) == 0
+	|| jCapacity <= 0 || jCapacity > WORKER_MAX_CAPACITY) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "A worker pool needs sessions and a valid capacity."));
+	releaseModuleEntry(moduleData);
+	return 0L;
+    }
+    jCount = (*env)->GetArrayLength(env, jSessionHandles);
+    ringCapacity = 2;
+    while (ringCapacity < jCapacity) {
+	ringCapacity <<= 1;
+    }
+
+    pool = (WorkerPool *) calloc(1, sizeof(WorkerPool));
+    if (pool == NULL_PTR) {
+	throwOutOfMemoryError(env);
+	releaseModuleEntry(moduleData);
+	return 0L;
+    }
+    /* the pool holds the reference to the module until it is destroyed */
+    pool->moduleData = moduleData;
+    pool->ckpFunctions = ckpFunctions;
+    pool->capacity = jCapacity;
+    pool->workerCount = jCount;
+    pool->workers = (WorkerThread *) calloc(jCount, sizeof(WorkerThread));
+    pool->workSignal = createNativeSignal();
+    pool->completionSignal = createNativeSignal();
+    jpSessionHandles = (jlong *) scratchAlloc(jCount * sizeof(jlong));
+    if (pool->workers == NULL_PTR || pool->workSignal == NULL_PTR || pool->completionSignal == NULL_PTR
+	|| jpSessionHandles == NULL_PTR || !initWorkerRing(&(pool->submissions), ringCapacity)
+	|| !initWorkerRing(&(pool->completions), ringCapacity)) {
+	scratchFree(jpSessionHandles);
+	destroyWorkerPool(pool);
+	throwOutOfMemoryError(env);
+	return 0L;
+    }
+
+    (*env)->GetLongArrayRegion(env, jSessionHandles, 0, jCount, jpSessionHandles);
+    for (i = 0; i < jCount; i++) {
+	pool->workers[i].pool = pool;
+	pool->workers[i].hSession = jLongToCKULong(jpSessionHandles[i]);
+    }
+    scratchFree(jpSessionHandles);
+
+    for (i = 0; i < jCount; i++) {
+	pool->workers[i].thread = startNativeThread(runWorker, &(pool->workers[i]));
+	if (pool->workers[i].thread == NULL_PTR) {
+	    destroyWorkerPool(pool);
+	    throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "Starting a worker thread failed."));
+	    return 0L;
+	}
+    }
+
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return (jlong) (size_t) pool;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolSubmit
+ * Signature: (JILiaik/pkcs/pkcs11/wrapper/CK_MECHANISM;J[J[[BZ)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jPool                 the native handle of the pool
+ * @param   jint jOperation             the operation, one of the WORKER_* constants
+ * @param   jobject jMechanism          CK_MECHANISM_PTR pMechanism
+ * @param   jlong jKeyHandle            CK_OBJECT_HANDLE hKey
+ * @param   jlongArray jIds             the id of each request
+ * @param   jobjectArray jData          CK_BYTE_PTR pData
+ *                                      CK_ULONG ulDataLen
+ * @return  jint jAccepted              the number of requests accepted, from the first on
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolSubmit
+    (JNIEnv *env, jobject obj, jlong jPool, jint jOperation, jobject jMechanism, jlong jKeyHandle,
+     jlongArray jIds, jobjectArray jData, jboolean jUseUtf8)
+{
+    WorkerPool *pool = (WorkerPool *) (size_t) jPool;
+    WorkerMechanism *mechanism;
+    WorkerTask **tasks;
+    jbyteArray jItem;
+    jlong *jpIds;
+    jsize jCount;
+    long inFlight, accepted, idleWorkers, i;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    if (pool == NULL_PTR || jMechanism == NULL_PTR || jIds == NULL_PTR || jData == NULL_PTR
+	|| (*env)->GetArrayLength(env, jIds) < (*env)->GetArrayLength(env, jData)) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The id array must be as long as the data array."));
+	return 0;
+    }
+    jCount = (*env)->GetArrayLength(env, jData);
+    if (pool->stopping) {
+	TRACE0(tag_call, __FUNCTION__, "exiting ");
+	return 0;
+    }
+
+    /* reserve room for as many requests as fit */
+    do {
+	inFlight = pool->inFlight;
+	accepted = pool->capacity - inFlight;
+	if (accepted > jCount) {
+	    accepted = jCount;
+	}
+	if (accepted <= 0) {
+	    TRACE0(tag_call, __FUNCTION__, "exiting ");
+	    return 0;
+	}
+    } while (!atomicCompareAndSwap(&(pool->inFlight), inFlight, inFlight + accepted));
+
+    mechanism = (WorkerMechanism *) malloc(sizeof(WorkerMechanism));
+    tasks = (WorkerTask **) scratchAlloc(accepted * sizeof(WorkerTask *));
+    jpIds = (jlong *) scratchAlloc(accepted * sizeof(jlong));
+    if (mechanism == NULL_PTR || tasks == NULL_PTR || jpIds == NULL_PTR) {
+	scratchFree(jpIds);
+	scratchFree(tasks);
+	free(mechanism);
+	addWorkerCount(&(pool->inFlight), -accepted);
+	throwOutOfMemoryError(env);
+	return 0;
+    }
+
+    /* the mechanism is converted once for all requests, on the heap, as the workers free it */
+    beginHeapScratch();
+    mechanism->mechanism = jMechanismToCKMechanism(env, jMechanism, jUseUtf8);
+    endHeapScratch();
+    mechanism->referenceCount = 1;
+    (*env)->GetLongArrayRegion(env, jIds, 0, accepted, jpIds);
+
+    /* convert all requests first, so that a failure submits none */
+    for (i = 0; i < accepted && !(*env)->ExceptionOccurred(env); i++) {
+	tasks[i] = (WorkerTask *) calloc(1, sizeof(WorkerTask));
+	if (tasks[i] == NULL_PTR) {
+	    throwOutOfMemoryError(env);
+	    break;
+	}
+	tasks[i]->id = jpIds[i];
+	tasks[i]->operation = jOperation;
+	tasks[i]->hKey = jLongToCKULong(jKeyHandle);
+	jItem = (jbyteArray) (*env)->GetObjectArrayElement(env, jData, i);
+	if (jItem == NULL_PTR) {
+	    /* leaves the input empty */
+	    continue;
+	}
+	jByteArrayToCKByteArray(env, jItem, &(tasks[i]->pInput), &(tasks[i]->ulInputLen));
+	(*env)->DeleteLocalRef(env, jItem);
+    }
+    if ((*env)->ExceptionOccurred(env)) {
+	while (i-- > 0) {
+	    if (tasks[i] != NULL_PTR) {
+		freeWorkerTask(tasks[i]);
+	    }
+	}
+	addWorkerCount(&(pool->inFlight), -accepted);
+	accepted = 0;
+    }
+
+    for (i = 0; i < accepted; i++) {
+	atomicIncrement(&(mechanism->referenceCount));
+	tasks[i]->mechanism = mechanism;
+	/* the reservation guarantees the room */
+	putWorkerTask(&(pool->submissions), tasks[i]);
+    }
+    releaseWorkerMechanism(mechanism);
+    scratchFree(jpIds);
+    scratchFree(tasks);
+
+    /* wake up sleeping workers; a worker about to sleep checks the ring once more */
+    memoryBarrier();
+    idleWorkers = pool->idleWorkers;
+    if (accepted > 0 && idleWorkers > 0) {
+	raiseNativeSignal(pool->workSignal, (idleWorkers < accepted) ? idleWorkers : accepted);
+    }
+
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return (jint) accepted;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolPoll
+ * Signature: (J[J[J[[BJ)I
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jPool                 the native handle of the pool
+ * @param   jlongArray jIds             receives the id of each result
+ * @param   jlongArray jResults         receives the CK_RV of each result
+ * @param   jobjectArray jOutputs       receives the CK_BYTE_PTR pOutput of each result
+ *                                      CK_ULONG_PTR pulOutputLen
+ * @param   jlong jTimeout              the milliseconds to wait for the first result; negative to
+ *                                      wait as long as it takes, 0 not to wait; the wait ends
+ *                                      early, if no request is in flight or the pool stops
+ * @return  jint jCount                 the number of results
+ */
+JNIEXPORT jint JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolPoll
+    (JNIEnv *env, jobject obj, jlong jPool, jlongArray jIds, jlongArray jResults, jobjectArray jOutputs,
+     jlong jTimeout)
+{
+    WorkerPool *pool = (WorkerPool *) (size_t) jPool;
+    WorkerTask **tasks;
+    jbyteArray jOutput;
+    jlong *jpIds, *jpResults;
+    jsize jMax, jCount, i;
+    long deadline = 0, wait;
+    int idle, stopping = 0;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    if (pool == NULL_PTR || jIds == NULL_PTR || jResults == NULL_PTR || jOutputs == NULL_PTR
+	|| (*env)->GetArrayLength(env, jResults) < (*env)->GetArrayLength(env, jIds)
+	|| (*env)->GetArrayLength(env, jOutputs) < (*env)->GetArrayLength(env, jIds)) {
+	throwPKCS11RuntimeException(env, (*env)->NewStringUTF(env, "The result arrays must be as long as the id array."));
+	return 0;
+    }
+    jMax = (*env)->GetArrayLength(env, jIds);
+    if (jMax > pool->capacity) {
+	jMax = (jsize) pool->capacity;
+    }
+    tasks = (WorkerTask **) scratchAlloc((jMax + 1) * sizeof(WorkerTask *));
+    jpIds = (jlong *) scratchAlloc((jMax + 1) * sizeof(jlong));
+    jpResults = (jlong *) scratchAlloc((jMax + 1) * sizeof(jlong));
+    if (tasks == NULL_PTR || jpIds == NULL_PTR || jpResults == NULL_PTR) {
+	scratchFree(jpResults);
+	scratchFree(jpIds);
+	scratchFree(tasks);
+	throwOutOfMemoryError(env);
+	return 0;
+    }
+
+    jCount = takeWorkerResults(pool, tasks, 0, jMax);
+    if (jTimeout > 0) {
+	/* another poller may take the result, which woke us up; never wait longer in total */
+	deadline = ringAdvance(getNativeMilliseconds(), (jTimeout < WORKER_MAX_TIMEOUT) ? jTimeout : WORKER_MAX_TIMEOUT);
+    }
+    /* wait for the first result; a worker checks for sleeping pollers after each put */
+    while (jCount == 0 && jMax > 0 && jTimeout != 0 && !stopping) {
+	wait = WORKER_WAIT_SLICE;
+	if (jTimeout > 0) {
+	    wait = ringDistance(deadline, getNativeMilliseconds());
+	    if (wait <= 0) {
+		break;
+	    }
+	    if (wait > WORKER_WAIT_SLICE) {
+		wait = WORKER_WAIT_SLICE;
+	    }
+	}
+	atomicIncrement(&(pool->waitingPollers));
+	jCount = takeWorkerResults(pool, tasks, 0, jMax);
+	/* with no request in flight, no result can come */
+	idle = (jCount == 0 && pool->inFlight == 0);
+	if (jCount == 0 && !idle && !pool->stopping) {
+	    waitNativeSignal(pool->completionSignal, wait);
+	    jCount = takeWorkerResults(pool, tasks, 0, jMax);
+	}
+	stopping = (int) pool->stopping;
+	atomicDecrement(&(pool->waitingPollers));
+	if (idle) {
+	    break;
+	}
+    }
+
+    for (i = 0; i < jCount; i++) {
+	jpIds[i] = tasks[i]->id;
+	jpResults[i] = ckULongToJLong(tasks[i]->rv);
+	jOutput = NULL_PTR;
+	if (tasks[i]->rv == CKR_OK && !(*env)->ExceptionOccurred(env)) {
+	    jOutput = ckByteArrayToJByteArray(env, tasks[i]->pOutput, tasks[i]->ulOutputLen);
+	}
+	if (!(*env)->ExceptionOccurred(env)) {
+	    (*env)->SetObjectArrayElement(env, jOutputs, i, jOutput);
+	}
+	if (jOutput != NULL_PTR) {
+	    (*env)->DeleteLocalRef(env, jOutput);
+	}
+	freeWorkerTask(tasks[i]);
+    }
+    if (jCount > 0 && !(*env)->ExceptionOccurred(env)) {
+	(*env)->SetLongArrayRegion(env, jIds, 0, jCount, jpIds);
+	(*env)->SetLongArrayRegion(env, jResults, 0, jCount, jpResults);
+    }
+
+    scratchFree(jpResults);
+    scratchFree(jpIds);
+    scratchFree(tasks);
+
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+    return jCount;
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolStop
+ * Signature: (J)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jPool                 the native handle of the pool
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolStop
+    (JNIEnv *env, jobject obj, jlong jPool)
+{
+    WorkerPool *pool = (WorkerPool *) (size_t) jPool;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    if (pool != NULL_PTR) {
+	stopWorkerPool(pool);
+    }
+
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
+
+/*
+ * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
+ * Method:    C_WorkerPoolDestroy
+ * Signature: (J)V
+ * Parametermapping:                    *PKCS11*
+ * @param   jlong jPool                 the native handle of the pool
+ */
+JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_C_1WorkerPoolDestroy
+    (JNIEnv *env, jobject obj, jlong jPool)
+{
+    WorkerPool *pool = (WorkerPool *) (size_t) jPool;
+
+    TRACE0(tag_call, __FUNCTION__, "entering");
+
+    if (pool != NULL_PTR) {
+	destroyWorkerPool(pool);
+    }
+
+    TRACE0(tag_call, __FUNCTION__, "exiting ");
+}
@@ -55,6 +55,15 @@
 #include "pkcs11wrapper.h"
 #include "platform.h"
 
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <time.h>
+#ifdef __SUNPRO_C
+#include <atomic.h>
+#endif /* __SUNPRO_C */
+
 
 /*
  * Class:     iaik_pkcs_pkcs11_wrapper_PKCS11Implementation
@@ -68,7 +77,6 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_connec
   CK_C_GetFunctionList C_GetFunctionList;
   CK_RV rv;
   ModuleData *moduleData;
-  jobject globalPKCS11ImplementationReference;
   char *systemErrorMessage;
   char *exceptionMessage;
 
@@ -111,14 +119,18 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_connec
   /*
    * Get function pointers to all PKCS #11 functions
    */
-  moduleData = (ModuleData *) malloc(sizeof(ModuleData));
+  moduleData = newModuleEntry(env);
+  if (moduleData == NULL_PTR) {
+    dlclose(hModule);
+    (*env)->ReleaseStringUTFChars(env, jPkcs11ModulePath, libraryNameStr);
+    return;
+  }
   moduleData->hModule = hModule;
   moduleData->applicationMutexHandler = NULL_PTR;
   rv = (C_GetFunctionList)(&(moduleData->ckFunctionListPtr));
   ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
-  globalPKCS11ImplementationReference = (*env)->NewGlobalRef(env, obj);
-  putModuleEntry(env, globalPKCS11ImplementationReference, moduleData);
+  putModuleEntry(env, obj, moduleData);
 
   (*env)->ReleaseStringUTFChars(env, jPkcs11ModulePath, libraryNameStr);
   TRACE0(tag_call, __FUNCTION__,"exiting");
@@ -137,10 +149,462 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_discon
   TRACE0(tag_debug, __FUNCTION__,"disconnecting module...");
   moduleData = removeModuleEntry(env, obj);
 
-	if (moduleData != NULL_PTR) {
-		dlclose(moduleData->hModule);
-	}
+  /* unloads the module, as soon as no other thread is using it any longer */
+  if (moduleData != NULL_PTR) {
+    releaseModuleEntry(moduleData);
+  }
 
-  free(moduleData);
   TRACE0(tag_call, __FUNCTION__,"exiting");
 }
+
+/*
+ * Unloads the shared library of the given module. This is called when the last
+ * reference to the module data is released.
+ */
+void unloadModule(ModuleData *moduleData)
+{
+  if (moduleData->hModule != NULL_PTR) {
+    dlclose(moduleData->hModule);
+    moduleData->hModule = NULL_PTR;
+  }
+}
+
+/*
+ * Atomically increments the given value and returns the new value.
+ */
+long atomicIncrement(volatile long *value)
+{
+#ifdef __SUNPRO_C
+  return (long) atomic_inc_ulong_nv((volatile ulong_t *) value);
+#else
+  return __sync_add_and_fetch(value, 1);
+#endif /* __SUNPRO_C */
+}
+
+/*
+ * Atomically decrements the given value and returns the new value.
+ */
+long atomicDecrement(volatile long *value)
+{
+#ifdef __SUNPRO_C
+  return (long) atomic_dec_ulong_nv((volatile ulong_t *) value);
+#else
+  return __sync_sub_and_fetch(value, 1);
+#endif /* __SUNPRO_C */
+}
+
+/*
+ * Atomically sets the given value to newValue, if it currently is expectedValue.
+ * Returns 1, if the value was set; 0, otherwise.
+ */
+int atomicCompareAndSwap(volatile long *value, long expectedValue, long newValue)
+{
+#ifdef __SUNPRO_C
+  return (atomic_cas_ulong((volatile ulong_t *) value, (ulong_t) expectedValue, (ulong_t) newValue) == (ulong_t) expectedValue) ? 1 : 0;
+#else
+  return __sync_bool_compare_and_swap(value, expectedValue, newValue) ? 1 : 0;
+#endif /* __SUNPRO_C */
+}
+
+/*
+ * Atomically sets the given pointer to newValue, if it currently is
+ * expectedValue. Returns 1, if the pointer was set; 0, otherwise.
+ */
+int atomicCompareAndSwapPointer(void * volatile *value, void *expectedValue, void *newValue)
+{
+#ifdef __SUNPRO_C
+  return (atomic_cas_ptr(value, expectedValue, newValue) == expectedValue) ? 1 : 0;
+#else
+  return __sync_bool_compare_and_swap(value, expectedValue, newValue) ? 1 : 0;
+#endif /* __SUNPRO_C */
+}
+
+/*
+ * Lets other threads run, e.g. while spinning for a lock held by a thread,
+ * which was preempted.
+ */
+void yieldNativeThread(void)
+{
+  sched_yield();
+}
+
+/* The key of the thread-specific value, which tells that a thread was attached
+ * to the VM for callbacks. Its destructor detaches the thread.
+ */
+static pthread_key_t attachedThreadKey;
+static int attachedThreadKeyCreated = 0;
+
+/*
+ * Detaches a terminating thread, which was attached by attachCurrentThread.
+ */
+static void detachTerminatingThread(void *vm)
+{
+  (*((JavaVM *) vm))->DetachCurrentThread((JavaVM *) vm);
+}
+
+/*
+ * Creates the key for remembering attached threads. This is called once, when
+ * the library is loaded.
+ */
+void initializeThreadAttachment(void)
+{
+  if (!attachedThreadKeyCreated) {
+    attachedThreadKeyCreated = (pthread_key_create(&attachedThreadKey, &detachTerminatingThread) == 0);
+  }
+}
+
+/*
+ * Deletes the key for remembering attached threads. Threads that are still
+ * attached stay attached.
+ */
+void finalizeThreadAttachment(void)
+{
+  if (attachedThreadKeyCreated) {
+    pthread_key_delete(attachedThreadKey);
+    attachedThreadKeyCreated = 0;
+  }
+}
+
+/*
+ * Attaches the calling native thread to the VM as daemon thread. It stays
+ * attached for following callbacks and gets detached, when it terminates.
+ * Returns NULL_PTR, if attaching fails.
+ */
+JNIEnv *attachCurrentThread(JavaVM *vm)
+{
+  JNIEnv *env;
+
+  if ((*vm)->AttachCurrentThreadAsDaemon(vm, (void **) &env, NULL_PTR) != JNI_OK) {
+    return NULL_PTR;
+  }
+  if (attachedThreadKeyCreated) {
+    pthread_setspecific(attachedThreadKey, vm);
+  }
+
+  return env;
+}
+
+/* The key of the thread-specific value, which holds the scratch arena of a
+ * thread. Its destructor frees the arena.
+ */
+static pthread_key_t scratchArenaKey;
+static int scratchArenaKeyCreated = 0;
+
+/*
+ * Creates the key for the scratch arenas. This is called once, when the
+ * library is loaded.
+ */
+void initializeScratchArenas(void)
+{
+  if (!scratchArenaKeyCreated) {
+    scratchArenaKeyCreated = (pthread_key_create(&scratchArenaKey, &freeScratchArena) == 0);
+  }
+}
+
+/*
+ * Deletes the key for the scratch arenas. The arenas of threads that are still
+ * alive are not freed.
+ */
+void finalizeScratchArenas(void)
+{
+  if (scratchArenaKeyCreated) {
+    pthread_key_delete(scratchArenaKey);
+    scratchArenaKeyCreated = 0;
+  }
+}
+
+/*
+ * Returns the scratch arena of the calling thread or NULL_PTR, if it has none.
+ */
+void *getThreadScratchArena(void)
+{
+  return scratchArenaKeyCreated ? pthread_getspecific(scratchArenaKey) : NULL_PTR;
+}
+
+/*
+ * Sets the scratch arena of the calling thread. Returns 0, if it cannot be set.
+ */
+int setThreadScratchArena(void *arena)
+{
+  return (scratchArenaKeyCreated && pthread_setspecific(scratchArenaKey, arena) == 0) ? 1 : 0;
+}
+
+/* A mutex for the module. It remembers the thread that holds it, so that
+ * unlocking a mutex, which the calling thread does not hold, fails with
+ * CKR_MUTEX_NOT_LOCKED as PKCS#11 requires.
+ */
+struct NativeMutex {
+  pthread_mutex_t mutex;
+  pthread_t owner;
+  int locked;
+};
+typedef struct NativeMutex NativeMutex;
+
+/*
+ * Creates a new pthread mutex for the module.
+ */
+CK_RV createNativeMutex(CK_VOID_PTR_PTR ppMutex)
+{
+  NativeMutex *nativeMutex;
+  int error;
+
+  if (ppMutex == NULL_PTR) {
+    return CKR_ARGUMENTS_BAD;
+  }
+  nativeMutex = (NativeMutex *) malloc(sizeof(NativeMutex));
+  if (nativeMutex == NULL_PTR) {
+    return CKR_HOST_MEMORY;
+  }
+  error = pthread_mutex_init(&(nativeMutex->mutex), NULL_PTR);
+  if (error != 0) {
+    free(nativeMutex);
+    return (error == ENOMEM) ? CKR_HOST_MEMORY : CKR_GENERAL_ERROR;
+  }
+  nativeMutex->locked = 0;
+  *ppMutex = nativeMutex;
+
+  return CKR_OK;
+}
+
+/*
+ * Destroys a mutex created by createNativeMutex.
+ */
+CK_RV destroyNativeMutex(CK_VOID_PTR pMutex)
+{
+  NativeMutex *nativeMutex = (NativeMutex *) pMutex;
+
+  if (nativeMutex == NULL_PTR) {
+    return CKR_MUTEX_BAD;
+  }
+  if (pthread_mutex_destroy(&(nativeMutex->mutex)) != 0) {
+    return CKR_GENERAL_ERROR;
+  }
+  free(nativeMutex);
+
+  return CKR_OK;
+}
+
+/*
+ * Locks a mutex created by createNativeMutex.
+ */
+CK_RV lockNativeMutex(CK_VOID_PTR pMutex)
+{
+  NativeMutex *nativeMutex = (NativeMutex *) pMutex;
+
+  if (nativeMutex == NULL_PTR) {
+    return CKR_MUTEX_BAD;
+  }
+  if (pthread_mutex_lock(&(nativeMutex->mutex)) != 0) {
+    return CKR_GENERAL_ERROR;
+  }
+  nativeMutex->owner = pthread_self();
+  nativeMutex->locked = 1;
+
+  return CKR_OK;
+}
+
+/*
+ * Unlocks a mutex created by createNativeMutex.
+ */
+CK_RV unlockNativeMutex(CK_VOID_PTR pMutex)
+{
+  NativeMutex *nativeMutex = (NativeMutex *) pMutex;
+
+  if (nativeMutex == NULL_PTR) {
+    return CKR_MUTEX_BAD;
+  }
+  /* only the holding thread can see itself as owner of a locked mutex */
+  if (!nativeMutex->locked || !pthread_equal(nativeMutex->owner, pthread_self())) {
+    return CKR_MUTEX_NOT_LOCKED;
+  }
+  nativeMutex->locked = 0;
+  if (pthread_mutex_unlock(&(nativeMutex->mutex)) != 0) {
+    return CKR_GENERAL_ERROR;
+  }
+
+  return CKR_OK;
+}
+
+/* The function and argument of a thread started by startNativeThread. */
+struct NativeThread {
+  pthread_t thread;
+  NativeThreadFunction function;
+  void *argument;
+};
+typedef struct NativeThread NativeThread;
+
+/*
+ * Runs the function of a thread started by startNativeThread.
+ */
+static void *runNativeThread(void *thread)
+{
+  (*((NativeThread *) thread)->function)(((NativeThread *) thread)->argument);
+
+  return NULL_PTR;
+}
+
+/*
+ * Starts a new thread running the given function with the given argument.
+ * Returns NULL_PTR, if the thread cannot be started; otherwise, the caller
+ * must call joinNativeThread for the returned thread.
+ */
+void *startNativeThread(NativeThreadFunction function, void *argument)
+{
+  NativeThread *nativeThread;
+
+  nativeThread = (NativeThread *) malloc(sizeof(NativeThread));
+  if (nativeThread == NULL_PTR) {
+    return NULL_PTR;
+  }
+  nativeThread->function = function;
+  nativeThread->argument = argument;
+  if (pthread_create(&(nativeThread->thread), NULL_PTR, &runNativeThread, nativeThread) != 0) {
+    free(nativeThread);
+    return NULL_PTR;
+  }
+
+  return nativeThread;
+}
+
+/*
+ * Waits until a thread started by startNativeThread has terminated and frees it.
+ */
+void joinNativeThread(void *thread)
+{
+  pthread_join(((NativeThread *) thread)->thread, NULL_PTR);
+  free(thread);
+}
+
+/* A counting signal; each raise lets one wait return. */
+struct NativeSignal {
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+  long count;
+};
+typedef struct NativeSignal NativeSignal;
+
+/*
+ * Creates a new signal, which is not raised. Returns NULL_PTR, if it cannot be
+ * created.
+ */
+void *createNativeSignal(void)
+{
+  NativeSignal *nativeSignal;
+
+  nativeSignal = (NativeSignal *) malloc(sizeof(NativeSignal));
+  if (nativeSignal == NULL_PTR) {
+    return NULL_PTR;
+  }
+  if (pthread_mutex_init(&(nativeSignal->mutex), NULL_PTR) != 0) {
+    free(nativeSignal);
+    return NULL_PTR;
+  }
+  if (pthread_cond_init(&(nativeSignal->condition), NULL_PTR) != 0) {
+    pthread_mutex_destroy(&(nativeSignal->mutex));
+    free(nativeSignal);
+    return NULL_PTR;
+  }
+  nativeSignal->count = 0;
+
+  return nativeSignal;
+}
+
+/*
+ * Destroys a signal created by createNativeSignal. No thread may wait for it.
+ */
+void destroyNativeSignal(void *signal)
+{
+  NativeSignal *nativeSignal = (NativeSignal *) signal;
+
+  pthread_cond_destroy(&(nativeSignal->condition));
+  pthread_mutex_destroy(&(nativeSignal->mutex));
+  free(nativeSignal);
+}
+
+/*
+ * Raises the signal count times; i.e. lets count waits return.
+ */
+void raiseNativeSignal(void *signal, long count)
+{
+  NativeSignal *nativeSignal = (NativeSignal *) signal;
+
+  pthread_mutex_lock(&(nativeSignal->mutex));
+  nativeSignal->count += count;
+  if (count == 1) {
+    pthread_cond_signal(&(nativeSignal->condition));
+  } else {
+    pthread_cond_broadcast(&(nativeSignal->condition));
+  }
+  pthread_mutex_unlock(&(nativeSignal->mutex));
+}
+
+/*
+ * Waits until the signal is raised or the timeout in milliseconds expires. A
+ * negative timeout waits as long as it takes. Returns 1, if the signal was
+ * raised, or 0, if the timeout expired.
+ */
+int waitNativeSignal(void *signal, long timeout)
+{
+  NativeSignal *nativeSignal = (NativeSignal *) signal;
+  struct timeval now;
+  struct timespec end;
+  int error = 0;
+  int raised = 0;
+
+  if (timeout >= 0) {
+    gettimeofday(&now, NULL_PTR);
+    end.tv_sec = now.tv_sec + timeout / 1000;
+    end.tv_nsec = now.tv_usec * 1000L + (timeout % 1000) * 1000000L;
+    if (end.tv_nsec >= 1000000000L) {
+      end.tv_sec++;
+      end.tv_nsec -= 1000000000L;
+    }
+  }
+  pthread_mutex_lock(&(nativeSignal->mutex));
+  while (nativeSignal->count == 0 && error == 0) {
+    error = (timeout >= 0)
+      ? pthread_cond_timedwait(&(nativeSignal->condition), &(nativeSignal->mutex), &end)
+      : pthread_cond_wait(&(nativeSignal->condition), &(nativeSignal->mutex));
+  }
+  if (nativeSignal->count > 0) {
+    nativeSignal->count--;
+    raised = 1;
+  }
+  pthread_mutex_unlock(&(nativeSignal->mutex));
+
+  return raised;
+}
+
+/*
+ * Returns the milliseconds of a clock, which never jumps back. Only the
+ * difference of two values, computed in unsigned arithmetic, has a meaning.
+ */
+long getNativeMilliseconds(void)
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec now;
+
+  if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+    return (long) ((unsigned long) now.tv_sec * 1000UL + (unsigned long) (now.tv_nsec / 1000000L));
+  }
+#endif /* CLOCK_MONOTONIC */
+  {
+    struct timeval time;
+
+    gettimeofday(&time, NULL_PTR);
+    return (long) ((unsigned long) time.tv_sec * 1000UL + (unsigned long) (time.tv_usec / 1000L));
+  }
+}
+
+/*
+ * Orders all memory accesses before this call before all accesses after it.
+ */
+void memoryBarrier(void)
+{
+#ifdef __SUNPRO_C
+  membar_enter();
+  membar_exit();
+#else
+  __sync_synchronize();
+#endif /* __SUNPRO_C */
+}
@@ -86,7 +86,56 @@ struct ModuleData {
   /* Reference to the object to use for mutex handling. NULL, if not used. */
   jobject applicationMutexHandler;
 
+  /* The number of references to this data; one held by the connection and one
+   * by each native call currently using the module. Zero, if unloaded.
+   */
+  volatile long referenceCount;
+
+  /* The next unused entry, while this data is kept for reuse. */
+  struct ModuleData *next;
+
+  /* The expected output lengths of the sessions of this module. */
+  struct OutputLengthSlot *outputLengthSlots;
+
 };
 typedef struct ModuleData ModuleData;
 
+/* Atomic operations used for reference counting module data. */
+long atomicIncrement(volatile long *value);
+long atomicDecrement(volatile long *value);
+int atomicCompareAndSwap(volatile long *value, long expectedValue, long newValue);
+int atomicCompareAndSwapPointer(void * volatile *value, void *expectedValue, void *newValue);
+void yieldNativeThread(void);
+
+/* Unloads the module (DLL or shared library) of the given module data. */
+void unloadModule(ModuleData *moduleData);
+
+/* Keeping native threads of the module attached to the VM for callbacks. */
+void initializeThreadAttachment(void);
+void finalizeThreadAttachment(void);
+JNIEnv *attachCurrentThread(JavaVM *vm);
+
+/* The thread-specific value, which holds the scratch arena of a thread. */
+void initializeScratchArenas(void);
+void finalizeScratchArenas(void);
+void *getThreadScratchArena(void);
+int setThreadScratchArena(void *arena);
+
+/* Mutex functions for the module, which use the mutexes of the operating system. */
+CK_RV createNativeMutex(CK_VOID_PTR_PTR ppMutex);
+CK_RV destroyNativeMutex(CK_VOID_PTR pMutex);
+CK_RV lockNativeMutex(CK_VOID_PTR pMutex);
+CK_RV unlockNativeMutex(CK_VOID_PTR pMutex);
+
+/* Threads, signals and memory barriers for the native worker pool. */
+typedef void (*NativeThreadFunction) (void *argument);
+void *startNativeThread(NativeThreadFunction function, void *argument);
+void joinNativeThread(void *thread);
+void *createNativeSignal(void);
+void destroyNativeSignal(void *signal);
+void raiseNativeSignal(void *signal, long count);
+int waitNativeSignal(void *signal, long timeout);
+long getNativeMilliseconds(void);
+void memoryBarrier(void);
+
 #endif //PLATFORM_H
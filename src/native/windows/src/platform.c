@@ -68,7 +68,6 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_connec
   CK_C_GetFunctionList C_GetFunctionList;
   CK_RV rv;
   ModuleData *moduleData;
-  jobject globalPKCS11ImplementationReference;
   LPVOID lpMsgBuf;
   char *exceptionMessage;
 
@@ -128,14 +127,18 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_connec
   /*
    * Get function pointers to all PKCS #11 functions
    */
-  moduleData = (ModuleData *) malloc(sizeof(ModuleData));
+  moduleData = newModuleEntry(env);
+  if (moduleData == NULL) {
+    FreeLibrary(hModule);
+    (*env)->ReleaseStringUTFChars(env, jPkcs11ModulePath, libraryNameStr);
+    return;
+  }
   moduleData->hModule = hModule;
   moduleData->applicationMutexHandler = NULL;
   rv = (C_GetFunctionList)(&(moduleData->ckFunctionListPtr));
   ckAssertReturnValueOK(env, rv, __FUNCTION__);
 
-  globalPKCS11ImplementationReference = (*env)->NewGlobalRef(env, obj);
-  putModuleEntry(env, globalPKCS11ImplementationReference, moduleData);
+  putModuleEntry(env, obj, moduleData);
 
   (*env)->ReleaseStringUTFChars(env, jPkcs11ModulePath, libraryNameStr);
 
@@ -156,11 +159,339 @@ JNIEXPORT void JNICALL Java_iaik_pkcs_pkcs11_wrapper_PKCS11Implementation_discon
   TRACE0(tag_debug, __FUNCTION__, "disconnecting module...");
   moduleData = removeModuleEntry(env, obj);
 
-	if (moduleData != NULL) {
-		FreeLibrary(moduleData->hModule);
-	}
-
-  free(moduleData);
+  /* unloads the module, as soon as no other thread is using it any longer */
+  if (moduleData != NULL) {
+    releaseModuleEntry(moduleData);
+  }
 
   TRACE0(tag_call, __FUNCTION__, "exiting ");
 }
+
+/*
+ * Unloads the DLL of the given module. This is called when the last reference
+ * to the module data is released.
+ */
+void unloadModule(ModuleData *moduleData)
+{
+  if (moduleData->hModule != NULL) {
+    FreeLibrary(moduleData->hModule);
+    moduleData->hModule = NULL;
+  }
+}
+
+/*
+ * Atomically increments the given value and returns the new value.
+ */
+long atomicIncrement(volatile long *value)
+{
+  return InterlockedIncrement(value);
+}
+
+/*
+ * Atomically decrements the given value and returns the new value.
+ */
+long atomicDecrement(volatile long *value)
+{
+  return InterlockedDecrement(value);
+}
+
+/*
+ * Atomically sets the given value to newValue, if it currently is expectedValue.
+ * Returns 1, if the value was set; 0, otherwise.
+ */
+int atomicCompareAndSwap(volatile long *value, long expectedValue, long newValue)
+{
+  return (InterlockedCompareExchange(value, newValue, expectedValue) == expectedValue) ? 1 : 0;
+}
+
+/*
+ * Atomically sets the given pointer to newValue, if it currently is
+ * expectedValue. Returns 1, if the pointer was set; 0, otherwise.
+ */
+int atomicCompareAndSwapPointer(void * volatile *value, void *expectedValue, void *newValue)
+{
+  return (InterlockedCompareExchangePointer(value, newValue, expectedValue) == expectedValue) ? 1 : 0;
+}
+
+/*
+ * Lets other threads run, e.g. while spinning for a lock held by a thread,
+ * which was preempted.
+ */
+void yieldNativeThread(void)
+{
+  SwitchToThread();
+}
+
+/* The index of the fiber local value, which tells that a thread was attached
+ * to the VM for callbacks. Its callback detaches the thread.
+ */
+static DWORD attachedThreadIndex = FLS_OUT_OF_INDEXES;
+
+/*
+ * Detaches a terminating thread, which was attached by attachCurrentThread.
+ */
+static VOID WINAPI detachTerminatingThread(PVOID vm)
+{
+  if (vm != NULL) {
+    (*((JavaVM *) vm))->DetachCurrentThread((JavaVM *) vm);
+  }
+}
+
+/*
+ * Allocates the index for remembering attached threads. This is called once,
+ * when the library is loaded.
+ */
+void initializeThreadAttachment(void)
+{
+  if (attachedThreadIndex == FLS_OUT_OF_INDEXES) {
+    attachedThreadIndex = FlsAlloc(&detachTerminatingThread);
+  }
+}
+
+/*
+ * The index for remembering attached threads is not freed, because FlsFree
+ * would call the detach callback for all attached threads on the calling
+ * thread. Threads that are still attached stay attached.
+ */
+void finalizeThreadAttachment(void)
+{
+}
+
+/*
+ * Attaches the calling native thread to the VM as daemon thread. It stays
+ * attached for following callbacks and gets detached, when it terminates.
+ * Returns NULL, if attaching fails.
+ */
+JNIEnv *attachCurrentThread(JavaVM *vm)
+{
+  JNIEnv *env;
+
+  if ((*vm)->AttachCurrentThreadAsDaemon(vm, (void **) &env, NULL) != JNI_OK) {
+    return NULL;
+  }
+  if (attachedThreadIndex != FLS_OUT_OF_INDEXES) {
+    FlsSetValue(attachedThreadIndex, vm);
+  }
+
+  return env;
+}
+
+/* The index of the fiber local value, which holds the scratch arena of a
+ * thread. Its callback frees the arena.
+ */
+static DWORD scratchArenaIndex = FLS_OUT_OF_INDEXES;
+
+/*
+ * Frees the scratch arena of a terminating thread.
+ */
+static VOID WINAPI freeTerminatingScratchArena(PVOID arena)
+{
+  if (arena != NULL) {
+    freeScratchArena(arena);
+  }
+}
+
+/*
+ * Allocates the index for the scratch arenas. This is called once, when the
+ * library is loaded.
+ */
+void initializeScratchArenas(void)
+{
+  if (scratchArenaIndex == FLS_OUT_OF_INDEXES) {
+    scratchArenaIndex = FlsAlloc(&freeTerminatingScratchArena);
+  }
+}
+
+/*
+ * Frees the index for the scratch arenas. FlsFree calls the callback for the
+ * arenas that are still set, which frees them.
+ */
+void finalizeScratchArenas(void)
+{
+  if (scratchArenaIndex != FLS_OUT_OF_INDEXES) {
+    FlsFree(scratchArenaIndex);
+    scratchArenaIndex = FLS_OUT_OF_INDEXES;
+  }
+}
+
+/*
+ * Returns the scratch arena of the calling thread or NULL, if it has none.
+ */
+void *getThreadScratchArena(void)
+{
+  return (scratchArenaIndex != FLS_OUT_OF_INDEXES) ? FlsGetValue(scratchArenaIndex) : NULL;
+}
+
+/*
+ * Sets the scratch arena of the calling thread. Returns 0, if it cannot be set.
+ */
+int setThreadScratchArena(void *arena)
+{
+  return (scratchArenaIndex != FLS_OUT_OF_INDEXES && FlsSetValue(scratchArenaIndex, arena)) ? 1 : 0;
+}
+
+/*
+ * Creates a new critical section as mutex for the module.
+ */
+CK_RV createNativeMutex(CK_VOID_PTR_PTR ppMutex)
+{
+  CRITICAL_SECTION *mutex;
+
+  if (ppMutex == NULL) {
+    return CKR_ARGUMENTS_BAD;
+  }
+  mutex = (CRITICAL_SECTION *) malloc(sizeof(CRITICAL_SECTION));
+  if (mutex == NULL) {
+    return CKR_HOST_MEMORY;
+  }
+  InitializeCriticalSection(mutex);
+  *ppMutex = mutex;
+
+  return CKR_OK;
+}
+
+/*
+ * Destroys a mutex created by createNativeMutex.
+ */
+CK_RV destroyNativeMutex(CK_VOID_PTR pMutex)
+{
+  if (pMutex == NULL) {
+    return CKR_MUTEX_BAD;
+  }
+  DeleteCriticalSection((CRITICAL_SECTION *) pMutex);
+  free(pMutex);
+
+  return CKR_OK;
+}
+
+/*
+ * Locks a mutex created by createNativeMutex.
+ */
+CK_RV lockNativeMutex(CK_VOID_PTR pMutex)
+{
+  if (pMutex == NULL) {
+    return CKR_MUTEX_BAD;
+  }
+  EnterCriticalSection((CRITICAL_SECTION *) pMutex);
+
+  return CKR_OK;
+}
+
+/*
+ * Unlocks a mutex created by createNativeMutex. A critical section cannot tell,
+ * if the calling thread holds it, so this does not detect CKR_MUTEX_NOT_LOCKED.
+ */
+CK_RV unlockNativeMutex(CK_VOID_PTR pMutex)
+{
+  if (pMutex == NULL) {
+    return CKR_MUTEX_BAD;
+  }
+  LeaveCriticalSection((CRITICAL_SECTION *) pMutex);
+
+  return CKR_OK;
+}
+
+/* The function and argument of a thread started by startNativeThread. */
+struct NativeThread {
+  HANDLE thread;
+  NativeThreadFunction function;
+  void *argument;
+};
+typedef struct NativeThread NativeThread;
+
+/*
+ * Runs the function of a thread started by startNativeThread.
+ */
+static DWORD WINAPI runNativeThread(LPVOID thread)
+{
+  (*((NativeThread *) thread)->function)(((NativeThread *) thread)->argument);
+
+  return 0;
+}
+
+/*
+ * Starts a new thread running the given function with the given argument.
+ * Returns NULL, if the thread cannot be started; otherwise, the caller must
+ * call joinNativeThread for the returned thread.
+ */
+void *startNativeThread(NativeThreadFunction function, void *argument)
+{
+  NativeThread *nativeThread;
+
+  nativeThread = (NativeThread *) malloc(sizeof(NativeThread));
+  if (nativeThread == NULL) {
+    return NULL;
+  }
+  nativeThread->function = function;
+  nativeThread->argument = argument;
+  nativeThread->thread = CreateThread(NULL, 0, &runNativeThread, nativeThread, 0, NULL);
+  if (nativeThread->thread == NULL) {
+    free(nativeThread);
+    return NULL;
+  }
+
+  return nativeThread;
+}
+
+/*
+ * Waits until a thread started by startNativeThread has terminated and frees it.
+ */
+void joinNativeThread(void *thread)
+{
+  WaitForSingleObject(((NativeThread *) thread)->thread, INFINITE);
+  CloseHandle(((NativeThread *) thread)->thread);
+  free(thread);
+}
+
+/*
+ * Creates a new signal, which is not raised; a semaphore, so that each raise
+ * lets one wait return. Returns NULL, if it cannot be created.
+ */
+void *createNativeSignal(void)
+{
+  return CreateSemaphore(NULL, 0, 0x7FFFFFFF, NULL);
+}
+
+/*
+ * Destroys a signal created by createNativeSignal. No thread may wait for it.
+ */
+void destroyNativeSignal(void *signal)
+{
+  CloseHandle((HANDLE) signal);
+}
+
+/*
+ * Raises the signal count times; i.e. lets count waits return.
+ */
+void raiseNativeSignal(void *signal, long count)
+{
+  ReleaseSemaphore((HANDLE) signal, count, NULL);
+}
+
+/*
+ * Waits until the signal is raised or the timeout in milliseconds expires. A
+ * negative timeout waits as long as it takes. Returns 1, if the signal was
+ * raised, or 0, if the timeout expired.
+ */
+int waitNativeSignal(void *signal, long timeout)
+{
+  return (WaitForSingleObject((HANDLE) signal, (timeout >= 0) ? (DWORD) timeout : INFINITE)
+          == WAIT_OBJECT_0) ? 1 : 0;
+}
+
+/*
+ * Returns the milliseconds of a clock, which never jumps back. Only the
+ * difference of two values, computed in unsigned arithmetic, has a meaning.
+ */
+long getNativeMilliseconds(void)
+{
+  return (long) GetTickCount();
+}
+
+/*
+ * Orders all memory accesses before this call before all accesses after it.
+ */
+void memoryBarrier(void)
+{
+  MemoryBarrier();
+}